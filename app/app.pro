@@ -10,21 +10,32 @@ INCLUDEPATH += \
 HEADERS += \
     src/base/article.h \
     src/base/articlemodel.h \
+    src/base/bandwidthscheduler.h \
     src/base/categorymodel.h \
     src/base/categorynamemodel.h \
     src/base/concurrenttransfersmodel.h \
+    src/base/customcommandscheduler.h \
     src/base/database.h \
+    src/base/datawriter.h \
     src/base/dbconnection.h \
+    src/base/dbmaintenance.h \
     src/base/dbnotify.h \
     src/base/diskcache.h \
     src/base/download.h \
     src/base/enclosuredownload.h \
     src/base/feedparser.h \
     src/base/json.h \
+    src/base/jsonreader.h \
+    src/base/jsonwriter.h \
     src/base/loggerverbositymodel.h \
+    src/base/logwriter.h \
+    src/base/mediaprefetcher.h \
+    src/base/metrics.h \
+    src/base/msgpackwriter.h \
     src/base/networkproxytypemodel.h \
     src/base/opmlparser.h \
     src/base/selectionmodel.h \
+    src/base/settingscache.h \
     src/base/subscription.h \
     src/base/subscriptionmodel.h \
     src/base/subscriptions.h \
@@ -33,9 +44,11 @@ HEADERS += \
     src/base/transferprioritymodel.h \
     src/base/transfers.h \
     src/base/updateintervaltypemodel.h \
+    src/base/updatescheduler.h \
     src/base/urlopenermodel.h \
     src/base/utils.h \
     src/plugins/articlerequest.h \
+    src/plugins/cachedarticlerequest.h \
     src/plugins/enclosurerequest.h \
     src/plugins/externalarticlerequest.h \
     src/plugins/externalenclosurerequest.h \
@@ -57,24 +70,37 @@ HEADERS += \
 SOURCES += \
     src/base/article.cpp \
     src/base/articlemodel.cpp \
+    src/base/bandwidthscheduler.cpp \
     src/base/categorymodel.cpp \
+    src/base/customcommandscheduler.cpp \
+    src/base/datawriter.cpp \
     src/base/dbconnection.cpp \
+    src/base/dbmaintenance.cpp \
     src/base/dbnotify.cpp \
     src/base/diskcache.cpp \
     src/base/download.cpp \
     src/base/enclosuredownload.cpp \
     src/base/feedparser.cpp \
     src/base/json.cpp \
+    src/base/jsonreader.cpp \
+    src/base/jsonwriter.cpp \
+    src/base/logwriter.cpp \
+    src/base/mediaprefetcher.cpp \
+    src/base/metrics.cpp \
+    src/base/msgpackwriter.cpp \
     src/base/opmlparser.cpp \
     src/base/selectionmodel.cpp \
+    src/base/settingscache.cpp \
     src/base/subscription.cpp \
     src/base/subscriptionmodel.cpp \
     src/base/subscriptions.cpp \
     src/base/transfer.cpp \
     src/base/transfermodel.cpp \
     src/base/transfers.cpp \
+    src/base/updatescheduler.cpp \
     src/base/urlopenermodel.cpp \
     src/base/utils.cpp \
+    src/plugins/cachedarticlerequest.cpp \
     src/plugins/externalarticlerequest.cpp \
     src/plugins/externalenclosurerequest.cpp \
     src/plugins/externalfeedplugin.cpp \
@@ -339,6 +365,10 @@ maemo5 {
         DBUS_INTERFACE \
         WEB_INTERFACE
     
+    linux-* {
+        DEFINES += USE_FALLOCATE
+    }
+    
     lessThan(QT_MAJOR_VERSION, 5) {
         QT += webkit
     }
@@ -466,14 +496,20 @@ contains(DEFINES, WEB_INTERFACE) {
         src/qhttpserver/qhttpserver.h \
         src/qhttpserver/qhttpserverapi.h \
         src/qhttpserver/qhttpserverfwd.h \
+        src/qhttpserver/qhttpworker.h \
         src/webif/articleserver.h \
+        src/webif/changelog.h \
+        src/webif/databaseserver.h \
         src/webif/enclosureserver.h \
         src/webif/fileserver.h \
         src/webif/pluginserver.h \
+        src/webif/requestlimiter.h \
         src/webif/serverresponse.h \
         src/webif/settingsserver.h \
         src/webif/transferserver.h \
         src/webif/subscriptionserver.h \
+        src/webif/syncserver.h \
+        src/webif/webrequesthandler.h \
         src/webif/webserver.h
     
     SOURCES += \
@@ -482,12 +518,18 @@ contains(DEFINES, WEB_INTERFACE) {
         src/qhttpserver/qhttprequest.cpp \
         src/qhttpserver/qhttpresponse.cpp \
         src/qhttpserver/qhttpserver.cpp \
+        src/qhttpserver/qhttpworker.cpp \
         src/webif/articleserver.cpp \
+        src/webif/changelog.cpp \
+        src/webif/databaseserver.cpp \
         src/webif/enclosureserver.cpp \
         src/webif/fileserver.cpp \
         src/webif/pluginserver.cpp \
+        src/webif/requestlimiter.cpp \
         src/webif/settingsserver.cpp \
         src/webif/subscriptionserver.cpp \
+        src/webif/syncserver.cpp \
         src/webif/transferserver.cpp \
+        src/webif/webrequesthandler.cpp \
         src/webif/webserver.cpp
 }
@@ -0,0 +1,131 @@
+/*
+ * Copyright (C) 2017 Stuart Howarth <showarth@marxoft.co.uk>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/*
+ * Compares the Utils text helpers with the implementations they replaced, which are copied here.
+ *
+ * Build and run with: qmake && make && ./textutils [iterations]
+ */
+
+#include "utils.h"
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QRegExp>
+#include <QStringList>
+#include <QTextStream>
+
+static QString oldReplaceSrcPaths(const QString &s, const QString &path) {
+    QString result(s);
+    const QRegExp src(" src=('|\")([^'\"]+)");
+    int pos = 0;
+    
+    while ((pos = src.indexIn(result, pos)) != -1) {
+        const QString url = src.cap(2);
+        const QString rep = path + url.toUtf8().toBase64();
+        result.replace(pos + 6, url.size(), rep);
+        pos += rep.size() + 7;
+    }
+    
+    return result;
+}
+
+static QString oldToRichText(const QString &s) {
+    QString result(s);
+    result.replace("&", "&amp;");
+    result.replace("<", "&lt;");
+    result.replace(QRegExp("[\n\r]"), "<br>");
+    
+    QRegExp re("((http(s|)://|[\\w-_\\.]+@)[^\\s<:\"']+)");
+    int pos = 0;
+    
+    while ((pos = re.indexIn(result, pos)) != -1) {
+        QString link = re.cap(1);
+        result.replace(pos, link.size(), QString("<a href='%1'>%2</a>")
+                .arg(link.contains('@') ? "mailto:" + link : link).arg(link));
+        pos += re.matchedLength() * 2 + 15;
+    }
+    
+    return result;
+}
+
+static QString oldUnescapeHtml(const QString &html) {
+    QString s(html);
+    s.replace("&amp;", "&");
+    s.replace("&apos;", "'");
+    s.replace("&lt;", "<");
+    s.replace("&gt;", ">");
+    s.replace("&quot;", "\"");
+    return s;
+}
+
+// An article body with the given number of paragraphs, each with an image, a link and some entities
+static QString articleBody(int paragraphs) {
+    QString body;
+    
+    for (int i = 0; i < paragraphs; i++) {
+        body.append(QString("<p>Paragraph %1 &lt;with&gt; &quot;entities&quot; &amp; more &apos;text&apos;. "
+                            "<img src=\"http://example.com/images/%1.jpg\" alt=\"\"> See http://example.com/%1 "
+                            "or mail news%1@example.com</p>\n").arg(i));
+    }
+    
+    return body;
+}
+
+template<typename Function>
+static qint64 run(Function function, const QString &input, int iterations) {
+    QElapsedTimer timer;
+    timer.start();
+    int size = 0;
+    
+    for (int i = 0; i < iterations; i++) {
+        size += function(input).size();
+    }
+    
+    Q_UNUSED(size);
+    return timer.elapsed();
+}
+
+static QString newReplaceSrcPaths(const QString &s) {
+    return Utils::replaceSrcPaths(s, "/cache/");
+}
+
+static QString oldReplaceSrcPathsWithPath(const QString &s) {
+    return oldReplaceSrcPaths(s, "/cache/");
+}
+
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+    const QStringList args = app.arguments();
+    const int iterations = args.size() > 1 ? qMax(1, args.at(1).toInt()) : 100;
+    QTextStream out(stdout);
+    out << "Iterations: " << iterations << "\n";
+    out << "Paragraphs\tFunction\tOld (ms)\tNew (ms)\n";
+    
+    const int sizes[] = { 10, 100, 1000 };
+    
+    for (int i = 0; i < 3; i++) {
+        const QString body = articleBody(sizes[i]);
+        out << sizes[i] << "\treplaceSrcPaths\t" << run(oldReplaceSrcPathsWithPath, body, iterations) << "\t"
+            << run(newReplaceSrcPaths, body, iterations) << "\n";
+        out << sizes[i] << "\tunescapeHtml\t" << run(oldUnescapeHtml, body, iterations) << "\t"
+            << run(Utils::unescapeHtml, body, iterations) << "\n";
+        out << sizes[i] << "\ttoRichText\t" << run(oldToRichText, body, iterations) << "\t"
+            << run(Utils::toRichText, body, iterations) << "\n";
+    }
+    
+    return 0;
+}
@@ -0,0 +1,14 @@
+TEMPLATE = app
+TARGET = textutils
+
+QT -= gui
+CONFIG += console
+CONFIG -= app_bundle
+
+INCLUDEPATH += ../../src/base
+
+HEADERS += ../../src/base/utils.h
+
+SOURCES += \
+    ../../src/base/utils.cpp \
+    main.cpp
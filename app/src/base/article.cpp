@@ -17,7 +17,7 @@
 #include "article.h"
 #include "dbconnection.h"
 #include "dbnotify.h"
-#include "json.h"
+#include "jsonreader.h"
 
 class ArticleRoleNames : public QHash<int, QByteArray>
 {
@@ -310,8 +310,12 @@ void Article::setAutoUpdate(bool enabled) {
         if (enabled) {
             connect(DBNotify::instance(), SIGNAL(articleFavourited(QString, bool)),
                     this, SLOT(onArticleFavourited(QString, bool)));
+            connect(DBNotify::instance(), SIGNAL(articlesFavourited(QStringList, bool)),
+                    this, SLOT(onArticlesFavourited(QStringList, bool)));
             connect(DBNotify::instance(), SIGNAL(articleRead(QString, QString, bool)),
                     this, SLOT(onArticleRead(QString, QString, bool)));
+            connect(DBNotify::instance(), SIGNAL(articlesRead(QStringList, QStringList, bool)),
+                    this, SLOT(onArticlesRead(QStringList, QStringList, bool)));
             connect(DBNotify::instance(), SIGNAL(subscriptionRead(QString, bool)),
                     this, SLOT(onSubscriptionRead(QString, bool)));
             connect(DBNotify::instance(), SIGNAL(allSubscriptionsRead()), this, SLOT(onAllSubscriptionsRead()));
@@ -356,7 +360,7 @@ void Article::onArticleFetched(DBConnection *connection) {
         setBody(connection->value(2).toString());
         setCategories(connection->value(3).toString().split(", ", QString::SkipEmptyParts));
         setDate(QDateTime::fromTime_t(connection->value(4).toInt()));
-        setEnclosures(QtJson::Json::parse(connection->value(5).toString()).toList());
+        setEnclosures(JsonReader::parse(connection->value(5).toString()).toList());
         setFavourite(connection->value(6).toBool());
         setRead(connection->value(7).toBool());
         setSubscriptionId(connection->value(8).toString());
@@ -380,12 +384,24 @@ void Article::onArticleFavourited(const QString &articleId, bool isFavourite) {
     }
 }
 
+void Article::onArticlesFavourited(const QStringList &articleIds, bool isFavourite) {
+    if (articleIds.contains(id())) {
+        setFavourite(isFavourite);
+    }
+}
+
 void Article::onArticleRead(const QString &articleId, const QString &, bool isRead) {
     if (articleId == id()) {
         setRead(isRead);
     }
 }
 
+void Article::onArticlesRead(const QStringList &articleIds, const QStringList &, bool isRead) {
+    if (articleIds.contains(id())) {
+        setRead(isRead);
+    }
+}
+
 void Article::onSubscriptionRead(const QString &subscriptionId, bool isRead) {
     if (subscriptionId == this->subscriptionId()) {
         setRead(isRead);
@@ -127,7 +127,9 @@ public Q_SLOTS:
 private Q_SLOTS:
     void onArticleFetched(DBConnection *connection);
     void onArticleFavourited(const QString &articleId, bool isFavourite);
+    void onArticlesFavourited(const QStringList &articleIds, bool isFavourite);
     void onArticleRead(const QString &articleId, const QString &subscriptionId, bool isRead);
+    void onArticlesRead(const QStringList &articleIds, const QStringList &subscriptionIds, bool isRead);
     void onSubscriptionRead(const QString &subscriptionId, bool isRead);
     void onAllSubscriptionsRead();
 
@@ -19,7 +19,7 @@
 #include "dbconnection.h"
 #include "dbnotify.h"
 #include "definitions.h"
-#include "json.h"
+#include "jsonreader.h"
 #include <QFont>
 #include <QIcon>
 
@@ -41,6 +41,8 @@ ArticleModel::ArticleModel(QObject *parent) :
             this, SLOT(onArticlesDeleted(QStringList, QString)));
     connect(DBNotify::instance(), SIGNAL(articleFavourited(QString, bool)),
             this, SLOT(onArticleFavourited(QString, bool)));
+    connect(DBNotify::instance(), SIGNAL(articlesFavourited(QStringList, bool)),
+            this, SLOT(onArticlesFavourited(QStringList, bool)));
     connect(DBNotify::instance(), SIGNAL(subscriptionDeleted(QString)), this, SLOT(onSubscriptionDeleted(QString)));
 }
 
@@ -274,6 +276,22 @@ bool ArticleModel::remove(int row) {
     return false;
 }
 
+void ArticleModel::markAllRead(bool read) {
+    QStringList ids;
+    
+    foreach (const Article *article, m_list) {
+        if (article->isRead() != read) {
+            ids << article->id();
+        }
+    }
+    
+    if (!ids.isEmpty()) {
+        DBConnection *connection = DBConnection::connection();
+        connect(connection, SIGNAL(finished(DBConnection*)), connection, SLOT(deleteLater()));
+        connection->markArticlesRead(ids, read);
+    }
+}
+
 QModelIndexList ArticleModel::match(const QModelIndex &start, int role, const QVariant &value, int hits,
                                     Qt::MatchFlags flags) const {
     return QAbstractListModel::match(start, role, value, hits, flags);
@@ -390,22 +408,24 @@ void ArticleModel::onArticlesDeleted(const QStringList &articleIds, const QStrin
 }
 
 void ArticleModel::onArticleFavourited(const QString &articleId, bool isFavourite) {
+    onArticlesFavourited(QStringList() << articleId, isFavourite);
+}
+
+void ArticleModel::onArticlesFavourited(const QStringList &articleIds, bool isFavourite) {
     if ((m_subscriptionId == FAVOURITES_SUBSCRIPTION_ID) && (status() == Ready)) {
         if (isFavourite) {
             m_insert = true;
             setStatus(Active);
-            DBConnection::connection(this, SLOT(onArticlesFetched(DBConnection*)))->fetchArticles(QStringList()
-                                                                                                  << articleId);
+            DBConnection::connection(this, SLOT(onArticlesFetched(DBConnection*)))->fetchArticles(articleIds);
         }
         else {
-            for (int i = 0; i < m_list.size(); i++) {
-                if (m_list.at(i)->id() == articleId) {
+            for (int i = m_list.size() - 1; i >= 0; i--) {
+                if (articleIds.contains(m_list.at(i)->id())) {
                     beginRemoveRows(QModelIndex(), i, i);
                     m_list.takeAt(i)->deleteLater();
                     endRemoveRows();
                     emit countChanged(rowCount());
                     m_offset--;
-                    return;
                 }
             }
         }
@@ -423,7 +443,7 @@ void ArticleModel::onArticlesFetched(DBConnection *connection) {
                                                connection->value(2).toString(),
                                                connection->value(3).toString().split(", ", QString::SkipEmptyParts),
                                                QDateTime::fromTime_t(connection->value(4).toInt()),
-                                               QtJson::Json::parse(connection->value(5).toString()).toList(),
+                                               JsonReader::parse(connection->value(5).toString()).toList(),
                                                connection->value(6).toBool(), connection->value(7).toBool(),
                                                connection->value(8).toString(), connection->value(9).toString(),
                                                connection->value(10).toString(), this);
@@ -440,7 +460,7 @@ void ArticleModel::onArticlesFetched(DBConnection *connection) {
                                                connection->value(2).toString(),
                                                connection->value(3).toString().split(", ", QString::SkipEmptyParts),
                                                QDateTime::fromTime_t(connection->value(4).toInt()),
-                                               QtJson::Json::parse(connection->value(5).toString()).toList(),
+                                               JsonReader::parse(connection->value(5).toString()).toList(),
                                                connection->value(6).toBool(), connection->value(7).toBool(),
                                                connection->value(8).toString(), connection->value(9).toString(),
                                                connection->value(10).toString(), this);
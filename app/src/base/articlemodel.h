@@ -81,6 +81,8 @@ public:
     Q_INVOKABLE Article* get(int row) const;
     Q_INVOKABLE bool remove(int row);
     
+    Q_INVOKABLE void markAllRead(bool read = true);
+    
     QModelIndexList match(const QModelIndex &start, int role, const QVariant &value, int hits = 1,
                           Qt::MatchFlags flags = Qt::MatchFlags(Qt::MatchExactly | Qt::MatchWrap)) const;
     Q_INVOKABLE int match(int start, const QByteArray &role, const QVariant &value,
@@ -97,6 +99,7 @@ private Q_SLOTS:
     void onArticlesAdded(const QStringList &articleIds, const QString &subscriptionId);
     void onArticlesDeleted(const QStringList &articleIds, const QString &subscriptionId);
     void onArticleFavourited(const QString &articleId, bool isFavourite);
+    void onArticlesFavourited(const QStringList &articleIds, bool isFavourite);
     void onArticlesFetched(DBConnection *connection);
     void onSubscriptionDeleted(const QString &id);
 
@@ -0,0 +1,185 @@
+/*
+ * Copyright (C) 2017 Stuart Howarth <showarth@marxoft.co.uk>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "bandwidthscheduler.h"
+#include "enclosuredownload.h"
+#include "settings.h"
+
+static const int ALLOCATION_INTERVAL = 100;
+
+BandwidthScheduler* BandwidthScheduler::self = 0;
+
+BandwidthScheduler::BandwidthScheduler() :
+    QObject(),
+    m_globalLimit(qint64(Settings::maximumDownloadSpeed()) * 1024)
+{
+    foreach (const QString &category, Settings::categoryNames()) {
+        const int speed = Settings::maximumDownloadSpeed(category);
+        
+        if (speed > 0) {
+            m_categoryLimits[category] = qint64(speed) * 1024;
+        }
+    }
+    
+    m_timer.setInterval(ALLOCATION_INTERVAL);
+    
+    connect(&m_timer, SIGNAL(timeout()), this, SLOT(allocate()));
+    connect(Settings::instance(), SIGNAL(maximumDownloadSpeedChanged(int)),
+            this, SLOT(onMaximumDownloadSpeedChanged(int)));
+    connect(Settings::instance(), SIGNAL(categoryMaximumDownloadSpeedChanged(QString, int)),
+            this, SLOT(onCategoryMaximumDownloadSpeedChanged(QString, int)));
+}
+
+BandwidthScheduler::~BandwidthScheduler() {
+    self = 0;
+}
+
+BandwidthScheduler* BandwidthScheduler::instance() {
+    return self ? self : self = new BandwidthScheduler;
+}
+
+qint64 BandwidthScheduler::limit(const EnclosureDownload *transfer) const {
+    const qint64 transferLimit = qint64(transfer->maximumSpeed()) * 1024;
+    const qint64 categoryLimit = m_categoryLimits.value(transfer->category(), 0);
+    
+    if (transferLimit <= 0) {
+        return categoryLimit;
+    }
+    
+    return categoryLimit > 0 ? qMin(transferLimit, categoryLimit) : transferLimit;
+}
+
+qint64 BandwidthScheduler::acquire(EnclosureDownload *transfer, qint64 bytes) {
+    if ((m_globalLimit <= 0) && (limit(transfer) <= 0)) {
+        return bytes;
+    }
+    
+    if (!m_allowances.contains(transfer)) {
+        connect(transfer, SIGNAL(destroyed(QObject*)), this, SLOT(onTransferDestroyed(QObject*)));
+    }
+    
+    qint64 &allowance = m_allowances[transfer];
+    const qint64 granted = qMin(bytes, allowance);
+    allowance -= granted;
+    
+    if (granted < bytes) {
+        m_waiting.insert(transfer);
+        
+        if (!m_timer.isActive()) {
+            m_time.start();
+            m_timer.start();
+        }
+    }
+    
+    return granted;
+}
+
+// Returns the part of a budget of one interval's worth of limit, with at most one second's worth of limit
+// allowed in total, that is given to a transfer of the given weight
+static qint64 share(qint64 limit, qint64 allowance, int elapsed, int weight, int totalWeight) {
+    const qint64 budget = qMin(limit * elapsed / 1000, limit - allowance);
+    return budget > 0 ? budget * weight / totalWeight : 0;
+}
+
+void BandwidthScheduler::allocate() {
+    const int elapsed = qMax(1, m_time.restart());
+    
+    if (m_waiting.isEmpty()) {
+        m_timer.stop();
+        return;
+    }
+    
+    // Allowances that are not being used are released, so that they do not count towards the totals
+    qint64 globalAllowance = 0;
+    QHash<QString, qint64> categoryAllowances;
+    QMutableHashIterator<EnclosureDownload*, qint64> iterator(m_allowances);
+    
+    while (iterator.hasNext()) {
+        iterator.next();
+        
+        if (iterator.key()->status() != Transfer::Downloading) {
+            iterator.setValue(0);
+        }
+        else if (iterator.value() > 0) {
+            globalAllowance += iterator.value();
+            categoryAllowances[iterator.key()->category()] += iterator.value();
+        }
+    }
+    
+    // The global and category budgets are shared between the waiting transfers they apply to,
+    // weighted by priority
+    int totalWeight = 0;
+    QHash<QString, int> categoryWeights;
+    
+    foreach (const EnclosureDownload *transfer, m_waiting) {
+        const int weight = 1 << (Transfer::LowestPriority - transfer->priority());
+        totalWeight += weight;
+        categoryWeights[transfer->category()] += weight;
+    }
+    
+    const QList<EnclosureDownload*> waiting = m_waiting.toList();
+    m_waiting.clear();
+    
+    foreach (EnclosureDownload *transfer, waiting) {
+        const int weight = 1 << (Transfer::LowestPriority - transfer->priority());
+        const QString category = transfer->category();
+        const qint64 categoryLimit = m_categoryLimits.value(category, 0);
+        const qint64 transferLimit = qint64(transfer->maximumSpeed()) * 1024;
+        qint64 granted = -1;
+        
+        if (m_globalLimit > 0) {
+            granted = share(m_globalLimit, globalAllowance, elapsed, weight, totalWeight);
+        }
+        
+        if (categoryLimit > 0) {
+            const qint64 s = share(categoryLimit, categoryAllowances.value(category), elapsed, weight,
+                                   categoryWeights.value(category));
+            granted = granted < 0 ? s : qMin(granted, s);
+        }
+        
+        if (transferLimit > 0) {
+            const qint64 s = share(transferLimit, m_allowances.value(transfer), elapsed, 1, 1);
+            granted = granted < 0 ? s : qMin(granted, s);
+        }
+        
+        if (granted > 0) {
+            m_allowances[transfer] += granted;
+        }
+        
+        // Only the transfers that are waiting are told, and they wait again if nothing was granted
+        QMetaObject::invokeMethod(transfer, "onBandwidthAvailable", Qt::QueuedConnection);
+    }
+}
+
+void BandwidthScheduler::onMaximumDownloadSpeedChanged(int speed) {
+    // Waiting transfers are given bandwidth under the new limit at the next allocation
+    m_globalLimit = qint64(speed) * 1024;
+}
+
+void BandwidthScheduler::onCategoryMaximumDownloadSpeedChanged(const QString &category, int speed) {
+    if (speed > 0) {
+        m_categoryLimits[category] = qint64(speed) * 1024;
+    }
+    else {
+        m_categoryLimits.remove(category);
+    }
+}
+
+void BandwidthScheduler::onTransferDestroyed(QObject *obj) {
+    EnclosureDownload *transfer = static_cast<EnclosureDownload*>(obj);
+    m_allowances.remove(transfer);
+    m_waiting.remove(transfer);
+}
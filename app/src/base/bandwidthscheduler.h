@@ -0,0 +1,63 @@
+/*
+ * Copyright (C) 2017 Stuart Howarth <showarth@marxoft.co.uk>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BANDWIDTHSCHEDULER_H
+#define BANDWIDTHSCHEDULER_H
+
+#include <QObject>
+#include <QHash>
+#include <QSet>
+#include <QTime>
+#include <QTimer>
+
+class EnclosureDownload;
+
+class BandwidthScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    ~BandwidthScheduler();
+    
+    static BandwidthScheduler* instance();
+    
+    qint64 acquire(EnclosureDownload *transfer, qint64 bytes);
+
+private Q_SLOTS:
+    void allocate();
+    
+    void onMaximumDownloadSpeedChanged(int speed);
+    void onCategoryMaximumDownloadSpeedChanged(const QString &category, int speed);
+    void onTransferDestroyed(QObject *obj);
+
+private:
+    BandwidthScheduler();
+    
+    qint64 limit(const EnclosureDownload *transfer) const;
+    
+    static BandwidthScheduler *self;
+    
+    qint64 m_globalLimit;
+    QHash<QString, qint64> m_categoryLimits;
+    
+    QHash<EnclosureDownload*, qint64> m_allowances;
+    QSet<EnclosureDownload*> m_waiting;
+    
+    QTimer m_timer;
+    QTime m_time;
+};
+
+#endif // BANDWIDTHSCHEDULER_H
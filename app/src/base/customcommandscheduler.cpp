@@ -0,0 +1,129 @@
+/*
+ * Copyright (C) 2017 Stuart Howarth <showarth@marxoft.co.uk>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "customcommandscheduler.h"
+#include "enclosuredownload.h"
+#include "logger.h"
+#include "settings.h"
+
+CustomCommandScheduler* CustomCommandScheduler::self = 0;
+
+CustomCommandScheduler::CustomCommandScheduler() :
+    QObject()
+{
+    connect(Settings::instance(), SIGNAL(maximumConcurrentCustomCommandsChanged(int)),
+            this, SLOT(onMaximumConcurrentCustomCommandsChanged()));
+}
+
+CustomCommandScheduler::~CustomCommandScheduler() {
+    self = 0;
+}
+
+CustomCommandScheduler* CustomCommandScheduler::instance() {
+    return self ? self : self = new CustomCommandScheduler;
+}
+
+int CustomCommandScheduler::active() const {
+    return m_active.size();
+}
+
+int CustomCommandScheduler::queued() const {
+    return m_queued.size();
+}
+
+QString CustomCommandScheduler::command(const QString &command) {
+    QString prefix;
+    const int niceness = Settings::customCommandNiceness();
+    
+    if (niceness > 0) {
+        prefix = QString("nice -n %1 ").arg(qMin(19, niceness));
+    }
+    
+    if (Settings::customCommandIdleIOEnabled()) {
+        prefix += "ionice -c 3 ";
+    }
+    
+    return prefix + command;
+}
+
+bool CustomCommandScheduler::acquire(EnclosureDownload *transfer) {
+    if (m_active.contains(transfer)) {
+        return true;
+    }
+    
+    const int max = Settings::maximumConcurrentCustomCommands();
+    
+    if (((max <= 0) || (active() < max)) && (m_queued.isEmpty())) {
+        connect(transfer, SIGNAL(destroyed(QObject*)), this, SLOT(onTransferDestroyed(QObject*)));
+        m_active.insert(transfer);
+        emit activeChanged(active());
+        return true;
+    }
+    
+    if (!m_queued.contains(transfer)) {
+        Logger::log("CustomCommandScheduler::acquire(). Queueing custom commands for transfer " + transfer->id(),
+                    Logger::MediumVerbosity);
+        connect(transfer, SIGNAL(destroyed(QObject*)), this, SLOT(onTransferDestroyed(QObject*)));
+        m_queued.enqueue(transfer);
+        emit queuedChanged(queued());
+    }
+    
+    return false;
+}
+
+void CustomCommandScheduler::release(EnclosureDownload *transfer) {
+    disconnect(transfer, SIGNAL(destroyed(QObject*)), this, SLOT(onTransferDestroyed(QObject*)));
+    
+    if (m_active.remove(transfer)) {
+        emit activeChanged(active());
+    }
+    
+    if (m_queued.removeOne(transfer)) {
+        emit queuedChanged(queued());
+    }
+    
+    startNextCommands();
+}
+
+void CustomCommandScheduler::startNextCommands() {
+    const int max = Settings::maximumConcurrentCustomCommands();
+    
+    while ((!m_queued.isEmpty()) && ((max <= 0) || (active() < max))) {
+        EnclosureDownload *transfer = m_queued.dequeue();
+        m_active.insert(transfer);
+        emit queuedChanged(queued());
+        emit activeChanged(active());
+        QMetaObject::invokeMethod(transfer, "startCustomCommands", Qt::QueuedConnection);
+    }
+}
+
+void CustomCommandScheduler::onMaximumConcurrentCustomCommandsChanged() {
+    startNextCommands();
+}
+
+void CustomCommandScheduler::onTransferDestroyed(QObject *obj) {
+    EnclosureDownload *transfer = static_cast<EnclosureDownload*>(obj);
+    
+    if (m_active.remove(transfer)) {
+        emit activeChanged(active());
+    }
+    
+    if (m_queued.removeOne(transfer)) {
+        emit queuedChanged(queued());
+    }
+    
+    startNextCommands();
+}
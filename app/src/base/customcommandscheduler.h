@@ -0,0 +1,65 @@
+/*
+ * Copyright (C) 2017 Stuart Howarth <showarth@marxoft.co.uk>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CUSTOMCOMMANDSCHEDULER_H
+#define CUSTOMCOMMANDSCHEDULER_H
+
+#include <QObject>
+#include <QQueue>
+#include <QSet>
+
+class EnclosureDownload;
+
+class CustomCommandScheduler : public QObject
+{
+    Q_OBJECT
+    
+    Q_PROPERTY(int active READ active NOTIFY activeChanged)
+    Q_PROPERTY(int queued READ queued NOTIFY queuedChanged)
+
+public:
+    ~CustomCommandScheduler();
+    
+    static CustomCommandScheduler* instance();
+    
+    int active() const;
+    int queued() const;
+    
+    static QString command(const QString &command);
+    
+    bool acquire(EnclosureDownload *transfer);
+    void release(EnclosureDownload *transfer);
+
+private Q_SLOTS:
+    void onMaximumConcurrentCustomCommandsChanged();
+    void onTransferDestroyed(QObject *obj);
+
+Q_SIGNALS:
+    void activeChanged(int active);
+    void queuedChanged(int queued);
+
+private:
+    CustomCommandScheduler();
+    
+    void startNextCommands();
+    
+    static CustomCommandScheduler *self;
+    
+    QSet<EnclosureDownload*> m_active;
+    QQueue<EnclosureDownload*> m_queued;
+};
+
+#endif // CUSTOMCOMMANDSCHEDULER_H
@@ -19,11 +19,80 @@
 
 #include "definitions.h"
 #include "logger.h"
+#include "utils.h"
 #include <QDir>
 #include <QSqlDatabase>
 #include <QSqlError>
 #include <QSqlQuery>
 
+static const int DATABASE_VERSION = 3;
+
+bool migrateDatabase(QSqlQuery &query) {
+    query.exec("PRAGMA user_version");
+    const int version = query.next() ? query.value(0).toInt() : 0;
+    
+    if (version >= DATABASE_VERSION) {
+        return true;
+    }
+    
+    Logger::log(QString("migrateDatabase(). Migrating database from version %1 to %2").arg(version)
+                .arg(DATABASE_VERSION), Logger::LowVerbosity);
+    
+    if (version < 1) {
+        // auto_vacuum can only be changed on an existing database by rebuilding it
+        query.exec("PRAGMA auto_vacuum");
+        
+        if ((!query.next()) || (query.value(0).toInt() != 2)) {
+            query.exec("PRAGMA auto_vacuum = INCREMENTAL");
+            query.exec("VACUUM");
+            QSqlError error = query.lastError();
+            
+            if (error.isValid()) {
+                Logger::log("migrateDatabase(). Error: " +  error.text());
+                return false;
+            }
+        }
+    }
+    
+    if (version < 2) {
+        // The text of compressed article bodies, which cannot be searched with LIKE
+        query.exec("ALTER TABLE articles ADD COLUMN searchText TEXT");
+        QSqlError error = query.lastError();
+        
+        if (error.isValid()) {
+            Logger::log("migrateDatabase(). Error: " +  error.text());
+            return false;
+        }
+    }
+    
+    if (version < 3) {
+        // Media was previously cached per article (CACHE_PATH/subscriptionId/articleId/). Those caches are
+        // replaced by the shared media cache, so any left from earlier versions are removed.
+        const QStringList reserved = QStringList() << QDir(MEDIA_CACHE_PATH).dirName()
+                                                   << QDir(THUMBNAIL_CACHE_PATH).dirName()
+                                                   << QDir(TEMPORARY_CACHE_PATH).dirName();
+        
+        foreach (const QFileInfo &subscription, QDir(CACHE_PATH).entryInfoList(QDir::Dirs | QDir::NoDotAndDotDot)) {
+            if (!reserved.contains(subscription.fileName())) {
+                foreach (const QFileInfo &article, QDir(subscription.absoluteFilePath())
+                                                   .entryInfoList(QDir::Dirs | QDir::NoDotAndDotDot)) {
+                    Utils::removeDirectory(article.absoluteFilePath());
+                }
+            }
+        }
+    }
+    
+    query.exec(QString("PRAGMA user_version = %1").arg(DATABASE_VERSION));
+    QSqlError error = query.lastError();
+    
+    if (error.isValid()) {
+        Logger::log("migrateDatabase(). Error: " +  error.text());
+        return false;
+    }
+    
+    return true;
+}
+
 bool initDatabase() {
     if (!DATABASE_PATH.isEmpty()) {
         if (!QDir().mkpath(DATABASE_PATH)) {
@@ -40,6 +109,8 @@ bool initDatabase() {
     }
     
     QSqlQuery query(db);
+    // Only takes effect for a new database. Existing databases are converted by migrateDatabase().
+    query.exec("PRAGMA auto_vacuum = INCREMENTAL");
     query.exec("CREATE TABLE IF NOT EXISTS subscriptions (id TEXT PRIMARY KEY NOT NULL, \
     description TEXT, downloadEnclosures INTEGER, iconPath TEXT, lastUpdated INTEGER, source TEXT, \
     sourceType INTEGER, title TEXT, updateInterval INTEGER, url TEXT)");
@@ -51,11 +122,31 @@ bool initDatabase() {
         return false;
     }
     
+    // The searchText column is added by migrateDatabase()
     query.exec("CREATE TABLE IF NOT EXISTS articles (id TEXT PRIMARY KEY NOT NULL, author TEXT, body TEXT, \
     categories TEXT, date INTEGER, enclosures TEXT, isFavourite INTEGER, isRead INTEGER, lastRead INTEGER, \
     subscriptionId TEXT REFERENCES subscriptions(id) ON DELETE CASCADE, title TEXT, url TEXT)");
     error = query.lastError();
     
+    if (error.isValid()) {
+        Logger::log("initDatabase(). Error: " +  error.text());
+        db.close();
+        return false;
+    }
+    // References from articles to URLs in the shared media cache
+    query.exec("CREATE TABLE IF NOT EXISTS media (articleId TEXT NOT NULL, url TEXT NOT NULL, \
+    PRIMARY KEY (articleId, url))");
+    error = query.lastError();
+    
+    if (error.isValid()) {
+        Logger::log("initDatabase(). Error: " +  error.text());
+        db.close();
+        return false;
+    }
+    
+    query.exec("CREATE INDEX IF NOT EXISTS media_url ON media (url)");
+    error = query.lastError();
+    
     if (error.isValid()) {
         Logger::log("initDatabase(). Error: " +  error.text());
         db.close();
@@ -71,6 +162,11 @@ bool initDatabase() {
         return false;
     }
 #endif
+    if (!migrateDatabase(query)) {
+        db.close();
+        return false;
+    }
+    
     Logger::log("initDatabase(). OK", Logger::LowVerbosity);
     db.close();
     return true;
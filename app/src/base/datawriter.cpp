@@ -0,0 +1,48 @@
+/*
+ * Copyright (C) 2017 Stuart Howarth <showarth@marxoft.co.uk>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "datawriter.h"
+#include <QStringList>
+
+void DataWriter::writeStringList(const QStringList &value) {
+    beginArray();
+    
+    foreach (const QString &s, value) {
+        writeString(s);
+    }
+    
+    endArray();
+}
+
+void DataWriter::writeProperty(const char *name, bool value) {
+    writeName(name);
+    writeBool(value);
+}
+
+void DataWriter::writeProperty(const char *name, qint64 value) {
+    writeName(name);
+    writeNumber(value);
+}
+
+void DataWriter::writeProperty(const char *name, const QString &value) {
+    writeName(name);
+    writeString(value);
+}
+
+void DataWriter::writeProperty(const char *name, const QVariant &value) {
+    writeName(name);
+    writeVariant(value);
+}
@@ -0,0 +1,62 @@
+/*
+ * Copyright (C) 2017 Stuart Howarth <showarth@marxoft.co.uk>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DATAWRITER_H
+#define DATAWRITER_H
+
+#include <QByteArray>
+#include <QVariant>
+
+/**
+ * The interface shared by the writers of the formats in which the web interface can respond.
+ *
+ * Values are written in order, with names written before each value of an object.
+ */
+class DataWriter
+{
+
+public:
+    virtual ~DataWriter() {}
+    
+    virtual QByteArray contentType() const = 0;
+    
+    virtual QByteArray data() const = 0;
+    
+    virtual void beginArray() = 0;
+    virtual void endArray() = 0;
+    
+    virtual void beginObject() = 0;
+    virtual void endObject() = 0;
+    
+    virtual void writeName(const char *name) = 0;
+    
+    virtual void writeNull() = 0;
+    virtual void writeBool(bool value) = 0;
+    virtual void writeNumber(qint64 value) = 0;
+    virtual void writeNumber(double value) = 0;
+    virtual void writeString(const QString &value) = 0;
+    virtual void writeRawJson(const QByteArray &json) = 0;
+    virtual void writeVariant(const QVariant &value) = 0;
+    
+    void writeStringList(const QStringList &value);
+    
+    void writeProperty(const char *name, bool value);
+    void writeProperty(const char *name, qint64 value);
+    void writeProperty(const char *name, const QString &value);
+    void writeProperty(const char *name, const QVariant &value);
+};
+
+#endif // DATAWRITER_H
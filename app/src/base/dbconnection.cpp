@@ -18,23 +18,118 @@
 #include "dbnotify.h"
 #include "definitions.h"
 #include "logger.h"
+#include "metrics.h"
+#include "settings.h"
 #include "utils.h"
+#include <QCoreApplication>
 #include <QDateTime>
+#include <QFile>
+#include <QHash>
+#include <QRegExp>
 #include <QSqlDatabase>
 #include <QSqlError>
 #include <QSqlRecord>
 #include <QThread>
+#include <QUrl>
 
 QThread* DBConnection::asyncThread = 0;
 
 const QString DBConnection::SUBSCRIPTION_FIELDS("subscriptions.id, subscriptions.description, subscriptions.downloadEnclosures, subscriptions.iconPath, subscriptions.lastUpdated, subscriptions.source, subscriptions.sourceType, subscriptions.title, subscriptions.updateInterval, subscriptions.url");
 const QString DBConnection::ARTICLE_FIELDS("articles.id, articles.author, articles.body, articles.categories, articles.date, articles.enclosures, articles.isFavourite, articles.isRead, articles.subscriptionId, articles.title, articles.url");
 
+// Article bodies/enclosures shorter than this are stored as plain text
+static const int COMPRESSION_THRESHOLD = 512;
+static const int COMPRESSION_BATCH_SIZE = 500;
+
+// Compressed cells are BLOBs beginning with this marker, which plain text (or JSON) never does
+static const QByteArray COMPRESSION_MARKER("\0CNZ", 4);
+
+// Property maps are used as column names in UPDATE statements, so only the columns in fields are accepted
+static QString invalidColumn(const QVariantMap &properties, const QString &table, const QString &fields) {
+    const QStringList columns = fields.split(", ");
+    
+    foreach (const QString &key, properties.keys()) {
+        if (!columns.contains(table + "." + key)) {
+            return key;
+        }
+    }
+    
+    return QString();
+}
+
+static bool isCompressed(const QVariant &value) {
+    return (value.type() == QVariant::ByteArray) && (value.toByteArray().startsWith(COMPRESSION_MARKER));
+}
+
+static QVariant compressedValue(const QVariant &value) {
+    if (((value.type() == QVariant::String) || (value.type() == QVariant::ByteArray)) && (!isCompressed(value))) {
+        const QByteArray data = value.type() == QVariant::String ? value.toString().toUtf8() : value.toByteArray();
+        
+        if (data.size() >= COMPRESSION_THRESHOLD) {
+            return COMPRESSION_MARKER + qCompress(data);
+        }
+    }
+    
+    return value;
+}
+
+// LIKE cannot match compressed bodies, so the text of those is kept in the searchText column
+static QVariant searchText(const QVariant &body, const QVariant &storedBody) {
+    if (!isCompressed(storedBody)) {
+        return QVariant(QVariant::String);
+    }
+    
+    QString text = body.toString();
+    text.remove(QRegExp("<[^>]*>"));
+    return Utils::unescapeHtml(text).simplified();
+}
+
+static QVariant uncompressedValue(const QVariant &value) {
+    if (isCompressed(value)) {
+        return QString::fromUtf8(qUncompress(value.toByteArray().mid(COMPRESSION_MARKER.size())));
+    }
+    
+    return value;
+}
+
+QString DBConnection::idList(const QStringList &ids) {
+    QStringList quoted;
+    
+    foreach (QString id, ids) {
+        quoted << "'" + id.replace("'", "''") + "'";
+    }
+    
+    return quoted.join(", ");
+}
+
+static QVariantList mediaUrls(const QString &body) {
+    const QRegExp re(QRegExp::escape(CACHE_PATH) + "[^/'\"]+/[^/'\"]+/([^/'\"]+)");
+    QVariantList urls;
+    int pos = 0;
+    
+    while ((pos = re.indexIn(body, pos)) != -1) {
+        const QString url = QString::fromUtf8(QByteArray::fromBase64(re.cap(1).toUtf8()));
+        
+        if (!urls.contains(url)) {
+            urls << url;
+        }
+        
+        pos += re.matchedLength();
+    }
+    
+    return urls;
+}
+
 DBConnection::DBConnection(bool asynchronous) :
     QObject(),
     m_asynchronous(asynchronous),
     m_progress(0),
-    m_status(Idle)
+    m_status(Idle),
+    m_operation(0),
+    m_queued(false),
+    m_bufferResults(false),
+    m_recordIndex(-1),
+    m_numRowsAffected(-1)
 {
     if ((asynchronous) && (asyncThread)) {
         moveToThread(asyncThread);
@@ -42,9 +137,48 @@ DBConnection::DBConnection(bool asynchronous) :
 }
 
 DBConnection::~DBConnection() {
+    if (m_queued) {
+        Metrics::increment(Metrics::DatabaseQueueDepth, -1.0);
+    }
+    
     close();
 }
 
+bool DBConnection::event(QEvent *e) {
+    // Queued operations are timed from when they are taken from the queue
+    if ((m_queued) && (e->type() == QEvent::MetaCall)) {
+        m_queued = false;
+        Metrics::increment(Metrics::DatabaseQueueDepth, -1.0);
+        m_operationTimer.start();
+    }
+    
+    return QObject::event(e);
+}
+
+void DBConnection::finish() {
+    if (m_bufferResults) {
+        m_records.clear();
+        m_recordIndex = -1;
+        m_numRowsAffected = m_query.numRowsAffected();
+        
+        if (status() == Ready) {
+            // Single record fetches leave the query positioned on their result
+            if (m_query.isValid()) {
+                m_records << m_query.record();
+                m_recordIndex = 0;
+            }
+            
+            while (m_query.next()) {
+                m_records << m_query.record();
+            }
+        }
+        
+        m_query.clear();
+    }
+    
+    emit finished(this);
+}
+
 bool DBConnection::isAsynchronous() const {
     return m_asynchronous;
 }
@@ -90,15 +224,37 @@ void DBConnection::setStatus(DBConnection::Status s) {
             setProgress(100);
             break;
         }
+        
+        if ((m_operation) && ((s == Ready) || (s == Error))) {
+            Metrics::observe(Metrics::DatabaseOperationDuration, m_operationTimer.elapsed() / 1000.0, m_operation);
+            m_operation = 0;
+        }
     }
 }
 
+Qt::ConnectionType DBConnection::beginOperation(const char *operation) {
+    m_operation = operation;
+    
+    if (isAsynchronous()) {
+        m_queued = true;
+        Metrics::increment(Metrics::DatabaseQueueDepth);
+        return Qt::QueuedConnection;
+    }
+    
+    m_operationTimer.start();
+    return Qt::DirectConnection;
+}
+
 DBConnection* DBConnection::connection() {
     return new DBConnection(true);
 }
 
 DBConnection* DBConnection::connection(QObject *obj, const char *slot) {
     DBConnection *conn = new DBConnection(true);
+    // Results read in another thread than the main thread (e.g. by the web interface workers) are
+    // copied before they are delivered, since the query cannot be stepped outside the database
+    // thread while it is running other queries.
+    conn->m_bufferResults = (conn->isAsynchronous()) && (obj->thread() != QCoreApplication::instance()->thread());
     QObject::connect(conn, SIGNAL(finished(DBConnection*)), obj, slot);
     return conn;
 }
@@ -117,7 +273,7 @@ void DBConnection::addSubscription(const QVariantList &properties) {
     }
     
     setStatus(Active);
-    const Qt::ConnectionType connType = isAsynchronous() ? Qt::QueuedConnection : Qt::DirectConnection;
+    const Qt::ConnectionType connType = beginOperation("addSubscription");
     QMetaObject::invokeMethod(this, "_p_addSubscription", connType, Q_ARG(QVariantList, properties));
 }
 
@@ -127,7 +283,7 @@ void DBConnection::addSubscriptions(const QList<QVariantList> &subscriptions) {
     }
     
     setStatus(Active);
-    const Qt::ConnectionType connType = isAsynchronous() ? Qt::QueuedConnection : Qt::DirectConnection;
+    const Qt::ConnectionType connType = beginOperation("addSubscriptions");
     QMetaObject::invokeMethod(this, "_p_addSubscriptions", connType, Q_ARG(QList<QVariantList>, subscriptions));
 }
 
@@ -137,7 +293,7 @@ void DBConnection::deleteSubscription(const QString &id) {
     }
     
     setStatus(Active);
-    const Qt::ConnectionType connType = isAsynchronous() ? Qt::QueuedConnection : Qt::DirectConnection;
+    const Qt::ConnectionType connType = beginOperation("deleteSubscription");
     QMetaObject::invokeMethod(this, "_p_deleteSubscription", connType, Q_ARG(QString, id));
 }
 
@@ -147,18 +303,29 @@ void DBConnection::updateSubscription(const QString &id, const QVariantMap &prop
     }
     
     setStatus(Active);
-    const Qt::ConnectionType connType = isAsynchronous() ? Qt::QueuedConnection : Qt::DirectConnection;
+    const Qt::ConnectionType connType = beginOperation("updateSubscription");
     QMetaObject::invokeMethod(this, "_p_updateSubscription", connType, Q_ARG(QString, id),
                               Q_ARG(QVariantMap, properties), Q_ARG(bool, fetchResult));
 }
 
+void DBConnection::updateSubscriptions(const QStringList &ids, const QVariantMap &properties, bool fetchResult) {
+    if (status() == Active) {
+        return;
+    }
+    
+    setStatus(Active);
+    const Qt::ConnectionType connType = beginOperation("updateSubscriptions");
+    QMetaObject::invokeMethod(this, "_p_updateSubscriptions", connType, Q_ARG(QStringList, ids),
+                              Q_ARG(QVariantMap, properties), Q_ARG(bool, fetchResult));
+}
+
 void DBConnection::markSubscriptionRead(const QString &id, bool isRead, bool fetchResult) {
     if (status() == Active) {
         return;
     }
     
     setStatus(Active);
-    const Qt::ConnectionType connType = isAsynchronous() ? Qt::QueuedConnection : Qt::DirectConnection;
+    const Qt::ConnectionType connType = beginOperation("markSubscriptionRead");
     QMetaObject::invokeMethod(this, "_p_markSubscriptionRead", connType, Q_ARG(QString, id), Q_ARG(bool, isRead),
                               Q_ARG(bool, fetchResult));
 }
@@ -169,7 +336,7 @@ void DBConnection::markAllSubscriptionsRead() {
     }
     
     setStatus(Active);
-    const Qt::ConnectionType connType = isAsynchronous() ? Qt::QueuedConnection : Qt::DirectConnection;
+    const Qt::ConnectionType connType = beginOperation("markAllSubscriptionsRead");
     QMetaObject::invokeMethod(this, "_p_markAllSubscriptionsRead", connType);
 }
 
@@ -179,7 +346,7 @@ void DBConnection::fetchSubscription(const QString &id) {
     }
     
     setStatus(Active);
-    const Qt::ConnectionType connType = isAsynchronous() ? Qt::QueuedConnection : Qt::DirectConnection;
+    const Qt::ConnectionType connType = beginOperation("fetchSubscription");
     QMetaObject::invokeMethod(this, "_p_fetchSubscription", connType, Q_ARG(QString, id));
 }
 
@@ -189,7 +356,7 @@ void DBConnection::fetchSubscriptions(int offset, int limit) {
     }
     
     setStatus(Active);
-    const Qt::ConnectionType connType = isAsynchronous() ? Qt::QueuedConnection : Qt::DirectConnection;
+    const Qt::ConnectionType connType = beginOperation("fetchSubscriptions");
     QMetaObject::invokeMethod(this, "_p_fetchSubscriptions", connType, Q_ARG(int, offset), Q_ARG(int, limit));
 }
 
@@ -199,7 +366,7 @@ void DBConnection::fetchSubscriptions(const QStringList &ids) {
     }
     
     setStatus(Active);
-    const Qt::ConnectionType connType = isAsynchronous() ? Qt::QueuedConnection : Qt::DirectConnection;
+    const Qt::ConnectionType connType = beginOperation("fetchSubscriptions");
     QMetaObject::invokeMethod(this, "_p_fetchSubscriptions", connType, Q_ARG(QStringList, ids));
 }
 
@@ -209,7 +376,7 @@ void DBConnection::fetchSubscriptions(const QString &criteria) {
     }
     
     setStatus(Active);
-    const Qt::ConnectionType connType = isAsynchronous() ? Qt::QueuedConnection : Qt::DirectConnection;
+    const Qt::ConnectionType connType = beginOperation("fetchSubscriptions");
     QMetaObject::invokeMethod(this, "_p_fetchSubscriptions", connType, Q_ARG(QString, criteria));
 }
 
@@ -219,7 +386,7 @@ void DBConnection::addArticle(const QVariantList &properties, const QString &sub
     }
     
     setStatus(Active);
-    const Qt::ConnectionType connType = isAsynchronous() ? Qt::QueuedConnection : Qt::DirectConnection;
+    const Qt::ConnectionType connType = beginOperation("addArticle");
     QMetaObject::invokeMethod(this, "_p_addArticle", connType, Q_ARG(QVariantList, properties),
                               Q_ARG(QString, subscriptionId));
 }
@@ -230,7 +397,7 @@ void DBConnection::addArticles(const QList<QVariantList> &articles, const QStrin
     }
     
     setStatus(Active);
-    const Qt::ConnectionType connType = isAsynchronous() ? Qt::QueuedConnection : Qt::DirectConnection;
+    const Qt::ConnectionType connType = beginOperation("addArticles");
     QMetaObject::invokeMethod(this, "_p_addArticles", connType, Q_ARG(QList<QVariantList>, articles),
                               Q_ARG(QString, subscriptionId));
 }
@@ -241,17 +408,27 @@ void DBConnection::deleteArticle(const QString &id) {
     }
     
     setStatus(Active);
-    const Qt::ConnectionType connType = isAsynchronous() ? Qt::QueuedConnection : Qt::DirectConnection;
+    const Qt::ConnectionType connType = beginOperation("deleteArticle");
     QMetaObject::invokeMethod(this, "_p_deleteArticle", connType, Q_ARG(QString, id));
 }
 
+void DBConnection::deleteArticles(const QStringList &ids) {
+    if (status() == Active) {
+        return;
+    }
+    
+    setStatus(Active);
+    const Qt::ConnectionType connType = beginOperation("deleteArticles");
+    QMetaObject::invokeMethod(this, "_p_deleteArticles", connType, Q_ARG(QStringList, ids));
+}
+
 void DBConnection::deleteReadArticles(int expiryDate) {
     if (status() == Active) {
         return;
     }
     
     setStatus(Active);
-    const Qt::ConnectionType connType = isAsynchronous() ? Qt::QueuedConnection : Qt::DirectConnection;
+    const Qt::ConnectionType connType = beginOperation("deleteReadArticles");
     QMetaObject::invokeMethod(this, "_p_deleteReadArticles", connType, Q_ARG(int, expiryDate));
 }
 
@@ -261,7 +438,7 @@ void DBConnection::updateArticle(const QString &id, const QVariantMap &propertie
     }
     
     setStatus(Active);
-    const Qt::ConnectionType connType = isAsynchronous() ? Qt::QueuedConnection : Qt::DirectConnection;
+    const Qt::ConnectionType connType = beginOperation("updateArticle");
     QMetaObject::invokeMethod(this, "_p_updateArticle", connType, Q_ARG(QString, id), Q_ARG(QVariantMap, properties),
                               Q_ARG(bool, fetchResult));
 }
@@ -272,29 +449,50 @@ void DBConnection::markArticleFavourite(const QString &id, bool isFavourite, boo
     }
     
     setStatus(Active);
-    const Qt::ConnectionType connType = isAsynchronous() ? Qt::QueuedConnection : Qt::DirectConnection;
+    const Qt::ConnectionType connType = beginOperation("markArticleFavourite");
     QMetaObject::invokeMethod(this, "_p_markArticleFavourite", connType, Q_ARG(QString, id), Q_ARG(bool, isFavourite),
                               Q_ARG(bool, fetchResult));
 }
 
+void DBConnection::markArticlesFavourite(const QStringList &ids, bool isFavourite) {
+    if (status() == Active) {
+        return;
+    }
+    
+    setStatus(Active);
+    const Qt::ConnectionType connType = beginOperation("markArticlesFavourite");
+    QMetaObject::invokeMethod(this, "_p_markArticlesFavourite", connType, Q_ARG(QStringList, ids),
+                              Q_ARG(bool, isFavourite));
+}
+
 void DBConnection::markArticleRead(const QString &id, bool isRead, bool fetchResult) {
     if (status() == Active) {
         return;
     }
     
     setStatus(Active);
-    const Qt::ConnectionType connType = isAsynchronous() ? Qt::QueuedConnection : Qt::DirectConnection;
+    const Qt::ConnectionType connType = beginOperation("markArticleRead");
     QMetaObject::invokeMethod(this, "_p_markArticleRead", connType, Q_ARG(QString, id), Q_ARG(bool, isRead),
                               Q_ARG(bool, fetchResult));
 }
 
+void DBConnection::markArticlesRead(const QStringList &ids, bool isRead) {
+    if (status() == Active) {
+        return;
+    }
+    
+    setStatus(Active);
+    const Qt::ConnectionType connType = beginOperation("markArticlesRead");
+    QMetaObject::invokeMethod(this, "_p_markArticlesRead", connType, Q_ARG(QStringList, ids), Q_ARG(bool, isRead));
+}
+
 void DBConnection::fetchArticle(const QString &id) {
     if (status() == Active) {
         return;
     }
     
     setStatus(Active);
-    const Qt::ConnectionType connType = isAsynchronous() ? Qt::QueuedConnection : Qt::DirectConnection;
+    const Qt::ConnectionType connType = beginOperation("fetchArticle");
     QMetaObject::invokeMethod(this, "_p_fetchArticle", connType, Q_ARG(QString, id));
 }
 
@@ -304,7 +502,7 @@ void DBConnection::fetchArticles(int offset, int limit) {
     }
     
     setStatus(Active);
-    const Qt::ConnectionType connType = isAsynchronous() ? Qt::QueuedConnection : Qt::DirectConnection;
+    const Qt::ConnectionType connType = beginOperation("fetchArticles");
     QMetaObject::invokeMethod(this, "_p_fetchArticles", connType, Q_ARG(int, offset), Q_ARG(int, limit));
 }
 
@@ -314,7 +512,7 @@ void DBConnection::fetchArticles(const QStringList &ids) {
     }
     
     setStatus(Active);
-    const Qt::ConnectionType connType = isAsynchronous() ? Qt::QueuedConnection : Qt::DirectConnection;
+    const Qt::ConnectionType connType = beginOperation("fetchArticles");
     QMetaObject::invokeMethod(this, "_p_fetchArticles", connType, Q_ARG(QStringList, ids));
 }
 
@@ -324,7 +522,7 @@ void DBConnection::fetchArticles(const QString &criteria) {
     }
     
     setStatus(Active);
-    const Qt::ConnectionType connType = isAsynchronous() ? Qt::QueuedConnection : Qt::DirectConnection;
+    const Qt::ConnectionType connType = beginOperation("fetchArticles");
     QMetaObject::invokeMethod(this, "_p_fetchArticles", connType, Q_ARG(QString, criteria));
 }
 
@@ -334,7 +532,7 @@ void DBConnection::fetchArticlesForSubscription(const QString &query, int offset
     }
     
     setStatus(Active);
-    const Qt::ConnectionType connType = isAsynchronous() ? Qt::QueuedConnection : Qt::DirectConnection;
+    const Qt::ConnectionType connType = beginOperation("fetchArticlesForSubscription");
     QMetaObject::invokeMethod(this, "_p_fetchArticlesForSubscription", connType, Q_ARG(QString, query),
                               Q_ARG(int, offset), Q_ARG(int, limit));
 }
@@ -345,7 +543,7 @@ void DBConnection::fetchFavouriteArticles(int offset, int limit) {
     }
     
     setStatus(Active);
-    const Qt::ConnectionType connType = isAsynchronous() ? Qt::QueuedConnection : Qt::DirectConnection;
+    const Qt::ConnectionType connType = beginOperation("fetchFavouriteArticles");
     QMetaObject::invokeMethod(this, "_p_fetchFavouriteArticles", connType, Q_ARG(int, offset), Q_ARG(int, limit));
 }
 
@@ -355,7 +553,7 @@ void DBConnection::fetchUnreadArticles(int offset, int limit) {
     }
     
     setStatus(Active);
-    const Qt::ConnectionType connType = isAsynchronous() ? Qt::QueuedConnection : Qt::DirectConnection;
+    const Qt::ConnectionType connType = beginOperation("fetchUnreadArticles");
     QMetaObject::invokeMethod(this, "_p_fetchUnreadArticles", connType, Q_ARG(int, offset), Q_ARG(int, limit));
 }
 
@@ -365,24 +563,46 @@ void DBConnection::searchArticles(const QString &query, int offset, int limit) {
     }
     
     setStatus(Active);
-    const Qt::ConnectionType connType = isAsynchronous() ? Qt::QueuedConnection : Qt::DirectConnection;
+    const Qt::ConnectionType connType = beginOperation("searchArticles");
     QMetaObject::invokeMethod(this, "_p_searchArticles", connType, Q_ARG(QString, query), Q_ARG(int, offset),
                               Q_ARG(int, limit));
 }
 
+void DBConnection::fetchDatabaseStatistics() {
+    if (status() == Active) {
+        return;
+    }
+    
+    setStatus(Active);
+    const Qt::ConnectionType connType = beginOperation("fetchDatabaseStatistics");
+    QMetaObject::invokeMethod(this, "_p_fetchDatabaseStatistics", connType);
+}
+
+void DBConnection::runMaintenance(bool analyze) {
+    if (status() == Active) {
+        return;
+    }
+    
+    setStatus(Active);
+    const Qt::ConnectionType connType = beginOperation("runMaintenance");
+    QMetaObject::invokeMethod(this, "_p_runMaintenance", connType, Q_ARG(bool, analyze));
+}
+
 void DBConnection::exec(const QString &statement) {
     if (status() == Active) {
         return;
     }
     
     setStatus(Active);
-    const Qt::ConnectionType connType = isAsynchronous() ? Qt::QueuedConnection : Qt::DirectConnection;
+    const Qt::ConnectionType connType = beginOperation("exec");
     QMetaObject::invokeMethod(this, "_p_exec", connType, Q_ARG(QString, statement));
 }
 
 void DBConnection::clear() {
     if (status() != Active) {
         m_query.clear();
+        m_records.clear();
+        m_recordIndex = -1;
     }
 }
 
@@ -390,6 +610,14 @@ void DBConnection::close() {}
 
 bool DBConnection::nextRecord() {
     if (status() == Ready) {
+        if (m_bufferResults) {
+            if (m_recordIndex < m_records.size()) {
+                ++m_recordIndex;
+            }
+            
+            return m_recordIndex < m_records.size();
+        }
+        
         return m_query.next();
     }
     
@@ -398,7 +626,7 @@ bool DBConnection::nextRecord() {
 
 int DBConnection::numRowsAffected() const {
     if (status() == Ready) {
-        return m_query.numRowsAffected();
+        return m_bufferResults ? m_numRowsAffected : m_query.numRowsAffected();
     }
     
     return -1;
@@ -406,7 +634,7 @@ int DBConnection::numRowsAffected() const {
 
 int DBConnection::size() const {
     if (status() == Ready) {
-        return m_query.size();
+        return m_bufferResults ? m_records.size() : m_query.size();
     }
     
     return -1;
@@ -414,7 +642,13 @@ int DBConnection::size() const {
 
 QVariant DBConnection::value(int index) const {
     if (status() == Ready) {
-        return m_query.value(index);
+        // Compressed article bodies/enclosures are stored as BLOBs and only uncompressed when requested
+        if (m_bufferResults) {
+            return ((m_recordIndex >= 0) && (m_recordIndex < m_records.size()))
+                   ? uncompressedValue(m_records.at(m_recordIndex).value(index)) : QVariant();
+        }
+        
+        return uncompressedValue(m_query.value(index));
     }
     
     return QVariant();
@@ -422,7 +656,12 @@ QVariant DBConnection::value(int index) const {
 
 QVariant DBConnection::value(const QString &name) const {
     if (status() == Ready) {
-        return m_query.record().value(name);
+        if (m_bufferResults) {
+            return ((m_recordIndex >= 0) && (m_recordIndex < m_records.size()))
+                   ? uncompressedValue(m_records.at(m_recordIndex).value(name)) : QVariant();
+        }
+        
+        return uncompressedValue(m_query.record().value(name));
     }
     
     return QVariant();
@@ -446,7 +685,7 @@ void DBConnection::_p_addSubscription(const QVariantList &properties) {
         setStatus(Error);
     }
     
-    emit finished(this);
+    finish();
 }
 
 void DBConnection::_p_addSubscriptions(const QList<QVariantList> &subscriptions) {
@@ -475,7 +714,7 @@ void DBConnection::_p_addSubscriptions(const QList<QVariantList> &subscriptions)
         setStatus(Error);
     }
     
-    emit finished(this);
+    finish();
 }
 
 void DBConnection::_p_deleteSubscription(const QString &id) {
@@ -488,7 +727,7 @@ void DBConnection::_p_deleteSubscription(const QString &id) {
     if (!m_query.exec()) {
         setErrorString(tr("Error executing query \"%1\": %2").arg(m_query.lastQuery()).arg(m_query.lastError().text()));
         setStatus(Error);
-        emit finished(this);
+        finish();
         return;
     }
 #endif
@@ -506,14 +745,22 @@ void DBConnection::_p_deleteSubscription(const QString &id) {
         setStatus(Error);
     }
     
-    emit finished(this);
+    finish();
 }
 
 void DBConnection::_p_updateSubscription(const QString &id, const QVariantMap &properties, bool fetchResult) {
     Logger::log("DBConnection::_p_updateSubscription(). ID: " + id, Logger::MediumVerbosity);
-    QString statement = QString("UPDATE subscriptions SET %1 = ? WHERE id = '%2'")
-                               .arg(QStringList(properties.keys()).join(" = ?, "))
-                               .arg(id);
+    const QString column = invalidColumn(properties, "subscriptions", SUBSCRIPTION_FIELDS);
+    
+    if (!column.isEmpty()) {
+        setErrorString(tr("Invalid subscription property \"%1\"").arg(column));
+        setStatus(Error);
+        finish();
+        return;
+    }
+    
+    QString statement = QString("UPDATE subscriptions SET %1 = ? WHERE id = ?")
+                               .arg(QStringList(properties.keys()).join(" = ?, "));
     m_query = QSqlQuery(database());
     m_query.prepare(statement);
     
@@ -521,6 +768,8 @@ void DBConnection::_p_updateSubscription(const QString &id, const QVariantMap &p
         m_query.addBindValue(value);
     }
     
+    m_query.addBindValue(id);
+    
     if (m_query.exec()) {        
         if (fetchResult) {
             statement = QString("SELECT %1, COUNT(articles.id) FROM subscriptions LEFT JOIN articles ON \
@@ -551,7 +800,61 @@ void DBConnection::_p_updateSubscription(const QString &id, const QVariantMap &p
         setStatus(Error);
     }
     
-    emit finished(this);
+    finish();
+}
+
+void DBConnection::_p_updateSubscriptions(const QStringList &ids, const QVariantMap &properties, bool fetchResult) {
+    Logger::log(QString("DBConnection::_p_updateSubscriptions(). %1 subscriptions").arg(ids.size()),
+                Logger::MediumVerbosity);
+    const QString column = invalidColumn(properties, "subscriptions", SUBSCRIPTION_FIELDS);
+    
+    if (!column.isEmpty()) {
+        setErrorString(tr("Invalid subscription property \"%1\"").arg(column));
+        setStatus(Error);
+        finish();
+        return;
+    }
+    
+    const QString subscriptions = idList(ids);
+    QString statement = QString("UPDATE subscriptions SET %1 = ? WHERE id IN (%2)")
+                               .arg(QStringList(properties.keys()).join(" = ?, "))
+                               .arg(subscriptions);
+    m_query = QSqlQuery(database());
+    m_query.prepare(statement);
+    
+    foreach (const QVariant &value, properties.values()) {
+        m_query.addBindValue(value);
+    }
+    
+    if (m_query.exec()) {
+        if (fetchResult) {
+            statement = QString("SELECT %1, COUNT(articles.id) FROM subscriptions LEFT JOIN articles ON \
+            subscriptions.id = articles.subscriptionId AND articles.isRead = 0 WHERE subscriptions.id IN (%2) \
+            GROUP BY subscriptions.id ORDER BY subscriptions.rowid ASC").arg(SUBSCRIPTION_FIELDS).arg(subscriptions);
+            
+            if (m_query.exec(statement)) {
+                setErrorString(QString());
+                setStatus(Ready);
+            }
+            else {
+                setErrorString(tr("Error executing query \"%1\": %2").arg(m_query.lastQuery())
+                                                                     .arg(m_query.lastError().text()));
+                setStatus(Error);
+            }
+        }
+        else {
+            setErrorString(QString());
+            setStatus(Ready);
+        }
+        
+        emit DBNotify::instance()->subscriptionsUpdated(ids);
+    }
+    else {
+        setErrorString(tr("Error executing query \"%1\": %2").arg(m_query.lastQuery()).arg(m_query.lastError().text()));
+        setStatus(Error);
+    }
+    
+    finish();
 }
 
 void DBConnection::_p_markSubscriptionRead(const QString &id, bool isRead, bool fetchResult) {
@@ -595,7 +898,7 @@ void DBConnection::_p_markSubscriptionRead(const QString &id, bool isRead, bool
         setStatus(Error);
     }
     
-    emit finished(this);
+    finish();
 }
 
 void DBConnection::_p_markAllSubscriptionsRead() {
@@ -618,7 +921,7 @@ void DBConnection::_p_markAllSubscriptionsRead() {
         setStatus(Error);
     }
     
-    emit finished(this);
+    finish();
 }
 
 void DBConnection::_p_fetchSubscription(const QString &id) {
@@ -637,7 +940,7 @@ void DBConnection::_p_fetchSubscription(const QString &id) {
         setStatus(Error);
     }
     
-    emit finished(this);
+    finish();
 }
 
 void DBConnection::_p_fetchSubscriptions(int offset, int limit) {
@@ -683,13 +986,23 @@ void DBConnection::_p_fetchSubscriptions(const QString &criteria) {
 
 void DBConnection::_p_addArticle(const QVariantList &properties, const QString &subscriptionId) {
     m_query = QSqlQuery(database());
-    m_query.prepare("INSERT INTO articles VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)");
+    m_query.prepare("INSERT INTO articles VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)");
+    const bool compress = Settings::compressArticles();
+    const QVariant body = compress ? compressedValue(properties.value(2)) : properties.value(2);
     
-    foreach (const QVariant &property, properties) {
-        m_query.addBindValue(property);
+    for (int i = 0; i < properties.size(); i++) {
+        if (i == 2) {
+            m_query.addBindValue(body);
+        }
+        else {
+            m_query.addBindValue(((compress) && (i == 5)) ? compressedValue(properties.at(i)) : properties.at(i));
+        }
     }
     
+    m_query.addBindValue(searchText(properties.value(2), body));
+    
     if (m_query.exec()) {
+        addMediaReferences(QVariantList() << properties.first(), QVariantList() << properties.value(2));
         setErrorString(QString());
         setStatus(Ready);
         emit DBNotify::instance()->articlesAdded(QStringList() << properties.first().toString(), subscriptionId);
@@ -699,25 +1012,54 @@ void DBConnection::_p_addArticle(const QVariantList &properties, const QString &
         setStatus(Error);
     }
     
-    emit finished(this);
+    finish();
 }
 
 void DBConnection::_p_addArticles(const QList<QVariantList> &articles, const QString &subscriptionId) {
     m_query = QSqlQuery(database());
-    m_query.prepare("INSERT INTO articles VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)");
+    m_query.prepare("INSERT INTO articles VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)");
+    
+    const bool compress = Settings::compressArticles();
+    const QVariantList bodies = articles.value(2);
+    QVariantList texts;
     
-    foreach (const QVariantList &article, articles) {
+    for (int i = 0; i < articles.size(); i++) {
+        const QVariantList &article = articles.at(i);
+        
         if (!article.isEmpty()) {
-            m_query.addBindValue(article);
+            if ((compress) && ((i == 2) || (i == 5))) {
+                QVariantList values;
+                
+                foreach (const QVariant &value, article) {
+                    values << compressedValue(value);
+                    
+                    if (i == 2) {
+                        texts << searchText(value, values.last());
+                    }
+                }
+                
+                m_query.addBindValue(values);
+            }
+            else {
+                m_query.addBindValue(article);
+            }
         }
     }
     
+    while (texts.size() < bodies.size()) {
+        texts << QVariant(QVariant::String);
+    }
+    
+    m_query.addBindValue(texts);
+    
     if (m_query.execBatch()) {
         QStringList ids;
         
         foreach (const QVariant &v, articles.first()) {
             ids << v.toString();
         }
+        
+        addMediaReferences(articles.first(), articles.value(2));
 
         setErrorString(QString());
         setStatus(Ready);
@@ -728,7 +1070,7 @@ void DBConnection::_p_addArticles(const QList<QVariantList> &articles, const QSt
         setStatus(Error);
     }
     
-    emit finished(this);
+    finish();
 }
 
 void DBConnection::_p_deleteArticle(const QString &id) {
@@ -746,7 +1088,7 @@ void DBConnection::_p_deleteArticle(const QString &id) {
             Utils::removeDirectory(QString("%1%2/%3").arg(CACHE_PATH).arg(subscriptionId).arg(id));
             setErrorString(QString());
             setStatus(Ready);
-            emit finished(this);
+            finish();
             emit DBNotify::instance()->articlesDeleted(QStringList() << id, subscriptionId);
             return;
         }
@@ -754,7 +1096,52 @@ void DBConnection::_p_deleteArticle(const QString &id) {
     
     setErrorString(tr("Error executing query \"%1\": %2").arg(m_query.lastQuery()).arg(m_query.lastError().text()));
     setStatus(Error);
-    emit finished(this);
+    finish();
+}
+
+void DBConnection::_p_deleteArticles(const QStringList &ids) {
+    Logger::log(QString("DBConnection::_p_deleteArticles(). %1 articles").arg(ids.size()), Logger::MediumVerbosity);
+    QSqlDatabase db = database();
+    db.transaction();
+    m_query = QSqlQuery(db);
+    
+    if (m_query.exec(QString("SELECT id, subscriptionId FROM articles WHERE id IN (%1)").arg(idList(ids)))) {
+        QStringList articleIds;
+        QStringList subscriptionIds;
+        
+        while (m_query.next()) {
+            articleIds << m_query.value(0).toString();
+            subscriptionIds << m_query.value(1).toString();
+        }
+        
+        if ((m_query.exec(QString("DELETE FROM articles WHERE id IN (%1)").arg(idList(articleIds))))
+            && (db.commit())) {
+            QHash<QString, QStringList> deleted;
+            
+            for (int i = 0; i < articleIds.size(); i++) {
+                Utils::removeDirectory(QString("%1%2/%3").arg(CACHE_PATH).arg(subscriptionIds.at(i))
+                                                         .arg(articleIds.at(i)));
+                deleted[subscriptionIds.at(i)] << articleIds.at(i);
+            }
+            
+            setErrorString(QString());
+            setStatus(Ready);
+            finish();
+            QHashIterator<QString, QStringList> iterator(deleted);
+            
+            while (iterator.hasNext()) {
+                iterator.next();
+                emit DBNotify::instance()->articlesDeleted(iterator.value(), iterator.key());
+            }
+            
+            return;
+        }
+    }
+    
+    setErrorString(tr("Error executing query \"%1\": %2").arg(m_query.lastQuery()).arg(m_query.lastError().text()));
+    db.rollback();
+    setStatus(Error);
+    finish();
 }
 
 void DBConnection::_p_deleteReadArticles(int expiryDate) {
@@ -781,9 +1168,12 @@ void DBConnection::_p_deleteReadArticles(int expiryDate) {
             const int p = 100 / articleIds.size();
             
             if (m_query.exec()) {
+                QHash<QString, QStringList> deleted;
+                
                 for (int i = 0; i < articleIds.size(); i++) {
                     Utils::removeDirectory(QString("%1%2/%3").arg(CACHE_PATH).arg(subscriptionIds.at(i))
                                                              .arg(articleIds.at(i)));
+                    deleted[subscriptionIds.at(i)] << articleIds.at(i);
                     setProgress(progress() + p);
                 }
                 
@@ -791,6 +1181,13 @@ void DBConnection::_p_deleteReadArticles(int expiryDate) {
                             .arg(articleIds.size()), Logger::LowVerbosity);
                 setErrorString(QString());
                 setStatus(Ready);
+                QHashIterator<QString, QStringList> iterator(deleted);
+                
+                while (iterator.hasNext()) {
+                    iterator.next();
+                    emit DBNotify::instance()->articlesDeleted(iterator.value(), iterator.key());
+                }
+                
                 emit DBNotify::instance()->readArticlesDeleted(articleIds.size());
             }
             else {
@@ -810,26 +1207,60 @@ void DBConnection::_p_deleteReadArticles(int expiryDate) {
         setStatus(Error);
     }
     
-    emit finished(this);
+    finish();
 }
 
 void DBConnection::_p_updateArticle(const QString &id, const QVariantMap &properties, bool fetchResult) {
     Logger::log("DBConnection::_p_updateArticle(). ID: " + id, Logger::MediumVerbosity);
-    QString statement = QString("UPDATE articles SET %1 = ? WHERE id = '%2'")
-                               .arg(QStringList(properties.keys()).join(" = ?, "))
-                               .arg(id);
+    const QString column = invalidColumn(properties, "articles", ARTICLE_FIELDS);
+    
+    if (!column.isEmpty()) {
+        setErrorString(tr("Invalid article property \"%1\"").arg(column));
+        setStatus(Error);
+        finish();
+        return;
+    }
+    
+    QStringList columns = properties.keys();
+    
+    if (properties.contains("body")) {
+        columns << "searchText";
+    }
+    
+    const QString statement = QString("UPDATE articles SET %1 = ? WHERE id = ?").arg(columns.join(" = ?, "));
     m_query = QSqlQuery(database());
     m_query.prepare(statement);
+    const bool compress = Settings::compressArticles();
+    QVariant body;
+    QMapIterator<QString, QVariant> iterator(properties);
     
-    foreach (const QVariant &value, properties.values()) {
-        m_query.addBindValue(value);
+    while (iterator.hasNext()) {
+        iterator.next();
+        
+        if ((compress) && ((iterator.key() == "body") || (iterator.key() == "enclosures"))) {
+            m_query.addBindValue(compressedValue(iterator.value()));
+            
+            if (iterator.key() == "body") {
+                body = compressedValue(iterator.value());
+            }
+        }
+        else {
+            m_query.addBindValue(iterator.value());
+        }
+    }
+    
+    if (properties.contains("body")) {
+        m_query.addBindValue(searchText(properties.value("body"), body));
     }
     
+    m_query.addBindValue(id);
+    
     if (m_query.exec()) {        
         if (fetchResult) {
-            statement = QString("SELECT %1 FROM articles WHERE id = '%2'").arg(ARTICLE_FIELDS).arg(id);
+            m_query.prepare(QString("SELECT %1 FROM articles WHERE id = ?").arg(ARTICLE_FIELDS));
+            m_query.addBindValue(id);
             
-            if ((m_query.exec(statement)) && (m_query.next())) {
+            if ((m_query.exec()) && (m_query.next())) {
                 setErrorString(QString());
                 setStatus(Ready);
             }
@@ -851,7 +1282,7 @@ void DBConnection::_p_updateArticle(const QString &id, const QVariantMap &proper
         setStatus(Error);
     }
     
-    emit finished(this);
+    finish();
 }
 
 void DBConnection::_p_markArticleFavourite(const QString &id, bool isFavourite, bool fetchResult) {
@@ -889,7 +1320,54 @@ void DBConnection::_p_markArticleFavourite(const QString &id, bool isFavourite,
         setStatus(Error);
     }
     
-    emit finished(this);
+    finish();
+}
+
+void DBConnection::_p_markArticlesFavourite(const QStringList &ids, bool isFavourite) {
+    Logger::log(QString("DBConnection::_p_markArticlesFavourite(). %1 articles").arg(ids.size())
+                + (isFavourite ? ", Status: favourite" : ", Status: unfavourite"), Logger::MediumVerbosity);
+    QSqlDatabase db = database();
+    db.transaction();
+    m_query = QSqlQuery(db);
+    // Only the articles that change state are updated and reported
+    m_query.prepare(QString("SELECT id FROM articles WHERE id IN (%1) AND isFavourite = ?").arg(idList(ids)));
+    m_query.addBindValue(isFavourite ? 0 : 1);
+    
+    if (m_query.exec()) {
+        QStringList articleIds;
+        
+        while (m_query.next()) {
+            articleIds << m_query.value(0).toString();
+        }
+        
+        const QString articles = idList(articleIds);
+        m_query.prepare(QString("UPDATE articles SET isFavourite = ? WHERE id IN (%1)").arg(articles));
+        m_query.addBindValue(isFavourite ? 1 : 0);
+        
+        if ((m_query.exec()) && (db.commit())) {
+            if (m_query.exec(QString("SELECT id, subscriptionId FROM articles WHERE id IN (%1)").arg(articles))) {
+                setErrorString(QString());
+                setStatus(Ready);
+            }
+            else {
+                setErrorString(tr("Error executing query \"%1\": %2").arg(m_query.lastQuery())
+                                                                     .arg(m_query.lastError().text()));
+                setStatus(Error);
+            }
+            
+            if (!articleIds.isEmpty()) {
+                emit DBNotify::instance()->articlesFavourited(articleIds, isFavourite);
+            }
+            
+            finish();
+            return;
+        }
+    }
+    
+    setErrorString(tr("Error executing query \"%1\": %2").arg(m_query.lastQuery()).arg(m_query.lastError().text()));
+    db.rollback();
+    setStatus(Error);
+    finish();
 }
 
 void DBConnection::_p_markArticleRead(const QString &id, bool isRead, bool fetchResult) {
@@ -927,9 +1405,60 @@ void DBConnection::_p_markArticleRead(const QString &id, bool isRead, bool fetch
         setStatus(Error);
     }
     
-    emit finished(this);
+    finish();
 };
 
+void DBConnection::_p_markArticlesRead(const QStringList &ids, bool isRead) {
+    Logger::log(QString("DBConnection::_p_markArticlesRead(). %1 articles").arg(ids.size())
+                + (isRead ? ", Status: read" : ", Status: unread"), Logger::MediumVerbosity);
+    QSqlDatabase db = database();
+    db.transaction();
+    m_query = QSqlQuery(db);
+    // Only the articles that change state are updated and reported, so unread counts can be adjusted
+    m_query.prepare(QString("SELECT id, subscriptionId FROM articles WHERE id IN (%1) AND isRead = ?")
+                           .arg(idList(ids)));
+    m_query.addBindValue(isRead ? 0 : 1);
+    
+    if (m_query.exec()) {
+        QStringList articleIds;
+        QStringList subscriptionIds;
+        
+        while (m_query.next()) {
+            articleIds << m_query.value(0).toString();
+            subscriptionIds << m_query.value(1).toString();
+        }
+        
+        const QString articles = idList(articleIds);
+        m_query.prepare(QString("UPDATE articles SET isRead = ?, lastRead = ? WHERE id IN (%1)").arg(articles));
+        m_query.addBindValue(isRead ? 1 : 0);
+        m_query.addBindValue(isRead ? QDateTime::currentDateTime().toTime_t() : 0);
+        
+        if ((m_query.exec()) && (db.commit())) {
+            if (m_query.exec(QString("SELECT id, subscriptionId FROM articles WHERE id IN (%1)").arg(articles))) {
+                setErrorString(QString());
+                setStatus(Ready);
+            }
+            else {
+                setErrorString(tr("Error executing query \"%1\": %2").arg(m_query.lastQuery())
+                                                                     .arg(m_query.lastError().text()));
+                setStatus(Error);
+            }
+            
+            if (!articleIds.isEmpty()) {
+                emit DBNotify::instance()->articlesRead(articleIds, subscriptionIds, isRead);
+            }
+            
+            finish();
+            return;
+        }
+    }
+    
+    setErrorString(tr("Error executing query \"%1\": %2").arg(m_query.lastQuery()).arg(m_query.lastError().text()));
+    db.rollback();
+    setStatus(Error);
+    finish();
+}
+
 void DBConnection::_p_fetchArticle(const QString &id) {
     m_query = QSqlQuery(database());
     m_query.prepare(QString("SELECT %1 FROM articles WHERE id = ?").arg(ARTICLE_FIELDS));
@@ -944,7 +1473,7 @@ void DBConnection::_p_fetchArticle(const QString &id) {
         setStatus(Error);
     }
     
-    emit finished(this);
+    finish();
 }
 
 void DBConnection::_p_fetchArticles(int offset, int limit) {
@@ -1019,7 +1548,9 @@ void DBConnection::_p_fetchUnreadArticles(int offset, int limit) {
 }
 
 void DBConnection::_p_searchArticles(const QString &query, int offset, int limit) {
-    QString statement = QString("SELECT %1 FROM articles WHERE author LIKE '%%2%' OR title LIKE '%%2%' OR body LIKE '%%2%' ORDER BY date DESC").arg(ARTICLE_FIELDS).arg(query);
+    // Compressed bodies are matched using their searchText
+    QString statement = QString("SELECT %1 FROM articles WHERE author LIKE ? OR title LIKE ? OR body LIKE ? \
+OR searchText LIKE ? ORDER BY date DESC").arg(ARTICLE_FIELDS);
     
     if (limit > 0) {
         statement.append(QString(" LIMIT %1, %2").arg(offset).arg(limit));
@@ -1028,7 +1559,198 @@ void DBConnection::_p_searchArticles(const QString &query, int offset, int limit
         statement.append(QString(" OFFSET %1").arg(offset));
     }
     
-    _p_exec(statement);
+    const QString pattern = "%" + query + "%";
+    m_query = QSqlQuery(database());
+    m_query.prepare(statement);
+    
+    for (int i = 0; i < 4; i++) {
+        m_query.addBindValue(pattern);
+    }
+    
+    if (m_query.exec()) {
+        setErrorString(QString());
+        setStatus(Ready);
+    }
+    else {
+        setErrorString(tr("Error executing query \"%1\": %2").arg(m_query.lastQuery()).arg(m_query.lastError().text()));
+        setStatus(Error);
+    }
+    
+    finish();
+}
+
+void DBConnection::_p_fetchDatabaseStatistics() {
+    m_query = QSqlQuery(database());
+    const QStringList pragmas = QStringList() << "page_size" << "page_count" << "freelist_count";
+    
+    foreach (const QString &pragma, pragmas) {
+        if ((m_query.exec("PRAGMA " + pragma)) && (m_query.next())) {
+            setProperty(pragma.toUtf8(), m_query.value(0));
+        }
+        else {
+            setErrorString(tr("Error executing query \"%1\": %2").arg(m_query.lastQuery())
+                                                                 .arg(m_query.lastError().text()));
+            setStatus(Error);
+            finish();
+            return;
+        }
+    }
+    
+    _p_exec("SELECT subscriptions.id, subscriptions.title, COUNT(articles.id), \
+    TOTAL(LENGTH(CAST(articles.body AS BLOB)) + LENGTH(CAST(articles.enclosures AS BLOB))) FROM subscriptions \
+    LEFT JOIN articles ON subscriptions.id = articles.subscriptionId GROUP BY subscriptions.id \
+    ORDER BY subscriptions.rowid ASC");
+}
+
+void DBConnection::_p_runMaintenance(bool analyze) {
+    Logger::log(QString("DBConnection::_p_runMaintenance(). Analyze: %1").arg(analyze ? "true" : "false"),
+                Logger::MediumVerbosity);
+    QStringList statements = QStringList() << "PRAGMA incremental_vacuum" << "PRAGMA optimize";
+    
+    if (analyze) {
+        statements << "ANALYZE";
+    }
+    
+    m_query = QSqlQuery(database());
+    
+    if (!removeOrphanedMedia()) {
+        setStatus(Error);
+        finish();
+        return;
+    }
+    
+    if ((Settings::compressArticles()) && (!compressStoredArticles())) {
+        setStatus(Error);
+        finish();
+        return;
+    }
+    
+    foreach (const QString &statement, statements) {
+        if (!m_query.exec(statement)) {
+            setErrorString(tr("Error executing query \"%1\": %2").arg(m_query.lastQuery())
+                                                                 .arg(m_query.lastError().text()));
+            setStatus(Error);
+            finish();
+            return;
+        }
+        
+        // incremental_vacuum only frees pages as its result rows are stepped through
+        while (m_query.next()) {}
+    }
+    
+    m_query.clear();
+    setErrorString(QString());
+    setStatus(Ready);
+    finish();
+}
+
+void DBConnection::addMediaReferences(const QVariantList &ids, const QVariantList &bodies) {
+    QVariantList articleIds;
+    QVariantList urls;
+    
+    for (int i = 0; i < ids.size(); i++) {
+        foreach (const QVariant &url, mediaUrls(bodies.value(i).toString())) {
+            articleIds << ids.at(i);
+            urls << url;
+        }
+    }
+    
+    if (urls.isEmpty()) {
+        return;
+    }
+    
+    QSqlQuery query(database());
+    query.prepare("INSERT OR IGNORE INTO media VALUES (?, ?)");
+    query.addBindValue(articleIds);
+    query.addBindValue(urls);
+    
+    if (!query.execBatch()) {
+        Logger::log("DBConnection::addMediaReferences(). Error: " + query.lastError().text());
+    }
+}
+
+bool DBConnection::removeOrphanedMedia() {
+    // Removes cached media that is no longer referenced by any article
+    if (!m_query.exec("SELECT DISTINCT url FROM media WHERE articleId NOT IN (SELECT id FROM articles) \
+AND url NOT IN (SELECT url FROM media WHERE articleId IN (SELECT id FROM articles))")) {
+        setErrorString(tr("Error executing query \"%1\": %2").arg(m_query.lastQuery()).arg(m_query.lastError().text()));
+        return false;
+    }
+    
+    QStringList urls;
+        
+    while (m_query.next()) {
+        urls << m_query.value(0).toString();
+    }
+            
+    // The media cache is only modified by its owner (MediaPrefetcher), which removes the files
+    if (!urls.isEmpty()) {
+        Logger::log(QString("DBConnection::removeOrphanedMedia(). %1 URLs no longer referenced").arg(urls.size()),
+                    Logger::MediumVerbosity);
+        emit DBNotify::instance()->mediaRemoved(urls);
+    }
+    
+    if (!m_query.exec("DELETE FROM media WHERE articleId NOT IN (SELECT id FROM articles)")) {
+        setErrorString(tr("Error executing query \"%1\": %2").arg(m_query.lastQuery()).arg(m_query.lastError().text()));
+        return false;
+    }
+    
+    return true;
+}
+
+bool DBConnection::compressStoredArticles() {
+    // Compresses a batch of articles that were stored before compression was enabled
+    // Enclosures were previously stored as uncompressed JSON BLOBs, so these are compressed too, and bodies
+    // compressed before the searchText column was added are given their searchText
+    m_query.prepare("SELECT id, body, enclosures FROM articles WHERE (typeof(body) = 'text' AND LENGTH(body) >= ?) \
+OR (typeof(body) = 'blob' AND substr(body, 1, 4) = ? AND searchText IS NULL) \
+OR (typeof(enclosures) = 'text' AND LENGTH(enclosures) >= ?) \
+OR (typeof(enclosures) = 'blob' AND LENGTH(enclosures) >= ? AND substr(enclosures, 1, 4) != ?) LIMIT ?");
+    m_query.addBindValue(COMPRESSION_THRESHOLD);
+    m_query.addBindValue(COMPRESSION_MARKER);
+    m_query.addBindValue(COMPRESSION_THRESHOLD);
+    m_query.addBindValue(COMPRESSION_THRESHOLD);
+    m_query.addBindValue(COMPRESSION_MARKER);
+    m_query.addBindValue(COMPRESSION_BATCH_SIZE);
+    
+    if (!m_query.exec()) {
+        setErrorString(tr("Error executing query \"%1\": %2").arg(m_query.lastQuery()).arg(m_query.lastError().text()));
+        return false;
+    }
+    
+    QVariantList ids;
+    QVariantList bodies;
+    QVariantList texts;
+    QVariantList enclosures;
+    
+    while (m_query.next()) {
+        ids << m_query.value(0);
+        bodies << compressedValue(m_query.value(1));
+        texts << searchText(uncompressedValue(m_query.value(1)), bodies.last());
+        enclosures << compressedValue(m_query.value(2));
+    }
+    
+    if (ids.isEmpty()) {
+        return true;
+    }
+    
+    Logger::log(QString("DBConnection::compressStoredArticles(). Compressing %1 articles").arg(ids.size()),
+                Logger::MediumVerbosity);
+    QSqlDatabase db = database();
+    db.transaction();
+    m_query.prepare("UPDATE articles SET body = ?, searchText = ?, enclosures = ? WHERE id = ?");
+    m_query.addBindValue(bodies);
+    m_query.addBindValue(texts);
+    m_query.addBindValue(enclosures);
+    m_query.addBindValue(ids);
+    
+    if ((m_query.execBatch()) && (db.commit())) {
+        return true;
+    }
+    
+    setErrorString(tr("Error executing query \"%1\": %2").arg(m_query.lastQuery()).arg(m_query.lastError().text()));
+    db.rollback();
+    return false;
 }
 
 void DBConnection::_p_exec(const QString &statement) {
@@ -1043,7 +1765,7 @@ void DBConnection::_p_exec(const QString &statement) {
         setStatus(Error);
     }
     
-    emit finished(this);
+    finish();
 }
 
 QSqlDatabase DBConnection::database() {
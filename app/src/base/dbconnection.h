@@ -17,8 +17,10 @@
 #ifndef DBCONNECTION_H
 #define DBCONNECTION_H
 
+#include <QElapsedTimer>
 #include <QObject>
 #include <QSqlQuery>
+#include <QSqlRecord>
 #include <QVariantMap>
 
 class QSqlDatabase;
@@ -60,6 +62,9 @@ public:
     static QThread* asynchronousThread();
     static void setAsynchronousThread(QThread *thread);
 
+    // Returns the ids as a quoted list for use in an IN (...) clause
+    static QString idList(const QStringList &ids);
+
     static const QString SUBSCRIPTION_FIELDS;
     static const QString ARTICLE_FIELDS;
 
@@ -68,6 +73,7 @@ public Q_SLOTS:
     void addSubscriptions(const QList<QVariantList> &subscriptions);
     void deleteSubscription(const QString &id);
     void updateSubscription(const QString &id, const QVariantMap &properties, bool fetchResult = false);
+    void updateSubscriptions(const QStringList &ids, const QVariantMap &properties, bool fetchResult = false);
     void markSubscriptionRead(const QString &id, bool isRead = true, bool fetchResult = false);
     void markAllSubscriptionsRead();
     
@@ -79,10 +85,13 @@ public Q_SLOTS:
     void addArticle(const QVariantList &properties, const QString &subscriptionId);
     void addArticles(const QList<QVariantList> &articles, const QString &subscriptionId);
     void deleteArticle(const QString &id);
+    void deleteArticles(const QStringList &ids);
     void deleteReadArticles(int expiryDate);
     void updateArticle(const QString &id, const QVariantMap &properties, bool fetchResult = false);
     void markArticleFavourite(const QString &id, bool isFavourite = true, bool fetchResult = false);
+    void markArticlesFavourite(const QStringList &ids, bool isFavourite = true);
     void markArticleRead(const QString &id, bool isRead = true, bool fetchResult = false);
+    void markArticlesRead(const QStringList &ids, bool isRead = true);
     
     void fetchArticle(const QString &id);
     void fetchArticles(int offset = 0, int limit = 0);
@@ -93,6 +102,9 @@ public Q_SLOTS:
     void fetchUnreadArticles(int offset = 0, int limit = 0);
     void searchArticles(const QString &query, int offset = 0, int limit = 0);
     
+    void fetchDatabaseStatistics();
+    void runMaintenance(bool analyze = false);
+    
     void exec(const QString &statement);
 
     void clear();
@@ -111,6 +123,7 @@ private Q_SLOTS:
     void _p_addSubscriptions(const QList<QVariantList> &subscriptions);
     void _p_deleteSubscription(const QString &id);
     void _p_updateSubscription(const QString &id, const QVariantMap &properties, bool fetchResult);
+    void _p_updateSubscriptions(const QStringList &ids, const QVariantMap &properties, bool fetchResult);
     void _p_markSubscriptionRead(const QString &id, bool isRead, bool fetchResult);
     void _p_markAllSubscriptionsRead();
     
@@ -122,10 +135,13 @@ private Q_SLOTS:
     void _p_addArticle(const QVariantList &properties, const QString &subscriptionId);
     void _p_addArticles(const QList<QVariantList> &articles, const QString &subscriptionId);
     void _p_deleteArticle(const QString &id);
+    void _p_deleteArticles(const QStringList &ids);
     void _p_deleteReadArticles(int expiryDate);
     void _p_updateArticle(const QString &id, const QVariantMap &properties, bool fetchResult);
     void _p_markArticleFavourite(const QString &id, bool isFavourite, bool fetchResult);
+    void _p_markArticlesFavourite(const QStringList &ids, bool isFavourite);
     void _p_markArticleRead(const QString &id, bool isRead, bool fetchResult);
+    void _p_markArticlesRead(const QStringList &ids, bool isRead);
     
     void _p_fetchArticle(const QString &id);
     void _p_fetchArticles(int offset, int limit);
@@ -136,6 +152,9 @@ private Q_SLOTS:
     void _p_fetchUnreadArticles(int offset, int limit);
     void _p_searchArticles(const QString &query, int offset, int limit);
     
+    void _p_fetchDatabaseStatistics();
+    void _p_runMaintenance(bool analyze);
+    
     void _p_exec(const QString &statement);
 
 Q_SIGNALS:
@@ -143,6 +162,9 @@ Q_SIGNALS:
     void progressChanged(int p);
     void statusChanged(DBConnection::Status s);
 
+protected:
+    bool event(QEvent *e);
+
 private:
     void setErrorString(const QString &e);
     
@@ -150,6 +172,15 @@ private:
     
     void setProgress(int p);
     
+    void finish();
+    
+    Qt::ConnectionType beginOperation(const char *operation);
+    
+    void addMediaReferences(const QVariantList &ids, const QVariantList &bodies);
+    bool removeOrphanedMedia();
+    
+    bool compressStoredArticles();
+    
     QSqlDatabase database();
     
     static QThread *asyncThread;
@@ -163,6 +194,15 @@ private:
     Status m_status;
     
     QSqlQuery m_query;
+    
+    const char *m_operation;
+    QElapsedTimer m_operationTimer;
+    bool m_queued;
+    
+    bool m_bufferResults;
+    QList<QSqlRecord> m_records;
+    int m_recordIndex;
+    int m_numRowsAffected;
 };
 
 #endif // DBCONNECTION_H
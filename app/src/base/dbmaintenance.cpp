@@ -0,0 +1,126 @@
+/*
+ * Copyright (C) 2017 Stuart Howarth <showarth@marxoft.co.uk>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "dbmaintenance.h"
+#include "dbconnection.h"
+#include "dbnotify.h"
+#include "definitions.h"
+#include "logger.h"
+#include "subscriptions.h"
+
+DBMaintenance* DBMaintenance::self = 0;
+
+DBMaintenance::DBMaintenance() :
+    QObject(),
+    m_active(false),
+    m_pending(false)
+{
+    m_timer.setInterval(DATABASE_MAINTENANCE_INTERVAL);
+    
+    connect(&m_timer, SIGNAL(timeout()), this, SLOT(runIfDue()));
+    connect(DBNotify::instance(), SIGNAL(articlesDeleted(QStringList, QString)), this, SLOT(onArticlesDeleted()));
+    connect(DBNotify::instance(), SIGNAL(readArticlesDeleted(int)), this, SLOT(onArticlesDeleted()));
+    connect(DBNotify::instance(), SIGNAL(subscriptionDeleted(QString)), this, SLOT(onArticlesDeleted()));
+    connect(Subscriptions::instance(), SIGNAL(statusChanged(Subscriptions::Status)), this, SLOT(runIfDue()));
+    
+    m_timer.start();
+}
+
+DBMaintenance::~DBMaintenance() {
+    self = 0;
+}
+
+DBMaintenance* DBMaintenance::instance() {
+    return self ? self : self = new DBMaintenance;
+}
+
+bool DBMaintenance::isActive() const {
+    return m_active;
+}
+
+void DBMaintenance::setActive(bool active) {
+    if (active != isActive()) {
+        m_active = active;
+        emit activeChanged(active);
+    }
+}
+
+QDateTime DBMaintenance::lastAnalyzed() const {
+    return m_lastAnalyzed;
+}
+
+QDateTime DBMaintenance::lastRun() const {
+    return m_lastRun;
+}
+
+bool DBMaintenance::run(bool analyze) {
+    if (isActive()) {
+        return false;
+    }
+    
+    if (Subscriptions::instance()->status() == Subscriptions::Active) {
+        Logger::log("DBMaintenance::run(). Subscriptions are being updated. Deferring maintenance",
+                    Logger::MediumVerbosity);
+        m_pending = true;
+        return false;
+    }
+    
+    Logger::log("DBMaintenance::run()", Logger::LowVerbosity);
+    m_pending = false;
+    setActive(true);
+    DBConnection *connection = DBConnection::connection(this, SLOT(onMaintenanceFinished(DBConnection*)));
+    connection->setProperty("analyze", analyze);
+    connection->runMaintenance(analyze);
+    return true;
+}
+
+void DBMaintenance::runIfDue() {
+    if ((isActive()) || (Subscriptions::instance()->status() == Subscriptions::Active)) {
+        return;
+    }
+    
+    const QDateTime now = QDateTime::currentDateTime();
+    const bool analyze = (!m_lastAnalyzed.isValid())
+                         || (m_lastAnalyzed.secsTo(now) >= DATABASE_ANALYZE_INTERVAL);
+    
+    if ((m_pending) || (analyze) || (!m_lastRun.isValid())
+        || (m_lastRun.msecsTo(now) >= DATABASE_MAINTENANCE_INTERVAL)) {
+        run(analyze);
+    }
+}
+
+void DBMaintenance::onArticlesDeleted() {
+    m_pending = true;
+}
+
+void DBMaintenance::onMaintenanceFinished(DBConnection *connection) {
+    if (connection->status() == DBConnection::Ready) {
+        m_lastRun = QDateTime::currentDateTime();
+        
+        if (connection->property("analyze").toBool()) {
+            m_lastAnalyzed = m_lastRun;
+        }
+        
+        Logger::log("DBMaintenance::onMaintenanceFinished(). OK", Logger::LowVerbosity);
+    }
+    else {
+        Logger::log("DBMaintenance::onMaintenanceFinished(). Error: " + connection->errorString());
+    }
+    
+    connection->deleteLater();
+    setActive(false);
+    emit finished();
+}
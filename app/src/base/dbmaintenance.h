@@ -0,0 +1,73 @@
+/*
+ * Copyright (C) 2017 Stuart Howarth <showarth@marxoft.co.uk>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DBMAINTENANCE_H
+#define DBMAINTENANCE_H
+
+#include <QObject>
+#include <QDateTime>
+#include <QTimer>
+
+class DBConnection;
+
+class DBMaintenance : public QObject
+{
+    Q_OBJECT
+    
+    Q_PROPERTY(bool active READ isActive NOTIFY activeChanged)
+    Q_PROPERTY(QDateTime lastAnalyzed READ lastAnalyzed NOTIFY finished)
+    Q_PROPERTY(QDateTime lastRun READ lastRun NOTIFY finished)
+
+public:
+    ~DBMaintenance();
+    
+    static DBMaintenance* instance();
+    
+    bool isActive() const;
+    
+    QDateTime lastAnalyzed() const;
+    QDateTime lastRun() const;
+
+public Q_SLOTS:
+    bool run(bool analyze = false);
+
+private Q_SLOTS:
+    void runIfDue();
+    
+    void onArticlesDeleted();
+    void onMaintenanceFinished(DBConnection *connection);
+
+Q_SIGNALS:
+    void activeChanged(bool active);
+    void finished();
+
+private:
+    DBMaintenance();
+    
+    void setActive(bool active);
+    
+    static DBMaintenance *self;
+    
+    bool m_active;
+    bool m_pending;
+    
+    QDateTime m_lastAnalyzed;
+    QDateTime m_lastRun;
+    
+    QTimer m_timer;
+};
+
+#endif // DBMAINTENANCE_H
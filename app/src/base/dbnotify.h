@@ -33,6 +33,7 @@ Q_SIGNALS:
     void subscriptionsAdded(const QStringList &ids);
     void subscriptionDeleted(const QString &id);
     void subscriptionUpdated(const QString &id);
+    void subscriptionsUpdated(const QStringList &ids);
     void subscriptionRead(const QString &id, bool isRead);
     void allSubscriptionsRead();
     
@@ -40,9 +41,14 @@ Q_SIGNALS:
     void articlesDeleted(const QStringList &articleIds, const QString &subscriptionId);
     void articleUpdated(const QString &id);
     void articleFavourited(const QString &id, bool isFavourite);
+    void articlesFavourited(const QStringList &ids, bool isFavourite);
     void articleRead(const QString &articleId, const QString &subscriptionId, bool isRead);
+    // subscriptionIds holds the subscription of each article in articleIds
+    void articlesRead(const QStringList &articleIds, const QStringList &subscriptionIds, bool isRead);
     void readArticlesDeleted(int count);
 
+    void mediaRemoved(const QStringList &urls);
+
     void error(const QString &errorString);
 
 private:
@@ -15,10 +15,49 @@
  */
 
 #include "diskcache.h"
+#include "definitions.h"
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QMultiMap>
+
+// Unknown until the owner first expires the media cache
+qint64 DiskCache::mediaCacheSize = -1;
+QMutex DiskCache::mediaCacheMutex;
 
 DiskCache::DiskCache(QObject *parent) :
-    QNetworkDiskCache(parent)
+    QNetworkDiskCache(parent),
+    m_mediaCacheOwner(false)
 {
+    setMaximumCacheSize(MEDIA_CACHE_SIZE);
+}
+
+QString DiskCache::directoryForPath(const QString &path) {
+    // Article media (CACHE_PATH/subscriptionId/articleId/url) is stored once in the shared media cache,
+    // since QNetworkDiskCache already keys entries by URL
+    if ((path.startsWith(CACHE_PATH)) && (path.mid(CACHE_PATH.size()).count("/") == 2)) {
+        return MEDIA_CACHE_PATH;
+    }
+    
+    return path.left(path.lastIndexOf("/") + 1);
+}
+
+QString DiskCache::thumbnailPath(const QString &url) {
+    return THUMBNAIL_CACHE_PATH + QCryptographicHash::hash(url.toUtf8(), QCryptographicHash::Md5).toHex() + ".png";
+}
+
+bool DiskCache::isMediaCacheOwner() const {
+    return m_mediaCacheOwner;
+}
+
+void DiskCache::setMediaCacheOwner(bool owner) {
+    m_mediaCacheOwner = owner;
+}
+
+bool DiskCache::isMediaCache() const {
+    return cacheDirectory() == QDir(MEDIA_CACHE_PATH).absolutePath() + "/";
 }
 
 QIODevice* DiskCache::prepare(const QNetworkCacheMetaData &metaData) {
@@ -27,3 +66,57 @@ QIODevice* DiskCache::prepare(const QNetworkCacheMetaData &metaData) {
     md.setRawHeaders(QList< QPair<QByteArray, QByteArray> >());
     return QNetworkDiskCache::prepare(md);
 }
+
+void DiskCache::insert(QIODevice *device) {
+    const qint64 size = device->size();
+    QNetworkDiskCache::insert(device);
+    
+    if (isMediaCache()) {
+        QMutexLocker locker(&mediaCacheMutex);
+        
+        if (mediaCacheSize >= 0) {
+            mediaCacheSize += size;
+        }
+    }
+}
+
+qint64 DiskCache::expire() {
+    if (!isMediaCache()) {
+        return QNetworkDiskCache::expire();
+    }
+    
+    QMutexLocker locker(&mediaCacheMutex);
+    
+    if ((!m_mediaCacheOwner) || ((mediaCacheSize >= 0) && (mediaCacheSize < maximumCacheSize()))) {
+        return qMax(qint64(0), mediaCacheSize);
+    }
+    
+    // As QNetworkDiskCache::expire(), the oldest items are removed until the cache is 90% of its maximum size
+    QMultiMap<QDateTime, QFileInfo> items;
+    qint64 size = 0;
+    QDirIterator iterator(cacheDirectory(), QDir::Files | QDir::NoSymLinks, QDirIterator::Subdirectories);
+    
+    while (iterator.hasNext()) {
+        iterator.next();
+        const QFileInfo info = iterator.fileInfo();
+        
+        if (info.fileName().endsWith(".d")) {
+            items.insert(info.created(), info);
+            size += info.size();
+        }
+    }
+    
+    const qint64 goal = maximumCacheSize() * 9 / 10;
+    QMapIterator<QDateTime, QFileInfo> item(items);
+    
+    while ((size > goal) && (item.hasNext())) {
+        item.next();
+        
+        if (QFile::remove(item.value().absoluteFilePath())) {
+            size -= item.value().size();
+        }
+    }
+    
+    mediaCacheSize = size;
+    return size;
+}
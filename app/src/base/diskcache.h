@@ -17,16 +17,40 @@
 #ifndef DISKCACHE_H
 #define DISKCACHE_H
 
+#include <QMutex>
 #include <QNetworkDiskCache>
 
+/**
+ * The shared media cache (MEDIA_CACHE_PATH) is used by several instances, possibly on different threads,
+ * so only the instance marked as its owner expires it. Other instances record the size of the items they
+ * insert, so that the owner knows when to expire the cache.
+ */
 class DiskCache : public QNetworkDiskCache
 {
     Q_OBJECT
 
 public:
     explicit DiskCache(QObject *parent = 0);
+    
+    static QString directoryForPath(const QString &path);
+    static QString thumbnailPath(const QString &url);
+        
+    bool isMediaCacheOwner() const;
+    void setMediaCacheOwner(bool owner);
         
     virtual QIODevice* prepare(const QNetworkCacheMetaData &metaData);
+    virtual void insert(QIODevice *device);
+    
+    virtual qint64 expire();
+
+private:
+    bool isMediaCache() const;
+    
+    static qint64 mediaCacheSize;
+    
+    static QMutex mediaCacheMutex;
+    
+    bool m_mediaCacheOwner;
 };
 
 #endif // DISKCACHE_H
@@ -17,15 +17,21 @@
 #include "download.h"
 #include "definitions.h"
 #include "logger.h"
+#include "metrics.h"
 #include <QNetworkAccessManager>
 #include <QNetworkReply>
 
+// Larger responses grow their buffer as they are read
+static const qint64 MAX_RESERVED_BYTES = 4 * 1024 * 1024;
+
 Download::Download(QObject *parent) :
     Transfer(Transfer::Download, parent),
     m_reply(0),
     m_canceled(false),
     m_redirects(0),
-    m_metadataSet(false)
+    m_metadataSet(false),
+    m_speedBytes(0),
+    m_pendingBytes(0)
 {
 }
 
@@ -33,6 +39,10 @@ QByteArray Download::readAll() const {
     return m_response;
 }
 
+QByteArray Download::rawHeader(const QByteArray &name) const {
+    return m_headers.value(name.toLower());
+}
+
 void Download::queue() {
     switch (status()) {
     case Canceled:
@@ -106,8 +116,12 @@ void Download::startDownload(const QString &u) {
     setStatus(Downloading);
     m_redirects = 0;
     m_response.clear();
+    m_headers.clear();
+    m_speedBytes = 0;
     m_speedTime.start();
+    m_progressTime.start();
     m_reply = networkAccessManager()->get(request);
+    m_reply->setReadBufferSize(DOWNLOAD_BUFFER_SIZE * 4);
     connect(m_reply, SIGNAL(metaDataChanged()), this, SLOT(onReplyMetaDataChanged()));
     connect(m_reply, SIGNAL(readyRead()), this, SLOT(onReplyReadyRead()));
     connect(m_reply, SIGNAL(finished()), this, SLOT(onReplyFinished()));
@@ -119,13 +133,53 @@ void Download::followRedirect(const QString &u) {
     request.setRawHeader("User-Agent", USER_AGENT);
     ++m_redirects;
     m_response.clear();
+    m_speedBytes = 0;
     m_speedTime.start();
+    m_progressTime.start();
     m_reply = networkAccessManager()->get(request);
+    m_reply->setReadBufferSize(DOWNLOAD_BUFFER_SIZE * 4);
     connect(m_reply, SIGNAL(metaDataChanged()), this, SLOT(onReplyMetaDataChanged()));
     connect(m_reply, SIGNAL(readyRead()), this, SLOT(onReplyReadyRead()));
     connect(m_reply, SIGNAL(finished()), this, SLOT(onReplyFinished()));
 }
 
+qint64 Download::readResponse(qint64 bytes) {
+    // Read straight into the response rather than through a temporary QByteArray
+    const int offset = m_response.size();
+    m_response.resize(offset + int(bytes));
+    const qint64 read = qMax(qint64(0), m_reply->read(m_response.data() + offset, bytes));
+    m_response.resize(offset + int(read));
+    return read;
+}
+
+void Download::reportProgress(qint64 bytes) {
+    m_pendingBytes += bytes;
+    m_speedBytes += bytes;
+    
+    if (m_progressTime.elapsed() >= TRANSFER_PROGRESS_INTERVAL) {
+        flushProgress();
+    }
+}
+
+void Download::flushProgress() {
+    m_progressTime.restart();
+    
+    if (m_pendingBytes > 0) {
+        Metrics::increment(Metrics::TransferredBytes, m_pendingBytes, "download");
+        setBytesTransferred(bytesTransferred() + m_pendingBytes);
+        m_pendingBytes = 0;
+        
+        if (size() > 0) {
+            setProgress(int(bytesTransferred() * 100 / size()));
+        }
+    }
+    
+    if (m_speedTime.elapsed() >= 1000) {
+        setSpeed(int(m_speedBytes * 1000 / m_speedTime.restart()));
+        m_speedBytes = 0;
+    }
+}
+
 void Download::onReplyMetaDataChanged() {
     if ((m_metadataSet) || (m_reply->error() != QNetworkReply::NoError) ||
         (!m_reply->rawHeader("Location").isEmpty())) {
@@ -140,6 +194,8 @@ void Download::onReplyMetaDataChanged() {
     
     if (bytes > 0) {
         setSize(bytes + bytesTransferred());
+        // The length is given by the server, so only a bounded amount is reserved up front
+        m_response.reserve(int(qMin(bytes, MAX_RESERVED_BYTES)));
     }
     
     m_metadataSet = true;
@@ -156,13 +212,7 @@ void Download::onReplyReadyRead() {
         return;
     }
 
-    m_response.append(m_reply->read(bytes));
-    setBytesTransferred(bytesTransferred() + bytes);
-    setSpeed(int(bytes) * 1000 / qMax(1, m_speedTime.restart()));
-    
-    if (size() > 0) {
-        setProgress(int(bytesTransferred() * 100 / size()));
-    }
+    reportProgress(readResponse(bytes));
 }
 
 void Download::onReplyFinished() {
@@ -186,20 +236,22 @@ void Download::onReplyFinished() {
 
     const QNetworkReply::NetworkError error = m_reply->error();
     const QString errorString = m_reply->errorString();
+    
+    // Keep the response headers of the final reply, so that callers can honour caching hints
+    foreach (const QByteArray &header, m_reply->rawHeaderList()) {
+        m_headers[header.toLower()] = m_reply->rawHeader(header);
+    }
 
     if ((m_reply->isOpen()) && (error == QNetworkReply::NoError)) {
         const qint64 bytes = m_reply->bytesAvailable();
         
         if ((bytes > 0) && (m_metadataSet)) {
-            m_response.append(m_reply->read(bytes));
-            setBytesTransferred(bytesTransferred() + bytes);
-            
-            if (size() > 0) {
-                setProgress(bytesTransferred() * 100 / size());
-            }
+            m_pendingBytes += readResponse(bytes);
         }
     }
     
+    flushProgress();
+    setSpeed(0);
     m_reply->deleteLater();
     m_reply = 0;
         
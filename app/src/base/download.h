@@ -18,6 +18,7 @@
 #define DOWNLOAD_H
 
 #include "transfer.h"
+#include <QHash>
 #include <QTime>
 
 class QNetworkReply;
@@ -31,6 +32,8 @@ public:
             
     Q_INVOKABLE QByteArray readAll() const;
     
+    QByteArray rawHeader(const QByteArray &name) const;
+    
 public Q_SLOTS:
     virtual void queue();
     virtual void start();
@@ -46,6 +49,10 @@ private:
     void startDownload(const QString &u);
     void followRedirect(const QString &u);
     
+    qint64 readResponse(qint64 bytes);
+    void reportProgress(qint64 bytes);
+    void flushProgress();
+    
     QNetworkReply *m_reply;
     
     bool m_canceled;
@@ -55,8 +62,14 @@ private:
     bool m_metadataSet;
     
     QByteArray m_response;
+    
+    QHash<QByteArray, QByteArray> m_headers;
 
     QTime m_speedTime;
+    qint64 m_speedBytes;
+    
+    QTime m_progressTime;
+    qint64 m_pendingBytes;
 };
     
 #endif // DOWNLOAD_H
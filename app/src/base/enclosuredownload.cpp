@@ -15,9 +15,12 @@
  */
 
 #include "enclosuredownload.h"
+#include "bandwidthscheduler.h"
+#include "customcommandscheduler.h"
 #include "definitions.h"
 #include "enclosurerequest.h"
 #include "logger.h"
+#include "metrics.h"
 #include "pluginmanager.h"
 #include "pluginsettings.h"
 #include "settings.h"
@@ -27,6 +30,10 @@
 #include <QNetworkAccessManager>
 #include <QNetworkReply>
 #include <QProcess>
+#ifdef USE_FALLOCATE
+#include <fcntl.h>
+#include <linux/falloc.h>
+#endif
 
 EnclosureDownload::EnclosureDownload(QObject *parent) :
     Transfer(Transfer::EnclosureDownload, parent),
@@ -35,10 +42,17 @@ EnclosureDownload::EnclosureDownload(QObject *parent) :
     m_canceled(false),
     m_category(tr("Default")),
     m_customCommandOverrideEnabled(false),
+    m_maximumSpeed(0),
     m_usePlugin(false),
     m_redirects(0),
-    m_metadataSet(false)
+    m_metadataSet(false),
+    m_segmentable(false),
+    m_rangesUnsupported(false),
+    m_segmentFallback(false),
+    m_speedBytes(0),
+    m_pendingBytes(0)
 {
+    m_buffer.resize(DOWNLOAD_BUFFER_SIZE);
 }
 
 QVariant EnclosureDownload::data(int role) const {
@@ -53,8 +67,12 @@ QVariant EnclosureDownload::data(int role) const {
         return downloadPath();
     case FileNameRole:
         return fileName();
+    case MaximumSpeedRole:
+        return maximumSpeed();
     case PluginSettingsRole:
         return pluginSettings();
+    case SegmentsRole:
+        return segments();
     case UsePluginRole:
         return usePlugin();
     default:
@@ -79,9 +97,15 @@ bool EnclosureDownload::setData(int role, const QVariant &value) {
     case FileNameRole:
         setFileName(value.toString());
         return true;
+    case MaximumSpeedRole:
+        setMaximumSpeed(value.toInt());
+        return true;
     case PluginSettingsRole:
         setPluginSettings(value.toMap());
         return true;
+    case SegmentsRole:
+        setSegments(value.toList());
+        return true;
     case UsePluginRole:
         setUsePlugin(value.toBool());
         return true;
@@ -168,6 +192,18 @@ void EnclosureDownload::setFileName(const QString &name) {
     }    
 }
 
+int EnclosureDownload::maximumSpeed() const {
+    return m_maximumSpeed;
+}
+
+void EnclosureDownload::setMaximumSpeed(int speed) {
+    if (speed != maximumSpeed()) {
+        m_maximumSpeed = qMax(0, speed);
+        emit maximumSpeedChanged();
+        emit dataChanged(this, MaximumSpeedRole);
+    }
+}
+
 bool EnclosureDownload::usePlugin() const {
     return m_usePlugin;
 }
@@ -190,6 +226,51 @@ void EnclosureDownload::setPluginSettings(const QVariantMap &settings) {
     emit dataChanged(this, PluginSettingsRole);
 }
 
+QVariantList EnclosureDownload::segments() const {
+    QVariantList list;
+    
+    foreach (const DownloadSegment &segment, m_segments) {
+        list << QString("%1:%2:%3").arg(segment.start).arg(segment.end).arg(segment.position);
+    }
+    
+    return list;
+}
+
+void EnclosureDownload::setSegments(const QVariantList &segments) {
+    m_segments.clear();
+    qint64 bytes = 0;
+    
+    foreach (const QVariant &v, segments) {
+        const QStringList parts = v.toString().split(":");
+        
+        if (parts.size() == 3) {
+            const DownloadSegment segment(parts.at(0).toLongLong(), parts.at(1).toLongLong(),
+                                          parts.at(2).toLongLong());
+            bytes += segment.position - segment.start;
+            m_segments << segment;
+        }
+    }
+    
+    if (!m_segments.isEmpty()) {
+        // The file is preallocated, so its size does not reflect the bytes transferred
+        setBytesTransferred(bytes);
+        
+        if (size() > 0) {
+            setProgress(bytesTransferred() * 100 / size());
+        }
+    }
+    
+    emit dataChanged(this, SegmentsRole);
+}
+
+void EnclosureDownload::resumeCustomCommands() {
+    Logger::log("EnclosureDownload::resumeCustomCommands()", Logger::LowVerbosity);
+    
+    if (!executeCustomCommands()) {
+        moveDownloadedFiles();
+    }
+}
+
 void EnclosureDownload::queue() {
     switch (status()) {
     case Canceled:
@@ -198,6 +279,7 @@ void EnclosureDownload::queue() {
     case Connecting:
     case Downloading:
     case ExecutingCustomCommand:
+    case WaitingForCustomCommand:
         return;
     default:
         break;
@@ -213,11 +295,18 @@ void EnclosureDownload::start() {
     case Connecting:
     case Downloading:
     case ExecutingCustomCommand:
+    case WaitingForCustomCommand:
         return;
     default:
         break;
     }
     
+    if ((m_segments.isEmpty()) && (size() > 0) && (bytesTransferred() >= size()) && (m_file.exists())) {
+        // The download completed, but was paused while waiting for its custom commands
+        resumeCustomCommands();
+        return;
+    }
+    
     if (!usePlugin()) {
         startDownload(url());
         return;
@@ -233,6 +322,8 @@ void EnclosureDownload::start() {
 
             if (request) {
                 setStatus(Connecting);
+                connect(request, SIGNAL(finished(EnclosureRequest*)),
+                        new MetricsTimer(Metrics::PluginRequestDuration, config->id(), request), SLOT(finish()));
                 connect(request, SIGNAL(finished(EnclosureRequest*)),
                         this, SLOT(onEnclosureRequestFinished(EnclosureRequest*)));
                 
@@ -259,6 +350,12 @@ void EnclosureDownload::pause() {
     case Connecting:
     case ExecutingCustomCommand:
         return;
+    case WaitingForCustomCommand:
+        // The download is complete, so its custom commands are run when it is started again
+        m_commands.clear();
+        CustomCommandScheduler::instance()->release(this);
+        setStatus(Paused);
+        return;
     default:
         break;
     }
@@ -267,6 +364,10 @@ void EnclosureDownload::pause() {
         m_canceled = false;
         m_reply->abort();
     }
+    else if (activeSegments() > 0) {
+        m_canceled = false;
+        abortSegments();
+    }
     else {
         setStatus(Paused);
     }
@@ -278,6 +379,10 @@ void EnclosureDownload::cancel() {
     case Completed:
     case ExecutingCustomCommand:
         return;
+    case WaitingForCustomCommand:
+        m_commands.clear();
+        CustomCommandScheduler::instance()->release(this);
+        break;
     default:
         break;
     }
@@ -286,7 +391,12 @@ void EnclosureDownload::cancel() {
         m_canceled = true;
         m_reply->abort();
     }
+    else if (activeSegments() > 0) {
+        m_canceled = true;
+        abortSegments();
+    }
     else {
+        m_segments.clear();
         m_file.remove();
         QDir().rmdir(downloadPath());        
         setStatus(Canceled);
@@ -306,10 +416,19 @@ QProcess* EnclosureDownload::process() {
 void EnclosureDownload::startDownload(QNetworkRequest &request, const QByteArray &operation, const QByteArray &data) {
     Logger::log("EnclosureDownload::startDownload(). URL: " + request.url().toString(), Logger::LowVerbosity);
     QDir().mkpath(downloadPath());
+    m_segmentable = (operation == "GET") && (data.isEmpty());
     
-    if (!m_file.open(m_file.exists() ? QFile::Append : QFile::WriteOnly)) {
-        setErrorString(m_file.errorString());
-        setStatus(Failed);
+    if ((m_segmentable) && (!m_segments.isEmpty())) {
+        if (m_file.exists()) {
+            startSegments(request);
+            return;
+        }
+        
+        m_segments.clear();
+        setBytesTransferred(0);
+    }
+    
+    if (!openFile()) {
         return;
     }
     
@@ -322,7 +441,9 @@ void EnclosureDownload::startDownload(QNetworkRequest &request, const QByteArray
     setSpeed(0);
     setStatus(Downloading);
     m_redirects = 0;
+    m_speedBytes = 0;
     m_speedTime.start();
+    m_progressTime.start();
 
     if (!data.isEmpty()) {
         QBuffer *buffer = new QBuffer;
@@ -335,6 +456,7 @@ void EnclosureDownload::startDownload(QNetworkRequest &request, const QByteArray
         m_reply = networkAccessManager()->sendCustomRequest(request, operation);
     }
     
+    m_reply->setReadBufferSize(DOWNLOAD_BUFFER_SIZE * 4);
     connect(m_reply, SIGNAL(metaDataChanged()), this, SLOT(onReplyMetaDataChanged()));
     connect(m_reply, SIGNAL(readyRead()), this, SLOT(onReplyReadyRead()));
     connect(m_reply, SIGNAL(finished()), this, SLOT(onReplyFinished()));
@@ -349,9 +471,7 @@ void EnclosureDownload::followRedirect(const QString &u) {
     Logger::log("EnclosureDownload::followRedirect(). URL: " + u, Logger::LowVerbosity);
     QDir().mkpath(downloadPath());
     
-    if (!m_file.open(m_file.exists() ? QFile::Append : QFile::WriteOnly)) {
-        setErrorString(m_file.errorString());
-        setStatus(Failed);
+    if (!openFile()) {
         return;
     }
     
@@ -363,13 +483,318 @@ void EnclosureDownload::followRedirect(const QString &u) {
         request.setRawHeader("Range", "bytes=" + QByteArray::number(bytesTransferred()) + "-");
     }
 
+    m_speedBytes = 0;
     m_speedTime.start();
+    m_progressTime.start();
     m_reply = networkAccessManager()->get(request);
+    m_reply->setReadBufferSize(DOWNLOAD_BUFFER_SIZE * 4);
     connect(m_reply, SIGNAL(metaDataChanged()), this, SLOT(onReplyMetaDataChanged()));
     connect(m_reply, SIGNAL(readyRead()), this, SLOT(onReplyReadyRead()));
     connect(m_reply, SIGNAL(finished()), this, SLOT(onReplyFinished()));
 }
 
+bool EnclosureDownload::openFile() {
+    // The download resumes from bytesTransferred(), which is checkpointed. Any data after it (e.g. a preallocated
+    // file, or data written after the last checkpoint before a crash) is discarded.
+    if (m_file.exists()) {
+        if (m_file.size() > bytesTransferred()) {
+            m_file.resize(bytesTransferred());
+        }
+        else {
+            setBytesTransferred(m_file.size());
+        }
+    }
+    
+    if (!m_file.open(m_file.exists() ? QFile::Append : QFile::WriteOnly)) {
+        setErrorString(m_file.errorString());
+        setStatus(Failed);
+        return false;
+    }
+    
+    return true;
+}
+
+void EnclosureDownload::preallocate(qint64 length, bool keepSize) {
+#ifdef USE_FALLOCATE
+    // Failure is harmless (e.g. the filesystem does not support it), the file just grows as it is written
+    if ((m_file.isOpen()) && (length > 0)
+        && (fallocate(m_file.handle(), keepSize ? FALLOC_FL_KEEP_SIZE : 0, 0, length) == -1)) {
+        Logger::log("EnclosureDownload::preallocate(). Cannot preallocate file", Logger::MediumVerbosity);
+    }
+#else
+    Q_UNUSED(length)
+    Q_UNUSED(keepSize)
+#endif
+}
+
+bool EnclosureDownload::writeReply(qint64 bytes) {
+    while (bytes > 0) {
+        const qint64 read = m_reply->read(m_buffer.data(), qMin(bytes, qint64(m_buffer.size())));
+        
+        if (read <= 0) {
+            break;
+        }
+        
+        if (m_file.write(m_buffer.constData(), read) != read) {
+            return false;
+        }
+        
+        bytes -= read;
+        reportProgress(read);
+    }
+    
+    return true;
+}
+
+void EnclosureDownload::reportProgress(qint64 bytes) {
+    m_pendingBytes += bytes;
+    m_speedBytes += bytes;
+    
+    if (m_progressTime.elapsed() >= TRANSFER_PROGRESS_INTERVAL) {
+        flushProgress();
+    }
+}
+
+void EnclosureDownload::flushProgress() {
+    m_progressTime.restart();
+    
+    if (m_pendingBytes > 0) {
+        Metrics::increment(Metrics::TransferredBytes, m_pendingBytes, "enclosure");
+        setBytesTransferred(bytesTransferred() + m_pendingBytes);
+        m_pendingBytes = 0;
+        
+        if (size() > 0) {
+            setProgress(int(bytesTransferred() * 100 / size()));
+        }
+    }
+    
+    if (m_speedTime.elapsed() >= 1000) {
+        setSpeed(int(m_speedBytes * 1000 / m_speedTime.restart()));
+        m_speedBytes = 0;
+    }
+}
+
+void EnclosureDownload::splitIntoSegments() {
+    const int count = qMax(1, Settings::downloadSegments());
+    const qint64 segmentSize = size() / count;
+    Logger::log(QString("EnclosureDownload::splitIntoSegments(). Splitting download into %1 segments").arg(count),
+                Logger::LowVerbosity);
+    m_file.close();
+    
+    if ((!m_file.open(QFile::ReadWrite)) || (!m_file.resize(size()))) {
+        Logger::log("EnclosureDownload::splitIntoSegments(). Cannot preallocate file: " + m_file.errorString());
+        m_file.close();
+        m_file.resize(0);
+        m_file.open(QFile::WriteOnly);
+        return;
+    }
+    
+    preallocate(size(), false);
+    m_segmentRequest = m_reply->request();
+    m_segmentRequest.setUrl(m_reply->url());
+    
+    for (int i = 0; i < count; i++) {
+        const qint64 start = i * segmentSize;
+        m_segments << DownloadSegment(start, i == count - 1 ? size() : start + segmentSize, start);
+    }
+    
+    // The current reply starts at byte 0, so it is reused for the first segment
+    disconnect(m_reply, 0, this, 0);
+    m_segments[0].reply = m_reply;
+    connect(m_reply, SIGNAL(readyRead()), this, SLOT(onSegmentReadyRead()));
+    connect(m_reply, SIGNAL(finished()), this, SLOT(onSegmentFinished()));
+    m_reply = 0;
+    m_speedBytes = 0;
+    
+    for (int i = 1; i < count; i++) {
+        startSegment(i);
+    }
+}
+
+void EnclosureDownload::startSegments(const QNetworkRequest &request) {
+    Logger::log(QString("EnclosureDownload::startSegments(). Resuming %1 segments").arg(m_segments.size()),
+                Logger::LowVerbosity);
+    
+    if (!m_file.open(QFile::ReadWrite)) {
+        setErrorString(m_file.errorString());
+        setStatus(Failed);
+        return;
+    }
+    
+    m_segmentRequest = request;
+    m_segmentRequest.setRawHeader("User-Agent", USER_AGENT);
+    m_metadataSet = true;
+    m_speedBytes = 0;
+    setSpeed(0);
+    setStatus(Downloading);
+    m_speedTime.start();
+    m_progressTime.start();
+    
+    for (int i = 0; i < m_segments.size(); i++) {
+        if (m_segments.at(i).position < m_segments.at(i).end) {
+            m_segments[i].redirects = 0;
+            startSegment(i);
+        }
+    }
+    
+    if (activeSegments() == 0) {
+        finishSegments();
+    }
+}
+
+void EnclosureDownload::startSegment(int i) {
+    DownloadSegment &segment = m_segments[i];
+    QNetworkRequest request(m_segmentRequest);
+    request.setRawHeader("Range", "bytes=" + QByteArray::number(segment.position) + "-"
+                         + QByteArray::number(segment.end - 1));
+    segment.reply = networkAccessManager()->get(request);
+    segment.reply->setReadBufferSize(DOWNLOAD_BUFFER_SIZE * 4);
+    connect(segment.reply, SIGNAL(metaDataChanged()), this, SLOT(onSegmentMetaDataChanged()));
+    connect(segment.reply, SIGNAL(readyRead()), this, SLOT(onSegmentReadyRead()));
+    connect(segment.reply, SIGNAL(finished()), this, SLOT(onSegmentFinished()));
+}
+
+void EnclosureDownload::readSegment(int i) {
+    QNetworkReply *reply = m_segments.at(i).reply;
+    qint64 bytes = reply->bytesAvailable();
+    
+    if (bytes >= DOWNLOAD_BUFFER_SIZE) {
+        bytes = BandwidthScheduler::instance()->acquire(this, bytes);
+        
+        if (bytes > 0) {
+            writeSegment(i, reply, bytes);
+        }
+    }
+}
+
+bool EnclosureDownload::writeSegment(int i, QNetworkReply *reply, qint64 bytes) {
+    DownloadSegment &segment = m_segments[i];
+    bytes = qMin(bytes, segment.end - segment.position);
+    
+    if ((bytes > 0) && (!m_file.seek(segment.position))) {
+        if (m_segmentError.isEmpty()) {
+            m_segmentError = tr("Cannot write to file - %1").arg(m_file.errorString());
+        }
+        
+        abortSegments();
+        return false;
+    }
+    
+    while (bytes > 0) {
+        const qint64 read = reply->read(m_buffer.data(), qMin(bytes, qint64(m_buffer.size())));
+        
+        if (read <= 0) {
+            break;
+        }
+        
+        if (m_file.write(m_buffer.constData(), read) != read) {
+            if (m_segmentError.isEmpty()) {
+                m_segmentError = tr("Cannot write to file - %1").arg(m_file.errorString());
+            }
+            
+            abortSegments();
+            return false;
+        }
+        
+        segment.position += read;
+        bytes -= read;
+        reportProgress(read);
+    }
+    
+    if ((segment.position >= segment.end) && (segment.reply) && (segment.reply->isRunning())) {
+        // A reply that ignored the Range end (the reused first reply) is stopped at the segment boundary
+        segment.reply->abort();
+        return false;
+    }
+    
+    return true;
+}
+
+void EnclosureDownload::abortSegments() {
+    for (int i = 0; i < m_segments.size(); i++) {
+        if ((m_segments.at(i).reply) && (m_segments.at(i).reply->isRunning())) {
+            m_segments.at(i).reply->abort();
+        }
+    }
+}
+
+void EnclosureDownload::finishSegments() {
+    flushProgress();
+    m_file.close();
+    setSpeed(0);
+    
+    if (m_segmentFallback) {
+        Logger::log("EnclosureDownload::finishSegments(). Falling back to a single connection", Logger::LowVerbosity);
+        m_segmentFallback = false;
+        m_segments.clear();
+        m_file.remove();
+        m_metadataSet = false;
+        setBytesTransferred(0);
+        setProgress(0);
+        QNetworkRequest request(m_segmentRequest);
+        request.setRawHeader("Range", QByteArray());
+        startDownload(request);
+        return;
+    }
+    
+    if (!m_segmentError.isEmpty()) {
+        setErrorString(m_segmentError);
+        m_segmentError.clear();
+        setStatus(Failed);
+        return;
+    }
+    
+    bool complete = true;
+    
+    foreach (const DownloadSegment &segment, m_segments) {
+        if (segment.position < segment.end) {
+            complete = false;
+            break;
+        }
+    }
+    
+    setErrorString(QString());
+    
+    if (complete) {
+        m_segments.clear();
+        
+        if (!executeCustomCommands()) {
+            moveDownloadedFiles();
+        }
+    }
+    else if (m_canceled) {
+        m_segments.clear();
+        m_file.remove();
+        QDir().rmdir(downloadPath());
+        setStatus(Canceled);
+    }
+    else {
+        setStatus(Paused);
+    }
+}
+
+int EnclosureDownload::segmentIndex(QNetworkReply *reply) const {
+    for (int i = 0; i < m_segments.size(); i++) {
+        if (m_segments.at(i).reply == reply) {
+            return i;
+        }
+    }
+    
+    return -1;
+}
+
+int EnclosureDownload::activeSegments() const {
+    int active = 0;
+    
+    foreach (const DownloadSegment &segment, m_segments) {
+        if (segment.reply) {
+            active++;
+        }
+    }
+    
+    return active;
+}
+
 bool EnclosureDownload::executeCustomCommands() {
     Logger::log("EnclosureDownload::executeCustomCommands()", Logger::LowVerbosity);
     m_commands.clear();
@@ -395,8 +820,13 @@ bool EnclosureDownload::executeCustomCommands() {
     }
     
     if (!m_commands.isEmpty()) {
-        setStatus(ExecutingCustomCommand);
-        executeCustomCommand(m_commands.takeFirst());
+        // Commands run once the scheduler has a free slot, so that they do not hold up other transfers
+        setStatus(WaitingForCustomCommand);
+        
+        if (CustomCommandScheduler::instance()->acquire(this)) {
+            startCustomCommands();
+        }
+        
         return true;
     }
     
@@ -411,7 +841,7 @@ void EnclosureDownload::executeCustomCommand(const Command &command) {
         process()->setWorkingDirectory(command.workingDirectory);
     }
     
-    process()->start(command.command);
+    process()->start(CustomCommandScheduler::command(command.command));
 }
 
 void EnclosureDownload::moveDownloadedFiles() {
@@ -482,6 +912,16 @@ void EnclosureDownload::onReplyMetaDataChanged() {
     }
     
     m_metadataSet = true;
+    
+    if ((m_segmentable) && (!m_rangesUnsupported) && (bytesTransferred() == 0)
+        && (Settings::downloadSegments() > 1) && (bytes >= SEGMENTED_DOWNLOAD_MIN_SIZE)
+        && (m_reply->rawHeader("Accept-Ranges").toLower() == "bytes")) {
+        splitIntoSegments();
+    }
+    else if (bytes > 0) {
+        // Reserve the space without changing the file size, which is used as the resume offset
+        preallocate(size(), true);
+    }
 }
 
 void EnclosureDownload::onReplyReadyRead() {
@@ -489,25 +929,24 @@ void EnclosureDownload::onReplyReadyRead() {
         return;
     }
 
-    const qint64 bytes = m_reply->bytesAvailable();
+    qint64 bytes = m_reply->bytesAvailable();
 
     if (bytes < DOWNLOAD_BUFFER_SIZE) {
         return;
     }
+    
+    bytes = BandwidthScheduler::instance()->acquire(this, bytes);
+    
+    if (bytes <= 0) {
+        return;
+    }
 
-    if (m_file.write(m_reply->read(bytes)) == -1) {
+    if (!writeReply(bytes)) {
         m_reply->deleteLater();
 	m_reply = 0;
+        flushProgress();
         setErrorString(tr("Cannot write to file - %1").arg(m_file.errorString()));
         setStatus(Failed);
-        return;
-    }
-    
-    setBytesTransferred(bytesTransferred() + bytes);
-    setSpeed(int(bytes) * 1000 / qMax(1, m_speedTime.restart()));
-    
-    if (size() > 0) {
-        setProgress(int(bytesTransferred() * 100 / size()));
     }
 }
 
@@ -534,19 +973,12 @@ void EnclosureDownload::onReplyFinished() {
     const QNetworkReply::NetworkError error = m_reply->error();
     const QString errorString = m_reply->errorString();
 
-    if ((m_reply->isOpen()) && (error == QNetworkReply::NoError) && (m_file.isOpen())) {
-        const qint64 bytes = m_reply->bytesAvailable();
-        
-        if ((bytes > 0) && (m_metadataSet)) {
-            m_file.write(m_reply->read(bytes));
-            setBytesTransferred(bytesTransferred() + bytes);
-            
-            if (size() > 0) {
-                setProgress(bytesTransferred() * 100 / size());
-            }
-        }
+    if ((m_reply->isOpen()) && (error == QNetworkReply::NoError) && (m_file.isOpen()) && (m_metadataSet)) {
+        writeReply(m_reply->bytesAvailable());
     }
 
+    flushProgress();
+    setSpeed(0);
     m_file.close();
     m_reply->deleteLater();
     m_reply = 0;
@@ -578,6 +1010,104 @@ void EnclosureDownload::onReplyFinished() {
     }
 }
 
+void EnclosureDownload::onSegmentMetaDataChanged() {
+    QNetworkReply *reply = qobject_cast<QNetworkReply*>(sender());
+    const int i = segmentIndex(reply);
+    
+    if ((i == -1) || (reply->error() != QNetworkReply::NoError) || (!reply->rawHeader("Location").isEmpty())) {
+        return;
+    }
+    
+    if (reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() != 206) {
+        Logger::log("EnclosureDownload::onSegmentMetaDataChanged(). Byte ranges are not supported by the server",
+                    Logger::LowVerbosity);
+        m_rangesUnsupported = true;
+        m_segmentFallback = true;
+        abortSegments();
+    }
+}
+
+void EnclosureDownload::onSegmentReadyRead() {
+    const int i = segmentIndex(qobject_cast<QNetworkReply*>(sender()));
+    
+    if (i != -1) {
+        readSegment(i);
+    }
+}
+
+void EnclosureDownload::onSegmentFinished() {
+    QNetworkReply *reply = qobject_cast<QNetworkReply*>(sender());
+    const int i = segmentIndex(reply);
+    
+    if (i == -1) {
+        return;
+    }
+    
+    m_segments[i].reply = 0;
+    reply->deleteLater();
+    const QString redirect = QString::fromUtf8(reply->rawHeader("Location"));
+    
+    if (!redirect.isEmpty()) {
+        if (m_segments.at(i).redirects < MAX_REDIRECTS) {
+            m_segments[i].redirects++;
+            m_segmentRequest.setUrl(redirect);
+            startSegment(i);
+            return;
+        }
+        
+        if (m_segmentError.isEmpty()) {
+            m_segmentError = tr("Maximum redirects reached");
+        }
+        
+        abortSegments();
+    }
+    else if (reply->error() == QNetworkReply::NoError) {
+        if ((!m_segmentFallback) && (writeSegment(i, reply, reply->bytesAvailable()))
+            && (m_segments.at(i).position < m_segments.at(i).end) && (m_segmentError.isEmpty())) {
+            m_segmentError = tr("Connection closed before the end of the segment");
+            abortSegments();
+        }
+    }
+    else if ((reply->error() != QNetworkReply::OperationCanceledError) && (m_segmentError.isEmpty())) {
+        m_segmentError = reply->errorString();
+        abortSegments();
+    }
+    
+    if (activeSegments() == 0) {
+        finishSegments();
+    }
+}
+
+void EnclosureDownload::onBandwidthAvailable() {
+    if (status() != Downloading) {
+        return;
+    }
+    
+    if (m_reply) {
+        if (m_reply->isRunning()) {
+            onReplyReadyRead();
+        }
+        
+        return;
+    }
+    
+    for (int i = 0; i < m_segments.size(); i++) {
+        if (m_segments.at(i).reply) {
+            readSegment(i);
+        }
+    }
+}
+
+void EnclosureDownload::startCustomCommands() {
+    if ((status() != WaitingForCustomCommand) || (m_commands.isEmpty())) {
+        CustomCommandScheduler::instance()->release(this);
+        return;
+    }
+    
+    setStatus(ExecutingCustomCommand);
+    executeCustomCommand(m_commands.takeFirst());
+}
+
 void EnclosureDownload::onCustomCommandFinished(int exitCode) {
     if (exitCode != 0) {
         Logger::log("EnclosureDownload::onCustomCommandFinished(): Error: " + m_process->readAllStandardError());
@@ -587,6 +1117,7 @@ void EnclosureDownload::onCustomCommandFinished(int exitCode) {
         executeCustomCommand(m_commands.takeFirst());
     }
     else {
+        CustomCommandScheduler::instance()->release(this);
         moveDownloadedFiles();
     }
 }
@@ -598,6 +1129,7 @@ void EnclosureDownload::onCustomCommandError() {
         executeCustomCommand(m_commands.takeFirst());
     }
     else {
+        CustomCommandScheduler::instance()->release(this);
         moveDownloadedFiles();
     }
 }
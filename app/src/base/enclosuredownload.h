@@ -19,11 +19,11 @@
 
 #include "transfer.h"
 #include <QFile>
+#include <QNetworkRequest>
 #include <QTime>
 
 class EnclosureRequest;
 class QNetworkReply;
-class QNetworkRequest;
 class QProcess;
 
 struct Command
@@ -40,6 +40,26 @@ struct Command
 
 typedef QList<Command> CommandList;
 
+struct DownloadSegment
+{
+    DownloadSegment(qint64 s, qint64 e, qint64 p) :
+        start(s),
+        end(e),
+        position(p),
+        reply(0),
+        redirects(0)
+    {
+    }
+
+    qint64 start;
+    qint64 end;
+    qint64 position;
+    QNetworkReply *reply;
+    int redirects;
+};
+
+typedef QList<DownloadSegment> SegmentList;
+
 class EnclosureDownload : public Transfer
 {
     Q_OBJECT
@@ -50,6 +70,7 @@ class EnclosureDownload : public Transfer
                NOTIFY customCommandOverrideEnabledChanged)
     Q_PROPERTY(QString downloadPath READ downloadPath WRITE setDownloadPath NOTIFY downloadPathChanged)
     Q_PROPERTY(QString fileName READ fileName WRITE setFileName NOTIFY fileNameChanged)
+    Q_PROPERTY(int maximumSpeed READ maximumSpeed WRITE setMaximumSpeed NOTIFY maximumSpeedChanged)
     Q_PROPERTY(bool usePlugin READ usePlugin WRITE setUsePlugin NOTIFY usePluginChanged)
     Q_PROPERTY(QVariantMap pluginSettings READ pluginSettings WRITE setPluginSettings NOTIFY pluginSettingsChanged)
 
@@ -73,11 +94,19 @@ public:
     QString fileName() const;
     void setFileName(const QString &fn);
     
+    int maximumSpeed() const;
+    void setMaximumSpeed(int speed);
+    
     bool usePlugin() const;
     void setUsePlugin(bool enabled);
     QVariantMap pluginSettings() const;
     void setPluginSettings(const QVariantMap &settings);
     
+    QVariantList segments() const;
+    void setSegments(const QVariantList &segments);
+    
+    void resumeCustomCommands();
+    
 public Q_SLOTS:
     virtual void queue();
     virtual void start();
@@ -89,6 +118,11 @@ private Q_SLOTS:
     void onReplyMetaDataChanged();
     void onReplyReadyRead();
     void onReplyFinished();
+    void onSegmentMetaDataChanged();
+    void onSegmentReadyRead();
+    void onSegmentFinished();
+    void onBandwidthAvailable();
+    void startCustomCommands();
     void onCustomCommandFinished(int exitCode);
     void onCustomCommandError();
     
@@ -98,6 +132,7 @@ Q_SIGNALS:
     void customCommandOverrideEnabledChanged();
     void downloadPathChanged();
     void fileNameChanged();
+    void maximumSpeedChanged();
     void usePluginChanged();
     void pluginSettingsChanged();
 
@@ -108,6 +143,22 @@ private:
                        const QByteArray &data = QByteArray());
     void startDownload(const QString &u);
     void followRedirect(const QString &u);
+    
+    bool openFile();
+    void preallocate(qint64 length, bool keepSize);
+    bool writeReply(qint64 bytes);
+    void reportProgress(qint64 bytes);
+    void flushProgress();
+    
+    void splitIntoSegments();
+    void startSegments(const QNetworkRequest &request);
+    void startSegment(int i);
+    void readSegment(int i);
+    bool writeSegment(int i, QNetworkReply *reply, qint64 bytes);
+    void abortSegments();
+    void finishSegments();
+    int segmentIndex(QNetworkReply *reply) const;
+    int activeSegments() const;
         
     bool executeCustomCommands();
     void executeCustomCommand(const Command &command);
@@ -118,6 +169,7 @@ private:
     QProcess *m_process;
     
     QFile m_file;
+    QByteArray m_buffer;
     
     bool m_canceled;
     
@@ -130,6 +182,8 @@ private:
         
     QString m_fileName;
     
+    int m_maximumSpeed;
+    
     bool m_usePlugin;
     QVariantMap m_pluginSettings;
     
@@ -138,8 +192,19 @@ private:
     CommandList m_commands;
     
     bool m_metadataSet;
+    
+    SegmentList m_segments;
+    QNetworkRequest m_segmentRequest;
+    QString m_segmentError;
+    bool m_segmentable;
+    bool m_rangesUnsupported;
+    bool m_segmentFallback;
 
     QTime m_speedTime;
+    qint64 m_speedBytes;
+    
+    QTime m_progressTime;
+    qint64 m_pendingBytes;
 };
     
 #endif // ENCLOSUREDOWNLOAD_H
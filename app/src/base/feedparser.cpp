@@ -17,24 +17,28 @@
 #include "feedparser.h"
 
 FeedParser::FeedParser() :
-    m_feedType(RSS)
+    m_feedType(RSS),
+    m_ttl(0)
 {
 }
 
 FeedParser::FeedParser(const QByteArray &content) :
-    m_feedType(RSS)
+    m_feedType(RSS),
+    m_ttl(0)
 {
     setContent(content);
 }
 
 FeedParser::FeedParser(const QString &content) :
-    m_feedType(RSS)
+    m_feedType(RSS),
+    m_ttl(0)
 {
     setContent(content);
 }
 
 FeedParser::FeedParser(QIODevice *device) :
-    m_feedType(RSS)
+    m_feedType(RSS),
+    m_ttl(0)
 {
     setContent(device);
 }
@@ -105,6 +109,14 @@ void FeedParser::setIconUrl(const QString &i) {
     m_iconUrl = i;
 }
 
+QList<int> FeedParser::skipHours() const {
+    return m_skipHours;
+}
+
+void FeedParser::setSkipHours(const QList<int> &h) {
+    m_skipHours = h;
+}
+
 QString FeedParser::title() const {
     return m_title;
 }
@@ -113,6 +125,14 @@ void FeedParser::setTitle(const QString &t) {
     m_title = t;
 }
 
+int FeedParser::ttl() const {
+    return m_ttl;
+}
+
+void FeedParser::setTtl(int t) {
+    m_ttl = t;
+}
+
 QString FeedParser::url() const {
     return m_url;
 }
@@ -170,7 +190,9 @@ void FeedParser::clear() {
     setEnclosures(QVariantList());
     setErrorString(QString());
     setIconUrl(QString());
+    setSkipHours(QList<int>());
     setTitle(QString());
+    setTtl(0);
     setUrl(QString());
 }
 
@@ -231,6 +253,12 @@ bool FeedParser::readChannel() {
             else if (name == "link") {
                 readUrl();
             }
+            else if (name == "ttl") {
+                readTtl();
+            }
+            else if ((name == "skipHours") && (m_reader.isStartElement())) {
+                readSkipHours();
+            }
             else if (name == "item") {
                 return true;
             }
@@ -446,11 +474,34 @@ void FeedParser::readIconUrl() {
     m_reader.readNextStartElement();
 }   
 
+void FeedParser::readSkipHours() {
+    QList<int> h;
+    m_reader.readNextStartElement();
+    
+    while (m_reader.qualifiedName() == "hour") {
+        bool ok;
+        const int hour = m_reader.readElementText().trimmed().toInt(&ok);
+        
+        if (ok) {
+            h << hour;
+        }
+        
+        m_reader.readNextStartElement();
+    }
+    
+    setSkipHours(h);
+}
+
 void FeedParser::readTitle() {
     setTitle(m_reader.readElementText().trimmed());
     m_reader.readNextStartElement();
 }
 
+void FeedParser::readTtl() {
+    setTtl(m_reader.readElementText().trimmed().toInt());
+    m_reader.readNextStartElement();
+}
+
 void FeedParser::readUrl() {
     const QXmlStreamAttributes attributes = m_reader.attributes();
     
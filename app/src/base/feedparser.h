@@ -52,9 +52,13 @@ public:
     FeedType feedType() const;
     
     QString iconUrl() const;
+    
+    QList<int> skipHours() const;
             
     QString title() const;
     
+    int ttl() const;
+    
     QString url() const;
     
     bool setContent(const QByteArray &content);
@@ -83,8 +87,12 @@ private:
     
     void setIconUrl(const QString &i);
     
+    void setSkipHours(const QList<int> &h);
+    
     void setTitle(const QString &t);
     
+    void setTtl(int t);
+    
     void setUrl(const QString &u);
     
     void readAuthor();
@@ -93,7 +101,9 @@ private:
     void readDescription();
     void readEnclosures();
     void readIconUrl();
+    void readSkipHours();
     void readTitle();
+    void readTtl();
     void readUrl();
 
     QXmlStreamReader m_reader;
@@ -113,9 +123,13 @@ private:
     FeedType m_feedType;
     
     QString m_iconUrl;
+    
+    QList<int> m_skipHours;
         
     QString m_title;
     
+    int m_ttl;
+    
     QString m_url;
 };
 
@@ -0,0 +1,311 @@
+/*
+ * Copyright (C) 2017 Stuart Howarth <showarth@marxoft.co.uk>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "jsonreader.h"
+#include <QStringList>
+
+// Arrays and objects are parsed recursively, and request bodies are untrusted, so nesting is limited
+static const int MAX_DEPTH = 512;
+
+static int hexValue(ushort c) {
+    if ((c >= '0') && (c <= '9')) {
+        return c - '0';
+    }
+    
+    if ((c >= 'a') && (c <= 'f')) {
+        return c - 'a' + 10;
+    }
+    
+    if ((c >= 'A') && (c <= 'F')) {
+        return c - 'A' + 10;
+    }
+    
+    return -1;
+}
+
+JsonReader::JsonReader(const QString &json) :
+    m_pos(json.constData()),
+    m_end(json.constData() + json.size()),
+    m_depth(0),
+    m_error(false)
+{
+}
+
+QVariant JsonReader::parse(const QString &json, bool *ok) {
+    JsonReader reader(json);
+    const QVariant value = reader.parseValue();
+    
+    if (ok) {
+        *ok = !reader.m_error;
+    }
+    
+    return reader.m_error ? QVariant() : value;
+}
+
+void JsonReader::skipWhitespace() {
+    while ((m_pos < m_end) && (m_pos->unicode() <= ' ')) {
+        ++m_pos;
+    }
+}
+
+QVariant JsonReader::parseValue() {
+    skipWhitespace();
+    
+    if (m_pos >= m_end) {
+        m_error = true;
+        return QVariant();
+    }
+    
+    switch (m_pos->unicode()) {
+    case '[':
+    case '{': {
+        if (m_depth >= MAX_DEPTH) {
+            m_error = true;
+            return QVariant();
+        }
+        
+        ++m_depth;
+        const QVariant value = m_pos->unicode() == '[' ? parseArray() : parseObject();
+        --m_depth;
+        return value;
+    }
+    case '"':
+        return parseString();
+    case 't':
+        return parseLiteral("true") ? QVariant(true) : QVariant();
+    case 'f':
+        return parseLiteral("false") ? QVariant(false) : QVariant();
+    case 'n':
+        parseLiteral("null");
+        return QVariant();
+    default:
+        return parseNumber();
+    }
+}
+
+QVariant JsonReader::parseArray() {
+    QVariantList list;
+    ++m_pos;
+    skipWhitespace();
+    
+    if ((m_pos < m_end) && (m_pos->unicode() == ']')) {
+        ++m_pos;
+        return list;
+    }
+    
+    while (!m_error) {
+        list << parseValue();
+        skipWhitespace();
+        
+        if (m_pos >= m_end) {
+            break;
+        }
+        
+        const ushort c = (m_pos++)->unicode();
+        
+        if (c == ']') {
+            return list;
+        }
+        
+        if (c != ',') {
+            break;
+        }
+    }
+    
+    m_error = true;
+    return QVariant();
+}
+
+QVariant JsonReader::parseObject() {
+    QVariantMap map;
+    ++m_pos;
+    skipWhitespace();
+    
+    if ((m_pos < m_end) && (m_pos->unicode() == '}')) {
+        ++m_pos;
+        return map;
+    }
+    
+    while (!m_error) {
+        skipWhitespace();
+        
+        if ((m_pos >= m_end) || (m_pos->unicode() != '"')) {
+            break;
+        }
+        
+        const QString key = parseString();
+        skipWhitespace();
+        
+        if ((m_pos >= m_end) || ((m_pos++)->unicode() != ':')) {
+            break;
+        }
+        
+        map.insert(key, parseValue());
+        skipWhitespace();
+        
+        if (m_pos >= m_end) {
+            break;
+        }
+        
+        const ushort c = (m_pos++)->unicode();
+        
+        if (c == '}') {
+            return map;
+        }
+        
+        if (c != ',') {
+            break;
+        }
+    }
+    
+    m_error = true;
+    return QVariant();
+}
+
+QVariant JsonReader::parseNumber() {
+    const QChar *start = m_pos;
+    bool isDouble = false;
+    
+    while (m_pos < m_end) {
+        const ushort c = m_pos->unicode();
+        
+        if ((c == '.') || (c == 'e') || (c == 'E')) {
+            isDouble = true;
+        }
+        else if (((c < '0') || (c > '9')) && (c != '-') && (c != '+')) {
+            break;
+        }
+        
+        ++m_pos;
+    }
+    
+    const QString number = QString::fromRawData(start, m_pos - start);
+    bool ok = false;
+    QVariant value;
+    
+    // Mirror QtJson, which returns signed numbers as qlonglong and others as qulonglong
+    if (isDouble) {
+        value = number.toDouble(&ok);
+    }
+    else if (number.startsWith('-')) {
+        value = number.toLongLong(&ok);
+    }
+    else {
+        value = number.toULongLong(&ok);
+    }
+    
+    if (!ok) {
+        m_error = true;
+        return QVariant();
+    }
+    
+    return value;
+}
+
+QString JsonReader::parseString() {
+    ++m_pos;
+    QString result;
+    const QChar *start = m_pos;
+    
+    while (m_pos < m_end) {
+        const ushort c = m_pos->unicode();
+        
+        if (c == '"') {
+            result.append(QString(start, m_pos - start));
+            ++m_pos;
+            return result;
+        }
+        
+        if (c != '\\') {
+            ++m_pos;
+            continue;
+        }
+        
+        result.append(QString(start, m_pos - start));
+        
+        if (++m_pos >= m_end) {
+            break;
+        }
+        
+        switch ((m_pos++)->unicode()) {
+        case '"':
+            result.append(QChar('"'));
+            break;
+        case '\\':
+            result.append(QChar('\\'));
+            break;
+        case '/':
+            result.append(QChar('/'));
+            break;
+        case 'b':
+            result.append(QChar('\b'));
+            break;
+        case 'f':
+            result.append(QChar('\f'));
+            break;
+        case 'n':
+            result.append(QChar('\n'));
+            break;
+        case 'r':
+            result.append(QChar('\r'));
+            break;
+        case 't':
+            result.append(QChar('\t'));
+            break;
+        case 'u': {
+            if (m_end - m_pos < 4) {
+                m_error = true;
+                return QString();
+            }
+            
+            int code = 0;
+            
+            for (int i = 0; i < 4; i++) {
+                const int h = hexValue((m_pos++)->unicode());
+                
+                if (h < 0) {
+                    m_error = true;
+                    return QString();
+                }
+                
+                code = (code << 4) | h;
+            }
+            
+            result.append(QChar(ushort(code)));
+            break;
+        }
+        default:
+            m_error = true;
+            return QString();
+        }
+        
+        start = m_pos;
+    }
+    
+    m_error = true;
+    return QString();
+}
+
+bool JsonReader::parseLiteral(const char *literal) {
+    for (; *literal; ++literal, ++m_pos) {
+        if ((m_pos >= m_end) || (m_pos->unicode() != ushort(*literal))) {
+            m_error = true;
+            return false;
+        }
+    }
+    
+    return true;
+}
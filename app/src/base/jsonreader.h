@@ -0,0 +1,49 @@
+/*
+ * Copyright (C) 2017 Stuart Howarth <showarth@marxoft.co.uk>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef JSONREADER_H
+#define JSONREADER_H
+
+#include <QVariant>
+
+class JsonReader
+{
+
+public:
+    static QVariant parse(const QString &json, bool *ok = 0);
+
+private:
+    explicit JsonReader(const QString &json);
+    
+    QVariant parseValue();
+    QVariant parseArray();
+    QVariant parseObject();
+    QVariant parseNumber();
+    QString parseString();
+    
+    bool parseLiteral(const char *literal);
+    
+    void skipWhitespace();
+    
+    const QChar *m_pos;
+    const QChar *m_end;
+    
+    int m_depth;
+    
+    bool m_error;
+};
+
+#endif // JSONREADER_H
@@ -0,0 +1,266 @@
+/*
+ * Copyright (C) 2017 Stuart Howarth <showarth@marxoft.co.uk>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "jsonwriter.h"
+#include <QStringList>
+#include <qnumeric.h>
+
+static const char HEX_DIGITS[] = "0123456789abcdef";
+
+JsonWriter::JsonWriter(int reserve) :
+    m_afterName(false)
+{
+    if (reserve > 0) {
+        m_data.reserve(reserve);
+    }
+}
+
+QByteArray JsonWriter::contentType() const {
+    return QByteArray("application/json");
+}
+
+QByteArray JsonWriter::data() const {
+    return m_data;
+}
+
+void JsonWriter::writeSeparator() {
+    if (m_afterName) {
+        m_afterName = false;
+    }
+    else if (!m_first.isEmpty()) {
+        if (m_first[m_first.size() - 1]) {
+            m_first[m_first.size() - 1] = false;
+        }
+        else {
+            m_data.append(',');
+        }
+    }
+}
+
+void JsonWriter::beginArray() {
+    writeSeparator();
+    m_data.append('[');
+    m_first.append(true);
+}
+
+void JsonWriter::endArray() {
+    m_data.append(']');
+    m_first.resize(m_first.size() - 1);
+}
+
+void JsonWriter::beginObject() {
+    writeSeparator();
+    m_data.append('{');
+    m_first.append(true);
+}
+
+void JsonWriter::endObject() {
+    m_data.append('}');
+    m_first.resize(m_first.size() - 1);
+}
+
+void JsonWriter::writeName(const char *name) {
+    writeSeparator();
+    m_data.append('"');
+    m_data.append(name);
+    m_data.append("\":");
+    m_afterName = true;
+}
+
+void JsonWriter::writeNull() {
+    writeSeparator();
+    m_data.append("null");
+}
+
+void JsonWriter::writeBool(bool value) {
+    writeSeparator();
+    m_data.append(value ? "true" : "false");
+}
+
+void JsonWriter::writeNumber(qint64 value) {
+    writeSeparator();
+    m_data.append(QByteArray::number(value));
+}
+
+void JsonWriter::writeNumber(double value) {
+    if ((qIsNaN(value)) || (qIsInf(value))) {
+        writeNull();
+        return;
+    }
+    
+    writeSeparator();
+    const QByteArray number = QByteArray::number(value, 'g', 15);
+    m_data.append(number);
+    
+    if ((!number.contains('.')) && (!number.contains('e'))) {
+        m_data.append(".0");
+    }
+}
+
+void JsonWriter::writeString(const QString &value) {
+    writeSeparator();
+    const QByteArray utf8 = value.toUtf8();
+    const char *data = utf8.constData();
+    const int size = utf8.size();
+    int start = 0;
+    m_data.append('"');
+    
+    // Append unescaped runs in one go, only breaking for characters that must be escaped
+    for (int i = 0; i < size; i++) {
+        const uchar c = uchar(data[i]);
+        
+        if ((c >= 0x20) && (c != '"') && (c != '\\')) {
+            continue;
+        }
+        
+        if (i > start) {
+            m_data.append(data + start, i - start);
+        }
+        
+        start = i + 1;
+        
+        switch (c) {
+        case '"':
+            m_data.append("\\\"");
+            break;
+        case '\\':
+            m_data.append("\\\\");
+            break;
+        case '\b':
+            m_data.append("\\b");
+            break;
+        case '\f':
+            m_data.append("\\f");
+            break;
+        case '\n':
+            m_data.append("\\n");
+            break;
+        case '\r':
+            m_data.append("\\r");
+            break;
+        case '\t':
+            m_data.append("\\t");
+            break;
+        default:
+            m_data.append("\\u00");
+            m_data.append(HEX_DIGITS[c >> 4]);
+            m_data.append(HEX_DIGITS[c & 0xf]);
+            break;
+        }
+    }
+    
+    if (size > start) {
+        m_data.append(data + start, size - start);
+    }
+    
+    m_data.append('"');
+}
+
+void JsonWriter::writeRawJson(const QByteArray &json) {
+    if (json.isEmpty()) {
+        writeNull();
+        return;
+    }
+    
+    writeSeparator();
+    m_data.append(json);
+}
+
+void JsonWriter::writeVariant(const QVariant &value) {
+    switch (value.type()) {
+    case QVariant::Invalid:
+        writeNull();
+        break;
+    case QVariant::List: {
+        beginArray();
+        const QVariantList list = value.toList();
+        
+        foreach (const QVariant &v, list) {
+            writeVariant(v);
+        }
+        
+        endArray();
+        break;
+    }
+    case QVariant::StringList:
+        writeStringList(value.toStringList());
+        break;
+    case QVariant::Map: {
+        beginObject();
+        const QVariantMap map = value.toMap();
+        QMapIterator<QString, QVariant> iterator(map);
+        
+        while (iterator.hasNext()) {
+            iterator.next();
+            writeString(iterator.key());
+            m_data.append(':');
+            m_afterName = true;
+            writeVariant(iterator.value());
+        }
+        
+        endObject();
+        break;
+    }
+    case QVariant::Hash: {
+        beginObject();
+        const QVariantHash hash = value.toHash();
+        QHashIterator<QString, QVariant> iterator(hash);
+        
+        while (iterator.hasNext()) {
+            iterator.next();
+            writeString(iterator.key());
+            m_data.append(':');
+            m_afterName = true;
+            writeVariant(iterator.value());
+        }
+        
+        endObject();
+        break;
+    }
+    case QVariant::String:
+    case QVariant::ByteArray:
+        writeString(value.toString());
+        break;
+    case QVariant::Double:
+        writeNumber(value.toDouble());
+        break;
+    case QVariant::Bool:
+        writeBool(value.toBool());
+        break;
+    case QVariant::ULongLong:
+        writeSeparator();
+        m_data.append(QByteArray::number(value.toULongLong()));
+        break;
+    default:
+        if (value.canConvert<qlonglong>()) {
+            writeNumber(qint64(value.toLongLong()));
+        }
+        else if (value.canConvert<QString>()) {
+            writeString(value.toString());
+        }
+        else {
+            writeNull();
+        }
+        
+        break;
+    }
+}
+
+QByteArray JsonWriter::serialize(const QVariant &value) {
+    JsonWriter writer;
+    writer.writeVariant(value);
+    return writer.data();
+}
@@ -0,0 +1,61 @@
+/*
+ * Copyright (C) 2017 Stuart Howarth <showarth@marxoft.co.uk>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef JSONWRITER_H
+#define JSONWRITER_H
+
+#include "datawriter.h"
+#include <QVarLengthArray>
+
+class JsonWriter : public DataWriter
+{
+
+public:
+    explicit JsonWriter(int reserve = 0);
+    
+    QByteArray contentType() const;
+    
+    QByteArray data() const;
+    
+    void beginArray();
+    void endArray();
+    
+    void beginObject();
+    void endObject();
+    
+    void writeName(const char *name);
+    
+    void writeNull();
+    void writeBool(bool value);
+    void writeNumber(qint64 value);
+    void writeNumber(double value);
+    void writeString(const QString &value);
+    void writeRawJson(const QByteArray &json);
+    void writeVariant(const QVariant &value);
+    
+    static QByteArray serialize(const QVariant &value);
+
+private:
+    void writeSeparator();
+    
+    QByteArray m_data;
+    
+    QVarLengthArray<bool, 16> m_first;
+    
+    bool m_afterName;
+};
+
+#endif // JSONWRITER_H
@@ -0,0 +1,172 @@
+/*
+ * Copyright (C) 2017 Stuart Howarth <showarth@marxoft.co.uk>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "logwriter.h"
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+
+static const int BUFFER_SIZE = 1000;
+static const int FLUSH_INTERVAL = 500;
+static const qint64 MAX_FILE_SIZE = 1048576;
+
+LogWriter* LogWriter::self = 0;
+
+LogWriter::LogWriter() :
+    QThread(),
+    m_clear(false),
+    m_stopping(false)
+{
+    qAddPostRoutine(shutdown);
+}
+
+LogWriter::~LogWriter() {
+    self = 0;
+}
+
+LogWriter* LogWriter::instance() {
+    return self ? self : self = new LogWriter;
+}
+
+void LogWriter::shutdown() {
+    if (!self) {
+        return;
+    }
+    
+    // Write any remaining lines before the application exits
+    self->m_mutex.lock();
+    self->m_stopping = true;
+    self->m_condition.wakeOne();
+    self->m_mutex.unlock();
+    self->wait();
+    delete self;
+}
+
+QString LogWriter::fileName() {
+    QMutexLocker locker(&m_mutex);
+    return m_fileName;
+}
+
+void LogWriter::setFileName(const QString &fileName) {
+    QMutexLocker locker(&m_mutex);
+    m_fileName = fileName;
+}
+
+QString LogWriter::text() {
+    QMutexLocker locker(&m_mutex);
+    return m_buffer.join(QString());
+}
+
+void LogWriter::write(const QString &line) {
+    QMutexLocker locker(&m_mutex);
+    m_buffer << line;
+    
+    if (m_buffer.size() > BUFFER_SIZE) {
+        m_buffer.removeFirst();
+    }
+    
+    if ((m_fileName.isEmpty()) || (m_stopping)) {
+        return;
+    }
+    
+    m_pending << line;
+    
+    if (m_pending.size() == 1) {
+        if (isRunning()) {
+            m_condition.wakeOne();
+        }
+        else {
+            start(QThread::LowPriority);
+        }
+    }
+}
+
+void LogWriter::clear() {
+    QMutexLocker locker(&m_mutex);
+    m_buffer.clear();
+    m_pending.clear();
+    m_clear = true;
+    
+    if (isRunning()) {
+        m_condition.wakeOne();
+    }
+    else if (!m_fileName.isEmpty()) {
+        QFile::remove(m_fileName);
+        m_clear = false;
+    }
+}
+
+void LogWriter::run() {
+    QMutexLocker locker(&m_mutex);
+    
+    forever {
+        while ((m_pending.isEmpty()) && (!m_clear) && (!m_stopping)) {
+            m_condition.wait(&m_mutex);
+        }
+        
+        if (!m_stopping) {
+            // Give other lines the chance to arrive, so they are written together
+            m_condition.wait(&m_mutex, FLUSH_INTERVAL);
+        }
+        
+        const QString fileName = m_fileName;
+        const QStringList lines = m_pending;
+        const bool clear = m_clear;
+        const bool stopping = m_stopping;
+        m_pending.clear();
+        m_clear = false;
+        locker.unlock();
+        
+        if ((clear) && (!fileName.isEmpty())) {
+            QFile::remove(fileName);
+        }
+        
+        writeLines(fileName, lines);
+        locker.relock();
+        
+        if ((stopping) && (m_pending.isEmpty())) {
+            return;
+        }
+    }
+}
+
+void LogWriter::writeLines(const QString &fileName, const QStringList &lines) {
+    if ((fileName.isEmpty()) || (lines.isEmpty())) {
+        return;
+    }
+    
+    QDir().mkpath(fileName.left(fileName.lastIndexOf("/")));
+    QFile file(fileName);
+    
+    if (!file.open(QFile::Append | QFile::Text)) {
+        qWarning("LogWriter: Cannot write to log file '%s'. Error: %s", fileName.toUtf8().constData(),
+                 file.errorString().toUtf8().constData());
+        return;
+    }
+    
+    file.write(lines.join(QString()).toUtf8());
+    file.flush();
+    
+    if (file.size() > MAX_FILE_SIZE) {
+        // Keep a single rotated file, so the log cannot grow without bound
+        file.close();
+        QFile::remove(fileName + ".1");
+        QFile::rename(fileName, fileName + ".1");
+    }
+    else {
+        file.close();
+    }
+}
@@ -0,0 +1,67 @@
+/*
+ * Copyright (C) 2017 Stuart Howarth <showarth@marxoft.co.uk>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LOGWRITER_H
+#define LOGWRITER_H
+
+#include <QMutex>
+#include <QStringList>
+#include <QThread>
+#include <QWaitCondition>
+
+class LogWriter : public QThread
+{
+    Q_OBJECT
+
+public:
+    ~LogWriter();
+    
+    static LogWriter* instance();
+    
+    QString fileName();
+    void setFileName(const QString &fileName);
+    
+    QString text();
+    
+    void write(const QString &line);
+    
+    void clear();
+
+protected:
+    virtual void run();
+
+private:
+    LogWriter();
+    
+    static void shutdown();
+    
+    void writeLines(const QString &fileName, const QStringList &lines);
+    
+    static LogWriter *self;
+    
+    QMutex m_mutex;
+    QWaitCondition m_condition;
+    
+    QString m_fileName;
+    
+    QStringList m_pending;
+    QStringList m_buffer;
+    
+    bool m_clear;
+    bool m_stopping;
+};
+
+#endif // LOGWRITER_H
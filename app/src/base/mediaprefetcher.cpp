@@ -0,0 +1,213 @@
+/*
+ * Copyright (C) 2017 Stuart Howarth <showarth@marxoft.co.uk>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mediaprefetcher.h"
+#include "dbconnection.h"
+#include "dbnotify.h"
+#include "definitions.h"
+#include "diskcache.h"
+#include "logger.h"
+#include "settings.h"
+#include <QDir>
+#include <QFile>
+#include <QImage>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+
+static const int MAX_CONCURRENT_PREFETCHES = 4;
+
+MediaPrefetcher* MediaPrefetcher::self = 0;
+
+MediaPrefetcher::MediaPrefetcher() :
+    QObject(),
+    m_nam(0),
+    m_active(0)
+{
+    connect(DBNotify::instance(), SIGNAL(articlesAdded(QStringList, QString)),
+            this, SLOT(onArticlesAdded(QStringList)));
+    connect(DBNotify::instance(), SIGNAL(mediaRemoved(QStringList)), this, SLOT(onMediaRemoved(QStringList)));
+}
+
+MediaPrefetcher::~MediaPrefetcher() {
+    self = 0;
+}
+
+MediaPrefetcher* MediaPrefetcher::instance() {
+    return self ? self : self = new MediaPrefetcher;
+}
+
+int MediaPrefetcher::pending() const {
+    return m_queue.size() + m_active;
+}
+
+QNetworkAccessManager* MediaPrefetcher::networkAccessManager() {
+    if (!m_nam) {
+        m_nam = new QNetworkAccessManager(this);
+        DiskCache *cache = new DiskCache(m_nam);
+        cache->setCacheDirectory(MEDIA_CACHE_PATH);
+        cache->setMediaCacheOwner(true);
+        m_nam->setCache(cache);
+        connect(m_nam, SIGNAL(finished(QNetworkReply*)), this, SLOT(onReplyFinished(QNetworkReply*)));
+    }
+    
+    return m_nam;
+}
+
+void MediaPrefetcher::prefetch(const QStringList &urls) {
+    if (urls.isEmpty()) {
+        return;
+    }
+    
+    QAbstractNetworkCache *cache = networkAccessManager()->cache();
+    
+    foreach (const QString &url, urls) {
+        if ((!m_queue.contains(url)) && ((!QFile::exists(DiskCache::thumbnailPath(url)))
+            || (!cache->metaData(QUrl::fromEncoded(url.toUtf8())).isValid()))) {
+            m_queue << url;
+        }
+    }
+    
+    Logger::log(QString("MediaPrefetcher::prefetch(). %1 URLs queued").arg(m_queue.size()), Logger::MediumVerbosity);
+    emit pendingChanged(pending());
+    
+    while ((m_active < MAX_CONCURRENT_PREFETCHES) && (!m_queue.isEmpty())) {
+        next();
+    }
+}
+
+void MediaPrefetcher::cancel() {
+    m_queue.clear();
+    emit pendingChanged(pending());
+}
+
+QNetworkReply* MediaPrefetcher::get(const QString &url, const QString &originalUrl) {
+    QNetworkRequest request(QUrl::fromEncoded(url.toUtf8()));
+    request.setRawHeader("User-Agent", USER_AGENT);
+    request.setAttribute(QNetworkRequest::CacheLoadControlAttribute, QNetworkRequest::PreferCache);
+    request.setAttribute(QNetworkRequest::User, originalUrl);
+    return networkAccessManager()->get(request);
+}
+
+void MediaPrefetcher::next() {
+    if (Settings::offlineModeEnabled()) {
+        cancel();
+        return;
+    }
+    
+    m_active++;
+    const QString url = m_queue.takeFirst();
+    get(url, url);
+}
+
+void MediaPrefetcher::onArticlesAdded(const QStringList &articleIds) {
+    if ((!Settings::prefetchArticleMedia()) || (Settings::offlineModeEnabled())) {
+        return;
+    }
+    
+    DBConnection *connection = DBConnection::connection(this, SLOT(onMediaUrlsFetched(DBConnection*)));
+    connection->exec(QString("SELECT DISTINCT url FROM media WHERE articleId IN (%1)")
+                     .arg(DBConnection::idList(articleIds)));
+}
+
+void MediaPrefetcher::onMediaUrlsFetched(DBConnection *connection) {
+    if (connection->status() == DBConnection::Ready) {
+        QStringList urls;
+        
+        while (connection->nextRecord()) {
+            urls << connection->value(0).toString();
+        }
+        
+        prefetch(urls);
+    }
+    else {
+        Logger::log("MediaPrefetcher::onMediaUrlsFetched(). Error: " + connection->errorString());
+    }
+    
+    connection->deleteLater();
+}
+
+void MediaPrefetcher::onMediaRemoved(const QStringList &urls) {
+    DiskCache *cache = qobject_cast<DiskCache*>(networkAccessManager()->cache());
+    int removed = 0;
+    
+    foreach (const QString &url, urls) {
+        QFile::remove(DiskCache::thumbnailPath(url));
+        
+        if (cache->remove(QUrl::fromEncoded(url.toUtf8()))) {
+            removed++;
+        }
+    }
+    
+    Logger::log(QString("MediaPrefetcher::onMediaRemoved(). %1 files removed").arg(removed), Logger::MediumVerbosity);
+    cache->expire();
+}
+
+void MediaPrefetcher::onReplyFinished(QNetworkReply *reply) {
+    const QString originalUrl = reply->request().attribute(QNetworkRequest::User).toString();
+    QString redirect = QString::fromUtf8(reply->rawHeader("Location"));
+    
+    if (!redirect.isEmpty()) {
+        const int redirects = reply->property("redirects").toInt();
+        
+        if (redirects < MAX_REDIRECTS) {
+            if (!redirect.startsWith("http")) {
+                const QUrl url = reply->url();
+                
+                if (redirect.startsWith("/")) {
+                    redirect.prepend(url.scheme() + "://" + url.authority());
+                }
+                else {
+                    redirect.prepend(url.scheme() + "://" + url.authority() + "/");
+                }
+            }
+            
+            reply->deleteLater();
+            get(redirect, originalUrl)->setProperty("redirects", redirects + 1);
+            return;
+        }
+    }
+    else if (reply->error() == QNetworkReply::NoError) {
+        const QString fileName = DiskCache::thumbnailPath(originalUrl);
+        
+        if (!QFile::exists(fileName)) {
+            QImage image = QImage::fromData(reply->readAll());
+            
+            if (!image.isNull()) {
+                if (image.height() > THUMBNAIL_SIZE) {
+                    image = image.scaledToHeight(THUMBNAIL_SIZE, Qt::SmoothTransformation);
+                }
+                
+                if ((!QDir().mkpath(THUMBNAIL_CACHE_PATH)) || (!image.save(fileName))) {
+                    Logger::log("MediaPrefetcher::onReplyFinished(). Unable to save thumbnail " + fileName);
+                }
+            }
+        }
+    }
+    else {
+        Logger::log(QString("MediaPrefetcher::onReplyFinished(). Error fetching %1: %2").arg(originalUrl)
+                    .arg(reply->errorString()), Logger::MediumVerbosity);
+    }
+    
+    reply->deleteLater();
+    m_active--;
+    
+    if (!m_queue.isEmpty()) {
+        next();
+    }
+    
+    emit pendingChanged(pending());
+}
@@ -0,0 +1,76 @@
+/*
+ * Copyright (C) 2017 Stuart Howarth <showarth@marxoft.co.uk>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MEDIAPREFETCHER_H
+#define MEDIAPREFETCHER_H
+
+#include <QObject>
+#include <QStringList>
+
+class DBConnection;
+class QNetworkAccessManager;
+class QNetworkReply;
+
+/**
+ * Fetches the media referenced by new articles into the shared media cache, and generates thumbnails.
+ *
+ * MediaPrefetcher owns the shared media cache: it is the only instance that expires it, and it removes
+ * media no longer referenced by any article when notified by DBNotify::mediaRemoved().
+ */
+class MediaPrefetcher : public QObject
+{
+    Q_OBJECT
+    
+    Q_PROPERTY(int pending READ pending NOTIFY pendingChanged)
+
+public:
+    ~MediaPrefetcher();
+    
+    static MediaPrefetcher* instance();
+    
+    int pending() const;
+
+public Q_SLOTS:
+    void prefetch(const QStringList &urls);
+    void cancel();
+
+private Q_SLOTS:
+    void onArticlesAdded(const QStringList &articleIds);
+    void onMediaUrlsFetched(DBConnection *connection);
+    void onMediaRemoved(const QStringList &urls);
+    void onReplyFinished(QNetworkReply *reply);
+
+Q_SIGNALS:
+    void pendingChanged(int pending);
+
+private:
+    MediaPrefetcher();
+    
+    QNetworkAccessManager* networkAccessManager();
+    
+    QNetworkReply* get(const QString &url, const QString &originalUrl);
+    void next();
+    
+    static MediaPrefetcher *self;
+    
+    QNetworkAccessManager *m_nam;
+    
+    QStringList m_queue;
+    
+    int m_active;
+};
+
+#endif // MEDIAPREFETCHER_H
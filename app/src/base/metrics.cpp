@@ -0,0 +1,174 @@
+/*
+ * Copyright (C) 2017 Stuart Howarth <showarth@marxoft.co.uk>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "metrics.h"
+
+struct MetricInfo
+{
+    const char *name;
+    const char *type;
+    const char *label;
+    const char *help;
+};
+
+// In the same order as Metrics::Metric
+static const MetricInfo METRICS[] = {
+    { "cutenews_db_operation_duration_seconds", "histogram", "operation",
+      "Time taken to execute a database operation." },
+    { "cutenews_db_queue_depth", "gauge", 0,
+      "Database operations waiting for the database thread." },
+    { "cutenews_feed_fetch_duration_seconds", "histogram", "subscription",
+      "Time taken to retrieve a subscription's feed." },
+    { "cutenews_feed_parse_duration_seconds", "histogram", "subscription",
+      "Time taken to parse a subscription's feed." },
+    { "cutenews_feed_update_failures_total", "counter", "subscription",
+      "Subscription updates that failed." },
+    { "cutenews_articles_added_total", "counter", "subscription",
+      "New articles added by subscription updates." },
+    { "cutenews_transferred_bytes_total", "counter", "type",
+      "Bytes transferred by downloads and uploads." },
+    { "cutenews_active_transfers", "gauge", 0,
+      "Transfers in progress." },
+    { "cutenews_plugin_request_duration_seconds", "histogram", "plugin",
+      "Time taken by a plugin article, enclosure or feed request." },
+    { "cutenews_http_request_duration_seconds", "histogram", "route",
+      "Time taken to respond to a web interface request." },
+    { "cutenews_http_requests_rejected_total", "counter", "reason",
+      "Web interface requests rejected by admission control." }
+};
+
+// Upper bounds of the histogram buckets, in seconds
+static const double BUCKETS[] = { 0.001, 0.005, 0.01, 0.05, 0.1, 0.25, 0.5, 1.0, 2.5, 5.0, 10.0, 30.0, 60.0 };
+static const int BUCKET_COUNT = int(sizeof(BUCKETS) / sizeof(BUCKETS[0]));
+
+QHash<QString, Metrics::Series> Metrics::series[Metrics::MetricCount];
+QMutex Metrics::mutex;
+
+static QByteArray formatNumber(double value) {
+    return QByteArray::number(value, 'g', 12);
+}
+
+static QByteArray formatLabels(const char *name, const QString &value, const QByteArray &bucket = QByteArray()) {
+    QByteArray labels;
+    
+    if ((name) && (!value.isEmpty())) {
+        QString escaped = value;
+        escaped.replace("\\", "\\\\").replace("\"", "\\\"").replace("\n", "\\n");
+        labels += QByteArray(name) + "=\"" + escaped.toUtf8() + "\"";
+    }
+    
+    if (!bucket.isEmpty()) {
+        if (!labels.isEmpty()) {
+            labels += ",";
+        }
+        
+        labels += "le=\"" + bucket + "\"";
+    }
+    
+    return labels.isEmpty() ? labels : "{" + labels + "}";
+}
+
+void Metrics::increment(Metric metric, double value, const QString &label) {
+    QMutexLocker locker(&mutex);
+    series[metric][label].value += value;
+}
+
+void Metrics::setValue(Metric metric, double value, const QString &label) {
+    QMutexLocker locker(&mutex);
+    series[metric][label].value = value;
+}
+
+void Metrics::observe(Metric metric, double value, const QString &label) {
+    QMutexLocker locker(&mutex);
+    Series &s = series[metric][label];
+    
+    if (s.buckets.isEmpty()) {
+        s.buckets.fill(0, BUCKET_COUNT);
+    }
+    
+    // The value of a histogram is the sum of its observations
+    s.value += value;
+    s.count++;
+    
+    for (int i = 0; i < BUCKET_COUNT; i++) {
+        if (value <= BUCKETS[i]) {
+            s.buckets[i]++;
+            break;
+        }
+    }
+}
+
+void Metrics::remove(Metric metric, const QString &label) {
+    QMutexLocker locker(&mutex);
+    series[metric].remove(label);
+}
+
+QByteArray Metrics::text() {
+    QMutexLocker locker(&mutex);
+    QByteArray text;
+    
+    for (int i = 0; i < MetricCount; i++) {
+        const MetricInfo &info = METRICS[i];
+        const QByteArray name(info.name);
+        const bool histogram = (qstrcmp(info.type, "histogram") == 0);
+        text += "# HELP " + name + " " + info.help + "\n";
+        text += "# TYPE " + name + " " + info.type + "\n";
+        QHashIterator<QString, Series> iterator(series[i]);
+        
+        while (iterator.hasNext()) {
+            iterator.next();
+            const Series &s = iterator.value();
+            
+            if (!histogram) {
+                text += name + formatLabels(info.label, iterator.key()) + " " + formatNumber(s.value) + "\n";
+                continue;
+            }
+            
+            // Buckets are reported cumulatively
+            quint64 count = 0;
+            
+            for (int j = 0; j < BUCKET_COUNT; j++) {
+                count += s.buckets.at(j);
+                text += name + "_bucket" + formatLabels(info.label, iterator.key(), formatNumber(BUCKETS[j])) + " "
+                        + QByteArray::number(count) + "\n";
+            }
+            
+            text += name + "_bucket" + formatLabels(info.label, iterator.key(), "+Inf") + " "
+                    + QByteArray::number(s.count) + "\n";
+            text += name + "_sum" + formatLabels(info.label, iterator.key()) + " " + formatNumber(s.value) + "\n";
+            text += name + "_count" + formatLabels(info.label, iterator.key()) + " "
+                    + QByteArray::number(s.count) + "\n";
+        }
+    }
+    
+    return text;
+}
+
+MetricsTimer::MetricsTimer(Metrics::Metric metric, const QString &label, QObject *parent) :
+    QObject(parent),
+    m_metric(metric),
+    m_label(label),
+    m_finished(false)
+{
+    m_timer.start();
+}
+
+void MetricsTimer::finish() {
+    if (!m_finished) {
+        m_finished = true;
+        Metrics::observe(m_metric, m_timer.elapsed() / 1000.0, m_label);
+    }
+}
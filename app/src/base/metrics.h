@@ -0,0 +1,104 @@
+/*
+ * Copyright (C) 2017 Stuart Howarth <showarth@marxoft.co.uk>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QMutex>
+#include <QObject>
+#include <QVector>
+
+/**
+ * Counters, gauges and histograms recorded by the application, for reporting in the Prometheus
+ * text format (http://prometheus.io).
+ *
+ * Each metric has at most one label, such as the subscription id or the database operation.
+ * Values can be recorded from any thread.
+ */
+class Metrics
+{
+
+public:
+    enum Metric {
+        DatabaseOperationDuration = 0,
+        DatabaseQueueDepth,
+        FeedFetchDuration,
+        FeedParseDuration,
+        FeedUpdateFailures,
+        ArticlesAdded,
+        TransferredBytes,
+        ActiveTransfers,
+        PluginRequestDuration,
+        HttpRequestDuration,
+        HttpRequestsRejected,
+        MetricCount
+    };
+    
+    static void increment(Metric metric, double value = 1.0, const QString &label = QString());
+    static void setValue(Metric metric, double value, const QString &label = QString());
+    static void observe(Metric metric, double value, const QString &label = QString());
+    static void remove(Metric metric, const QString &label);
+    
+    static QByteArray text();
+
+private:
+    struct Series
+    {
+        Series() :
+            value(0.0),
+            count(0)
+        {
+        }
+        
+        double value;
+        quint64 count;
+        QVector<quint64> buckets;
+    };
+    
+    static QHash<QString, Series> series[MetricCount];
+    
+    static QMutex mutex;
+};
+
+/**
+ * Records the time from its creation until finish() is called as an observation of a metric.
+ *
+ * Typically created as a child of the object being timed, with finish() connected to its
+ * finished signal.
+ */
+class MetricsTimer : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit MetricsTimer(Metrics::Metric metric, const QString &label, QObject *parent = 0);
+
+public Q_SLOTS:
+    void finish();
+
+private:
+    Metrics::Metric m_metric;
+    
+    QString m_label;
+    
+    QElapsedTimer m_timer;
+    
+    bool m_finished;
+};
+
+#endif // METRICS_H
@@ -0,0 +1,299 @@
+/*
+ * Copyright (C) 2017 Stuart Howarth <showarth@marxoft.co.uk>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "msgpackwriter.h"
+#include "jsonreader.h"
+#include <QStringList>
+#include <string.h>
+
+// The placeholder header is the largest one, a type byte followed by a 32-bit count
+static const int CONTAINER_HEADER_SIZE = 5;
+
+MsgPackWriter::MsgPackWriter(int reserve) :
+    m_afterName(false)
+{
+    if (reserve > 0) {
+        m_data.reserve(reserve);
+    }
+}
+
+QByteArray MsgPackWriter::contentType() const {
+    return QByteArray("application/x-msgpack");
+}
+
+QByteArray MsgPackWriter::data() const {
+    return m_data;
+}
+
+void MsgPackWriter::beginValue() {
+    // The value of an object property is counted with its name
+    if (m_afterName) {
+        m_afterName = false;
+    }
+    else if (!m_containers.isEmpty()) {
+        m_containers[m_containers.size() - 1].count++;
+    }
+}
+
+void MsgPackWriter::beginContainer() {
+    beginValue();
+    Container container;
+    container.position = m_data.size();
+    container.count = 0;
+    m_containers.append(container);
+    m_data.append(QByteArray(CONTAINER_HEADER_SIZE, '\0'));
+}
+
+void MsgPackWriter::endContainer(uchar fixType, uchar type16, uchar type32) {
+    const Container container = m_containers[m_containers.size() - 1];
+    m_containers.resize(m_containers.size() - 1);
+    char *header = m_data.data() + container.position;
+    
+    if (container.count < 16) {
+        header[0] = char(fixType | container.count);
+        m_data.remove(container.position + 1, CONTAINER_HEADER_SIZE - 1);
+    }
+    else if (container.count < 0x10000) {
+        header[0] = char(type16);
+        header[1] = char(container.count >> 8);
+        header[2] = char(container.count);
+        m_data.remove(container.position + 3, CONTAINER_HEADER_SIZE - 3);
+    }
+    else {
+        header[0] = char(type32);
+        header[1] = char(container.count >> 24);
+        header[2] = char(container.count >> 16);
+        header[3] = char(container.count >> 8);
+        header[4] = char(container.count);
+    }
+}
+
+void MsgPackWriter::beginArray() {
+    beginContainer();
+}
+
+void MsgPackWriter::endArray() {
+    endContainer(0x90, 0xdc, 0xdd);
+}
+
+void MsgPackWriter::beginObject() {
+    beginContainer();
+}
+
+void MsgPackWriter::endObject() {
+    endContainer(0x80, 0xde, 0xdf);
+}
+
+void MsgPackWriter::writeKey(const QByteArray &utf8) {
+    beginValue();
+    writeUtf8(utf8);
+    m_afterName = true;
+}
+
+void MsgPackWriter::writeName(const char *name) {
+    writeKey(QByteArray::fromRawData(name, int(strlen(name))));
+}
+
+void MsgPackWriter::writeNull() {
+    beginValue();
+    m_data.append(char(0xc0));
+}
+
+void MsgPackWriter::writeBool(bool value) {
+    beginValue();
+    m_data.append(char(value ? 0xc3 : 0xc2));
+}
+
+void MsgPackWriter::writeNumber(qint64 value) {
+    beginValue();
+    
+    if (value >= 0) {
+        writeUnsigned(quint64(value));
+    }
+    else if (value >= -32) {
+        m_data.append(char(value));
+    }
+    else if (value >= -128) {
+        m_data.append(char(0xd0));
+        appendBigEndian(quint64(value), 1);
+    }
+    else if (value >= -32768) {
+        m_data.append(char(0xd1));
+        appendBigEndian(quint64(value), 2);
+    }
+    else if (value >= Q_INT64_C(-2147483648)) {
+        m_data.append(char(0xd2));
+        appendBigEndian(quint64(value), 4);
+    }
+    else {
+        m_data.append(char(0xd3));
+        appendBigEndian(quint64(value), 8);
+    }
+}
+
+void MsgPackWriter::writeNumber(double value) {
+    beginValue();
+    quint64 bits;
+    memcpy(&bits, &value, sizeof(bits));
+    m_data.append(char(0xcb));
+    appendBigEndian(bits, 8);
+}
+
+void MsgPackWriter::writeString(const QString &value) {
+    beginValue();
+    writeUtf8(value.toUtf8());
+}
+
+void MsgPackWriter::writeRawJson(const QByteArray &json) {
+    if (json.isEmpty()) {
+        writeNull();
+        return;
+    }
+    
+    writeVariant(JsonReader::parse(QString::fromUtf8(json)));
+}
+
+void MsgPackWriter::writeVariant(const QVariant &value) {
+    switch (value.type()) {
+    case QVariant::Invalid:
+        writeNull();
+        break;
+    case QVariant::List: {
+        beginArray();
+        const QVariantList list = value.toList();
+        
+        foreach (const QVariant &v, list) {
+            writeVariant(v);
+        }
+        
+        endArray();
+        break;
+    }
+    case QVariant::StringList:
+        writeStringList(value.toStringList());
+        break;
+    case QVariant::Map: {
+        beginObject();
+        const QVariantMap map = value.toMap();
+        QMapIterator<QString, QVariant> iterator(map);
+        
+        while (iterator.hasNext()) {
+            iterator.next();
+            writeKey(iterator.key().toUtf8());
+            writeVariant(iterator.value());
+        }
+        
+        endObject();
+        break;
+    }
+    case QVariant::Hash: {
+        beginObject();
+        const QVariantHash hash = value.toHash();
+        QHashIterator<QString, QVariant> iterator(hash);
+        
+        while (iterator.hasNext()) {
+            iterator.next();
+            writeKey(iterator.key().toUtf8());
+            writeVariant(iterator.value());
+        }
+        
+        endObject();
+        break;
+    }
+    case QVariant::String:
+    case QVariant::ByteArray:
+        writeString(value.toString());
+        break;
+    case QVariant::Double:
+        writeNumber(value.toDouble());
+        break;
+    case QVariant::Bool:
+        writeBool(value.toBool());
+        break;
+    case QVariant::ULongLong:
+        beginValue();
+        writeUnsigned(value.toULongLong());
+        break;
+    default:
+        if (value.canConvert<qlonglong>()) {
+            writeNumber(qint64(value.toLongLong()));
+        }
+        else if (value.canConvert<QString>()) {
+            writeString(value.toString());
+        }
+        else {
+            writeNull();
+        }
+        
+        break;
+    }
+}
+
+void MsgPackWriter::writeUtf8(const QByteArray &utf8) {
+    const int size = utf8.size();
+    
+    if (size < 32) {
+        m_data.append(char(0xa0 | size));
+    }
+    else if (size < 0x100) {
+        m_data.append(char(0xd9));
+        appendBigEndian(size, 1);
+    }
+    else if (size < 0x10000) {
+        m_data.append(char(0xda));
+        appendBigEndian(size, 2);
+    }
+    else {
+        m_data.append(char(0xdb));
+        appendBigEndian(size, 4);
+    }
+    
+    m_data.append(utf8);
+}
+
+void MsgPackWriter::writeUnsigned(quint64 value) {
+    if (value < 0x80) {
+        m_data.append(char(value));
+    }
+    else if (value < 0x100) {
+        m_data.append(char(0xcc));
+        appendBigEndian(value, 1);
+    }
+    else if (value < 0x10000) {
+        m_data.append(char(0xcd));
+        appendBigEndian(value, 2);
+    }
+    else if (value < Q_UINT64_C(0x100000000)) {
+        m_data.append(char(0xce));
+        appendBigEndian(value, 4);
+    }
+    else {
+        m_data.append(char(0xcf));
+        appendBigEndian(value, 8);
+    }
+}
+
+void MsgPackWriter::appendBigEndian(quint64 value, int size) {
+    for (int shift = (size - 1) * 8; shift >= 0; shift -= 8) {
+        m_data.append(char(value >> shift));
+    }
+}
+
+QByteArray MsgPackWriter::serialize(const QVariant &value) {
+    MsgPackWriter writer;
+    writer.writeVariant(value);
+    return writer.data();
+}
@@ -0,0 +1,81 @@
+/*
+ * Copyright (C) 2017 Stuart Howarth <showarth@marxoft.co.uk>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MSGPACKWRITER_H
+#define MSGPACKWRITER_H
+
+#include "datawriter.h"
+#include <QVarLengthArray>
+
+/**
+ * Writes MessagePack (http://msgpack.org), a compact binary equivalent of JSON.
+ *
+ * Arrays and objects are written with a placeholder header, which is replaced by the smallest
+ * header for the number of items when the array or object is ended.
+ */
+class MsgPackWriter : public DataWriter
+{
+
+public:
+    explicit MsgPackWriter(int reserve = 0);
+    
+    QByteArray contentType() const;
+    
+    QByteArray data() const;
+    
+    void beginArray();
+    void endArray();
+    
+    void beginObject();
+    void endObject();
+    
+    void writeName(const char *name);
+    
+    void writeNull();
+    void writeBool(bool value);
+    void writeNumber(qint64 value);
+    void writeNumber(double value);
+    void writeString(const QString &value);
+    void writeRawJson(const QByteArray &json);
+    void writeVariant(const QVariant &value);
+    
+    static QByteArray serialize(const QVariant &value);
+
+private:
+    struct Container
+    {
+        int position;
+        int count;
+    };
+    
+    void beginValue();
+    void beginContainer();
+    void endContainer(uchar fixType, uchar type16, uchar type32);
+    
+    void writeKey(const QByteArray &utf8);
+    void writeUtf8(const QByteArray &utf8);
+    void writeUnsigned(quint64 value);
+    
+    void appendBigEndian(quint64 value, int size);
+    
+    QByteArray m_data;
+    
+    QVarLengthArray<Container, 16> m_containers;
+    
+    bool m_afterName;
+};
+
+#endif // MSGPACKWRITER_H
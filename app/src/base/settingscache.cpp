@@ -0,0 +1,239 @@
+/*
+ * Copyright (C) 2017 Stuart Howarth <showarth@marxoft.co.uk>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "settingscache.h"
+#include "logger.h"
+#include <QFile>
+#include <QFileInfo>
+#include <QSettings>
+
+static const int SYNC_INTERVAL = 1000;
+
+SettingsCache* SettingsCache::self = 0;
+
+SettingsCache::SettingsCache() :
+    QObject(),
+    m_syncScheduled(false)
+{
+    m_syncTimer.setSingleShot(true);
+    m_syncTimer.setInterval(SYNC_INTERVAL);
+    
+    connect(&m_syncTimer, SIGNAL(timeout()), this, SLOT(sync()));
+    connect(&m_watcher, SIGNAL(fileChanged(QString)), this, SLOT(onFileChanged(QString)));
+}
+
+SettingsCache::~SettingsCache() {
+    sync();
+    qDeleteAll(m_files);
+    self = 0;
+}
+
+SettingsCache* SettingsCache::instance() {
+    return self ? self : self = new SettingsCache;
+}
+
+QVariant SettingsCache::value(const QString &fileName, const QString &key, const QVariant &defaultValue) {
+    m_lock.lockForRead();
+    
+    if (const SettingsFile *f = m_files.value(fileName)) {
+        const QVariant v = f->values.value(key, defaultValue);
+        m_lock.unlock();
+        return v;
+    }
+    
+    m_lock.unlock();
+    QWriteLocker locker(&m_lock);
+    return file(fileName)->values.value(key, defaultValue);
+}
+
+QVariantMap SettingsCache::values(const QString &fileName) {
+    QWriteLocker locker(&m_lock);
+    return file(fileName)->values;
+}
+
+void SettingsCache::setValue(const QString &fileName, const QString &key, const QVariant &value) {
+    QWriteLocker locker(&m_lock);
+    SettingsFile *f = file(fileName);
+    const SettingsChange change(key, value, false);
+    applyChange(f->values, change);
+    f->changes << change;
+    
+    if (!m_syncScheduled) {
+        m_syncScheduled = true;
+        QMetaObject::invokeMethod(this, "scheduleSync", Qt::QueuedConnection);
+    }
+}
+
+bool SettingsCache::contains(const QString &fileName, const QString &key) {
+    QWriteLocker locker(&m_lock);
+    return file(fileName)->values.contains(key);
+}
+
+QStringList SettingsCache::childKeys(const QString &fileName, const QString &group) {
+    QWriteLocker locker(&m_lock);
+    const QVariantMap &values = file(fileName)->values;
+    const QString prefix = group + "/";
+    QStringList keys;
+    
+    for (QVariantMap::const_iterator iterator = values.lowerBound(prefix);
+         (iterator != values.constEnd()) && (iterator.key().startsWith(prefix)); ++iterator) {
+        const QString key = iterator.key().mid(prefix.size());
+        
+        if (!key.contains("/")) {
+            keys << key;
+        }
+    }
+    
+    return keys;
+}
+
+void SettingsCache::remove(const QString &fileName, const QString &key) {
+    QWriteLocker locker(&m_lock);
+    SettingsFile *f = file(fileName);
+    const SettingsChange change(key, QVariant(), true);
+    applyChange(f->values, change);
+    f->changes << change;
+    
+    if (!m_syncScheduled) {
+        m_syncScheduled = true;
+        QMetaObject::invokeMethod(this, "scheduleSync", Qt::QueuedConnection);
+    }
+}
+
+void SettingsCache::sync() {
+    m_lock.lockForWrite();
+    m_syncScheduled = false;
+    QHash<QString, SettingsChangeList> changes;
+    QHashIterator<QString, SettingsFile*> iterator(m_files);
+    
+    while (iterator.hasNext()) {
+        iterator.next();
+        
+        if (!iterator.value()->changes.isEmpty()) {
+            changes[iterator.key()] = iterator.value()->changes;
+            iterator.value()->changes.clear();
+        }
+    }
+    
+    m_lock.unlock();
+    QHashIterator<QString, SettingsChangeList> changesIterator(changes);
+    
+    while (changesIterator.hasNext()) {
+        changesIterator.next();
+        const QString &fileName = changesIterator.key();
+        QSettings settings(fileName, QSettings::IniFormat);
+        
+        foreach (const SettingsChange &change, changesIterator.value()) {
+            if (change.remove) {
+                settings.remove(change.key);
+            }
+            else {
+                settings.setValue(change.key, change.value);
+            }
+        }
+        
+        settings.sync();
+        
+        if (settings.status() != QSettings::NoError) {
+            Logger::log("SettingsCache::sync(). Cannot write settings to " + fileName);
+        }
+        
+        // Remember our own write, so that the change notification does not cause a reload
+        const QFileInfo info(fileName);
+        m_lock.lockForWrite();
+        
+        if (SettingsFile *f = m_files.value(fileName)) {
+            f->lastModified = info.lastModified();
+            f->size = info.size();
+        }
+        
+        m_lock.unlock();
+        watchFile(fileName);
+    }
+}
+
+void SettingsCache::watchFile(const QString &fileName) {
+    if ((QFile::exists(fileName)) && (!m_watcher.files().contains(fileName))) {
+        m_watcher.addPath(fileName);
+    }
+}
+
+void SettingsCache::scheduleSync() {
+    if (!m_syncTimer.isActive()) {
+        m_syncTimer.start();
+    }
+}
+
+void SettingsCache::onFileChanged(const QString &fileName) {
+    // The file may have been replaced rather than modified, in which case it is no longer watched
+    watchFile(fileName);
+    const QFileInfo info(fileName);
+    QWriteLocker locker(&m_lock);
+    SettingsFile *f = m_files.value(fileName);
+    
+    if ((!f) || ((info.lastModified() == f->lastModified) && (info.size() == f->size))) {
+        return;
+    }
+    
+    Logger::log("SettingsCache::onFileChanged(). Reloading " + fileName, Logger::MediumVerbosity);
+    load(fileName, f);
+}
+
+SettingsFile* SettingsCache::file(const QString &fileName) {
+    SettingsFile *f = m_files.value(fileName);
+    
+    if (!f) {
+        f = new SettingsFile;
+        load(fileName, f);
+        m_files[fileName] = f;
+        QMetaObject::invokeMethod(this, "watchFile", Qt::QueuedConnection, Q_ARG(QString, fileName));
+    }
+    
+    return f;
+}
+
+void SettingsCache::load(const QString &fileName, SettingsFile *f) {
+    const QSettings settings(fileName, QSettings::IniFormat);
+    f->values.clear();
+    
+    foreach (const QString &key, settings.allKeys()) {
+        f->values[key] = settings.value(key);
+    }
+    
+    // Changes that have not been written yet take precedence over the file
+    foreach (const SettingsChange &change, f->changes) {
+        applyChange(f->values, change);
+    }
+    
+    const QFileInfo info(fileName);
+    f->lastModified = info.lastModified();
+    f->size = info.size();
+}
+
+void SettingsCache::applyChange(QVariantMap &values, const SettingsChange &change) {
+    if (!change.remove) {
+        values[change.key] = change.value;
+        return;
+    }
+    
+    values.remove(change.key);
+    const QString prefix = change.key + "/";
+    QVariantMap::iterator iterator = values.lowerBound(prefix);
+    
+    while ((iterator != values.end()) && (iterator.key().startsWith(prefix))) {
+        iterator = values.erase(iterator);
+    }
+}
@@ -0,0 +1,97 @@
+/*
+ * Copyright (C) 2017 Stuart Howarth <showarth@marxoft.co.uk>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SETTINGSCACHE_H
+#define SETTINGSCACHE_H
+
+#include <QDateTime>
+#include <QFileSystemWatcher>
+#include <QHash>
+#include <QReadWriteLock>
+#include <QStringList>
+#include <QTimer>
+#include <QVariantMap>
+
+struct SettingsChange
+{
+    SettingsChange(const QString &k, const QVariant &v, bool r) :
+        key(k),
+        value(v),
+        remove(r)
+    {
+    }
+
+    QString key;
+    QVariant value;
+    bool remove;
+};
+
+typedef QList<SettingsChange> SettingsChangeList;
+
+struct SettingsFile
+{
+    QVariantMap values;
+    SettingsChangeList changes;
+    QDateTime lastModified;
+    qint64 size;
+};
+
+class SettingsCache : public QObject
+{
+    Q_OBJECT
+
+public:
+    ~SettingsCache();
+    
+    static SettingsCache* instance();
+    
+    QVariant value(const QString &fileName, const QString &key, const QVariant &defaultValue = QVariant());
+    QVariantMap values(const QString &fileName);
+    void setValue(const QString &fileName, const QString &key, const QVariant &value);
+    
+    bool contains(const QString &fileName, const QString &key);
+    QStringList childKeys(const QString &fileName, const QString &group);
+    
+    void remove(const QString &fileName, const QString &key);
+
+public Q_SLOTS:
+    void sync();
+
+private Q_SLOTS:
+    void watchFile(const QString &fileName);
+    void scheduleSync();
+    
+    void onFileChanged(const QString &fileName);
+
+private:
+    SettingsCache();
+    
+    SettingsFile* file(const QString &fileName);
+    void load(const QString &fileName, SettingsFile *file);
+    
+    static void applyChange(QVariantMap &values, const SettingsChange &change);
+    
+    static SettingsCache *self;
+    
+    QReadWriteLock m_lock;
+    QHash<QString, SettingsFile*> m_files;
+    bool m_syncScheduled;
+    
+    QFileSystemWatcher m_watcher;
+    QTimer m_syncTimer;
+};
+
+#endif // SETTINGSCACHE_H
@@ -317,11 +317,15 @@ void Subscription::setAutoUpdate(bool enabled) {
                     this, SLOT(onArticlesDeleted(QStringList, QString)));
             connect(DBNotify::instance(), SIGNAL(articleRead(QString, QString, bool)),
                     this, SLOT(onArticleRead(QString, QString, bool)));
+            connect(DBNotify::instance(), SIGNAL(articlesRead(QStringList, QStringList, bool)),
+                    this, SLOT(onArticlesRead(QStringList, QStringList, bool)));
             connect(DBNotify::instance(), SIGNAL(subscriptionRead(QString, bool)),
                     this, SLOT(onSubscriptionRead(QString, bool)));
             connect(DBNotify::instance(), SIGNAL(allSubscriptionsRead()), this, SLOT(onAllSubscriptionsRead()));
             connect(DBNotify::instance(), SIGNAL(subscriptionUpdated(QString)),
                     this, SLOT(onSubscriptionUpdated(QString)));
+            connect(DBNotify::instance(), SIGNAL(subscriptionsUpdated(QStringList)),
+                    this, SLOT(onSubscriptionsUpdated(QStringList)));
         }
         else {
             disconnect(DBNotify::instance(), 0, this, 0);
@@ -374,6 +378,14 @@ void Subscription::onArticleRead(const QString &, const QString &subscriptionId,
     }
 }
 
+void Subscription::onArticlesRead(const QStringList &, const QStringList &subscriptionIds, bool isRead) {
+    const int count = subscriptionIds.count(id());
+    
+    if (count > 0) {
+        setUnreadArticles(isRead ? unreadArticles() - count : unreadArticles() + count);
+    }
+}
+
 void Subscription::onSubscriptionFetched(DBConnection *connection) {
     if (connection->status() == DBConnection::Ready) {        
         setDescription(connection->value(1).toString());
@@ -421,3 +433,9 @@ void Subscription::onSubscriptionUpdated(const QString &subscriptionId) {
         DBConnection::connection(this, SLOT(onSubscriptionFetched(DBConnection*)))->fetchSubscription(subscriptionId);
     }
 }
+
+void Subscription::onSubscriptionsUpdated(const QStringList &subscriptionIds) {
+    if (subscriptionIds.contains(id())) {
+        onSubscriptionUpdated(id());
+    }
+}
@@ -136,10 +136,12 @@ private Q_SLOTS:
     void onArticlesAdded(const QStringList &articleIds, const QString &subscriptionId);
     void onArticlesDeleted(const QStringList &articleIds, const QString &subscriptionId);
     void onArticleRead(const QString &articleId, const QString &subscriptionId, bool isRead);
+    void onArticlesRead(const QStringList &articleIds, const QStringList &subscriptionIds, bool isRead);
     void onSubscriptionFetched(DBConnection *connection);
     void onSubscriptionRead(const QString &subscriptionId, bool isRead);
     void onAllSubscriptionsRead();
     void onSubscriptionUpdated(const QString &subscriptionId);
+    void onSubscriptionsUpdated(const QStringList &subscriptionIds);
 
 Q_SIGNALS:
     void idChanged();
@@ -23,11 +23,13 @@
 #include "feedrequest.h"
 #include "json.h"
 #include "logger.h"
+#include "metrics.h"
 #include "opmlparser.h"
 #include "pluginmanager.h"
 #include "settings.h"
 #include "subscription.h"
 #include "transfers.h"
+#include "updatescheduler.h"
 #include "utils.h"
 #include <QProcess>
 #include <QImage>
@@ -40,6 +42,21 @@
 const QString Subscriptions::FAVICONS_URL("http://www.google.com/s2/favicons?domain=");
 #endif
 
+static void addEnclosureDownloads(const QVariantList &enclosures) {
+    foreach (const QVariant &e, enclosures) {
+        const QVariantMap enclosure = e.toMap();
+        const QString url = enclosure.value("url").toString();
+        
+        // Skip enclosures that are already queued or have been downloaded before
+        if (Transfers::instance()->enclosureIsKnown(url, enclosure.value("length").toLongLong())) {
+            Logger::log("Subscriptions::parseXml(). Skipping known enclosure " + url, Logger::MediumVerbosity);
+        }
+        else {
+            Transfers::instance()->addEnclosureDownload(url, true);
+        }
+    }
+}
+
 Subscriptions* Subscriptions::self = 0;
 
 Subscriptions::Subscriptions() :
@@ -49,6 +66,7 @@ Subscriptions::Subscriptions() :
     m_feedRequest(0),
     m_subscription(0),
     m_process(0),
+    m_scheduler(new UpdateScheduler(this)),
     m_progress(0),
     m_status(Idle),
     m_total(0)
@@ -56,6 +74,7 @@ Subscriptions::Subscriptions() :
     m_updateTimer.setInterval(60000);
     
     connect(DBNotify::instance(), SIGNAL(subscriptionsAdded(QStringList)), this, SLOT(update(QStringList)));
+    connect(DBNotify::instance(), SIGNAL(subscriptionDeleted(QString)), this, SLOT(onSubscriptionDeleted(QString)));
     connect(&m_updateTimer, SIGNAL(timeout()), this, SLOT(getScheduledUpdates()));
 #ifdef DBUS_INTERFACE
     QDBusConnection connection = QDBusConnection::sessionBus();
@@ -97,6 +116,7 @@ void Subscriptions::setOfflineModeEnabled(bool enabled) {
             m_updateTimer.stop();
         }
         else {
+            m_scheduler->load();
             m_updateTimer.start();
         }
 
@@ -118,11 +138,25 @@ void Subscriptions::setScheduledUpdatesInterval(int interval) {
 }
 
 void Subscriptions::getScheduledUpdates() {
-    const uint lastChecked = QDateTime::currentDateTime().toTime_t() - scheduledUpdatesInterval();
-    Logger::log("Subscriptions::getScheduledUpdates(). Fetching subscriptions due for update since " +
-                QDateTime::fromTime_t(lastChecked).toString(Qt::ISODate), Logger::MediumVerbosity);
-    DBConnection *conn = DBConnection::connection(this, SLOT(onSubscriptionIdsFetched(DBConnection*)));
-    conn->exec(QString("SELECT id FROM subscriptions WHERE updateInterval > 0 AND lastUpdated < %1 - updateInterval ORDER BY rowid ASC").arg(lastChecked));
+    if (!m_scheduler->isLoaded()) {
+        m_scheduler->load();
+        return;
+    }
+    
+    const QStringList ids = m_scheduler->takeDueSubscriptions(QDateTime::currentDateTime().toTime_t());
+    
+    if (ids.isEmpty()) {
+        return;
+    }
+    
+    Logger::log(QString("Subscriptions::getScheduledUpdates(). %1 subscriptions due for update").arg(ids.size()),
+                Logger::MediumVerbosity);
+    
+    foreach (const QString &id, ids) {
+        if (!m_queue.contains(id)) {
+            update(id);
+        }
+    }
 }
 
 Subscriptions::Status Subscriptions::status() const {
@@ -260,6 +294,7 @@ void Subscriptions::next() {
 }
 
 void Subscriptions::update() {
+    m_updateTime.start();
     setStatusText(tr("Retrieving feed for %1").arg(subscription()->title()));
     
     if (subscription()->sourceType() == Subscription::Plugin) {
@@ -307,12 +342,21 @@ void Subscriptions::update() {
     }
 }
 
+void Subscriptions::updateFailed() {
+    Metrics::increment(Metrics::FeedUpdateFailures, 1.0, subscription()->id());
+    m_scheduler->failed(subscription()->id(), responseHints());
+}
+
 void Subscriptions::parseXml(const QByteArray &xml) {
+    // The feed has been retrieved, so the rest of the update is the time taken to parse it
+    Metrics::observe(Metrics::FeedFetchDuration, m_updateTime.elapsed() / 1000.0, subscription()->id());
+    m_updateTime.restart();
     FeedParser parser(xml);
     
     if (!parser.readChannel()) {
         Logger::log(QString("Subscriptions::parserXml(). Error parsing XML for subscription %1. Error: %2")
                 .arg(subscription()->id()).arg(parser.errorString()));
+        updateFailed();
         setStatusText(tr("Error parsing XML for %1").arg(subscription()->title()));
         setStatus(Error);
         next();
@@ -326,6 +370,10 @@ void Subscriptions::parseXml(const QByteArray &xml) {
     const QString subscriptionId = subscription()->id();
     const QDateTime lastUpdated = subscription()->lastUpdated();
     
+    UpdateHints hints = responseHints();
+    hints.minimumInterval = qMax(hints.minimumInterval, parser.ttl() * 60);
+    hints.skipHours = parser.skipHours();
+    
     QVariantMap sub;
     sub["title"] = channelTitle;
     sub["description"] = channelDescription;
@@ -337,6 +385,8 @@ void Subscriptions::parseXml(const QByteArray &xml) {
     if (parser.date() <= lastUpdated) {
         Logger::log(QString("Subscriptions::parseXml(). No new articles since %1 for subscription %2")
                     .arg(lastUpdated.toString()).arg(subscriptionId), Logger::LowVerbosity);
+        Metrics::observe(Metrics::FeedParseDuration, m_updateTime.elapsed() / 1000.0, subscriptionId);
+        m_scheduler->updated(subscriptionId, 0, 0, hints);
         DBConnection::connection(this, SLOT(onConnectionFinished(DBConnection*)))->updateSubscription(subscriptionId,
                                                                                                       sub);
         
@@ -366,7 +416,8 @@ void Subscriptions::parseXml(const QByteArray &xml) {
             .arg(CACHE_AUTHORITY).arg(CACHE_PATH).arg(subscriptionId).arg(id));
     QVariantList categories = QVariantList() << parser.categories().join(", ");
     QVariantList dates = QVariantList() << date.toTime_t();
-    QVariantList enclosures = QVariantList() << QtJson::Json::serialize(enc);
+    uint newest = date.toTime_t();
+    QVariantList enclosures = QVariantList() << QString::fromUtf8(QtJson::Json::serialize(enc));
     QVariantList favourites = QVariantList() << 0;
     QVariantList reads = QVariantList() << 0;
     QVariantList lastReads = QVariantList() << 0;
@@ -375,9 +426,7 @@ void Subscriptions::parseXml(const QByteArray &xml) {
     QVariantList urls = QVariantList() << parser.url();
     
     if (subscription()->downloadEnclosures()) {
-        foreach (const QVariant &e, enc) {
-            Transfers::instance()->addEnclosureDownload(e.toMap().value("url").toString(), true);
-        }
+        addEnclosureDownloads(enc);
     }
 
     int articles = 1;
@@ -391,8 +440,9 @@ void Subscriptions::parseXml(const QByteArray &xml) {
         bodies << Utils::replaceSrcPaths(parser.description(), QString("%1%2%3/%4/").arg(CACHE_AUTHORITY)
                 .arg(CACHE_PATH).arg(subscriptionId).arg(id));
         categories << parser.categories().join(", ");
-        dates << parser.date().toTime_t();
-        enclosures << QtJson::Json::serialize(enc);
+        dates << date.toTime_t();
+        newest = qMax(newest, date.toTime_t());
+        enclosures << QString::fromUtf8(QtJson::Json::serialize(enc));
         favourites << 0;
         reads << 0;
         lastReads << 0;
@@ -401,14 +451,15 @@ void Subscriptions::parseXml(const QByteArray &xml) {
         urls << parser.url();
 
         if (subscription()->downloadEnclosures()) {
-            foreach (const QVariant &e, enc) {
-                Transfers::instance()->addEnclosureDownload(e.toMap().value("url").toString(), true);
-            }
+            addEnclosureDownloads(enc);
         }
     }
     
     Logger::log(QString("Subscriptions::parseXml(). %1 new articles found since %2 for subscription %3")
             .arg(ids.size()).arg(lastUpdated.toString()).arg(subscriptionId), Logger::LowVerbosity);
+    Metrics::observe(Metrics::FeedParseDuration, m_updateTime.elapsed() / 1000.0, subscriptionId);
+    Metrics::increment(Metrics::ArticlesAdded, ids.size(), subscriptionId);
+    m_scheduler->updated(subscriptionId, ids.size(), newest, hints);
     
     DBConnection::connection(this, SLOT(onConnectionFinished(DBConnection*)))->addArticles(QList<QVariantList>()
                              << ids << authors << bodies << categories << dates << enclosures << favourites << reads
@@ -432,6 +483,16 @@ void Subscriptions::parseXml(const QByteArray &xml) {
     next();
 }
 
+UpdateHints Subscriptions::responseHints() {
+    UpdateHints hints;
+    
+    if ((m_feedDownloader) && (subscription()->sourceType() == Subscription::Url)) {
+        hints.readHeaders(m_feedDownloader->rawHeader("Cache-Control"), m_feedDownloader->rawHeader("Retry-After"));
+    }
+    
+    return hints;
+}
+
 void Subscriptions::downloadIcon(const QString &url) {
     iconDownloader()->setUrl(url);
     iconDownloader()->start();
@@ -514,6 +575,7 @@ void Subscriptions::onFeedDownloadFinished() {
         return;
     }
     
+    updateFailed();
     next();
 }
 
@@ -568,6 +630,7 @@ void Subscriptions::onFeedRequestFinished(FeedRequest *request) {
     case FeedRequest::Error:
         setStatusText(tr("Error retrieving feed for %1: %2").arg(subscription()->title())
                                                             .arg(request->errorString()));
+        updateFailed();
         break;
     default:
         break;
@@ -579,6 +642,7 @@ void Subscriptions::onFeedRequestFinished(FeedRequest *request) {
 void Subscriptions::onProcessError() {
     Logger::log("Subscriptions::onProcessError(). Error: " + m_process->errorString());
     setStatusText(tr("Error retrieving feed for %1: %2").arg(subscription()->title()).arg(m_process->errorString()));
+    updateFailed();
     next();
 }
 
@@ -596,6 +660,7 @@ void Subscriptions::onProcessFinished(int exitCode) {
     
     setStatusText(tr("Error retrieving feed for %1: %2").arg(subscription()->title())
                                                         .arg(m_process->errorString()));
+    updateFailed();
     next();
 }
 
@@ -620,6 +685,14 @@ void Subscriptions::onSubscriptionIdsFetched(DBConnection *connection) {
     connection->deleteLater();
 }
 
+void Subscriptions::onSubscriptionDeleted(const QString &id) {
+    // The metrics of deleted subscriptions would otherwise be reported until the application is restarted
+    Metrics::remove(Metrics::FeedFetchDuration, id);
+    Metrics::remove(Metrics::FeedParseDuration, id);
+    Metrics::remove(Metrics::FeedUpdateFailures, id);
+    Metrics::remove(Metrics::ArticlesAdded, id);
+}
+
 void Subscriptions::onConnectionFinished(DBConnection *connection) {
     connection->deleteLater();
 }
@@ -17,6 +17,7 @@
 #ifndef SUBSCRIPTIONS_H
 #define SUBSCRIPTIONS_H
 
+#include <QElapsedTimer>
 #include <QObject>
 #include <QQueue>
 #include <QTimer>
@@ -25,7 +26,10 @@ class DBConnection;
 class Download;
 class FeedRequest;
 class Subscription;
+class UpdateScheduler;
 class QProcess;
+
+struct UpdateHints;
 class QString;
 
 class Subscriptions : public QObject
@@ -96,6 +100,7 @@ private Q_SLOTS:
     
     void onSubscriptionFetched(Subscription *subscription);
     void onSubscriptionIdsFetched(DBConnection *connection);
+    void onSubscriptionDeleted(const QString &id);
     
     void onConnectionFinished(DBConnection *connection);
 
@@ -121,6 +126,9 @@ private:
     void downloadIcon(const QString &url);
     void parseXml(const QByteArray &xml);
     
+    UpdateHints responseHints();
+    void updateFailed();
+    
     Download* feedDownloader();
     Download* iconDownloader();
     FeedRequest* feedRequest(const QString &pluginId);
@@ -136,10 +144,12 @@ private:
     FeedRequest *m_feedRequest;
     Subscription *m_subscription;
     QProcess *m_process;
+    UpdateScheduler *m_scheduler;
     
     int m_progress;
 
     QTimer m_updateTimer;
+    QElapsedTimer m_updateTime;
         
     Status m_status;
     QString m_statusText;
@@ -35,12 +35,14 @@ public:
         insert(Transfer::ErrorStringRole, "errorString");
         insert(Transfer::FileNameRole, "fileName");
         insert(Transfer::IdRole, "id");
+        insert(Transfer::MaximumSpeedRole, "maximumSpeed");
         insert(Transfer::NameRole, "name");
         insert(Transfer::PluginSettingsRole, "pluginSettings");
         insert(Transfer::PriorityRole, "priority");
         insert(Transfer::PriorityStringRole, "priorityString");
         insert(Transfer::ProgressRole, "progress");
         insert(Transfer::ProgressStringRole, "progressString");
+        insert(Transfer::SegmentsRole, "segments");
         insert(Transfer::SizeRole, "size");
         insert(Transfer::SizeStringRole, "sizeString");
         insert(Transfer::SpeedRole, "speed");
@@ -345,6 +347,8 @@ QString Transfer::statusString() const {
         return tr("Uploading");
     case ExecutingCustomCommand:
         return tr("Executing custom command");
+    case WaitingForCustomCommand:
+        return tr("Waiting to execute custom command");
     default:
         return QString();
     }
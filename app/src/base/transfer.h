@@ -74,7 +74,9 @@ public:
         TransferTypeRole,
         TransferTypeStringRole,
         UrlRole,
-        UsePluginRole
+        UsePluginRole,
+        MaximumSpeedRole,
+        SegmentsRole
     };
     
     enum Priority {
@@ -95,6 +97,7 @@ public:
         Downloading,
         Uploading,
         ExecutingCustomCommand,
+        WaitingForCustomCommand,
         Unknown
     };
     
@@ -184,6 +187,8 @@ protected:
 private:
     static QHash<int, QByteArray> roles;
     
+    friend class Transfers;
+    
     QPointer<QNetworkAccessManager> m_nam;
     
     bool m_ownNetworkAccessManager;
@@ -97,7 +97,7 @@ QMap<int, QVariant> TransferModel::itemData(const QModelIndex &index) const {
     QMap<int, QVariant> map;
     
     if (const Transfer *transfer = Transfers::instance()->get(index.row())) {
-        for (int i = Transfer::BytesTransferredRole; i <= Transfer::UsePluginRole; i++) {
+        for (int i = Transfer::BytesTransferredRole; i <= Transfer::MaximumSpeedRole; i++) {
             map[i] = transfer->data(i);
         }
     }
@@ -135,7 +135,7 @@ QVariantMap TransferModel::itemData(int row) const {
     QVariantMap map;
     
     if (const Transfer *transfer = Transfers::instance()->get(row)) {
-        for (int i = Transfer::BytesTransferredRole; i <= Transfer::UsePluginRole; i++) {
+        for (int i = Transfer::BytesTransferredRole; i <= Transfer::MaximumSpeedRole; i++) {
             map[roleNames().value(i)] = transfer->data(i);
         }
     }
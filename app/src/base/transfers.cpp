@@ -18,22 +18,34 @@
 #include "definitions.h"
 #include "download.h"
 #include "enclosuredownload.h"
+#include "json.h"
 #include "logger.h"
+#include "metrics.h"
 #include "settings.h"
 #include "utils.h"
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
 #include <QNetworkAccessManager>
 #include <QSettings>
+#include <QUrl>
 
 Transfers* Transfers::self = 0;
 
 Transfers::Transfers() :
     QObject(),
-    m_nam(new QNetworkAccessManager(this))
+    m_nam(new QNetworkAccessManager(this)),
+    m_journal(APP_CONFIG_PATH + "transfers.journal"),
+    m_journalRecords(0),
+    m_enclosureRecords(0),
+    m_nextTicket(0)
 {
     m_queueTimer.setSingleShot(true);
     m_queueTimer.setInterval(1000);
+    m_checkpointTimer.setInterval(TRANSFER_CHECKPOINT_INTERVAL);
     
     connect(&m_queueTimer, SIGNAL(timeout()), this, SLOT(startNextTransfers()));
+    connect(&m_checkpointTimer, SIGNAL(timeout()), this, SLOT(checkpointTransfers()));
 }
 
 Transfers::~Transfers() {
@@ -71,9 +83,8 @@ Transfer* Transfers::addEnclosureDownload(const QString &url, const QString &com
     transfer->setPriority(Transfer::Priority(priority));
     transfer->setUrl(url);
     transfer->setUsePlugin(usePlugin);
-    connect(transfer, SIGNAL(statusChanged()), this, SLOT(onTransferStatusChanged()));
-    
-    m_transfers << transfer;
+    addTransfer(transfer);
+    journalTransfer(transfer);
     emit countChanged(count());
     emit transferAdded(transfer);
     
@@ -93,13 +104,155 @@ Transfer* Transfers::get(int i) const {
 }
 
 Transfer* Transfers::get(const QString &id) const {
-    foreach (Transfer *transfer, m_transfers) {
-        if (transfer->id() == id) {
-            return transfer;
+    return m_ids.value(id);
+}
+
+bool Transfers::enclosureIsKnown(const QString &url, qint64 size) const {
+    if ((m_urls.contains(url)) || (m_enclosures.contains(url))) {
+        return true;
+    }
+    
+    // The same file re-published under a different URL, e.g. with tracking parameters
+    return (size > 0) && (m_enclosureKeys.contains(enclosureKey(url, size)));
+}
+
+QVariantMap Transfers::enclosure(const QString &url) const {
+    if (const Transfer *transfer = m_urls.value(url)) {
+        QVariantMap enclosure;
+        enclosure["url"] = url;
+        enclosure["status"] = "queued";
+        enclosure["transferId"] = transfer->id();
+        enclosure["size"] = transfer->size();
+        return enclosure;
+    }
+    
+    QVariantMap enclosure = m_enclosures.value(url);
+    
+    if (!enclosure.isEmpty()) {
+        enclosure["status"] = "downloaded";
+    }
+    
+    return enclosure;
+}
+
+QString Transfers::enclosureKey(const QString &url, qint64 size) {
+    return QString("%1:%2").arg(QFileInfo(QUrl(url).path()).fileName()).arg(size);
+}
+
+void Transfers::loadEnclosures() {
+    QFile file(APP_CONFIG_PATH + "enclosures");
+    
+    if (!file.open(QFile::ReadOnly)) {
+        return;
+    }
+    
+    while (!file.atEnd()) {
+        const QByteArray line = file.readLine().trimmed();
+        
+        if (!line.isEmpty()) {
+            addEnclosure(QtJson::Json::parse(QString::fromUtf8(line)).toMap());
+            m_enclosureRecords++;
         }
     }
     
-    return 0;
+    file.close();
+    Logger::log(QString("Transfers::loadEnclosures(). %1 downloaded enclosures loaded").arg(m_enclosures.size()),
+                Logger::LowVerbosity);
+    
+    if ((m_enclosureRecords > m_enclosures.size()) || (m_enclosures.size() > MAX_ENCLOSURE_RECORDS)) {
+        saveEnclosures();
+    }
+}
+
+void Transfers::saveEnclosures() {
+    // Only the most recent downloads are kept, since older enclosures are unlikely to be published again
+    QMultiMap<uint, QString> dates;
+    
+    foreach (const QVariantMap &enclosure, m_enclosures) {
+        dates.insert(enclosure.value("date").toUInt(), enclosure.value("url").toString());
+    }
+    
+    QMultiMap<uint, QString>::iterator iterator = dates.begin();
+    
+    while (m_enclosures.size() > MAX_ENCLOSURE_RECORDS) {
+        const QString url = iterator.value();
+        const QString key = enclosureKey(url, m_enclosures.take(url).value("size").toLongLong());
+        
+        if (m_enclosureKeys.value(key) == url) {
+            m_enclosureKeys.remove(key);
+        }
+        
+        ++iterator;
+    }
+    
+    const QString fileName = APP_CONFIG_PATH + "enclosures";
+    QFile file(fileName + ".tmp");
+    QDir().mkpath(APP_CONFIG_PATH);
+    
+    if (!file.open(QFile::WriteOnly | QFile::Truncate)) {
+        Logger::log("Transfers::saveEnclosures(). Cannot compact enclosures: " + file.errorString());
+        return;
+    }
+    
+    foreach (const QVariantMap &enclosure, m_enclosures) {
+        file.write(QtJson::Json::serialize(enclosure) + "\n");
+    }
+    
+    file.close();
+    QFile::remove(fileName);
+    
+    if (!file.rename(fileName)) {
+        Logger::log("Transfers::saveEnclosures(). Cannot replace enclosures: " + file.errorString());
+        return;
+    }
+    
+    m_enclosureRecords = m_enclosures.size();
+    Logger::log(QString("Transfers::saveEnclosures(). %1 downloaded enclosures saved").arg(m_enclosures.size()),
+                Logger::LowVerbosity);
+}
+
+void Transfers::addEnclosure(const QVariantMap &enclosure) {
+    const QString url = enclosure.value("url").toString();
+    
+    if (url.isEmpty()) {
+        return;
+    }
+    
+    m_enclosures[url] = enclosure;
+    const qint64 size = enclosure.value("size").toLongLong();
+    
+    if (size > 0) {
+        m_enclosureKeys[enclosureKey(url, size)] = url;
+    }
+}
+
+void Transfers::recordEnclosure(Transfer *transfer) {
+    QVariantMap enclosure;
+    enclosure["url"] = transfer->url();
+    enclosure["size"] = transfer->size();
+    enclosure["date"] = QDateTime::currentDateTime().toTime_t();
+    
+    if (const EnclosureDownload *download = qobject_cast<EnclosureDownload*>(transfer)) {
+        enclosure["fileName"] = download->fileName();
+    }
+    
+    addEnclosure(enclosure);
+    QDir().mkpath(APP_CONFIG_PATH);
+    QFile file(APP_CONFIG_PATH + "enclosures");
+    
+    if (file.open(QFile::WriteOnly | QFile::Append)) {
+        file.write(QtJson::Json::serialize(enclosure) + "\n");
+        file.close();
+        m_enclosureRecords++;
+    }
+    else {
+        Logger::log("Transfers::recordEnclosure(). Cannot record enclosure: " + file.errorString());
+    }
+    
+    // Records are appended, so the ledger is compacted once it holds a tenth more than it keeps
+    if (m_enclosureRecords > MAX_ENCLOSURE_RECORDS + MAX_ENCLOSURE_RECORDS / 10) {
+        saveEnclosures();
+    }
 }
 
 bool Transfers::start() {
@@ -145,90 +298,269 @@ bool Transfers::cancel(const QString &id) {
     return false;
 }
 
+QVariantMap Transfers::transferRecord(const Transfer *transfer) {
+    QVariantMap record;
+    record["bytesTransferred"] = transfer->data(Transfer::BytesTransferredRole);
+    record["category"] = transfer->data(Transfer::CategoryRole);
+    record["customCommand"] = transfer->data(Transfer::CustomCommandRole);
+    record["customCommandOverrideEnabled"] = transfer->data(Transfer::CustomCommandOverrideEnabledRole);
+    record["downloadPath"] = transfer->data(Transfer::DownloadPathRole);
+    record["fileName"] = transfer->data(Transfer::FileNameRole);
+    record["id"] = transfer->data(Transfer::IdRole);
+    record["maximumSpeed"] = transfer->data(Transfer::MaximumSpeedRole);
+    record["name"] = transfer->data(Transfer::NameRole);
+    record["priority"] = transfer->data(Transfer::PriorityRole);
+    record["segments"] = transfer->data(Transfer::SegmentsRole);
+    record["size"] = transfer->data(Transfer::SizeRole);
+    record["status"] = transfer->data(Transfer::StatusRole);
+    record["transferType"] = transfer->data(Transfer::TransferTypeRole);
+    record["url"] = transfer->data(Transfer::UrlRole);
+    record["usePlugin"] = transfer->data(Transfer::UsePluginRole);
+    record["pluginSettings"] = transfer->data(Transfer::PluginSettingsRole);
+    return record;
+}
+
+bool Transfers::openJournal() {
+    if (m_journal.isOpen()) {
+        return true;
+    }
+    
+    QDir().mkpath(APP_CONFIG_PATH);
+    
+    if (!m_journal.open(QFile::WriteOnly | QFile::Append)) {
+        Logger::log("Transfers::openJournal(). Cannot open journal: " + m_journal.errorString());
+        return false;
+    }
+    
+    return true;
+}
+
+bool Transfers::appendToJournal(const QVariantMap &record) {
+    if (!openJournal()) {
+        return false;
+    }
+    
+    // One record per line, so a record truncated by a crash only loses that record
+    m_journal.write(QtJson::Json::serialize(record) + "\n");
+    m_journal.flush();
+    m_journalRecords++;
+    
+    if (m_journalRecords > qMax(TRANSFER_JOURNAL_COMPACT_THRESHOLD, count() * 2)) {
+        save();
+    }
+    
+    return true;
+}
+
+void Transfers::journalTransfer(Transfer *transfer) {
+    m_checkpoints[transfer] = transfer->bytesTransferred();
+    appendToJournal(transferRecord(transfer));
+}
+
+void Transfers::journalRemoval(Transfer *transfer) {
+    m_checkpoints.remove(transfer);
+    QVariantMap record;
+    record["id"] = transfer->id();
+    record["removed"] = true;
+    appendToJournal(record);
+}
+
 void Transfers::save() {
-    QSettings settings(APP_CONFIG_PATH + "transfers", QSettings::IniFormat);
-    settings.clear();
-    settings.beginWriteArray("transfers");
-    
-    for (int i = 0; i < m_transfers.size(); i++) {
-        const Transfer *transfer = m_transfers.at(i);
-        settings.setArrayIndex(i);
-        settings.setValue("category", transfer->data(Transfer::CategoryRole));
-        settings.setValue("customCommand", transfer->data(Transfer::CustomCommandRole));
-        settings.setValue("customCommandOverrideEnabled", transfer->data(Transfer::CustomCommandOverrideEnabledRole));
-        settings.setValue("downloadPath", transfer->data(Transfer::DownloadPathRole));
-        settings.setValue("fileName", transfer->data(Transfer::FileNameRole));
-        settings.setValue("id", transfer->data(Transfer::IdRole));
-        settings.setValue("name", transfer->data(Transfer::NameRole));
-        settings.setValue("priority", transfer->data(Transfer::PriorityRole));
-        settings.setValue("size", transfer->data(Transfer::SizeRole));
-        settings.setValue("transferType", transfer->data(Transfer::TransferTypeRole));
-        settings.setValue("url", transfer->data(Transfer::UrlRole));
-        settings.setValue("usePlugin", transfer->data(Transfer::UsePluginRole));
-        settings.setValue("pluginSettings", transfer->data(Transfer::PluginSettingsRole));
-    }
-    
-    settings.endArray();
+    const QString fileName = m_journal.fileName();
+    QFile file(fileName + ".tmp");
+    m_journal.close();
+    QDir().mkpath(APP_CONFIG_PATH);
+    
+    if (!file.open(QFile::WriteOnly | QFile::Truncate)) {
+        Logger::log("Transfers::save(). Cannot compact journal: " + file.errorString());
+        return;
+    }
+    
+    foreach (Transfer *transfer, m_transfers) {
+        m_checkpoints[transfer] = transfer->bytesTransferred();
+        file.write(QtJson::Json::serialize(transferRecord(transfer)) + "\n");
+    }
+    
+    file.close();
+    QFile::remove(fileName);
+    
+    if (!file.rename(fileName)) {
+        Logger::log("Transfers::save(). Cannot replace journal: " + file.errorString());
+        return;
+    }
+    
+    m_journalRecords = m_transfers.size();
     Logger::log(QString("Transfers::save(). %1 transfers saved").arg(m_transfers.size()), Logger::LowVerbosity);
 }
 
 void Transfers::load() {
-    QSettings settings(APP_CONFIG_PATH  + "transfers", QSettings::IniFormat);
-    const int size = settings.beginReadArray("transfers");
-    Logger::log(QString("Transfers::load(). Loading %1 transfers").arg(size), Logger::LowVerbosity);
-
-    for (int i = 0; i < size; i++) {
-        settings.setArrayIndex(i);
-        Transfer *transfer;
-
-        switch (settings.value("transferType").toInt()) {
-        case Transfer::Download:
-            transfer = new Download(this);
-            break;
-        default:
-            transfer = new EnclosureDownload(this);
-            break;
+    const QString fileName = m_journal.fileName();
+    loadEnclosures();
+    
+    if ((!QFile::exists(fileName)) && (QFile::exists(fileName + ".tmp"))) {
+        // Interrupted while compacting, after the old journal was removed
+        QFile::rename(fileName + ".tmp", fileName);
+    }
+    
+    QStringList ids;
+    QHash<QString, QVariantMap> records;
+    QFile file(fileName);
+    
+    if (file.open(QFile::ReadOnly)) {
+        // Replay the journal. Later records for a transfer supersede earlier ones
+        while (!file.atEnd()) {
+            const QByteArray line = file.readLine().trimmed();
+            
+            if (line.isEmpty()) {
+                continue;
+            }
+            
+            bool ok = false;
+            const QVariantMap record = QtJson::Json::parse(QString::fromUtf8(line), ok).toMap();
+            const QString id = record.value("id").toString();
+            
+            if ((!ok) || (id.isEmpty())) {
+                Logger::log("Transfers::load(). Ignoring malformed journal record: " + QString::fromUtf8(line),
+                            Logger::LowVerbosity);
+                continue;
+            }
+            
+            if (record.value("removed").toBool()) {
+                records.remove(id);
+                ids.removeOne(id);
+            }
+            else {
+                if (!records.contains(id)) {
+                    ids << id;
+                }
+                
+                records[id] = record;
+            }
+        }
+        
+        file.close();
+    }
+    else {
+        // Migrate from the INI file used by earlier versions
+        QSettings settings(APP_CONFIG_PATH  + "transfers", QSettings::IniFormat);
+        const int size = settings.beginReadArray("transfers");
+        
+        for (int i = 0; i < size; i++) {
+            settings.setArrayIndex(i);
+            QVariantMap record;
+            
+            foreach (const QString &key, settings.childKeys()) {
+                record[key] = settings.value(key);
+            }
+            
+            const QString id = record.value("id").toString();
+            ids << id;
+            records[id] = record;
         }
         
-        transfer->setData(Transfer::CategoryRole, settings.value("category"));
-        transfer->setData(Transfer::CustomCommandRole, settings.value("customCommand"));
-        transfer->setData(Transfer::CustomCommandOverrideEnabledRole,
-                          transfer->property("customCommandOverrideEnabled"));
-        transfer->setData(Transfer::DownloadPathRole, settings.value("downloadPath"));
-        transfer->setData(Transfer::FileNameRole, settings.value("fileName"));
-        transfer->setData(Transfer::IdRole, settings.value("id"));
-        transfer->setData(Transfer::NameRole, settings.value("name"));
-        transfer->setData(Transfer::PriorityRole, settings.value("priority"));
-        transfer->setData(Transfer::SizeRole, settings.value("size"));
-        transfer->setData(Transfer::UrlRole, settings.value("url"));
-        transfer->setData(Transfer::UsePluginRole, settings.value("usePlugin"));
-        transfer->setData(Transfer::PluginSettingsRole, settings.value("pluginSettings"));
-        connect(transfer, SIGNAL(statusChanged()), this, SLOT(onTransferStatusChanged()));
-    
-        m_transfers << transfer;
+        settings.endArray();
+    }
+    
+    Logger::log(QString("Transfers::load(). Loading %1 transfers").arg(ids.size()), Logger::LowVerbosity);
+    
+    foreach (const QString &id, ids) {
+        const QVariantMap record = records.value(id);
+        Transfer *transfer = createTransfer(record);
+        addTransfer(transfer);
         emit countChanged(count());
         emit transferAdded(transfer);
+        
+        switch (record.value("status").toInt()) {
+        case Transfer::WaitingForCustomCommand:
+        case Transfer::ExecutingCustomCommand:
+            // The download completed, but its custom commands were pending or interrupted, so they are run again
+            if (EnclosureDownload *download = qobject_cast<EnclosureDownload*>(transfer)) {
+                download->resumeCustomCommands();
+                continue;
+            }
+            
+            break;
+        default:
+            break;
+        }
     
         if (Settings::startTransfersAutomatically()) {
             transfer->queue();
         }
     }
     
-    settings.endArray();
+    save();
+    
+    if (QFile::exists(fileName)) {
+        QFile::remove(APP_CONFIG_PATH + "transfers");
+    }
+}
+
+Transfer* Transfers::createTransfer(const QVariantMap &record) {
+    Transfer *transfer;
+    
+    switch (record.value("transferType").toInt()) {
+    case Transfer::Download:
+        transfer = new Download(this);
+        break;
+    default:
+        transfer = new EnclosureDownload(this);
+        break;
+    }
+    
+    transfer->setData(Transfer::CategoryRole, record.value("category"));
+    transfer->setData(Transfer::CustomCommandRole, record.value("customCommand"));
+    transfer->setData(Transfer::CustomCommandOverrideEnabledRole, record.value("customCommandOverrideEnabled"));
+    transfer->setData(Transfer::DownloadPathRole, record.value("downloadPath"));
+    transfer->setData(Transfer::FileNameRole, record.value("fileName"));
+    transfer->setData(Transfer::IdRole, record.value("id"));
+    transfer->setData(Transfer::MaximumSpeedRole, record.value("maximumSpeed"));
+    transfer->setData(Transfer::NameRole, record.value("name"));
+    transfer->setData(Transfer::PriorityRole, record.value("priority"));
+    transfer->setData(Transfer::SizeRole, record.value("size"));
+    
+    // The journaled offset is used rather than the file size, which can be larger than the data written
+    // (e.g. a preallocated file, or data written after the last checkpoint before a crash)
+    if ((transfer->transferType() == Transfer::EnclosureDownload) && (record.contains("bytesTransferred"))) {
+        transfer->setBytesTransferred(record.value("bytesTransferred").toLongLong());
+        
+        if (transfer->size() > 0) {
+            transfer->setProgress(int(transfer->bytesTransferred() * 100 / transfer->size()));
+        }
+    }
+    
+    transfer->setData(Transfer::SegmentsRole, record.value("segments"));
+    transfer->setData(Transfer::UrlRole, record.value("url"));
+    transfer->setData(Transfer::UsePluginRole, record.value("usePlugin"));
+    transfer->setData(Transfer::PluginSettingsRole, record.value("pluginSettings"));
+    return transfer;
 }
 
 void Transfers::getNextTransfers() {
     const int max = Settings::maximumConcurrentTransfers();
     
     for (int priority = Transfer::HighestPriority; priority <= Transfer::LowestPriority; priority++) {
-        foreach (Transfer *transfer, m_transfers) {
-            if ((transfer->priority() == priority) && (transfer->status() == Transfer::Queued)) {
-                if (active() < max) {
-                    addActiveTransfer(transfer);
-                }
-                else {
-                    return;
-                }
+        QQueue<QueueEntry> &queue = m_queued[priority];
+        
+        while (!queue.isEmpty()) {
+            if (active() >= max) {
+                return;
+            }
+            
+            // Entries are left in place when a transfer leaves the queue (e.g. it is paused, re-queued or
+            // removed), so stale ones are discarded here
+            const QueueEntry entry = queue.dequeue();
+            
+            if (m_tickets.value(entry.transfer) != entry.ticket) {
+                continue;
+            }
+            
+            Transfer *transfer = entry.transfer;
+            m_tickets.remove(transfer);
+            
+            if ((transfer->status() == Transfer::Queued) && (transfer->priority() == priority)
+                    && (!m_active.contains(transfer))) {
+                addActiveTransfer(transfer);
             }
         }
     }
@@ -242,39 +574,113 @@ void Transfers::startNextTransfers() {
     }
 }
 
+void Transfers::addTransfer(Transfer *transfer) {
+    m_indexes[transfer] = m_transfers.size();
+    m_transfers << transfer;
+    m_ids[transfer->id()] = transfer;
+    m_urls[transfer->url()] = transfer;
+    connect(transfer, SIGNAL(priorityChanged()), this, SLOT(onTransferPriorityChanged()));
+    connect(transfer, SIGNAL(statusChanged()), this, SLOT(onTransferStatusChanged()));
+}
+
 void Transfers::removeTransfer(Transfer *transfer) {
     removeActiveTransfer(transfer);
-    m_transfers.removeOne(transfer);
+    const int i = m_indexes.take(transfer);
+    m_transfers.removeAt(i);
+    
+    // Only the transfers after the removed one change position
+    for (int j = i; j < m_transfers.size(); j++) {
+        m_indexes[m_transfers.at(j)] = j;
+    }
+    
+    m_tickets.remove(transfer);
+    m_ids.remove(transfer->id());
+    
+    if (m_urls.value(transfer->url()) == transfer) {
+        m_urls.remove(transfer->url());
+    }
+    journalRemoval(transfer);
     transfer->deleteLater();
     emit countChanged(count());
+    emit transferRemoved(transfer);
+}
+
+void Transfers::enqueueTransfer(Transfer *transfer) {
+    // Any earlier entry becomes stale, so that a re-queued transfer cannot start ahead of those queued before it
+    QueueEntry entry;
+    entry.transfer = transfer;
+    entry.ticket = ++m_nextTicket;
+    m_tickets[transfer] = entry.ticket;
+    m_queued[transfer->priority()].enqueue(entry);
 }
 
 void Transfers::addActiveTransfer(Transfer *transfer) {
     m_active << transfer;
+    Metrics::setValue(Metrics::ActiveTransfers, m_active.size());
     emit activeChanged(active());
+    
+    if (!m_checkpointTimer.isActive()) {
+        m_checkpointTimer.start();
+    }
 }
 
 void Transfers::removeActiveTransfer(Transfer *transfer) {
     m_active.removeOne(transfer);
+    Metrics::setValue(Metrics::ActiveTransfers, m_active.size());
     emit activeChanged(active());
+    
+    if (m_active.isEmpty()) {
+        m_checkpointTimer.stop();
+    }
+}
+
+void Transfers::checkpointTransfers() {
+    // Record the resume offsets of running transfers, so that recovery after a crash
+    // does not restart segments from their last status change
+    foreach (Transfer *transfer, m_active) {
+        if (transfer->bytesTransferred() != m_checkpoints.value(transfer, -1)) {
+            journalTransfer(transfer);
+        }
+    }
+}
+
+void Transfers::onTransferPriorityChanged() {
+    if (Transfer *transfer = qobject_cast<Transfer*>(sender())) {
+        if (transfer->status() == Transfer::Queued) {
+            enqueueTransfer(transfer);
+        }
+    }
 }
 
 void Transfers::onTransferStatusChanged() {
     if (Transfer *transfer = qobject_cast<Transfer*>(sender())) {
         switch (transfer->status()) {
         case Transfer::Paused:
+        case Transfer::Failed:
             removeActiveTransfer(transfer);
+            journalTransfer(transfer);
             break;
-        case Transfer::Failed:
+        case Transfer::WaitingForCustomCommand:
+            // Custom commands are throttled by CustomCommandScheduler, so the transfer no longer
+            // counts towards the maximum concurrent transfers
             removeActiveTransfer(transfer);
-            save();
+            journalTransfer(transfer);
+            break;
+        case Transfer::ExecutingCustomCommand:
+            journalTransfer(transfer);
             break;
         case Transfer::Canceled:
+            removeTransfer(transfer);
+            break;
         case Transfer::Completed:
+            if (transfer->transferType() == Transfer::EnclosureDownload) {
+                recordEnclosure(transfer);
+            }
+            
             removeTransfer(transfer);
-            save();
             break;
         case Transfer::Queued:
+            enqueueTransfer(transfer);
             break;
         default:
             return;
@@ -18,7 +18,10 @@
 #define TRANSFERS_H
 
 #include "transfer.h"
+#include <QFile>
+#include <QQueue>
 #include <QTimer>
+#include <QVariantMap>
 
 class QNetworkAccessManager;
 
@@ -44,6 +47,9 @@ public:
     Q_INVOKABLE Transfer* get(int i) const;
     Q_INVOKABLE Transfer* get(const QString &id) const;
     
+    Q_INVOKABLE bool enclosureIsKnown(const QString &url, qint64 size = 0) const;
+    Q_INVOKABLE QVariantMap enclosure(const QString &url) const;
+    
 public Q_SLOTS:
     void setMaximumConcurrentTransfers(int maximum);
     
@@ -59,19 +65,40 @@ public Q_SLOTS:
 private Q_SLOTS:
     void startNextTransfers();
     
+    void checkpointTransfers();
+    
+    void onTransferPriorityChanged();
     void onTransferStatusChanged();
     
 Q_SIGNALS:
     void activeChanged(int active);
     void countChanged(int count);
     void transferAdded(Transfer *transfer);
+    void transferRemoved(Transfer *transfer);
     
 private:
     Transfers();
     
     void getNextTransfers();
     
+    Transfer* createTransfer(const QVariantMap &record);
+    void addTransfer(Transfer *transfer);
     void removeTransfer(Transfer *transfer);
+    
+    void enqueueTransfer(Transfer *transfer);
+    
+    static QVariantMap transferRecord(const Transfer *transfer);
+    
+    static QString enclosureKey(const QString &url, qint64 size);
+    void loadEnclosures();
+    void saveEnclosures();
+    void addEnclosure(const QVariantMap &enclosure);
+    void recordEnclosure(Transfer *transfer);
+    
+    bool openJournal();
+    bool appendToJournal(const QVariantMap &record);
+    void journalTransfer(Transfer *transfer);
+    void journalRemoval(Transfer *transfer);
 
     void addActiveTransfer(Transfer *transfer);
     void removeActiveTransfer(Transfer *transfer);
@@ -81,9 +108,34 @@ private:
     QNetworkAccessManager *m_nam;
     
     QTimer m_queueTimer;
+    QTimer m_checkpointTimer;
+    
+    QFile m_journal;
+    int m_journalRecords;
     
     QList<Transfer*> m_transfers;
-    QList<Transfer*> m_active;    
+    QHash<Transfer*, int> m_indexes;
+    QList<Transfer*> m_active;
+    
+    QHash<QString, Transfer*> m_ids;
+    QHash<QString, Transfer*> m_urls;
+    
+    QHash<QString, QVariantMap> m_enclosures;
+    QHash<QString, QString> m_enclosureKeys;
+    int m_enclosureRecords;
+    // Each entry of the priority queues carries a ticket, and only the entry with a transfer's latest ticket
+    // is current
+    struct QueueEntry
+    {
+        Transfer *transfer;
+        quint64 ticket;
+    };
+    
+    QHash<int, QQueue<QueueEntry> > m_queued;
+    QHash<Transfer*, quint64> m_tickets;
+    quint64 m_nextTicket;
+    
+    QHash<Transfer*, qint64> m_checkpoints;
 };
     
 #endif // TRANSFERS_H
@@ -0,0 +1,288 @@
+/*
+ * Copyright (C) 2017 Stuart Howarth <showarth@marxoft.co.uk>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "updatescheduler.h"
+#include "dbconnection.h"
+#include "dbnotify.h"
+#include "logger.h"
+#include <QDateTime>
+#include <QLocale>
+
+// Adaptive intervals never exceed a day, unless the subscription asks for longer
+static const int MAXIMUM_UPDATE_INTERVAL = 86400;
+static const int MAXIMUM_BACKOFF_STEPS = 4;
+
+void UpdateHints::readHeaders(const QByteArray &cacheControl, const QByteArray &retry) {
+    foreach (const QByteArray &directive, cacheControl.split(',')) {
+        const QByteArray d = directive.trimmed().toLower();
+        
+        if (d.startsWith("max-age=")) {
+            minimumInterval = qMax(minimumInterval, d.mid(8).toInt());
+        }
+    }
+    
+    const QByteArray r = retry.trimmed();
+    
+    if (r.isEmpty()) {
+        return;
+    }
+    
+    bool ok;
+    const int seconds = r.toInt(&ok);
+    
+    if (ok) {
+        retryAfter = qMax(0, seconds);
+    }
+    else {
+        // Day and month names are always English
+        const QString text = QString::fromLatin1(r);
+        QDateTime date = QLocale::c().toDateTime(text.left(text.lastIndexOf(" ")), "ddd, dd MMM yyyy HH:mm:ss");
+        
+        if (date.isValid()) {
+            date.setTimeSpec(Qt::UTC);
+            retryAfter = qMax(0, QDateTime::currentDateTimeUtc().secsTo(date));
+        }
+    }
+}
+
+UpdateScheduler::UpdateScheduler(QObject *parent) :
+    QObject(parent),
+    m_loaded(false)
+{
+    connect(DBNotify::instance(), SIGNAL(subscriptionsAdded(QStringList)), this, SLOT(onSubscriptionsAdded(QStringList)));
+    connect(DBNotify::instance(), SIGNAL(subscriptionDeleted(QString)), this, SLOT(onSubscriptionDeleted(QString)));
+    connect(DBNotify::instance(), SIGNAL(subscriptionUpdated(QString)), this, SLOT(onSubscriptionUpdated(QString)));
+    connect(DBNotify::instance(), SIGNAL(subscriptionsUpdated(QStringList)),
+            this, SLOT(onSubscriptionsUpdated(QStringList)));
+}
+
+bool UpdateScheduler::isLoaded() const {
+    return m_loaded;
+}
+
+uint UpdateScheduler::nextUpdate(const QString &id) const {
+    return m_entries.value(id).nextUpdate;
+}
+
+QStringList UpdateScheduler::takeDueSubscriptions(uint time) {
+    QStringList ids;
+    
+    while ((!m_queue.isEmpty()) && (m_queue.begin().key() <= time)) {
+        const QString id = m_queue.begin().value();
+        m_queue.erase(m_queue.begin());
+        Entry &entry = m_entries[id];
+        entry.nextUpdate = 0;
+        // Reschedule provisionally in case the update is canceled and never reported
+        schedule(id, entry, time);
+        ids << id;
+    }
+    
+    return ids;
+}
+
+void UpdateScheduler::updated(const QString &id, int articles, uint newestArticle, const UpdateHints &hints) {
+    if (!m_entries.contains(id)) {
+        return;
+    }
+    
+    const uint now = QDateTime::currentDateTime().toTime_t();
+    Entry &entry = m_entries[id];
+    entry.lastUpdated = now;
+    entry.failures = 0;
+    
+    if (articles > 0) {
+        entry.misses = 0;
+        
+        if ((entry.newestArticle > 0) && (newestArticle > entry.newestArticle)) {
+            const int observed = int(newestArticle - entry.newestArticle) / articles;
+            entry.articleInterval = entry.articleInterval > 0 ? (entry.articleInterval * 3 + observed) / 4 : observed;
+        }
+        
+        entry.newestArticle = qMax(entry.newestArticle, newestArticle);
+    }
+    else {
+        ++entry.misses;
+    }
+    
+    entry.minimumInterval = hints.minimumInterval;
+    entry.skipHours = 0;
+    
+    foreach (const int hour, hints.skipHours) {
+        if ((hour >= 0) && (hour < 24)) {
+            entry.skipHours |= (1 << hour);
+        }
+    }
+    
+    schedule(id, entry, now, now + hints.retryAfter);
+    Logger::log(QString("UpdateScheduler::updated(). Subscription %1 next due at %2")
+                       .arg(id).arg(QDateTime::fromTime_t(entry.nextUpdate).toString(Qt::ISODate)),
+                Logger::MediumVerbosity);
+}
+
+void UpdateScheduler::failed(const QString &id, const UpdateHints &hints) {
+    if (!m_entries.contains(id)) {
+        return;
+    }
+    
+    const uint now = QDateTime::currentDateTime().toTime_t();
+    Entry &entry = m_entries[id];
+    ++entry.failures;
+    schedule(id, entry, now, now + hints.retryAfter);
+    Logger::log(QString("UpdateScheduler::failed(). Subscription %1 next due at %2")
+                       .arg(id).arg(QDateTime::fromTime_t(entry.nextUpdate).toString(Qt::ISODate)),
+                Logger::MediumVerbosity);
+}
+
+void UpdateScheduler::load() {
+    if (isLoaded()) {
+        return;
+    }
+    
+    Logger::log("UpdateScheduler::load()", Logger::MediumVerbosity);
+    DBConnection::connection(this, SLOT(onSubscriptionsLoaded(DBConnection*)))->exec("SELECT id, updateInterval, lastUpdated FROM subscriptions");
+}
+
+int UpdateScheduler::interval(const Entry &entry) const {
+    int seconds = entry.updateInterval;
+    
+    // Aim for roughly two updates per article published
+    if (entry.articleInterval > 0) {
+        seconds = qMax(seconds, entry.articleInterval / 2);
+    }
+    
+    if (entry.misses > 0) {
+        seconds += seconds * qMin(entry.misses, MAXIMUM_BACKOFF_STEPS) / 2;
+    }
+    
+    if (entry.failures > 0) {
+        seconds = qMax(seconds, entry.updateInterval << qMin(entry.failures, MAXIMUM_BACKOFF_STEPS));
+    }
+    
+    seconds = qMin(seconds, qMax(entry.updateInterval, MAXIMUM_UPDATE_INTERVAL));
+    return qMax(seconds, qMin(entry.minimumInterval, MAXIMUM_UPDATE_INTERVAL));
+}
+
+void UpdateScheduler::readSubscriptions(DBConnection *connection) {
+    while (connection->nextRecord()) {
+        const QString id = connection->value(0).toString();
+        const int updateInterval = connection->value(1).toInt();
+        const bool added = !m_entries.contains(id);
+        Entry &entry = m_entries[id];
+        entry.lastUpdated = connection->value(2).toUInt();
+        
+        if ((added) || (updateInterval != entry.updateInterval)) {
+            entry.updateInterval = updateInterval;
+            schedule(id, entry, entry.lastUpdated);
+        }
+    }
+}
+
+void UpdateScheduler::schedule(const QString &id, Entry &entry, uint time, uint notBefore) {
+    unschedule(id, entry);
+    
+    if (entry.updateInterval <= 0) {
+        return;
+    }
+    
+    uint due = qMax(time + interval(entry), notBefore);
+    
+    // skipHours are given in GMT, so whole hours can be taken directly from the timestamp
+    for (int i = 0; (i < 24) && (entry.skipHours & (1 << ((due / 3600) % 24))); i++) {
+        due += 3600 - due % 3600;
+    }
+    
+    entry.nextUpdate = due;
+    m_queue.insert(due, id);
+}
+
+void UpdateScheduler::unschedule(const QString &id, Entry &entry) {
+    if (entry.nextUpdate > 0) {
+        m_queue.remove(entry.nextUpdate, id);
+        entry.nextUpdate = 0;
+    }
+}
+
+void UpdateScheduler::onSubscriptionsAdded(const QStringList &ids) {
+    if (isLoaded()) {
+        DBConnection::connection(this, SLOT(onSubscriptionsFetched(DBConnection*)))->exec(QString("SELECT id, updateInterval, lastUpdated FROM subscriptions WHERE id IN (%1)").arg(DBConnection::idList(ids)));
+    }
+}
+
+void UpdateScheduler::onSubscriptionDeleted(const QString &id) {
+    if (m_entries.contains(id)) {
+        unschedule(id, m_entries[id]);
+        m_entries.remove(id);
+    }
+}
+
+void UpdateScheduler::onSubscriptionUpdated(const QString &id) {
+    if (isLoaded()) {
+        DBConnection::connection(this, SLOT(onSubscriptionsFetched(DBConnection*)))->exec(QString("SELECT id, updateInterval, lastUpdated FROM subscriptions WHERE id IN (%1)").arg(DBConnection::idList(QStringList() << id)));
+    }
+}
+
+void UpdateScheduler::onSubscriptionsUpdated(const QStringList &ids) {
+    // Same query as for added subscriptions, which also picks up changed intervals
+    onSubscriptionsAdded(ids);
+}
+
+void UpdateScheduler::onSubscriptionsLoaded(DBConnection *connection) {
+    if (connection->status() == DBConnection::Ready) {
+        m_entries.clear();
+        m_queue.clear();
+        readSubscriptions(connection);
+        m_loaded = true;
+        Logger::log(QString("UpdateScheduler::onSubscriptionsLoaded(). %1 subscriptions loaded").arg(m_entries.size()),
+                    Logger::MediumVerbosity);
+        DBConnection::connection(this, SLOT(onArticleRatesFetched(DBConnection*)))->exec("SELECT subscriptionId, COUNT(id), MIN(date), MAX(date) FROM articles GROUP BY subscriptionId");
+    }
+    else {
+        Logger::log("UpdateScheduler::onSubscriptionsLoaded(). Error: " + connection->errorString());
+    }
+    
+    connection->deleteLater();
+}
+
+void UpdateScheduler::onSubscriptionsFetched(DBConnection *connection) {
+    if (connection->status() == DBConnection::Ready) {
+        readSubscriptions(connection);
+    }
+    
+    connection->deleteLater();
+}
+
+void UpdateScheduler::onArticleRatesFetched(DBConnection *connection) {
+    if (connection->status() == DBConnection::Ready) {
+        while (connection->nextRecord()) {
+            const QString id = connection->value(0).toString();
+            
+            if (m_entries.contains(id)) {
+                Entry &entry = m_entries[id];
+                const int count = connection->value(1).toInt();
+                const uint oldest = connection->value(2).toUInt();
+                entry.newestArticle = connection->value(3).toUInt();
+                
+                if ((count > 1) && (entry.newestArticle > oldest)) {
+                    entry.articleInterval = int(entry.newestArticle - oldest) / (count - 1);
+                }
+                
+                schedule(id, entry, entry.lastUpdated);
+            }
+        }
+    }
+    
+    connection->deleteLater();
+}
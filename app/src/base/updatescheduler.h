@@ -0,0 +1,111 @@
+/*
+ * Copyright (C) 2017 Stuart Howarth <showarth@marxoft.co.uk>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef UPDATESCHEDULER_H
+#define UPDATESCHEDULER_H
+
+#include <QObject>
+#include <QHash>
+#include <QMultiMap>
+#include <QStringList>
+
+class DBConnection;
+
+struct UpdateHints
+{
+    UpdateHints() :
+        minimumInterval(0),
+        retryAfter(0)
+    {
+    }
+    
+    void readHeaders(const QByteArray &cacheControl, const QByteArray &retryAfter);
+    
+    int minimumInterval; // Seconds, from <ttl> or Cache-Control max-age
+    int retryAfter; // Seconds, from Retry-After
+    QList<int> skipHours; // GMT hours, from <skipHours>
+};
+
+class UpdateScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit UpdateScheduler(QObject *parent = 0);
+    
+    bool isLoaded() const;
+    
+    uint nextUpdate(const QString &id) const;
+    
+    QStringList takeDueSubscriptions(uint time);
+    
+    void updated(const QString &id, int articles, uint newestArticle, const UpdateHints &hints);
+    void failed(const QString &id, const UpdateHints &hints);
+
+public Q_SLOTS:
+    void load();
+
+private Q_SLOTS:
+    void onSubscriptionsAdded(const QStringList &ids);
+    void onSubscriptionDeleted(const QString &id);
+    void onSubscriptionUpdated(const QString &id);
+    void onSubscriptionsUpdated(const QStringList &ids);
+    
+    void onSubscriptionsLoaded(DBConnection *connection);
+    void onSubscriptionsFetched(DBConnection *connection);
+    void onArticleRatesFetched(DBConnection *connection);
+
+private:
+    struct Entry
+    {
+        Entry() :
+            updateInterval(0),
+            lastUpdated(0),
+            nextUpdate(0),
+            newestArticle(0),
+            articleInterval(0),
+            misses(0),
+            failures(0),
+            minimumInterval(0),
+            skipHours(0)
+        {
+        }
+        
+        int updateInterval;
+        uint lastUpdated;
+        uint nextUpdate;
+        uint newestArticle;
+        int articleInterval;
+        int misses;
+        int failures;
+        int minimumInterval;
+        quint32 skipHours;
+    };
+    
+    int interval(const Entry &entry) const;
+    
+    void readSubscriptions(DBConnection *connection);
+    
+    void schedule(const QString &id, Entry &entry, uint time, uint notBefore = 0);
+    void unschedule(const QString &id, Entry &entry);
+    
+    bool m_loaded;
+    
+    QHash<QString, Entry> m_entries;
+    QMultiMap<uint, QString> m_queue;
+};
+
+#endif // UPDATESCHEDULER_H
@@ -18,6 +18,7 @@
 #include "definitions.h"
 #include "enclosurerequest.h"
 #include "logger.h"
+#include "metrics.h"
 #include "pluginmanager.h"
 #include "pluginsettings.h"
 #include <QDesktopServices>
@@ -143,6 +144,8 @@ bool UrlOpenerModel::openWithPlugin(const QString &url) {
             EnclosureRequest *request = plugins.at(i).plugin->enclosureRequest(this);
             
             if (request) {
+                connect(request, SIGNAL(finished(EnclosureRequest*)),
+                        new MetricsTimer(Metrics::PluginRequestDuration, config->id(), request), SLOT(finish()));
                 connect(request, SIGNAL(finished(EnclosureRequest*)),
                         this, SLOT(onEnclosureRequestFinished(EnclosureRequest*)));
 
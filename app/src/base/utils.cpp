@@ -19,10 +19,102 @@
 #include <QFile>
 #include <QRegExp>
 #include <QUuid>
+#include <algorithm>
 #if QT_VERSION >= 0x050000
 #include <QUrlQuery>
 #endif
 
+struct HtmlEntity {
+    const char *name;
+    uint codePoint;
+};
+
+// Sorted by name, for binary search
+static const HtmlEntity HTML_ENTITIES[] = {
+    { "AElig", 198 }, { "Aacute", 193 }, { "Acirc", 194 }, { "Agrave", 192 }, { "Alpha", 913 }, { "Aring", 197 },
+    { "Atilde", 195 }, { "Auml", 196 }, { "Beta", 914 }, { "Ccedil", 199 }, { "Chi", 935 }, { "Dagger", 8225 },
+    { "Delta", 916 }, { "ETH", 208 }, { "Eacute", 201 }, { "Ecirc", 202 }, { "Egrave", 200 }, { "Epsilon", 917 },
+    { "Eta", 919 }, { "Euml", 203 }, { "Gamma", 915 }, { "Iacute", 205 }, { "Icirc", 206 }, { "Igrave", 204 },
+    { "Iota", 921 }, { "Iuml", 207 }, { "Kappa", 922 }, { "Lambda", 923 }, { "Mu", 924 }, { "Ntilde", 209 },
+    { "Nu", 925 }, { "OElig", 338 }, { "Oacute", 211 }, { "Ocirc", 212 }, { "Ograve", 210 }, { "Omega", 937 },
+    { "Omicron", 927 }, { "Oslash", 216 }, { "Otilde", 213 }, { "Ouml", 214 }, { "Phi", 934 }, { "Pi", 928 },
+    { "Prime", 8243 }, { "Psi", 936 }, { "Rho", 929 }, { "Scaron", 352 }, { "Sigma", 931 }, { "THORN", 222 },
+    { "Tau", 932 }, { "Theta", 920 }, { "Uacute", 218 }, { "Ucirc", 219 }, { "Ugrave", 217 }, { "Upsilon", 933 },
+    { "Uuml", 220 }, { "Xi", 926 }, { "Yacute", 221 }, { "Yuml", 376 }, { "Zeta", 918 }, { "aacute", 225 },
+    { "acirc", 226 }, { "acute", 180 }, { "aelig", 230 }, { "agrave", 224 }, { "alefsym", 8501 }, { "alpha", 945 },
+    { "amp", 38 }, { "and", 8743 }, { "ang", 8736 }, { "apos", 39 }, { "aring", 229 }, { "asymp", 8776 },
+    { "atilde", 227 }, { "auml", 228 }, { "bdquo", 8222 }, { "beta", 946 }, { "brvbar", 166 }, { "bull", 8226 },
+    { "cap", 8745 }, { "ccedil", 231 }, { "cedil", 184 }, { "cent", 162 }, { "chi", 967 }, { "circ", 710 },
+    { "clubs", 9827 }, { "cong", 8773 }, { "copy", 169 }, { "crarr", 8629 }, { "cup", 8746 }, { "curren", 164 },
+    { "dArr", 8659 }, { "dagger", 8224 }, { "darr", 8595 }, { "deg", 176 }, { "delta", 948 }, { "diams", 9830 },
+    { "divide", 247 }, { "eacute", 233 }, { "ecirc", 234 }, { "egrave", 232 }, { "empty", 8709 }, { "emsp", 8195 },
+    { "ensp", 8194 }, { "epsilon", 949 }, { "equiv", 8801 }, { "eta", 951 }, { "eth", 240 }, { "euml", 235 },
+    { "euro", 8364 }, { "exist", 8707 }, { "fnof", 402 }, { "forall", 8704 }, { "frac12", 189 }, { "frac14", 188 },
+    { "frac34", 190 }, { "frasl", 8260 }, { "gamma", 947 }, { "ge", 8805 }, { "gt", 62 }, { "hArr", 8660 },
+    { "harr", 8596 }, { "hearts", 9829 }, { "hellip", 8230 }, { "iacute", 237 }, { "icirc", 238 },
+    { "iexcl", 161 }, { "igrave", 236 }, { "image", 8465 }, { "infin", 8734 }, { "int", 8747 }, { "iota", 953 },
+    { "iquest", 191 }, { "isin", 8712 }, { "iuml", 239 }, { "kappa", 954 }, { "lArr", 8656 }, { "lambda", 955 },
+    { "lang", 9001 }, { "laquo", 171 }, { "larr", 8592 }, { "lceil", 8968 }, { "ldquo", 8220 }, { "le", 8804 },
+    { "lfloor", 8970 }, { "lowast", 8727 }, { "loz", 9674 }, { "lrm", 8206 }, { "lsaquo", 8249 },
+    { "lsquo", 8216 }, { "lt", 60 }, { "macr", 175 }, { "mdash", 8212 }, { "micro", 181 }, { "middot", 183 },
+    { "minus", 8722 }, { "mu", 956 }, { "nabla", 8711 }, { "nbsp", 160 }, { "ndash", 8211 }, { "ne", 8800 },
+    { "ni", 8715 }, { "not", 172 }, { "notin", 8713 }, { "nsub", 8836 }, { "ntilde", 241 }, { "nu", 957 },
+    { "oacute", 243 }, { "ocirc", 244 }, { "oelig", 339 }, { "ograve", 242 }, { "oline", 8254 }, { "omega", 969 },
+    { "omicron", 959 }, { "oplus", 8853 }, { "or", 8744 }, { "ordf", 170 }, { "ordm", 186 }, { "oslash", 248 },
+    { "otilde", 245 }, { "otimes", 8855 }, { "ouml", 246 }, { "para", 182 }, { "part", 8706 }, { "permil", 8240 },
+    { "perp", 8869 }, { "phi", 966 }, { "pi", 960 }, { "piv", 982 }, { "plusmn", 177 }, { "pound", 163 },
+    { "prime", 8242 }, { "prod", 8719 }, { "prop", 8733 }, { "psi", 968 }, { "quot", 34 }, { "rArr", 8658 },
+    { "radic", 8730 }, { "rang", 9002 }, { "raquo", 187 }, { "rarr", 8594 }, { "rceil", 8969 }, { "rdquo", 8221 },
+    { "real", 8476 }, { "reg", 174 }, { "rfloor", 8971 }, { "rho", 961 }, { "rlm", 8207 }, { "rsaquo", 8250 },
+    { "rsquo", 8217 }, { "sbquo", 8218 }, { "scaron", 353 }, { "sdot", 8901 }, { "sect", 167 }, { "shy", 173 },
+    { "sigma", 963 }, { "sigmaf", 962 }, { "sim", 8764 }, { "spades", 9824 }, { "sub", 8834 }, { "sube", 8838 },
+    { "sum", 8721 }, { "sup", 8835 }, { "sup1", 185 }, { "sup2", 178 }, { "sup3", 179 }, { "supe", 8839 },
+    { "szlig", 223 }, { "tau", 964 }, { "there4", 8756 }, { "theta", 952 }, { "thetasym", 977 },
+    { "thinsp", 8201 }, { "thorn", 254 }, { "tilde", 732 }, { "times", 215 }, { "trade", 8482 }, { "uArr", 8657 },
+    { "uacute", 250 }, { "uarr", 8593 }, { "ucirc", 251 }, { "ugrave", 249 }, { "uml", 168 }, { "upsih", 978 },
+    { "upsilon", 965 }, { "uuml", 252 }, { "weierp", 8472 }, { "xi", 958 }, { "yacute", 253 }, { "yen", 165 },
+    { "yuml", 255 }, { "zeta", 950 }, { "zwj", 8205 }, { "zwnj", 8204 }
+};
+
+static const int HTML_ENTITY_COUNT = sizeof(HTML_ENTITIES) / sizeof(HtmlEntity);
+static const int HTML_ENTITY_MAX_LENGTH = 8;
+
+static bool htmlEntityLessThan(const HtmlEntity &entity, const QByteArray &name) {
+    return qstrcmp(entity.name, name.constData()) < 0;
+}
+
+static void appendCodePoint(QString &s, uint codePoint) {
+    if (QChar::requiresSurrogates(codePoint)) {
+        s += QChar(QChar::highSurrogate(codePoint));
+        s += QChar(QChar::lowSurrogate(codePoint));
+    }
+    else {
+        s += QChar(codePoint);
+    }
+}
+
+static void appendEscapedText(QString &s, const QStringRef &text) {
+    const QChar *data = text.unicode();
+    
+    for (int i = 0; i < text.size(); i++) {
+        switch (data[i].unicode()) {
+        case '&':
+            s += QLatin1String("&amp;");
+            break;
+        case '<':
+            s += QLatin1String("&lt;");
+            break;
+        case '\n':
+        case '\r':
+            s += QLatin1String("<br>");
+            break;
+        default:
+            s += data[i];
+            break;
+        }
+    }
+}
+
 Utils::Utils(QObject *parent) :
     QObject(parent)
 {
@@ -142,36 +234,64 @@ bool Utils::removeDirectory(const QString &directory) {
 }
 
 QString Utils::replaceSrcPaths(const QString &s, const QString &path) {
-    QString result(s);
-    const QRegExp src(" src=('|\")([^'\"]+)");
+    const QLatin1String src(" src=");
+    const int srcLength = 5;
+    QString result;
+    result.reserve(s.size() + s.size() / 4);
+    int start = 0;
     int pos = 0;
 
-    while ((pos = src.indexIn(result, pos)) != -1) {
-        const QString url = src.cap(2);
-        const QString rep = path + url.toUtf8().toBase64();
-        result.replace(pos + 6, url.size(), rep);
-        pos += rep.size() + 7;
+    while ((pos = s.indexOf(src, pos)) != -1) {
+        pos += srcLength;
+        
+        if ((pos >= s.size()) || ((s.at(pos) != '\'') && (s.at(pos) != '"'))) {
+            continue;
+        }
+        
+        const int urlStart = ++pos;
+        
+        while ((pos < s.size()) && (s.at(pos) != '\'') && (s.at(pos) != '"')) {
+            pos++;
+        }
+        
+        if (pos > urlStart) {
+            result += s.midRef(start, urlStart - start);
+            result += path;
+            result += QString::fromLatin1(s.midRef(urlStart, pos - urlStart).toString().toUtf8().toBase64());
+            start = pos;
+        }
     }
 
+    result += s.midRef(start);
     return result;
 }
 
 QString Utils::toRichText(const QString &s) {
-    QString result(s);
-    result.replace("&", "&amp;");
-    result.replace("<", "&lt;");
-    result.replace(QRegExp("[\n\r]"), "<br>");
-    
-    QRegExp re("((http(s|)://|[\\w-_\\.]+@)[^\\s<:\"']+)");
+    const QRegExp re("((http(s|)://|[\\w-_\\.]+@)[^\\s<:\"']+)");
+    QString result;
+    result.reserve(s.size() + s.size() / 4);
+    int start = 0;
     int pos = 0;
 
-    while ((pos = re.indexIn(result, pos)) != -1) {
-        QString link = re.cap(1);
-        result.replace(pos, link.size(), QString("<a href='%1'>%2</a>")
-                .arg(link.contains('@') ? "mailto:" + link : link).arg(link));
-        pos += re.matchedLength() * 2 + 15;
+    while ((pos = re.indexIn(s, pos)) != -1) {
+        const int length = re.matchedLength();
+        const QStringRef link = s.midRef(pos, length);
+        appendEscapedText(result, s.midRef(start, pos - start));
+        result += QLatin1String("<a href='");
+        
+        if (link.contains('@')) {
+            result += QLatin1String("mailto:");
+        }
+        
+        appendEscapedText(result, link);
+        result += QLatin1String("'>");
+        appendEscapedText(result, link);
+        result += QLatin1String("</a>");
+        pos += length;
+        start = pos;
     }
 
+    appendEscapedText(result, s.midRef(start));
     return result;
 }
 
@@ -188,12 +308,62 @@ QString Utils::unescape(const QString &s) {
 }
 
 QString Utils::unescapeHtml(const QString &html) {
-    QString s(html);
-    s.replace("&amp;", "&");
-    s.replace("&apos;", "'");
-    s.replace("&lt;", "<");
-    s.replace("&gt;", ">");
-    s.replace("&quot;", "\"");
+    QString s;
+    s.reserve(html.size());
+    int start = 0;
+    int pos = 0;
+
+    while ((pos = html.indexOf('&', pos)) != -1) {
+        const int limit = qMin(html.size(), pos + HTML_ENTITY_MAX_LENGTH + 2);
+        int end = pos + 1;
+        
+        while ((end < limit) && (html.at(end) != ';')) {
+            end++;
+        }
+        
+        if ((end == limit) || (end == pos + 1)) {
+            pos++;
+            continue;
+        }
+        
+        uint codePoint = 0;
+        
+        if (html.at(pos + 1) == '#') {
+            bool ok = false;
+            
+            if ((end > pos + 2) && ((html.at(pos + 2) == 'x') || (html.at(pos + 2) == 'X'))) {
+                codePoint = html.mid(pos + 3, end - pos - 3).toUInt(&ok, 16);
+            }
+            else {
+                codePoint = html.mid(pos + 2, end - pos - 2).toUInt(&ok, 10);
+            }
+            
+            if ((!ok) || (codePoint == 0) || (codePoint > 0x10FFFF)) {
+                codePoint = 0;
+            }
+        }
+        else {
+            const QByteArray name = html.mid(pos + 1, end - pos - 1).toLatin1();
+            const HtmlEntity *entity = std::lower_bound(HTML_ENTITIES, HTML_ENTITIES + HTML_ENTITY_COUNT, name,
+                                                        htmlEntityLessThan);
+            
+            if ((entity != HTML_ENTITIES + HTML_ENTITY_COUNT) && (name == entity->name)) {
+                codePoint = entity->codePoint;
+            }
+        }
+        
+        if (codePoint == 0) {
+            pos++;
+            continue;
+        }
+        
+        s += html.midRef(start, pos - start);
+        appendCodePoint(s, codePoint);
+        pos = end + 1;
+        start = pos;
+    }
+
+    s += html.midRef(start);
     return s;
 }
 
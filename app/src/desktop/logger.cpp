@@ -16,9 +16,8 @@
  */
 
 #include "logger.h"
+#include "logwriter.h"
 #include <QDateTime>
-#include <QFile>
-#include <QTextStream>
 #include <iostream>
 
 QString Logger::fn;
@@ -35,27 +34,11 @@ QString Logger::fileName() {
 
 void Logger::setFileName(const QString &f) {
     fn = f;
+    LogWriter::instance()->setFileName(f);
 }
 
 QString Logger::text() {
-    QString output;
-    
-    if (!fn.isEmpty()) {
-        QFile file(fn);
-        
-        if (file.open(QFile::ReadOnly | QFile::Text)) {
-            QTextStream stream(&file);
-
-            while (!stream.atEnd()) {
-                output.append(stream.readLine());
-                output.append("\n");
-            }
-
-            file.close();
-        }
-    }
-    
-    return output;
+    return LogWriter::instance()->text();
 }
 
 int Logger::verbosity() {
@@ -64,32 +47,24 @@ int Logger::verbosity() {
 
 void Logger::setVerbosity(int v) {
     vb = v;
+    // Make sure the writer exists before other threads start logging
+    LogWriter::instance();
 }
 
 void Logger::clear() {
-    if (!fn.isEmpty()) {
-        QFile::remove(fn);
-    }
+    LogWriter::instance()->clear();
 }
 
 void Logger::log(const QString &message, int minimumVerbosity) {
-    if (minimumVerbosity <= vb) {
-        const QString date = QDateTime::currentDateTime().toString(Qt::ISODate);
-        QString output = QString("%1: %2\n").arg(date).arg(message);
-        
-        if (!fn.isEmpty()) {
-            QFile file(fn);
-            
-            if (file.open(QFile::Append | QFile::Text)) {
-                QTextStream stream(&file);
-                stream << output;
-                file.close();
-                return;
-            }
-            
-            output = tr("%1: Cannot write to log file '%2'. Error: %3").arg(date).arg(fn).arg(file.errorString());
-        }
-        
+    if (minimumVerbosity > vb) {
+        return;
+    }
+    
+    // Lines are written to the log file by LogWriter in a background thread
+    const QString output = QString("%1: %2\n").arg(QDateTime::currentDateTime().toString(Qt::ISODate)).arg(message);
+    LogWriter::instance()->write(output);
+    
+    if (fn.isEmpty()) {
         std::cout << output.toUtf8().constData();
     }
 }
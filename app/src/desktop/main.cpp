@@ -14,14 +14,20 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include "bandwidthscheduler.h"
+#include "changelog.h"
 #include "cutenews.h"
+#include "customcommandscheduler.h"
 #include "database.h"
 #include "dbconnection.h"
+#include "dbmaintenance.h"
 #include "dbnotify.h"
 #include "definitions.h"
 #include "logger.h"
+#include "mediaprefetcher.h"
 #include "pluginmanager.h"
 #include "settings.h"
+#include "settingscache.h"
 #include "subscriptions.h"
 #include "transfers.h"
 #include "urlopenermodel.h"
@@ -67,13 +73,19 @@ Q_DECL_EXPORT int main(int argc, char *argv[]) {
     initDatabase();
     registerTypes();
 
+    QScopedPointer<SettingsCache> settingsCache(SettingsCache::instance());
     QScopedPointer<CuteNews> cutenews(CuteNews::instance());
     QScopedPointer<DBNotify> notify(DBNotify::instance());
     QScopedPointer<PluginManager> plugins(PluginManager::instance());
     QScopedPointer<Settings> settings(Settings::instance());
     QScopedPointer<Subscriptions> subscriptions(Subscriptions::instance());
+    QScopedPointer<DBMaintenance> maintenance(DBMaintenance::instance());
+    QScopedPointer<MediaPrefetcher> prefetcher(MediaPrefetcher::instance());
+    QScopedPointer<BandwidthScheduler> scheduler(BandwidthScheduler::instance());
+    QScopedPointer<CustomCommandScheduler> commandScheduler(CustomCommandScheduler::instance());
     QScopedPointer<Transfers> transfers(Transfers::instance());
     QScopedPointer<UrlOpenerModel> opener(UrlOpenerModel::instance());
+    QScopedPointer<ChangeLog> changes(ChangeLog::instance());
     QScopedPointer<WebServer> server(WebServer::instance());
         
     QThread thread;
@@ -86,6 +98,7 @@ Q_DECL_EXPORT int main(int argc, char *argv[]) {
     server.data()->setUsername(Settings::webInterfaceUsername());
     server.data()->setPassword(Settings::webInterfacePassword());
     server.data()->setAuthenticationEnabled(Settings::webInterfaceAuthenticationEnabled());
+    server.data()->setThreadCount(Settings::webInterfaceThreadCount());
     plugins.data()->load();
     transfers.data()->load();
     opener.data()->load();
@@ -113,6 +126,8 @@ Q_DECL_EXPORT int main(int argc, char *argv[]) {
     QObject::connect(settings.data(), SIGNAL(webInterfacePasswordChanged(QString)),
                      server.data(), SLOT(setPassword(QString)));
     QObject::connect(settings.data(), SIGNAL(webInterfacePortChanged(int)), server.data(), SLOT(setPort(int)));
+    QObject::connect(settings.data(), SIGNAL(webInterfaceThreadCountChanged(int)),
+                     server.data(), SLOT(setThreadCount(int)));
     QObject::connect(settings.data(), SIGNAL(webInterfaceEnabledChanged(bool)),
                      server.data(), SLOT(setRunning(bool)));
     QObject::connect(&app, SIGNAL(lastWindowClosed()), cutenews.data(), SLOT(quit()));
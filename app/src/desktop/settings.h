@@ -31,11 +31,19 @@ class Settings : public QObject
 
     Q_PROPERTY(QByteArray articlesHeaderViewState READ articlesHeaderViewState WRITE setArticlesHeaderViewState)
     Q_PROPERTY(QStringList categoryNames READ categoryNames NOTIFY categoriesChanged)
+    Q_PROPERTY(bool compressArticles READ compressArticles WRITE setCompressArticles NOTIFY compressArticlesChanged)
+    Q_PROPERTY(int maximumConcurrentCustomCommands READ maximumConcurrentCustomCommands
+               WRITE setMaximumConcurrentCustomCommands NOTIFY maximumConcurrentCustomCommandsChanged)
+    Q_PROPERTY(int customCommandNiceness READ customCommandNiceness WRITE setCustomCommandNiceness
+               NOTIFY customCommandNicenessChanged)
+    Q_PROPERTY(bool customCommandIdleIOEnabled READ customCommandIdleIOEnabled WRITE setCustomCommandIdleIOEnabled
+               NOTIFY customCommandIdleIOEnabledChanged)
     Q_PROPERTY(QString customTransferCommand READ customTransferCommand WRITE setCustomTransferCommand
                NOTIFY customTransferCommandChanged)
     Q_PROPERTY(bool customTransferCommandEnabled READ customTransferCommandEnabled WRITE setCustomTransferCommandEnabled
                NOTIFY customTransferCommandEnabledChanged)
     Q_PROPERTY(QString defaultCategory READ defaultCategory WRITE setDefaultCategory NOTIFY defaultCategoryChanged)
+    Q_PROPERTY(int downloadSegments READ downloadSegments WRITE setDownloadSegments NOTIFY downloadSegmentsChanged)
     Q_PROPERTY(QString downloadPath READ downloadPath WRITE setDownloadPath NOTIFY downloadPathChanged)
     Q_PROPERTY(bool enableJavaScriptInBrowser READ enableJavaScriptInBrowser WRITE setEnableJavaScriptInBrowser
                NOTIFY enableJavaScriptInBrowserChanged)
@@ -60,8 +68,12 @@ class Settings : public QObject
     Q_PROPERTY(int networkProxyType READ networkProxyType WRITE setNetworkProxyType NOTIFY networkProxyChanged)
     Q_PROPERTY(QString networkProxyUsername READ networkProxyUsername WRITE setNetworkProxyUsername
                NOTIFY networkProxyChanged)
+    Q_PROPERTY(int maximumDownloadSpeed READ maximumDownloadSpeed WRITE setMaximumDownloadSpeed
+               NOTIFY maximumDownloadSpeedChanged)
     Q_PROPERTY(bool offlineModeEnabled READ offlineModeEnabled WRITE setOfflineModeEnabled
                NOTIFY offlineModeEnabledChanged)
+    Q_PROPERTY(bool prefetchArticleMedia READ prefetchArticleMedia WRITE setPrefetchArticleMedia
+               NOTIFY prefetchArticleMediaChanged)
     Q_PROPERTY(int readArticleExpiry READ readArticleExpiry WRITE setReadArticleExpiry NOTIFY readArticleExpiryChanged)
     Q_PROPERTY(bool startTransfersAutomatically READ startTransfersAutomatically WRITE setStartTransfersAutomatically
                NOTIFY startTransfersAutomaticallyChanged)
@@ -75,6 +87,8 @@ class Settings : public QObject
     Q_PROPERTY(QString webInterfacePassword READ webInterfacePassword WRITE setWebInterfacePassword
                NOTIFY webInterfacePasswordChanged)
     Q_PROPERTY(int webInterfacePort READ webInterfacePort WRITE setWebInterfacePort NOTIFY webInterfacePortChanged)
+    Q_PROPERTY(int webInterfaceThreadCount READ webInterfaceThreadCount WRITE setWebInterfaceThreadCount
+               NOTIFY webInterfaceThreadCountChanged)
     Q_PROPERTY(QString webInterfaceUsername READ webInterfaceUsername WRITE setWebInterfaceUsername
                NOTIFY webInterfaceUsernameChanged)
     
@@ -89,11 +103,21 @@ public:
     static QList<Category> categories();
     static void setCategories(const QList<Category> &c);
     
+    static bool compressArticles();
+    
+    static int maximumConcurrentCustomCommands();
+    
+    static int customCommandNiceness();
+    
+    static bool customCommandIdleIOEnabled();
+    
     static QString customTransferCommand();
     static bool customTransferCommandEnabled();
     
     static QString defaultCategory();
     
+    static int downloadSegments();
+    
     static QString downloadPath();
     Q_INVOKABLE static QString downloadPath(const QString &category);
 
@@ -117,8 +141,13 @@ public:
     static int networkProxyType();
     static QString networkProxyUsername();
     
+    static int maximumDownloadSpeed();
+    Q_INVOKABLE static int maximumDownloadSpeed(const QString &category);
+    
     static bool offlineModeEnabled();
     
+    static bool prefetchArticleMedia();
+    
     static int readArticleExpiry();
     
     static bool startTransfersAutomatically();
@@ -131,6 +160,7 @@ public:
     static bool webInterfaceEnabled();
     static QString webInterfacePassword();
     static int webInterfacePort();
+    static int webInterfaceThreadCount();
     static QString webInterfaceUsername();
             
     Q_INVOKABLE static QVariant value(const QString &key, const QVariant &defaultValue = QVariant());
@@ -142,9 +172,19 @@ public Q_SLOTS:
     static void setDefaultCategory(const QString &category);
     static void removeCategory(const QString &name);
     
+    static void setCompressArticles(bool enabled);
+    
+    static void setMaximumConcurrentCustomCommands(int maximum);
+    
+    static void setCustomCommandNiceness(int niceness);
+    
+    static void setCustomCommandIdleIOEnabled(bool enabled);
+    
     static void setCustomTransferCommand(const QString &command);
     static void setCustomTransferCommandEnabled(bool enabled);
     
+    static void setDownloadSegments(int segments);
+    
     static void setDownloadPath(const QString &path);
 
     static void setEnableJavaScriptInBrowser(bool enabled);
@@ -168,8 +208,13 @@ public Q_SLOTS:
     static void setNetworkProxyType(int type);
     static void setNetworkProxyUsername(const QString &username);
     
+    static void setMaximumDownloadSpeed(int speed);
+    static void setMaximumDownloadSpeed(const QString &category, int speed);
+    
     static void setOfflineModeEnabled(bool enabled);
 
+    static void setPrefetchArticleMedia(bool enabled);
+    
     static void setReadArticleExpiry(int expiry);
     
     static void setStartTransfersAutomatically(bool enabled);
@@ -182,6 +227,7 @@ public Q_SLOTS:
     static void setWebInterfaceEnabled(bool enabled);
     static void setWebInterfacePassword(const QString &password);
     static void setWebInterfacePort(int port);
+    static void setWebInterfaceThreadCount(int count);
     static void setWebInterfaceUsername(const QString &username);
             
     static void setValue(const QString &key, const QVariant &value);
@@ -189,8 +235,13 @@ public Q_SLOTS:
 Q_SIGNALS:
     void categoriesChanged();
     void defaultCategoryChanged(const QString &category);
+    void compressArticlesChanged(bool enabled);
+    void maximumConcurrentCustomCommandsChanged(int maximum);
+    void customCommandNicenessChanged(int niceness);
+    void customCommandIdleIOEnabledChanged(bool enabled);
     void customTransferCommandChanged(const QString &command);
     void customTransferCommandEnabledChanged(bool enabled);
+    void downloadSegmentsChanged(int segments);
     void downloadPathChanged(const QString &path);
     void enableJavaScriptInBrowserChanged(bool enabled);
     void loggerFileNameChanged(const QString &fileName);
@@ -198,7 +249,10 @@ Q_SIGNALS:
     void maximumConcurrentTransfersChanged(int maximum);
     void networkProxyChanged();
     void networkProxyEnabledChanged(bool enabled);
+    void maximumDownloadSpeedChanged(int speed);
+    void categoryMaximumDownloadSpeedChanged(const QString &category, int speed);
     void offlineModeEnabledChanged(bool enabled);
+    void prefetchArticleMediaChanged(bool enabled);
     void readArticleExpiryChanged(int expiry);
     void startTransfersAutomaticallyChanged(bool enabled);
     void updateSubscriptionsOnStartupChanged(bool enabled);
@@ -206,6 +260,7 @@ Q_SIGNALS:
     void webInterfaceEnabledChanged(bool enabled);
     void webInterfacePasswordChanged(const QString &password);
     void webInterfacePortChanged(int port);
+    void webInterfaceThreadCountChanged(int count);
     void webInterfaceUsernameChanged(const QString &username);
 
 private:
@@ -14,15 +14,20 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include "bandwidthscheduler.h"
 #include "cutenews.h"
+#include "customcommandscheduler.h"
 #include "database.h"
 #include "dbconnection.h"
+#include "dbmaintenance.h"
 #include "dbnotify.h"
 #include "definitions.h"
 #include "eventfeed.h"
 #include "logger.h"
+#include "mediaprefetcher.h"
 #include "pluginmanager.h"
 #include "settings.h"
+#include "settingscache.h"
 #include "subscriptions.h"
 #include "transfers.h"
 #include "urlopenermodel.h"
@@ -55,12 +60,17 @@ Q_DECL_EXPORT int main(int argc, char *argv[]) {
     
     initDatabase();
     
+    QScopedPointer<SettingsCache> settingsCache(SettingsCache::instance());
     QScopedPointer<CuteNews> cutenews(CuteNews::instance());
     QScopedPointer<DBNotify> notify(DBNotify::instance());
     QScopedPointer<EventFeed> feed(EventFeed::instance());
     QScopedPointer<PluginManager> plugins(PluginManager::instance());
     QScopedPointer<Settings> settings(Settings::instance());
     QScopedPointer<Subscriptions> subscriptions(Subscriptions::instance());
+    QScopedPointer<DBMaintenance> maintenance(DBMaintenance::instance());
+    QScopedPointer<MediaPrefetcher> prefetcher(MediaPrefetcher::instance());
+    QScopedPointer<BandwidthScheduler> scheduler(BandwidthScheduler::instance());
+    QScopedPointer<CustomCommandScheduler> commandScheduler(CustomCommandScheduler::instance());
     QScopedPointer<Transfers> transfers(Transfers::instance());
     QScopedPointer<UrlOpenerModel> opener(UrlOpenerModel::instance());
     
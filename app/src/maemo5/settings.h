@@ -31,11 +31,19 @@ class Settings : public QObject
     Q_OBJECT
     
     Q_PROPERTY(QStringList categoryNames READ categoryNames NOTIFY categoriesChanged)
+    Q_PROPERTY(bool compressArticles READ compressArticles WRITE setCompressArticles NOTIFY compressArticlesChanged)
+    Q_PROPERTY(int maximumConcurrentCustomCommands READ maximumConcurrentCustomCommands
+               WRITE setMaximumConcurrentCustomCommands NOTIFY maximumConcurrentCustomCommandsChanged)
+    Q_PROPERTY(int customCommandNiceness READ customCommandNiceness WRITE setCustomCommandNiceness
+               NOTIFY customCommandNicenessChanged)
+    Q_PROPERTY(bool customCommandIdleIOEnabled READ customCommandIdleIOEnabled WRITE setCustomCommandIdleIOEnabled
+               NOTIFY customCommandIdleIOEnabledChanged)
     Q_PROPERTY(QString customTransferCommand READ customTransferCommand WRITE setCustomTransferCommand
                NOTIFY customTransferCommandChanged)
     Q_PROPERTY(bool customTransferCommandEnabled READ customTransferCommandEnabled
                WRITE setCustomTransferCommandEnabled NOTIFY customTransferCommandEnabledChanged)
     Q_PROPERTY(QString defaultCategory READ defaultCategory WRITE setDefaultCategory NOTIFY defaultCategoryChanged)
+    Q_PROPERTY(int downloadSegments READ downloadSegments WRITE setDownloadSegments NOTIFY downloadSegmentsChanged)
     Q_PROPERTY(QString downloadPath READ downloadPath WRITE setDownloadPath NOTIFY downloadPathChanged)
     Q_PROPERTY(bool enableAutomaticScrollingInWidget READ enableAutomaticScrollingInWidget
                WRITE setEnableAutomaticScrollingInWidget NOTIFY enableAutomaticScrollingInWidgetChanged)
@@ -57,10 +65,14 @@ class Settings : public QObject
     Q_PROPERTY(int networkProxyType READ networkProxyType WRITE setNetworkProxyType NOTIFY networkProxyChanged)
     Q_PROPERTY(QString networkProxyUsername READ networkProxyUsername WRITE setNetworkProxyUsername
                NOTIFY networkProxyChanged)
+    Q_PROPERTY(int maximumDownloadSpeed READ maximumDownloadSpeed WRITE setMaximumDownloadSpeed
+               NOTIFY maximumDownloadSpeedChanged)
     Q_PROPERTY(bool offlineModeEnabled READ offlineModeEnabled WRITE setOfflineModeEnabled
                NOTIFY offlineModeEnabledChanged)
     Q_PROPERTY(bool openArticlesExternallyFromWidget READ openArticlesExternallyFromWidget
                WRITE setOpenArticlesExternallyFromWidget NOTIFY openArticlesExternallyFromWidgetChanged)
+    Q_PROPERTY(bool prefetchArticleMedia READ prefetchArticleMedia WRITE setPrefetchArticleMedia
+               NOTIFY prefetchArticleMediaChanged)
     Q_PROPERTY(int readArticleExpiry READ readArticleExpiry WRITE setReadArticleExpiry
                NOTIFY readArticleExpiryChanged)
     Q_PROPERTY(int screenOrientation READ screenOrientation WRITE setScreenOrientation
@@ -136,11 +148,21 @@ public:
     static QList<Category> categories();
     static void setCategories(const QList<Category> &c);
     
+    static bool compressArticles();
+    
+    static int maximumConcurrentCustomCommands();
+    
+    static int customCommandNiceness();
+    
+    static bool customCommandIdleIOEnabled();
+    
     static QString customTransferCommand();
     static bool customTransferCommandEnabled();
     
     static QString defaultCategory();
     
+    static int downloadSegments();
+    
     static QString downloadPath();
     Q_INVOKABLE static QString downloadPath(const QString &category);
     
@@ -163,10 +185,15 @@ public:
     static int networkProxyType();
     static QString networkProxyUsername();
     
+    static int maximumDownloadSpeed();
+    Q_INVOKABLE static int maximumDownloadSpeed(const QString &category);
+    
     static bool offlineModeEnabled();
     
     static bool openArticlesExternallyFromWidget();
     
+    static bool prefetchArticleMedia();
+    
     static int readArticleExpiry();
 
     static int screenOrientation();
@@ -214,9 +241,19 @@ public Q_SLOTS:
     static void setDefaultCategory(const QString &category);
     static void removeCategory(const QString &name);
     
+    static void setCompressArticles(bool enabled);
+    
+    static void setMaximumConcurrentCustomCommands(int maximum);
+    
+    static void setCustomCommandNiceness(int niceness);
+    
+    static void setCustomCommandIdleIOEnabled(bool enabled);
+    
     static void setCustomTransferCommand(const QString &command);
     static void setCustomTransferCommandEnabled(bool enabled);
     
+    static void setDownloadSegments(int segments);
+    
     static void setDownloadPath(const QString &path);
     
     static void setEnableAutomaticScrollingInWidget(bool enabled);
@@ -239,10 +276,15 @@ public Q_SLOTS:
     static void setNetworkProxyType(int type);
     static void setNetworkProxyUsername(const QString &username);
     
+    static void setMaximumDownloadSpeed(int speed);
+    static void setMaximumDownloadSpeed(const QString &category, int speed);
+    
     static void setOfflineModeEnabled(bool enabled);
     
     static void setOpenArticlesExternallyFromWidget(bool enabled);
     
+    static void setPrefetchArticleMedia(bool enabled);
+    
     static void setReadArticleExpiry(int expiry);
     
     static void setScreenOrientation(int orientation);
@@ -288,8 +330,13 @@ public Q_SLOTS:
 Q_SIGNALS:
     void categoriesChanged();
     void defaultCategoryChanged(const QString &category);
+    void compressArticlesChanged(bool enabled);
+    void maximumConcurrentCustomCommandsChanged(int maximum);
+    void customCommandNicenessChanged(int niceness);
+    void customCommandIdleIOEnabledChanged(bool enabled);
     void customTransferCommandChanged(const QString &command);
     void customTransferCommandEnabledChanged(bool enabled);
+    void downloadSegmentsChanged(int segments);
     void downloadPathChanged(const QString &path);
     void enableAutomaticScrollingInWidgetChanged(bool enabled);
     void enableJavaScriptInBrowserChanged(bool enabled);
@@ -299,8 +346,11 @@ Q_SIGNALS:
     void maximumConcurrentTransfersChanged(int maximum);
     void networkProxyChanged();
     void networkProxyEnabledChanged(bool enabled);
+    void maximumDownloadSpeedChanged(int speed);
+    void categoryMaximumDownloadSpeedChanged(const QString &category, int speed);
     void offlineModeEnabledChanged(bool enabled);
     void openArticlesExternallyFromWidgetChanged(bool enabled);
+    void prefetchArticleMediaChanged(bool enabled);
     void readArticleExpiryChanged(int expiry);
     void screenOrientationChanged(int orientation);
     void startTransfersAutomaticallyChanged(bool enabled);
@@ -0,0 +1,227 @@
+/*
+ * Copyright (C) 2017 Stuart Howarth <showarth@marxoft.co.uk>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "cachedarticlerequest.h"
+#include "feedplugin.h"
+#include "logger.h"
+#include "metrics.h"
+
+// Results are kept for ten minutes, and for at most 50 articles
+static const int ARTICLE_CACHE_EXPIRY = 600;
+static const int ARTICLE_CACHE_SIZE = 50;
+
+CachedArticleRequest::CachedArticleRequest(FeedPlugin *plugin, const QString &pluginId, ArticleRequestCache *cache,
+                                           QObject *parent) :
+    ArticleRequest(parent),
+    m_plugin(plugin),
+    m_pluginId(pluginId),
+    m_cache(cache),
+    m_status(Idle)
+{
+}
+
+CachedArticleRequest::~CachedArticleRequest() {
+    if (m_cache) {
+        m_cache->removeRequest(this);
+    }
+}
+
+QString CachedArticleRequest::errorString() const {
+    return m_errorString;
+}
+
+void CachedArticleRequest::setErrorString(const QString &e) {
+    m_errorString = e;
+}
+
+ArticleResult CachedArticleRequest::result() const {
+    return m_result;
+}
+
+void CachedArticleRequest::setResult(const ArticleResult &r) {
+    m_result = r;
+}
+
+ArticleRequest::Status CachedArticleRequest::status() const {
+    return m_status;
+}
+
+void CachedArticleRequest::setStatus(ArticleRequest::Status s) {
+    if (s != status()) {
+        m_status = s;
+        emit statusChanged(s);
+    }
+}
+
+bool CachedArticleRequest::cancel() {
+    if (status() != Active) {
+        return false;
+    }
+    
+    if (m_cache) {
+        m_cache->removeRequest(this);
+    }
+    
+    finish(Canceled, ArticleResult(), QString());
+    return true;
+}
+
+bool CachedArticleRequest::getArticle(const QString &url, const QVariantMap &settings) {
+    if (status() == Active) {
+        return false;
+    }
+    
+    setErrorString(QString());
+    setResult(ArticleResult());
+    setStatus(Active);
+    ArticleResult cached;
+    
+    // Results that are not fetched by the plugin are reported asynchronously, in the same way
+    if ((m_cache) && (m_cache->result(url, cached))) {
+        Logger::log("CachedArticleRequest::getArticle(). Using cached result for " + url, Logger::HighVerbosity);
+        setResult(cached);
+    }
+    else if ((!m_cache) || (!m_cache->addRequest(this, m_plugin, m_pluginId, url, settings))) {
+        setErrorString(tr("Plugin cannot fetch article %1").arg(url));
+    }
+    else {
+        return true;
+    }
+    
+    QMetaObject::invokeMethod(this, "onQueuedFinish", Qt::QueuedConnection);
+    return true;
+}
+
+void CachedArticleRequest::finish(Status s, const ArticleResult &r, const QString &e) {
+    setErrorString(e);
+    setResult(r);
+    setStatus(s);
+    emit finished(this);
+}
+
+void CachedArticleRequest::onQueuedFinish() {
+    // The request may have been canceled in the meantime
+    if (status() == Active) {
+        finish(errorString().isEmpty() ? Ready : Error, result(), errorString());
+    }
+}
+
+ArticleRequestCache::ArticleRequestCache(QObject *parent) :
+    QObject(parent),
+    m_results(ARTICLE_CACHE_SIZE)
+{
+}
+
+bool ArticleRequestCache::result(const QString &url, ArticleResult &result) {
+    if (const CachedResult *cached = m_results.object(url)) {
+        if (cached->expiryDate > QDateTime::currentDateTime()) {
+            result = cached->result;
+            return true;
+        }
+        
+        m_results.remove(url);
+    }
+    
+    return false;
+}
+
+bool ArticleRequestCache::addRequest(CachedArticleRequest *request, FeedPlugin *plugin, const QString &pluginId,
+                                     const QString &url, const QVariantMap &settings) {
+    if (m_pending.contains(url)) {
+        Logger::log("ArticleRequestCache::addRequest(). Waiting for active request for " + url,
+                    Logger::HighVerbosity);
+        m_pending[url].waiting << request;
+        return true;
+    }
+    
+    ArticleRequest *pluginRequest = plugin ? plugin->articleRequest(this) : 0;
+    
+    if (!pluginRequest) {
+        return false;
+    }
+    
+    PendingRequest pending;
+    pending.request = pluginRequest;
+    pending.waiting << request;
+    m_pending.insert(url, pending);
+    pluginRequest->setProperty("url", url);
+    connect(pluginRequest, SIGNAL(finished(ArticleRequest*)),
+            new MetricsTimer(Metrics::PluginRequestDuration, pluginId, pluginRequest), SLOT(finish()));
+    connect(pluginRequest, SIGNAL(finished(ArticleRequest*)), this, SLOT(onRequestFinished(ArticleRequest*)));
+    
+    if (!pluginRequest->getArticle(url, settings)) {
+        m_pending.remove(url);
+        pluginRequest->deleteLater();
+        return false;
+    }
+    
+    return true;
+}
+
+void ArticleRequestCache::removeRequest(CachedArticleRequest *request) {
+    QMutableHashIterator<QString, PendingRequest> iterator(m_pending);
+    
+    while (iterator.hasNext()) {
+        iterator.next();
+        PendingRequest &pending = iterator.value();
+        
+        if (pending.waiting.removeOne(request)) {
+            // The plugin request is canceled only when no other request is waiting for it
+            if (pending.waiting.isEmpty()) {
+                disconnect(pending.request, 0, this, 0);
+                pending.request->cancel();
+                pending.request->deleteLater();
+                iterator.remove();
+            }
+            
+            return;
+        }
+    }
+}
+
+void ArticleRequestCache::clear() {
+    m_results.clear();
+}
+
+void ArticleRequestCache::onRequestFinished(ArticleRequest *request) {
+    const QString url = request->property("url").toString();
+    // The waiting requests may be deleted when finished, including by the receivers of one another
+    QList< QPointer<CachedArticleRequest> > waiting;
+    
+    foreach (CachedArticleRequest *r, m_pending.take(url).waiting) {
+        waiting << r;
+    }
+    
+    const ArticleRequest::Status status = request->status();
+    const ArticleResult result = request->result();
+    const QString errorString = request->errorString();
+    request->deleteLater();
+    
+    // Errors are not cached, so that the article is fetched again next time
+    if (status == ArticleRequest::Ready) {
+        CachedResult *cached = new CachedResult;
+        cached->result = result;
+        cached->expiryDate = QDateTime::currentDateTime().addSecs(ARTICLE_CACHE_EXPIRY);
+        m_results.insert(url, cached);
+    }
+    
+    foreach (const QPointer<CachedArticleRequest> &r, waiting) {
+        if (r) {
+            r->finish(status, result, errorString);
+        }
+    }
+}
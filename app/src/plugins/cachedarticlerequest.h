@@ -0,0 +1,123 @@
+/*
+ * Copyright (C) 2017 Stuart Howarth <showarth@marxoft.co.uk>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef CACHEDARTICLEREQUEST_H
+#define CACHEDARTICLEREQUEST_H
+
+#include "articlerequest.h"
+#include <QCache>
+#include <QHash>
+#include <QPointer>
+
+class ArticleRequestCache;
+class FeedPlugin;
+
+/**
+ * An ArticleRequest that is answered from the ArticleRequestCache.
+ *
+ * Returned by PluginManager::articleRequest(), so that re-opening an article, or opening it from
+ * several clients at once, does not fetch it from the plugin each time.
+ */
+class CachedArticleRequest : public ArticleRequest
+{
+    Q_OBJECT
+
+public:
+    explicit CachedArticleRequest(FeedPlugin *plugin, const QString &pluginId, ArticleRequestCache *cache,
+                                  QObject *parent = 0);
+    ~CachedArticleRequest();
+    
+    virtual QString errorString() const;
+    
+    virtual ArticleResult result() const;
+    
+    virtual Status status() const;
+
+public Q_SLOTS:
+    virtual bool cancel();
+    virtual bool getArticle(const QString &url, const QVariantMap &settings);
+
+private Q_SLOTS:
+    void onQueuedFinish();
+
+private:
+    void setErrorString(const QString &e);
+    
+    void setResult(const ArticleResult &r);
+    
+    void setStatus(Status s);
+    
+    void finish(Status s, const ArticleResult &r, const QString &e);
+    
+    FeedPlugin *m_plugin;
+    QString m_pluginId;
+    
+    QPointer<ArticleRequestCache> m_cache;
+    
+    QString m_errorString;
+    
+    ArticleResult m_result;
+    
+    Status m_status;
+    
+    friend class ArticleRequestCache;
+};
+
+/**
+ * Keeps the results of article requests for a limited time, keyed by article URL.
+ *
+ * Only one request is made to the plugin for a URL at a time. Any CachedArticleRequest for the
+ * same URL made while it is active receives the same result.
+ */
+class ArticleRequestCache : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ArticleRequestCache(QObject *parent = 0);
+    
+    bool result(const QString &url, ArticleResult &result);
+    
+    bool addRequest(CachedArticleRequest *request, FeedPlugin *plugin, const QString &pluginId,
+                    const QString &url, const QVariantMap &settings);
+    void removeRequest(CachedArticleRequest *request);
+
+public Q_SLOTS:
+    void clear();
+
+private Q_SLOTS:
+    void onRequestFinished(ArticleRequest *request);
+
+private:
+    struct CachedResult
+    {
+        ArticleResult result;
+        QDateTime expiryDate;
+    };
+    
+    struct PendingRequest
+    {
+        ArticleRequest *request;
+        QList<CachedArticleRequest*> waiting;
+    };
+    
+    QCache<QString, CachedResult> m_results;
+    
+    QHash<QString, PendingRequest> m_pending;
+};
+
+#endif // CACHEDARTICLEREQUEST_H
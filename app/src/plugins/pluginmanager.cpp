@@ -16,10 +16,12 @@
  */
 
 #include "pluginmanager.h"
+#include "cachedarticlerequest.h"
 #include "definitions.h"
 #include "externalfeedplugin.h"
 #include "javascriptfeedplugin.h"
 #include "logger.h"
+#include "metrics.h"
 #include <QDir>
 #include <QFileInfo>
 #include <QPluginLoader>
@@ -32,8 +34,10 @@ PluginManager* PluginManager::self = 0;
 
 PluginManager::PluginManager() :
     QObject(),
+    m_articleCache(new ArticleRequestCache(this)),
     m_lastLoaded(QDateTime::fromTime_t(0))
 {
+    connect(this, SIGNAL(loaded(int)), m_articleCache, SLOT(clear()));
 }
 
 PluginManager::~PluginManager() {
@@ -156,8 +160,11 @@ bool PluginManager::articleIsSupported(const QString &url) const {
 }
 
 ArticleRequest* PluginManager::articleRequest(const QString &url, QObject *parent) const {
-    if (FeedPlugin *plugin = getPluginForArticle(url)) {
-        return plugin->articleRequest(parent);
+    // Requests are made via the cache, so that results are reused and concurrent requests are combined
+    if (const FeedPluginConfig *config = getConfigForArticle(url)) {
+        if (FeedPlugin *plugin = getPlugin(config->id())) {
+            return new CachedArticleRequest(plugin, config->id(), m_articleCache, parent);
+        }
     }
 
     return 0;
@@ -177,8 +184,17 @@ bool PluginManager::enclosureIsSupported(const QString &url) const {
 }
 
 EnclosureRequest* PluginManager::enclosureRequest(const QString &url, QObject *parent) const {
-    if (FeedPlugin *plugin = getPluginForEnclosure(url)) {
-        return plugin->enclosureRequest(parent);
+    if (const FeedPluginConfig *config = getConfigForEnclosure(url)) {
+        if (FeedPlugin *plugin = getPlugin(config->id())) {
+            EnclosureRequest *request = plugin->enclosureRequest(parent);
+            
+            if (request) {
+                connect(request, SIGNAL(finished(EnclosureRequest*)),
+                        new MetricsTimer(Metrics::PluginRequestDuration, config->id(), request), SLOT(finish()));
+            }
+            
+            return request;
+        }
     }
 
     return 0;
@@ -186,7 +202,14 @@ EnclosureRequest* PluginManager::enclosureRequest(const QString &url, QObject *p
 
 FeedRequest* PluginManager::feedRequest(const QString &id, QObject *parent) const {
     if (FeedPlugin *plugin = getPlugin(id)) {
-        return plugin->feedRequest(parent);
+        FeedRequest *request = plugin->feedRequest(parent);
+        
+        if (request) {
+            connect(request, SIGNAL(finished(FeedRequest*)),
+                    new MetricsTimer(Metrics::PluginRequestDuration, id, request), SLOT(finish()));
+        }
+        
+        return request;
     }
 
     return 0;
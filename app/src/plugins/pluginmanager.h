@@ -21,6 +21,8 @@
 #include "feedplugin.h"
 #include "feedpluginconfig.h"
 
+class ArticleRequestCache;
+
 struct FeedPluginPair
 {
     FeedPluginPair(FeedPluginConfig *c, FeedPlugin* p) :
@@ -76,6 +78,8 @@ private:
 
     static PluginManager *self;
 
+    ArticleRequestCache *m_articleCache;
+
     QDateTime m_lastLoaded;
 
     FeedPluginList m_plugins;
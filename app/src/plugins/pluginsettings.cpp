@@ -16,7 +16,7 @@
 
 #include "pluginsettings.h"
 #include "definitions.h"
-#include <QSettings>
+#include "settingscache.h"
 
 PluginSettings::PluginSettings(QObject *parent) :
     QObject(parent)
@@ -42,10 +42,8 @@ void PluginSettings::setPluginId(const QString &id) {
 
 bool PluginSettings::remove(const QString &key) {
     if ((!pluginId().isEmpty()) && (key != value(key))) {
-        QSettings settings(PLUGIN_CONFIG_PATH + pluginId(), QSettings::IniFormat);
-
-        if (settings.contains(key)) {
-            settings.remove(key);
+        if (SettingsCache::instance()->contains(PLUGIN_CONFIG_PATH + pluginId(), key)) {
+            SettingsCache::instance()->remove(PLUGIN_CONFIG_PATH + pluginId(), key);
             emit changed();
             return true;
         }
@@ -59,7 +57,7 @@ QVariant PluginSettings::value(const QString &key, const QVariant &defaultValue)
         return QVariant();
     }
     
-    const QVariant v = QSettings(PLUGIN_CONFIG_PATH + pluginId(), QSettings::IniFormat).value(key, defaultValue);
+    const QVariant v = SettingsCache::instance()->value(PLUGIN_CONFIG_PATH + pluginId(), key, defaultValue);
     
     if (v.type() == QVariant::String) {
         if ((v == "true") || (v == "false")) {
@@ -75,7 +73,7 @@ QVariant PluginSettings::value(const QString &key, const QVariant &defaultValue)
 
 void PluginSettings::setValue(const QString &key, const QVariant &value) {
     if ((!pluginId().isEmpty()) && (key != this->value(key))) {
-        QSettings(PLUGIN_CONFIG_PATH + pluginId(), QSettings::IniFormat).setValue(key, value);
+        SettingsCache::instance()->setValue(PLUGIN_CONFIG_PATH + pluginId(), key, value);
         emit changed();
     }
 }
@@ -84,11 +82,7 @@ QVariantMap PluginSettings::values() const {
     QVariantMap map;
 
     if (!pluginId().isEmpty()) {
-        const QSettings settings(PLUGIN_CONFIG_PATH + pluginId(), QSettings::IniFormat);
-        
-        foreach (const QString &key, settings.allKeys()) {
-            map[key] = settings.value(key);
-        }
+        map = SettingsCache::instance()->values(PLUGIN_CONFIG_PATH + pluginId());
     }
 
     return map;
@@ -99,11 +93,11 @@ void PluginSettings::setValues(const QVariantMap &values) {
         return;
     }
 
-    QSettings settings(PLUGIN_CONFIG_PATH + pluginId(), QSettings::IniFormat);
     QMapIterator<QString, QVariant> iterator(values);
 
     while (iterator.hasNext()) {
-        settings.setValue(iterator.key(), iterator.value());
+        iterator.next();
+        SettingsCache::instance()->setValue(PLUGIN_CONFIG_PATH + pluginId(), iterator.key(), iterator.value());
     }
 
     emit changed();
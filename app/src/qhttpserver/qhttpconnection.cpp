@@ -23,6 +23,7 @@
 #include "qhttpconnection.h"
 
 #include <QTcpSocket>
+#include <QThread>
 #include <QHostAddress>
 
 #include "http_parser.h"
@@ -31,15 +32,25 @@
 
 /// @cond nodoc
 
+static const int READ_BUFFER_SIZE = 16384;
+static const int MAX_PIPELINED_REQUESTS = 16;
+static const int REQUEST_READ_TIMEOUT = 30000;
+
 QHttpConnection::QHttpConnection(QTcpSocket *socket, QObject *parent)
     : QObject(parent),
       m_socket(socket),
       m_parser(0),
       m_parserSettings(0),
       m_request(0),
+      m_closing(false),
       m_transmitLen(0),
       m_transmitPos(0)
 {
+    m_readBuffer.resize(READ_BUFFER_SIZE);
+    m_idleTimer.setSingleShot(true);
+    m_readTimer.setSingleShot(true);
+    m_readTimer.setInterval(REQUEST_READ_TIMEOUT);
+
     m_parser = (http_parser *)malloc(sizeof(http_parser));
     http_parser_init(m_parser, HTTP_REQUEST);
 
@@ -57,6 +68,9 @@ QHttpConnection::QHttpConnection(QTcpSocket *socket, QObject *parent)
     connect(socket, SIGNAL(readyRead()), this, SLOT(parseRequest()));
     connect(socket, SIGNAL(disconnected()), this, SLOT(socketDisconnected()));
     connect(socket, SIGNAL(bytesWritten(qint64)), this, SLOT(updateWriteCount(qint64)));
+    connect(&m_idleTimer, SIGNAL(timeout()), this, SLOT(close()));
+    connect(&m_readTimer, SIGNAL(timeout()), this, SLOT(readTimedOut()));
+    m_idleTimer.start();
 }
 
 QHttpConnection::~QHttpConnection()
@@ -98,13 +112,79 @@ void QHttpConnection::updateWriteCount(qint64 count)
     }
 }
 
+bool QHttpConnection::isIdle() const
+{
+    return !m_closing && m_responses.isEmpty() && !m_readTimer.isActive() &&
+           m_idleTimer.isActive();
+}
+
+void QHttpConnection::close()
+{
+    m_closing = true;
+    m_idleTimer.stop();
+    m_readTimer.stop();
+    m_socket->disconnectFromHost();
+}
+
+void QHttpConnection::readTimedOut()
+{
+    // The client has not sent a complete request in time
+    if (m_responses.isEmpty()) {
+        m_socket->write("HTTP/1.1 408 Request Timeout\r\n"
+                        "Connection: close\r\n"
+                        "Content-Length: 0\r\n\r\n");
+    }
+
+    close();
+}
+
+void QHttpConnection::setIdleTimeout(int msecs)
+{
+    m_idleTimer.setInterval(msecs);
+}
+
+void QHttpConnection::releaseRequest(QHttpRequest *request)
+{
+    Q_ASSERT(QThread::currentThread() == thread());
+
+    if (m_request == request)
+        m_request = 0;
+
+    for (int i = 0; i < m_responses.size(); ++i) {
+        if (m_responses.at(i).request == request)
+            m_responses[i].request = 0;
+    }
+}
+
 void QHttpConnection::parseRequest()
 {
     Q_ASSERT(m_parser);
 
-    while (m_socket->bytesAvailable()) {
-        QByteArray arr = m_socket->readAll();
-        http_parser_execute(m_parser, m_parserSettings, arr.constData(), arr.size());
+    // Stop reading while too many pipelined requests are awaiting their responses. The
+    // remaining data is parsed once they have been written.
+    while (!m_closing && m_responses.size() < MAX_PIPELINED_REQUESTS &&
+           m_socket->bytesAvailable() > 0) {
+        const qint64 bytes = m_socket->read(m_readBuffer.data(), m_readBuffer.size());
+
+        if (bytes <= 0)
+            break;
+
+        const size_t parsed =
+            http_parser_execute(m_parser, m_parserSettings, m_readBuffer.constData(), bytes);
+
+        if (m_closing)
+            return;
+
+        if (parsed != size_t(bytes) || HTTP_PARSER_ERRNO(m_parser) != HPE_OK) {
+            if (m_responses.isEmpty()) {
+                m_socket->write("HTTP/1.1 400 Bad Request\r\n"
+                                "Connection: close\r\n"
+                                "Content-Length: 0\r\n\r\n");
+            }
+
+            close();
+            return;
+        }
     }
 }
 
@@ -114,16 +194,87 @@ void QHttpConnection::write(const QByteArray &data)
     m_transmitLen += data.size();
 }
 
+void QHttpConnection::writeResponseData(QObject *response, const QByteArray &data)
+{
+    if (m_closing)
+        return;
+
+    if (!m_responses.isEmpty() && m_responses.first().response == response) {
+        write(data);
+        return;
+    }
+
+    for (int i = 1; i < m_responses.size(); ++i) {
+        if (m_responses.at(i).response == response && !m_responses.at(i).done) {
+            m_responses[i].data.append(data);
+            return;
+        }
+    }
+}
+
 void QHttpConnection::flush()
 {
     m_socket->flush();
 }
 
-void QHttpConnection::responseDone()
+void QHttpConnection::writePendingResponses()
+{
+    while (!m_closing && !m_responses.isEmpty()) {
+        PendingResponse &head = m_responses.first();
+
+        if (!head.data.isEmpty()) {
+            write(head.data);
+            head.data.clear();
+        }
+
+        // The head response now writes straight to the socket until it is done
+        if (!head.done)
+            return;
+
+        const bool last = head.last;
+        m_responses.removeFirst();
+
+        if (last) {
+            m_responses.clear();
+            close();
+            return;
+        }
+    }
+
+    if (!m_closing) {
+        // A partly received request is covered by the read timeout instead
+        if (!m_readTimer.isActive())
+            m_idleTimer.start();
+
+        if (m_socket->bytesAvailable() > 0)
+            QMetaObject::invokeMethod(this, "parseRequest", Qt::QueuedConnection);
+    }
+}
+
+void QHttpConnection::finishResponse(QObject *response, bool last)
 {
-    QHttpResponse *response = qobject_cast<QHttpResponse *>(QObject::sender());
-    if (response->m_last)
-        m_socket->disconnectFromHost();
+    for (int i = 0; i < m_responses.size(); ++i) {
+        PendingResponse &pending = m_responses[i];
+
+        if (pending.response != response || pending.done)
+            continue;
+
+        pending.done = true;
+        pending.last = last;
+
+        // Requests are parented to the connection, so release them once answered
+        // rather than keeping them for the lifetime of a persistent connection.
+        if (QHttpRequest *request = pending.request) {
+            if (request->successful())
+                request->deleteLater();
+            else
+                connect(request, SIGNAL(end()), request, SLOT(deleteLater()));
+        }
+
+        break;
+    }
+
+    writePendingResponses();
 }
 
 /* URL Utilities */
@@ -170,7 +321,18 @@ QUrl createUrl(const char *urlData, const http_parser_url &urlInfo)
 int QHttpConnection::MessageBegin(http_parser *parser)
 {
     QHttpConnection *theConnection = static_cast<QHttpConnection *>(parser->data);
+
+    // Ignore anything pipelined after a response that closes the connection
+    if (theConnection->m_closing)
+        return -1;
+
+    // Unlike the idle timeout, the read timeout is not restarted as data arrives, so a
+    // client cannot hold the connection by sending the request a byte at a time.
+    theConnection->m_idleTimer.stop();
+    theConnection->m_readTimer.start();
     theConnection->m_currentHeaders.clear();
+    theConnection->m_currentHeaderField.clear();
+    theConnection->m_currentHeaderValue.clear();
     theConnection->m_currentUrl.clear();
     theConnection->m_currentUrl.reserve(128);
 
@@ -212,11 +374,18 @@ int QHttpConnection::HeadersComplete(http_parser *parser)
     theConnection->m_request->m_remotePort = theConnection->m_socket->peerPort();
 
     QHttpResponse *response = new QHttpResponse(theConnection);
-    if (parser->http_major < 1 || parser->http_minor < 1)
-        response->m_keepAlive = false;
+    // Honours "Connection: close" from HTTP/1.1 clients and "Connection: keep-alive" from
+    // HTTP/1.0 clients
+    response->m_keepAlive = http_should_keep_alive(parser);
+
+    PendingResponse pending;
+    pending.response = response;
+    pending.request = theConnection->m_request;
+    pending.done = false;
+    pending.last = false;
+    theConnection->m_responses.append(pending);
 
     connect(theConnection, SIGNAL(destroyed()), response, SLOT(connectionClosed()));
-    connect(response, SIGNAL(done()), theConnection, SLOT(responseDone()));
 
     // we are good to go!
     emit theConnection->newRequest(theConnection->m_request, response);
@@ -225,10 +394,15 @@ int QHttpConnection::HeadersComplete(http_parser *parser)
 
 int QHttpConnection::MessageComplete(http_parser *parser)
 {
-    // TODO: do cleanup and prepare for next request
     QHttpConnection *theConnection = static_cast<QHttpConnection *>(parser->data);
     Q_ASSERT(theConnection->m_request);
 
+    theConnection->m_readTimer.stop();
+
+    // The response may already have been written while the body was being read
+    if (theConnection->m_responses.isEmpty())
+        theConnection->m_idleTimer.start();
+
     theConnection->m_request->setSuccessful(true);
     emit theConnection->m_request->end();
     return 0;
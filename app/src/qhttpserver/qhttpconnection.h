@@ -27,6 +27,8 @@
 #include "qhttpserverfwd.h"
 
 #include <QObject>
+#include <QPointer>
+#include <QTimer>
 
 /// @cond nodoc
 
@@ -38,6 +40,17 @@ public:
     QHttpConnection(QTcpSocket *socket, QObject *parent = 0);
     virtual ~QHttpConnection();
 
+    /// Whether the connection is open with no requests in progress.
+    bool isIdle() const;
+
+    /// Close the connection once all pending data has been written.
+    void close();
+
+    void setIdleTimeout(int msecs);
+
+    /// Stop referring to a request that is handled elsewhere. See QHttpRequest::detach().
+    void releaseRequest(QHttpRequest *request);
+
     void write(const QByteArray &data);
     void flush();
 
@@ -47,7 +60,10 @@ signals:
 
 private slots:
     void parseRequest();
-    void responseDone();
+    void readTimedOut();
+    // Connected to the signals of responses, which may be handled in another thread.
+    void writeResponseData(QObject *response, const QByteArray &data);
+    void finishResponse(QObject *response, bool last);
     void socketDisconnected();
     void updateWriteCount(qint64);
 
@@ -61,12 +77,31 @@ private:
     static int MessageComplete(http_parser *parser);
 
 private:
+    // Responses are written in request order, so the responses to pipelined
+    // requests are buffered until those before them have finished.
+    struct PendingResponse
+    {
+        QHttpResponse *response;
+        QPointer<QHttpRequest> request;
+        QByteArray data;
+        bool done;
+        bool last;
+    };
+
+    void writePendingResponses();
+
     QTcpSocket *m_socket;
     http_parser *m_parser;
     http_parser_settings *m_parserSettings;
 
     // Since there can only be one request at any time even with pipelining.
-    QHttpRequest *m_request;
+    QPointer<QHttpRequest> m_request;
+
+    QList<PendingResponse> m_responses;
+    QByteArray m_readBuffer;
+    QTimer m_idleTimer;
+    QTimer m_readTimer;
+    bool m_closing;
 
     QByteArray m_currentUrl;
     // The ones we are reading in from the parser
@@ -89,6 +89,14 @@ void QHttpRequest::storeBody()
 #endif
 }
 
+void QHttpRequest::detach()
+{
+    if (m_connection) {
+        m_connection->releaseRequest(this);
+        m_connection = 0;
+    }
+}
+
 QString QHttpRequest::MethodToString(HttpMethod method)
 {
     int index = staticMetaObject.indexOfEnumerator("HttpMethod");
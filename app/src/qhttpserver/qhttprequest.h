@@ -163,6 +163,13 @@ public:
         @sa data() body() */
     void storeBody();
 
+    /// Releases the request from its connection.
+    /** The connection no longer refers to the request or deletes it once it
+        has been answered, so deleting it becomes the responsibility of the caller.
+        This must be called in the thread of the connection, e.g. before the
+        request is moved to another thread. */
+    void detach();
+
 signals:
     /// Emitted when new body data has been received.
     /** @note This may be emitted zero or more times
@@ -43,6 +43,12 @@ QHttpResponse::QHttpResponse(QHttpConnection *connection)
       m_finished(false)
 {
    connect(m_connection, SIGNAL(allBytesWritten()), this, SIGNAL(allBytesWritten()));
+   // The connection is not touched directly, since it may be closed and deleted in its own
+   // thread while the response is handled in another. Signals are queued to the connection's
+   // thread when needed, and are disconnected when it is destroyed.
+   connect(this, SIGNAL(dataWritten(QObject*, QByteArray)),
+           m_connection, SLOT(writeResponseData(QObject*, QByteArray)));
+   connect(this, SIGNAL(finished(QObject*, bool)), m_connection, SLOT(finishResponse(QObject*, bool)));
 }
 
 QHttpResponse::~QHttpResponse()
@@ -57,13 +63,18 @@ void QHttpResponse::setHeader(const QString &field, const QString &value)
         qWarning() << "QHttpResponse::setHeader() Cannot set headers after response has finished.";
 }
 
+void QHttpResponse::writeData(const QByteArray &data)
+{
+    emit dataWritten(this, data);
+}
+
 void QHttpResponse::writeHeader(const char *field, const QString &value)
 {
     if (!m_finished) {
-        m_connection->write(field);
-        m_connection->write(": ");
-        m_connection->write(value.toUtf8());
-        m_connection->write("\r\n");
+        writeData(field);
+        writeData(": ");
+        writeData(value.toUtf8());
+        writeData("\r\n");
     } else
         qWarning()
             << "QHttpResponse::writeHeader() Cannot write headers after response has finished.";
@@ -133,10 +144,9 @@ void QHttpResponse::writeHead(int status)
         return;
     }
 
-    m_connection->write(
-        QString("HTTP/1.1 %1 %2\r\n").arg(status).arg(STATUS_CODES[status]).toLatin1());
+    writeData(QString("HTTP/1.1 %1 %2\r\n").arg(status).arg(STATUS_CODES[status]).toLatin1());
     writeHeaders();
-    m_connection->write("\r\n");
+    writeData("\r\n");
 
     m_headerWritten = true;
 }
@@ -158,7 +168,7 @@ void QHttpResponse::write(const QByteArray &data)
         return;
     }
 
-    m_connection->write(data);
+    writeData(data);
 }
 
 void QHttpResponse::end(const QByteArray &data)
@@ -172,6 +182,8 @@ void QHttpResponse::end(const QByteArray &data)
         write(data);
     m_finished = true;
 
+    emit finished(this, m_last);
+
     emit done();
 
     /// @todo End connection and delete ourselves. Is this a still valid note?
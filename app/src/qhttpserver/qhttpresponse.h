@@ -27,6 +27,7 @@
 #include "qhttpserverfwd.h"
 
 #include <QObject>
+#include <QPointer>
 
 /// The QHttpResponse class handles sending data back to the client as a response to a request.
 /** The steps to respond correctly are
@@ -77,6 +78,7 @@ public:
         STATUS_REQUEST_UNSUPPORTED_MEDIA_TYPE = 415,
         STATUS_REQUESTED_RANGE_NOT_SATISFIABLE = 416,
         STATUS_EXPECTATION_FAILED = 417,
+        STATUS_TOO_MANY_REQUESTS = 429,
         STATUS_INTERNAL_SERVER_ERROR = 500,
         STATUS_NOT_IMPLEMENTED = 501,
         STATUS_BAD_GATEWAY = 502,
@@ -137,13 +139,21 @@ signals:
         has already been scheduled for deletion. */
     void done();
 
+    /// @cond nodoc
+    void dataWritten(QObject *response, const QByteArray &data);
+    void finished(QObject *response, bool last);
+    /// @endcond
+
 private:
     QHttpResponse(QHttpConnection *connection);
 
+    void writeData(const QByteArray &data);
     void writeHeaders();
     void writeHeader(const char *field, const QString &value);
 
-    QHttpConnection *m_connection;
+    // The response may be handled in another thread than its connection, which
+    // can be closed in the meantime.
+    QPointer<QHttpConnection> m_connection;
 
     HeaderHash m_headers;
 
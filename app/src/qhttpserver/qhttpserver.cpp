@@ -24,14 +24,48 @@
 
 #include <QTcpServer>
 #include <QTcpSocket>
+#include <QThread>
 #include <QVariant>
 #include <QDebug>
 
-#include "qhttpconnection.h"
+#include "qhttpworker.h"
 
 QHash<int, QString> STATUS_CODES;
 
-QHttpServer::QHttpServer(QObject *parent) : QObject(parent), m_tcpServer(0)
+/// @cond nodoc
+
+// Hands accepted socket descriptors to the server, so that the sockets can be
+// created in the thread of the worker that handles them.
+class QHttpTcpServer : public QTcpServer
+{
+public:
+    QHttpTcpServer(QHttpServer *server) : QTcpServer(server), m_server(server)
+    {
+    }
+
+protected:
+#if QT_VERSION >= QT_VERSION_CHECK(5, 0, 0)
+    void incomingConnection(qintptr socketDescriptor)
+#else
+    void incomingConnection(int socketDescriptor)
+#endif
+    {
+        m_server->incomingConnection(socketDescriptor);
+    }
+
+private:
+    QHttpServer *m_server;
+};
+
+/// @endcond
+
+QHttpServer::QHttpServer(QObject *parent)
+    : QObject(parent),
+      m_tcpServer(0),
+      m_maxConnections(32),
+      m_keepAliveTimeout(15000),
+      m_threadCount(0),
+      m_nextWorker(0)
 {
 #define STATUS_CODE(num, reason) STATUS_CODES.insert(num, reason);
     // {{{
@@ -77,6 +111,7 @@ QHttpServer::QHttpServer(QObject *parent) : QObject(parent), m_tcpServer(0)
     STATUS_CODE(424, "Failed Dependency")    // RFC 4918
     STATUS_CODE(425, "Unordered Collection") // RFC 4918
     STATUS_CODE(426, "Upgrade Required")     // RFC 2817
+    STATUS_CODE(429, "Too Many Requests")    // RFC 6585
     STATUS_CODE(500, "Internal Server Error")
     STATUS_CODE(501, "Not Implemented")
     STATUS_CODE(502, "Bad Gateway")
@@ -92,6 +127,7 @@ QHttpServer::QHttpServer(QObject *parent) : QObject(parent), m_tcpServer(0)
 
 QHttpServer::~QHttpServer()
 {
+    stopWorkers();
 }
 
 QHostAddress QHttpServer::serverAddress() const
@@ -106,31 +142,113 @@ qint16 QHttpServer::serverPort() const
     return m_tcpServer->serverPort();
 }
 
-void QHttpServer::newConnection()
+int QHttpServer::maxConnections() const
 {
-    Q_ASSERT(m_tcpServer);
+    return m_maxConnections;
+}
 
-    while (m_tcpServer->hasPendingConnections()) {
-        QHttpConnection *connection =
-            new QHttpConnection(m_tcpServer->nextPendingConnection(), this);
-        connect(connection, SIGNAL(newRequest(QHttpRequest *, QHttpResponse *)), this,
-                SIGNAL(newRequest(QHttpRequest *, QHttpResponse *)));
-    }
+void QHttpServer::setMaxConnections(int maximum)
+{
+    m_maxConnections = qMax(1, maximum);
+    const int perWorker = qMax(1, m_maxConnections / qMax(1, m_workers.size()));
+
+    foreach (QHttpWorker *worker, m_workers)
+        QMetaObject::invokeMethod(worker, "setMaxConnections", Q_ARG(int, perWorker));
 }
 
-bool QHttpServer::listen(const QHostAddress &address, quint16 port)
+int QHttpServer::keepAliveTimeout() const
+{
+    return m_keepAliveTimeout;
+}
+
+void QHttpServer::setKeepAliveTimeout(int msecs)
+{
+    m_keepAliveTimeout = msecs;
+
+    foreach (QHttpWorker *worker, m_workers)
+        QMetaObject::invokeMethod(worker, "setKeepAliveTimeout", Q_ARG(int, msecs));
+}
+
+int QHttpServer::threadCount() const
+{
+    return m_threadCount;
+}
+
+void QHttpServer::setThreadCount(int count)
 {
-    Q_ASSERT(!m_tcpServer);
-    m_tcpServer = new QTcpServer(this);
+    m_threadCount = qMax(0, count);
+}
 
-    bool couldBindToPort = m_tcpServer->listen(address, port);
-    if (couldBindToPort) {
-        connect(m_tcpServer, SIGNAL(newConnection()), this, SLOT(newConnection()));
+void QHttpServer::incomingConnection(qint64 socketDescriptor)
+{
+    Q_ASSERT(!m_workers.isEmpty());
+
+    // Distribute connections across the workers in turn
+    QHttpWorker *worker = m_workers.at(m_nextWorker++ % m_workers.size());
+    QMetaObject::invokeMethod(worker, "addConnection", Q_ARG(qlonglong, socketDescriptor));
+}
+
+void QHttpServer::startWorkers()
+{
+    const int workers = qMax(1, m_threadCount);
+
+    if ((m_workers.size() == workers) && (m_threads.size() == m_threadCount))
+        return;
+
+    stopWorkers();
+
+    if (m_threadCount == 0) {
+        m_workers.append(new QHttpWorker(this));
     } else {
-        delete m_tcpServer;
-        m_tcpServer = NULL;
+        for (int i = 0; i < m_threadCount; ++i) {
+            QThread *thread = new QThread;
+            QHttpWorker *worker = new QHttpWorker;
+            worker->moveToThread(thread);
+            connect(thread, SIGNAL(finished()), worker, SLOT(deleteLater()), Qt::DirectConnection);
+            thread->start();
+            m_threads.append(thread);
+            m_workers.append(worker);
+        }
+    }
+
+    foreach (QHttpWorker *worker, m_workers) {
+        connect(worker, SIGNAL(newRequest(QHttpRequest *, QHttpResponse *)), this,
+                SIGNAL(newRequest(QHttpRequest *, QHttpResponse *)), Qt::DirectConnection);
+    }
+
+    setMaxConnections(m_maxConnections);
+    setKeepAliveTimeout(m_keepAliveTimeout);
+}
+
+void QHttpServer::stopWorkers()
+{
+    // Workers in their own threads are deleted, along with their connections, as the
+    // threads finish
+    foreach (QThread *thread, m_threads)
+        thread->quit();
+
+    foreach (QThread *thread, m_threads) {
+        thread->wait();
+        delete thread;
     }
-    return couldBindToPort;
+
+    if (m_threads.isEmpty())
+        qDeleteAll(m_workers);
+
+    m_threads.clear();
+    m_workers.clear();
+    m_nextWorker = 0;
+}
+
+bool QHttpServer::listen(const QHostAddress &address, quint16 port)
+{
+    if (!m_tcpServer)
+        m_tcpServer = new QHttpTcpServer(this);
+    else if (m_tcpServer->isListening())
+        m_tcpServer->close();
+
+    startWorkers();
+    return m_tcpServer->listen(address, port);
 }
 
 bool QHttpServer::listen(quint16 port)
@@ -32,6 +32,7 @@
 
 #include <QObject>
 #include <QHostAddress>
+#include <QList>
 
 /// Maps status codes to string reason phrases
 extern QHash<int, QString> STATUS_CODES;
@@ -67,6 +68,24 @@ public:
     QHostAddress serverAddress() const;
     qint16 serverPort() const;
 
+    /// The maximum number of simultaneous client connections.
+    /** When the limit is reached, an idle persistent connection is closed to make room
+        for the new one. If there is none, the new client gets a 503 response. */
+    int maxConnections() const;
+    void setMaxConnections(int maximum);
+
+    /// How long (in milliseconds) an idle persistent connection is kept open.
+    int keepAliveTimeout() const;
+    void setKeepAliveTimeout(int msecs);
+
+    /// The number of threads that connections are distributed across.
+    /** With the default of 0, connections are handled in the server's own thread.
+        Otherwise newRequest() is emitted in the thread that handles the connection,
+        so it should be connected using Qt::DirectConnection. Changes take effect
+        when listen() is next called. */
+    int threadCount() const;
+    void setThreadCount(int count);
+
     /// Start the server by bounding to the given @c address and @c port.
     /** @note This function returns immediately, it does not block.
         @param address Address on which to listen to. Default is to listen on
@@ -92,11 +111,21 @@ signals:
         @param response Response object to the request. */
     void newRequest(QHttpRequest *request, QHttpResponse *response);
 
-private slots:
-    void newConnection();
-
 private:
+    void incomingConnection(qint64 socketDescriptor);
+
+    void startWorkers();
+    void stopWorkers();
+
     QTcpServer *m_tcpServer;
+    QList<QHttpWorker *> m_workers;
+    QList<QThread *> m_threads;
+    int m_maxConnections;
+    int m_keepAliveTimeout;
+    int m_threadCount;
+    int m_nextWorker;
+
+    friend class QHttpTcpServer;
 };
 
 #endif
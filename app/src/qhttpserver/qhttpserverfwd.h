@@ -36,10 +36,12 @@ class QHttpServer;
 class QHttpConnection;
 class QHttpRequest;
 class QHttpResponse;
+class QHttpWorker;
 
 // Qt
 class QTcpServer;
 class QTcpSocket;
+class QThread;
 
 // http_parser
 struct http_parser_settings;
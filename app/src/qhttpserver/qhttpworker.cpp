@@ -0,0 +1,99 @@
+/*
+ * Copyright 2011-2014 Nikhil Marathe <nsm.nikhil@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "qhttpworker.h"
+
+#include <QTcpSocket>
+
+#include "qhttpconnection.h"
+
+/// @cond nodoc
+
+QHttpWorker::QHttpWorker(QObject *parent)
+    : QObject(parent),
+      m_maxConnections(32),
+      m_keepAliveTimeout(15000)
+{
+}
+
+QHttpWorker::~QHttpWorker()
+{
+}
+
+void QHttpWorker::addConnection(qlonglong socketDescriptor)
+{
+    // The socket is created here so that it belongs to the worker's thread
+    QTcpSocket *socket = new QTcpSocket;
+
+    if (!socket->setSocketDescriptor(socketDescriptor)) {
+        delete socket;
+        return;
+    }
+
+    if (m_connections.size() >= m_maxConnections && !closeIdleConnection()) {
+        socket->write("HTTP/1.1 503 Service Unavailable\r\n"
+                      "Connection: close\r\n"
+                      "Content-Length: 0\r\n\r\n");
+        connect(socket, SIGNAL(disconnected()), socket, SLOT(deleteLater()));
+        socket->disconnectFromHost();
+        return;
+    }
+
+    QHttpConnection *connection = new QHttpConnection(socket, this);
+    connection->setIdleTimeout(m_keepAliveTimeout);
+    m_connections.append(connection);
+    connect(connection, SIGNAL(destroyed(QObject *)), this, SLOT(connectionDestroyed(QObject *)));
+    connect(connection, SIGNAL(newRequest(QHttpRequest *, QHttpResponse *)), this,
+            SIGNAL(newRequest(QHttpRequest *, QHttpResponse *)));
+}
+
+void QHttpWorker::setMaxConnections(int maximum)
+{
+    m_maxConnections = qMax(1, maximum);
+}
+
+void QHttpWorker::setKeepAliveTimeout(int msecs)
+{
+    m_keepAliveTimeout = msecs;
+
+    foreach (QHttpConnection *connection, m_connections)
+        connection->setIdleTimeout(msecs);
+}
+
+void QHttpWorker::connectionDestroyed(QObject *connection)
+{
+    m_connections.removeAll(static_cast<QHttpConnection *>(connection));
+}
+
+bool QHttpWorker::closeIdleConnection()
+{
+    foreach (QHttpConnection *connection, m_connections) {
+        if (connection->isIdle()) {
+            connection->close();
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/// @endcond
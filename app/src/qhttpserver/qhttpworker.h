@@ -0,0 +1,65 @@
+/*
+ * Copyright 2011-2014 Nikhil Marathe <nsm.nikhil@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#ifndef Q_HTTP_WORKER
+#define Q_HTTP_WORKER
+
+#include "qhttpserverapi.h"
+#include "qhttpserverfwd.h"
+
+#include <QObject>
+#include <QList>
+
+/// @cond nodoc
+
+/// Owns the connections handled by one thread of the server.
+class QHTTPSERVER_API QHttpWorker : public QObject
+{
+    Q_OBJECT
+
+public:
+    QHttpWorker(QObject *parent = 0);
+    virtual ~QHttpWorker();
+
+public slots:
+    void addConnection(qlonglong socketDescriptor);
+
+    void setMaxConnections(int maximum);
+    void setKeepAliveTimeout(int msecs);
+
+signals:
+    void newRequest(QHttpRequest *, QHttpResponse *);
+
+private slots:
+    void connectionDestroyed(QObject *connection);
+
+private:
+    bool closeIdleConnection();
+
+    QList<QHttpConnection *> m_connections;
+    int m_maxConnections;
+    int m_keepAliveTimeout;
+};
+
+/// @endcond
+
+#endif
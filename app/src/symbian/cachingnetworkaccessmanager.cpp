@@ -45,7 +45,7 @@ QNetworkReply* CachingNetworkAccessManager::createRequest(QNetworkAccessManager:
         setCache(dc);
     }
 
-    const QString cacheDir = path.left(path.lastIndexOf("/"));
+    const QString cacheDir = DiskCache::directoryForPath(path);
 
     if (dc->cacheDirectory() != cacheDir) {
         dc->setCacheDirectory(cacheDir);
@@ -35,14 +35,21 @@ static const QString LIB_SUFFIX(".qtplugin");
 
 // Icons
 static const int ICON_SIZE = 64;
+static const int THUMBNAIL_SIZE = 120;
 
 // Cache
 static const QString CACHE_AUTHORITY("http://localhost/");
 static const QString CACHE_PATH(HOME_PATH + "cutenews/.cache/");
+static const QString MEDIA_CACHE_PATH(CACHE_PATH + "media/");
+static const QString THUMBNAIL_CACHE_PATH(CACHE_PATH + "thumbnails/");
+static const qint64 MEDIA_CACHE_SIZE = 524288000;
+static const QString TEMPORARY_CACHE_PATH(CACHE_PATH + "temp/");
 
 // Database
 static const QString DATABASE_PATH;
 static const QString DATABASE_NAME("cutenews.db");
+static const int DATABASE_MAINTENANCE_INTERVAL = 3600000;
+static const int DATABASE_ANALYZE_INTERVAL = 86400;
 
 // Config
 static const QString APP_CONFIG_PATH(QDesktopServices::storageLocation(QDesktopServices::HomeLocation) + "/.config/cutenews/");
@@ -53,6 +60,11 @@ static const QString DOWNLOAD_PATH(HOME_PATH + "cutenews/");
 
 // Network
 static const int DOWNLOAD_BUFFER_SIZE = 512000;
+static const qint64 SEGMENTED_DOWNLOAD_MIN_SIZE = 10485760;
+static const int TRANSFER_CHECKPOINT_INTERVAL = 30000;
+static const int TRANSFER_JOURNAL_COMPACT_THRESHOLD = 500;
+static const int MAX_ENCLOSURE_RECORDS = 5000;
+static const int TRANSFER_PROGRESS_INTERVAL = 250;
 static const int MAX_CONCURRENT_TRANSFERS = 4;
 static const int MAX_REDIRECTS = 8;
 static const QByteArray USER_AGENT("Wget/1.13.4 (linux-gnu)");
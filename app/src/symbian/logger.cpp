@@ -16,11 +16,9 @@
  */
 
 #include "logger.h"
+#include "logwriter.h"
 #include <QDateTime>
 #include <QDebug>
-#include <QDir>
-#include <QFile>
-#include <QTextStream>
 
 QString Logger::fn;
 int Logger::vb = 0;
@@ -36,27 +34,11 @@ QString Logger::fileName() {
 
 void Logger::setFileName(const QString &f) {
     fn = f;
+    LogWriter::instance()->setFileName(f);
 }
 
 QString Logger::text() {
-    QString output;
-    
-    if (!fn.isEmpty()) {
-        QFile file(fn);
-        
-        if (file.open(QFile::ReadOnly | QFile::Text)) {
-            QTextStream stream(&file);
-
-            while (!stream.atEnd()) {
-                output.append(stream.readLine());
-                output.append("\n");
-            }
-
-            file.close();
-        }
-    }
-    
-    return output;
+    return LogWriter::instance()->text();
 }
 
 int Logger::verbosity() {
@@ -65,34 +47,24 @@ int Logger::verbosity() {
 
 void Logger::setVerbosity(int v) {
     vb = v;
+    // Make sure the writer exists before other threads start logging
+    LogWriter::instance();
 }
 
 void Logger::clear() {
-    if (!fn.isEmpty()) {
-        QFile::remove(fn);
-    }
+    LogWriter::instance()->clear();
 }
 
 void Logger::log(const QString &message, int minimumVerbosity) {
-    if (minimumVerbosity <= vb) {
-        const QString date = QDateTime::currentDateTime().toString(Qt::ISODate);
-        QString output = QString("%1: %2\n").arg(date).arg(message);
-        
-        if (!fn.isEmpty()) {
-            if (QDir().mkpath(fn.left(fn.lastIndexOf("/")))) {
-                QFile file(fn);
-
-                if (file.open(QFile::Append | QFile::Text)) {
-                    QTextStream stream(&file);
-                    stream << output;
-                    file.close();
-                    return;
-                }
-            }
-            
-            output = tr("%1: Cannot write to log file '%2'").arg(date).arg(fn);
-        }
-        
+    if (minimumVerbosity > vb) {
+        return;
+    }
+    
+    // Lines are written to the log file by LogWriter in a background thread
+    const QString output = QString("%1: %2\n").arg(QDateTime::currentDateTime().toString(Qt::ISODate)).arg(message);
+    LogWriter::instance()->write(output);
+    
+    if (fn.isEmpty()) {
         qDebug() << output.toUtf8().constData();
     }
 }
@@ -16,24 +16,29 @@
 
 #include "article.h"
 #include "articlemodel.h"
+#include "bandwidthscheduler.h"
 #include "cachingnetworkaccessmanagerfactory.h"
 #include "categorymodel.h"
 #include "categorynamemodel.h"
 #include "clipboard.h"
 #include "concurrenttransfersmodel.h"
+#include "customcommandscheduler.h"
 #include "cutenews.h"
 #include "database.h"
 #include "dbconnection.h"
+#include "dbmaintenance.h"
 #include "dbnotify.h"
 #include "definitions.h"
 #include "loggerverbositymodel.h"
 #include "maskeditem.h"
+#include "mediaprefetcher.h"
 #include "networkproxytypemodel.h"
 #include "pluginconfigmodel.h"
 #include "pluginmanager.h"
 #include "pluginsettings.h"
 #include "screenorientationmodel.h"
 #include "settings.h"
+#include "settingscache.h"
 #include "subscription.h"
 #include "subscriptionmodel.h"
 #include "subscriptions.h"
@@ -97,12 +102,17 @@ Q_DECL_EXPORT int main(int argc, char *argv[]) {
     registerTypes();
     Settings::setNetworkProxy();
 
+    QScopedPointer<SettingsCache> settingsCache(SettingsCache::instance());
     QScopedPointer<Clipboard> clipboard(Clipboard::instance());
     QScopedPointer<CuteNews> cutenews(CuteNews::instance());
     QScopedPointer<DBNotify> notify(DBNotify::instance());
     QScopedPointer<PluginManager> plugins(PluginManager::instance());
     QScopedPointer<Settings> settings(Settings::instance());
     QScopedPointer<Subscriptions> subscriptions(Subscriptions::instance());
+    QScopedPointer<DBMaintenance> maintenance(DBMaintenance::instance());
+    QScopedPointer<MediaPrefetcher> prefetcher(MediaPrefetcher::instance());
+    QScopedPointer<BandwidthScheduler> scheduler(BandwidthScheduler::instance());
+    QScopedPointer<CustomCommandScheduler> commandScheduler(CustomCommandScheduler::instance());
     QScopedPointer<Transfers> transfers(Transfers::instance());
     
     Logger logger;
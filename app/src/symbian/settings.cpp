@@ -16,7 +16,7 @@
 
 #include "settings.h"
 #include "definitions.h"
-#include <QSettings>
+#include "settingscache.h"
 #include <QNetworkProxy>
 
 Settings* Settings::self = 0;
@@ -35,42 +35,31 @@ Settings* Settings::instance() {
 }
 
 QStringList Settings::categoryNames() {
-    QSettings settings(APP_CONFIG_PATH + "settings", QSettings::IniFormat);
-    settings.beginGroup("Categories");
-    QStringList names = settings.childKeys();
+    QStringList names = SettingsCache::instance()->childKeys(APP_CONFIG_PATH + "settings", "Categories");
     names.prepend(tr("Default"));
-    settings.endGroup();
     
     return names;
 }
 
 QList<Category> Settings::categories() {
     QList<Category> list;
-    QSettings settings(APP_CONFIG_PATH + "settings", QSettings::IniFormat);
-    settings.beginGroup("Categories");
     
-    foreach (const QString &key, settings.childKeys()) {
+    foreach (const QString &key, SettingsCache::instance()->childKeys(APP_CONFIG_PATH + "settings", "Categories")) {
         Category category;
         category.name = key;
-        category.path = settings.value(key).toString();
+        category.path = value("Categories/" + key).toString();
         list << category;
     }
     
-    settings.endGroup();
-    
     return list;
 }
 
 void Settings::setCategories(const QList<Category> &c) {
-    QSettings settings(APP_CONFIG_PATH + "settings", QSettings::IniFormat);
-    settings.remove("Categories");
-    settings.beginGroup("Categories");
+    SettingsCache::instance()->remove(APP_CONFIG_PATH + "settings", "Categories");
     
     foreach (const Category &category, c) {
-        settings.setValue(category.name, category.path);
+        setValue("Categories/" + category.name, category.path);
     }
-    
-    settings.endGroup();
 
     if (self) {
         emit self->categoriesChanged();
@@ -88,18 +77,13 @@ void Settings::addCategory(const QString &name, const QString &path) {
 }
 
 void Settings::removeCategory(const QString &name) {
-    QSettings settings(APP_CONFIG_PATH + "settings", QSettings::IniFormat);
-    settings.beginGroup("Categories");
-    
-    if (settings.contains(name)) {
-        settings.remove(name);
+    if (SettingsCache::instance()->contains(APP_CONFIG_PATH + "settings", "Categories/" + name)) {
+        SettingsCache::instance()->remove(APP_CONFIG_PATH + "settings", "Categories/" + name);
 
         if (self) {
             emit self->categoriesChanged();
         }
     }
-    
-    settings.endGroup();
 }
 
 QString Settings::defaultCategory() {
@@ -116,6 +100,62 @@ void Settings::setDefaultCategory(const QString &category) {
     }
 }
 
+bool Settings::compressArticles() {
+    return value("Database/compressArticles", false).toBool();
+}
+
+void Settings::setCompressArticles(bool enabled) {
+    if (enabled != compressArticles()) {
+        setValue("Database/compressArticles", enabled);
+        
+        if (self) {
+            emit self->compressArticlesChanged(enabled);
+        }
+    }
+}
+
+int Settings::maximumConcurrentCustomCommands() {
+    return value("Transfers/maximumConcurrentCustomCommands", 1).toInt();
+}
+
+void Settings::setMaximumConcurrentCustomCommands(int maximum) {
+    if (maximum != maximumConcurrentCustomCommands()) {
+        setValue("Transfers/maximumConcurrentCustomCommands", maximum);
+        
+        if (self) {
+            emit self->maximumConcurrentCustomCommandsChanged(maximum);
+        }
+    }
+}
+
+int Settings::customCommandNiceness() {
+    return value("Transfers/customCommandNiceness", 0).toInt();
+}
+
+void Settings::setCustomCommandNiceness(int niceness) {
+    if (niceness != customCommandNiceness()) {
+        setValue("Transfers/customCommandNiceness", niceness);
+        
+        if (self) {
+            emit self->customCommandNicenessChanged(niceness);
+        }
+    }
+}
+
+bool Settings::customCommandIdleIOEnabled() {
+    return value("Transfers/customCommandIdleIOEnabled", false).toBool();
+}
+
+void Settings::setCustomCommandIdleIOEnabled(bool enabled) {
+    if (enabled != customCommandIdleIOEnabled()) {
+        setValue("Transfers/customCommandIdleIOEnabled", enabled);
+        
+        if (self) {
+            emit self->customCommandIdleIOEnabledChanged(enabled);
+        }
+    }
+}
+
 QString Settings::customTransferCommand() {
     return value("Transfers/customCommand").toString();
 }
@@ -144,6 +184,20 @@ void Settings::setCustomTransferCommandEnabled(bool enabled) {
     }
 }
 
+int Settings::downloadSegments() {
+    return value("Transfers/downloadSegments", 4).toInt();
+}
+
+void Settings::setDownloadSegments(int segments) {
+    if (segments != downloadSegments()) {
+        setValue("Transfers/downloadSegments", segments);
+        
+        if (self) {
+            emit self->downloadSegmentsChanged(segments);
+        }
+    }
+}
+
 QString Settings::downloadPath() {
     QString path = value("Transfers/downloadPath", DOWNLOAD_PATH).toString();
 
@@ -327,6 +381,34 @@ void Settings::setNetworkProxyUsername(const QString &username) {
     }
 }
 
+int Settings::maximumDownloadSpeed() {
+    return value("Transfers/maximumDownloadSpeed", 0).toInt();
+}
+
+void Settings::setMaximumDownloadSpeed(int speed) {
+    if (speed != maximumDownloadSpeed()) {
+        setValue("Transfers/maximumDownloadSpeed", speed);
+        
+        if (self) {
+            emit self->maximumDownloadSpeedChanged(speed);
+        }
+    }
+}
+
+int Settings::maximumDownloadSpeed(const QString &category) {
+    return value("CategoryDownloadSpeeds/" + category, 0).toInt();
+}
+
+void Settings::setMaximumDownloadSpeed(const QString &category, int speed) {
+    if (speed != maximumDownloadSpeed(category)) {
+        setValue("CategoryDownloadSpeeds/" + category, speed);
+        
+        if (self) {
+            emit self->categoryMaximumDownloadSpeedChanged(category, speed);
+        }
+    }
+}
+
 bool Settings::offlineModeEnabled() {
     return value("Network/offlineModeEnabled", false).toBool();
 }
@@ -341,6 +423,20 @@ void Settings::setOfflineModeEnabled(bool enabled) {
     }
 }
 
+bool Settings::prefetchArticleMedia() {
+    return value("Subscriptions/prefetchArticleMedia", false).toBool();
+}
+
+void Settings::setPrefetchArticleMedia(bool enabled) {
+    if (enabled != prefetchArticleMedia()) {
+        setValue("Subscriptions/prefetchArticleMedia", enabled);
+        
+        if (self) {
+            emit self->prefetchArticleMediaChanged(enabled);
+        }
+    }
+}
+
 int Settings::readArticleExpiry() {
     return value("Subscriptions/readArticleExpiry", -1).toInt();
 }
@@ -398,9 +494,9 @@ void Settings::setUpdateSubscriptionsOnStartup(bool enabled) {
 }
 
 QVariant Settings::value(const QString &key, const QVariant &defaultValue) {
-    return QSettings(APP_CONFIG_PATH + "settings", QSettings::IniFormat).value(key, defaultValue);
+    return SettingsCache::instance()->value(APP_CONFIG_PATH + "settings", key, defaultValue);
 }
 
 void Settings::setValue(const QString &key, const QVariant &value) {
-    QSettings(APP_CONFIG_PATH + "settings", QSettings::IniFormat).setValue(key, value);
+    SettingsCache::instance()->setValue(APP_CONFIG_PATH + "settings", key, value);
 }
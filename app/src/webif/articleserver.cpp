@@ -17,28 +17,87 @@
 #include "articleserver.h"
 #include "dbconnection.h"
 #include "definitions.h"
-#include "json.h"
+#include "diskcache.h"
+#include "jsonreader.h"
 #include "pluginmanager.h"
 #include "pluginsettings.h"
 #include "qhttprequest.h"
 #include "qhttpresponse.h"
 #include "serverresponse.h"
 #include "utils.h"
+#include <QCache>
+#include <QDateTime>
+#include <QFile>
+#include <QMutex>
+#include <QRegExp>
+#include <QScopedPointer>
 
-static QVariantMap articleQueryToMap(const DBConnection *connection, const QString &authority) {
-    QVariantMap article;
-    article["id"] = connection->value(0);
-    article["author"] = connection->value(1);
-    article["body"] = connection->value(2).toString().replace(CACHE_AUTHORITY, authority);
-    article["categories"] = connection->value(3).toString().split(", ", QString::SkipEmptyParts);
-    article["date"] = connection->value(4);
-    article["enclosures"] = QtJson::Json::parse(connection->value(5).toString());
-    article["favourite"] = connection->value(6).toBool();
-    article["read"] = connection->value(7).toBool();
-    article["subscriptionId"] = connection->value(8);
-    article["title"] = connection->value(9);
-    article["url"] = connection->value(10);
-    return article;
+static const int ARTICLE_RESPONSE_RESERVE = 0x10000;
+static const int THUMBNAIL_CACHE_SIZE = 2000;
+// Thumbnails that do not exist yet may still be prefetched, so they are looked for again after this interval
+static const qint64 THUMBNAIL_RETRY_INTERVAL = 60000;
+
+struct Thumbnail
+{
+    QString fileName;
+    bool exists;
+    qint64 checked;
+};
+    
+// Thumbnails are found once per article rather than for each response. Requests are handled in several threads.
+static QCache<QString, Thumbnail> thumbnails(THUMBNAIL_CACHE_SIZE);
+static QMutex thumbnailsMutex;
+        
+static QString thumbnailUrl(const QString &id, const QString &body, const QString &authority) {
+    QMutexLocker locker(&thumbnailsMutex);
+    Thumbnail *thumbnail = thumbnails.object(id);
+    
+    if (!thumbnail) {
+        thumbnail = new Thumbnail;
+        thumbnail->exists = false;
+        thumbnail->checked = 0;
+        const QRegExp re(QRegExp::escape(CACHE_PATH) + "[^/'\"]+/[^/'\"]+/([^/'\"]+)");
+        
+        if (re.indexIn(body) != -1) {
+            thumbnail->fileName = DiskCache::thumbnailPath(QString::fromUtf8(QByteArray::fromBase64(re.cap(1).toUtf8())));
+        }
+        
+        thumbnails.insert(id, thumbnail);
+    }
+    
+    if ((!thumbnail->exists) && (!thumbnail->fileName.isEmpty())) {
+        const qint64 now = QDateTime::currentMSecsSinceEpoch();
+        
+        if (now - thumbnail->checked >= THUMBNAIL_RETRY_INTERVAL) {
+            thumbnail->exists = QFile::exists(thumbnail->fileName);
+            thumbnail->checked = now;
+        }
+    }
+    
+    return thumbnail->exists ? authority + thumbnail->fileName : QString();
+}
+
+static void writeArticle(DataWriter &writer, const DBConnection *connection, const QString &authority) {
+    const QString body = connection->value(2).toString();
+    // Properties are written in the same (alphabetical) order as a serialized QVariantMap
+    writer.beginObject();
+    writer.writeProperty("author", connection->value(1).toString());
+    writer.writeProperty("body", QString(body).replace(CACHE_AUTHORITY, authority));
+    writer.writeName("categories");
+    writer.writeStringList(connection->value(3).toString().split(", ", QString::SkipEmptyParts));
+    writer.writeProperty("date", qint64(connection->value(4).toLongLong()));
+    // Enclosures are stored as JSON, so they can be written without parsing
+    const QByteArray enclosures = connection->value(5).toString().toUtf8();
+    writer.writeName("enclosures");
+    writer.writeRawJson(enclosures.isEmpty() ? QByteArray("[]") : enclosures);
+    writer.writeProperty("favourite", connection->value(6).toBool());
+    writer.writeProperty("id", connection->value(0).toString());
+    writer.writeProperty("read", connection->value(7).toBool());
+    writer.writeProperty("subscriptionId", connection->value(8).toString());
+    writer.writeProperty("thumbnail", thumbnailUrl(connection->value(0).toString(), body, authority));
+    writer.writeProperty("title", connection->value(9).toString());
+    writer.writeProperty("url", connection->value(10).toString());
+    writer.endObject();
 }
 
 static QVariantMap articleResultToMap(const ArticleResult &result, const QString &authority) {
@@ -172,6 +231,51 @@ bool ArticleServer::handleRequest(QHttpRequest *request, QHttpResponse *response
             return true;
         }
 
+        if (request->method() == QHttpRequest::HTTP_POST) {
+            // Batch operations take a list of article ids
+            const QStringList ids = JsonReader::parse(QString::fromUtf8(request->body())).toStringList();
+            
+            if (ids.isEmpty()) {
+                writeResponse(response, QHttpResponse::STATUS_BAD_REQUEST);
+                return true;
+            }
+            
+            if (parts.at(1).compare("read", Qt::CaseInsensitive) == 0) {
+                DBConnection *connection = DBConnection::connection(this, SLOT(onArticlesChanged(DBConnection*)));
+                addResponse(connection, response);
+                connection->markArticlesRead(ids, true);
+                return true;
+            }
+            
+            if (parts.at(1).compare("unread", Qt::CaseInsensitive) == 0) {
+                DBConnection *connection = DBConnection::connection(this, SLOT(onArticlesChanged(DBConnection*)));
+                addResponse(connection, response);
+                connection->markArticlesRead(ids, false);
+                return true;
+            }
+            
+            if (parts.at(1).compare("favourite", Qt::CaseInsensitive) == 0) {
+                DBConnection *connection = DBConnection::connection(this, SLOT(onArticlesChanged(DBConnection*)));
+                addResponse(connection, response);
+                connection->markArticlesFavourite(ids, true);
+                return true;
+            }
+            
+            if (parts.at(1).compare("unfavourite", Qt::CaseInsensitive) == 0) {
+                DBConnection *connection = DBConnection::connection(this, SLOT(onArticlesChanged(DBConnection*)));
+                addResponse(connection, response);
+                connection->markArticlesFavourite(ids, false);
+                return true;
+            }
+            
+            if (parts.at(1).compare("delete", Qt::CaseInsensitive) == 0) {
+                DBConnection *connection = DBConnection::connection(this, SLOT(onReadArticlesDeleted(DBConnection*)));
+                addResponse(connection, response);
+                connection->deleteArticles(ids);
+                return true;
+            }
+        }
+        
         if (request->method() == QHttpRequest::HTTP_DELETE) {
             DBConnection *connection = DBConnection::connection(this, SLOT(onConnectionFinished(DBConnection*)));
             addResponse(connection, response);
@@ -210,9 +314,9 @@ void ArticleServer::removeResponse(QHttpResponse *response) {
 void ArticleServer::onArticleFetched(DBConnection *connection) {
     if (QHttpResponse *response = getResponse(connection)) {
         if (connection->status() == DBConnection::Ready) {
-            const QString authority = response->property("authority").toString();
-            writeResponse(response, QHttpResponse::STATUS_OK, QtJson::Json::serialize(articleQueryToMap(connection,
-                                                                                                        authority)));
+            QScopedPointer<DataWriter> writer(createWriter(response));
+            writeArticle(*writer, connection, response->property("authority").toString());
+            writeResponse(response, QHttpResponse::STATUS_OK, *writer);
         }
         else {
             writeResponse(response, QHttpResponse::STATUS_INTERNAL_SERVER_ERROR);
@@ -224,13 +328,37 @@ void ArticleServer::onArticlesFetched(DBConnection *connection) {
     if (QHttpResponse *response = getResponse(connection)) {
         if (connection->status() == DBConnection::Ready) {
             const QString authority = response->property("authority").toString();
-            QVariantList articles;
+            QScopedPointer<DataWriter> writer(createWriter(response, ARTICLE_RESPONSE_RESERVE));
+            writer->beginArray();
+            
+            while (connection->nextRecord()) {
+                writeArticle(*writer, connection, authority);
+            }
+            
+            writer->endArray();
+            writeResponse(response, QHttpResponse::STATUS_OK, *writer);
+        }
+        else {
+            writeResponse(response, QHttpResponse::STATUS_INTERNAL_SERVER_ERROR);
+        }
+    }
+}
+
+void ArticleServer::onArticlesChanged(DBConnection *connection) {
+    if (QHttpResponse *response = getResponse(connection)) {
+        if (connection->status() == DBConnection::Ready) {
+            QScopedPointer<DataWriter> writer(createWriter(response));
+            writer->beginArray();
             
             while (connection->nextRecord()) {
-                articles << articleQueryToMap(connection, authority);
+                writer->beginObject();
+                writer->writeProperty("id", connection->value(0).toString());
+                writer->writeProperty("subscriptionId", connection->value(1).toString());
+                writer->endObject();
             }
             
-            writeResponse(response, QHttpResponse::STATUS_OK, QtJson::Json::serialize(articles));
+            writer->endArray();
+            writeResponse(response, QHttpResponse::STATUS_OK, *writer);
         }
         else {
             writeResponse(response, QHttpResponse::STATUS_INTERNAL_SERVER_ERROR);
@@ -243,7 +371,7 @@ void ArticleServer::onArticleRequestFinished(ArticleRequest *request) {
         if (request->status() == ArticleRequest::Ready) {
             const QString authority = response->property("authority").toString();
             writeResponse(response, QHttpResponse::STATUS_OK,
-                    QtJson::Json::serialize(articleResultToMap(request->result(), authority)));
+                    articleResultToMap(request->result(), authority));
         }
         else {
             writeResponse(response, QHttpResponse::STATUS_INTERNAL_SERVER_ERROR);
@@ -256,7 +384,7 @@ void ArticleServer::onReadArticlesDeleted(DBConnection *connection) {
         if (connection->status() == DBConnection::Ready) {
             QVariantMap result;
             result["count"] = connection->numRowsAffected();
-            writeResponse(response, QHttpResponse::STATUS_OK, QtJson::Json::serialize(result));
+            writeResponse(response, QHttpResponse::STATUS_OK, result);
         }
         else {
             writeResponse(response, QHttpResponse::STATUS_INTERNAL_SERVER_ERROR);
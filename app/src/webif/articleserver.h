@@ -37,6 +37,7 @@ public:
 private Q_SLOTS:
     void onArticleFetched(DBConnection *connection);
     void onArticlesFetched(DBConnection *connection);
+    void onArticlesChanged(DBConnection *connection);
     void onArticleRequestFinished(ArticleRequest *request);
     void onReadArticlesDeleted(DBConnection *connection);
     void onConnectionFinished(DBConnection *connection);
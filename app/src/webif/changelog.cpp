@@ -0,0 +1,276 @@
+/*
+ * Copyright (C) 2017 Stuart Howarth <showarth@marxoft.co.uk>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "changelog.h"
+#include "dbnotify.h"
+#include "logger.h"
+#include "transfers.h"
+#include <QDateTime>
+#include <QSet>
+
+static const int MAXIMUM_ENTRIES = 20000;
+
+// Read states are kept alongside the items, but are not reported as changed items
+static const int READ_STATE_ITEM = ChangeLog::ItemTypeCount;
+
+ChangeLog* ChangeLog::self = 0;
+
+ChangeLog::ChangeLog() :
+    QObject(),
+    m_sequence(QDateTime::currentDateTime().toMSecsSinceEpoch()),
+    m_firstSequence(m_sequence)
+{
+    connect(DBNotify::instance(), SIGNAL(subscriptionsAdded(QStringList)), this, SLOT(onSubscriptionsAdded(QStringList)));
+    connect(DBNotify::instance(), SIGNAL(subscriptionDeleted(QString)), this, SLOT(onSubscriptionDeleted(QString)));
+    connect(DBNotify::instance(), SIGNAL(subscriptionUpdated(QString)), this, SLOT(onSubscriptionUpdated(QString)));
+    connect(DBNotify::instance(), SIGNAL(subscriptionsUpdated(QStringList)),
+            this, SLOT(onSubscriptionsUpdated(QStringList)));
+    connect(DBNotify::instance(), SIGNAL(subscriptionRead(QString, bool)), this, SLOT(onSubscriptionRead(QString, bool)));
+    connect(DBNotify::instance(), SIGNAL(allSubscriptionsRead()), this, SLOT(onAllSubscriptionsRead()));
+    connect(DBNotify::instance(), SIGNAL(articlesAdded(QStringList, QString)),
+            this, SLOT(onArticlesAdded(QStringList, QString)));
+    connect(DBNotify::instance(), SIGNAL(articlesDeleted(QStringList, QString)),
+            this, SLOT(onArticlesDeleted(QStringList, QString)));
+    connect(DBNotify::instance(), SIGNAL(articleUpdated(QString)), this, SLOT(onArticleUpdated(QString)));
+    connect(DBNotify::instance(), SIGNAL(articleFavourited(QString, bool)), this, SLOT(onArticleFavourited(QString)));
+    connect(DBNotify::instance(), SIGNAL(articlesFavourited(QStringList, bool)),
+            this, SLOT(onArticlesFavourited(QStringList)));
+    connect(DBNotify::instance(), SIGNAL(articleRead(QString, QString, bool)),
+            this, SLOT(onArticleRead(QString, QString)));
+    connect(DBNotify::instance(), SIGNAL(articlesRead(QStringList, QStringList, bool)),
+            this, SLOT(onArticlesRead(QStringList, QStringList)));
+    connect(Transfers::instance(), SIGNAL(transferAdded(Transfer*)), this, SLOT(onTransferAdded(Transfer*)));
+    connect(Transfers::instance(), SIGNAL(transferRemoved(Transfer*)), this, SLOT(onTransferRemoved(Transfer*)));
+    
+    for (int i = 0; i < Transfers::instance()->count(); i++) {
+        connect(Transfers::instance()->get(i), SIGNAL(dataChanged(Transfer*, int)),
+                this, SLOT(onTransferDataChanged(Transfer*)));
+    }
+}
+
+ChangeLog::~ChangeLog() {
+    self = 0;
+}
+
+ChangeLog* ChangeLog::instance() {
+    return self ? self : self = new ChangeLog;
+}
+
+qlonglong ChangeLog::sequence() const {
+    QMutexLocker locker(&m_mutex);
+    return m_sequence;
+}
+
+QList<ChangeSet> ChangeLog::changesSince(qlonglong since) const {
+    QMutexLocker locker(&m_mutex);
+    QList<ChangeSet> changes;
+    
+    for (int i = 0; i < ItemTypeCount; i++) {
+        ChangeSet set;
+        set.sequence = m_sequence;
+        set.complete = (since >= m_firstSequence) && (since <= m_sequence);
+        changes << set;
+    }
+    
+    if (!changes.first().complete) {
+        return changes;
+    }
+    
+    QMap<qlonglong, Key>::const_iterator iterator = m_sequences.upperBound(since);
+    
+    while (iterator != m_sequences.constEnd()) {
+        const Key &key = iterator.value();
+        
+        if (key.first != READ_STATE_ITEM) {
+            const Entry &entry = m_entries[key];
+            ChangeSet &set = changes[key.first];
+            
+            if (entry.action == Removed) {
+                set.removed << key.second;
+            }
+            else if (entry.added > since) {
+                set.added << key.second;
+            }
+            else {
+                set.changed << key.second;
+            }
+        }
+        
+        ++iterator;
+    }
+    
+    return changes;
+}
+
+QList< QPair<QString, bool> > ChangeLog::readStatesSince(qlonglong since) const {
+    QMutexLocker locker(&m_mutex);
+    QList< QPair<QString, bool> > states;
+    QMap<qlonglong, Key>::const_iterator iterator = m_sequences.upperBound(since);
+    
+    while (iterator != m_sequences.constEnd()) {
+        const Key &key = iterator.value();
+        
+        if (key.first == READ_STATE_ITEM) {
+            states << qMakePair(key.second, m_entries[key].action == MarkedRead);
+        }
+        
+        ++iterator;
+    }
+    
+    return states;
+}
+
+void ChangeLog::record(ItemType type, const QString &id, Action action) {
+    QMutexLocker locker(&m_mutex);
+    insert(Key(type, id), action);
+    trim();
+}
+
+void ChangeLog::record(ItemType type, const QStringList &ids, Action action) {
+    QMutexLocker locker(&m_mutex);
+    
+    foreach (const QString &id, ids) {
+        insert(Key(type, id), action);
+    }
+    
+    trim();
+}
+
+void ChangeLog::recordReadState(const QString &subscriptionId, bool isRead) {
+    QMutexLocker locker(&m_mutex);
+    
+    // Marking all subscriptions supersedes any earlier per-subscription states
+    if (subscriptionId.isEmpty()) {
+        QHash<Key, Entry>::iterator iterator = m_entries.begin();
+        
+        while (iterator != m_entries.end()) {
+            if (iterator.key().first == READ_STATE_ITEM) {
+                m_sequences.remove(iterator.value().sequence);
+                iterator = m_entries.erase(iterator);
+            }
+            else {
+                ++iterator;
+            }
+        }
+    }
+    
+    insert(Key(READ_STATE_ITEM, subscriptionId), isRead ? MarkedRead : MarkedUnread);
+    trim();
+}
+
+void ChangeLog::insert(const Key &key, Action action) {
+    Entry &entry = m_entries[key];
+    
+    if (entry.sequence > 0) {
+        m_sequences.remove(entry.sequence);
+    }
+    
+    entry.sequence = ++m_sequence;
+    entry.action = action;
+    
+    if (action == Added) {
+        entry.added = entry.sequence;
+    }
+    
+    m_sequences.insert(entry.sequence, key);
+}
+
+void ChangeLog::trim() {
+    if (m_sequences.size() <= MAXIMUM_ENTRIES) {
+        return;
+    }
+    
+    Logger::log(QString("ChangeLog::trim(). Removing %1 entries").arg(m_sequences.size() - MAXIMUM_ENTRIES),
+                Logger::HighVerbosity);
+    
+    while (m_sequences.size() > MAXIMUM_ENTRIES) {
+        QMap<qlonglong, Key>::iterator iterator = m_sequences.begin();
+        m_firstSequence = iterator.key();
+        m_entries.remove(iterator.value());
+        m_sequences.erase(iterator);
+    }
+}
+
+void ChangeLog::onSubscriptionsAdded(const QStringList &ids) {
+    record(SubscriptionItem, ids, Added);
+}
+
+void ChangeLog::onSubscriptionDeleted(const QString &id) {
+    record(SubscriptionItem, id, Removed);
+}
+
+void ChangeLog::onSubscriptionUpdated(const QString &id) {
+    record(SubscriptionItem, id, Changed);
+}
+
+void ChangeLog::onSubscriptionsUpdated(const QStringList &ids) {
+    record(SubscriptionItem, ids, Changed);
+}
+
+void ChangeLog::onSubscriptionRead(const QString &id, bool isRead) {
+    recordReadState(id, isRead);
+    record(SubscriptionItem, id, Changed);
+}
+
+void ChangeLog::onAllSubscriptionsRead() {
+    recordReadState(QString(), true);
+}
+
+void ChangeLog::onArticlesAdded(const QStringList &articleIds, const QString &subscriptionId) {
+    record(ArticleItem, articleIds, Added);
+    record(SubscriptionItem, subscriptionId, Changed);
+}
+
+void ChangeLog::onArticlesDeleted(const QStringList &articleIds, const QString &subscriptionId) {
+    record(ArticleItem, articleIds, Removed);
+    record(SubscriptionItem, subscriptionId, Changed);
+}
+
+void ChangeLog::onArticleUpdated(const QString &id) {
+    record(ArticleItem, id, Changed);
+}
+
+void ChangeLog::onArticleFavourited(const QString &id) {
+    record(ArticleItem, id, Changed);
+}
+
+void ChangeLog::onArticlesFavourited(const QStringList &ids) {
+    record(ArticleItem, ids, Changed);
+}
+
+void ChangeLog::onArticleRead(const QString &articleId, const QString &subscriptionId) {
+    record(ArticleItem, articleId, Changed);
+    record(SubscriptionItem, subscriptionId, Changed);
+}
+
+void ChangeLog::onArticlesRead(const QStringList &articleIds, const QStringList &subscriptionIds) {
+    record(ArticleItem, articleIds, Changed);
+    record(SubscriptionItem, subscriptionIds.toSet().toList(), Changed);
+}
+
+void ChangeLog::onTransferAdded(Transfer *transfer) {
+    connect(transfer, SIGNAL(dataChanged(Transfer*, int)), this, SLOT(onTransferDataChanged(Transfer*)));
+    record(TransferItem, transfer->id(), Added);
+}
+
+void ChangeLog::onTransferDataChanged(Transfer *transfer) {
+    record(TransferItem, transfer->id(), Changed);
+}
+
+void ChangeLog::onTransferRemoved(Transfer *transfer) {
+    disconnect(transfer, 0, this, 0);
+    record(TransferItem, transfer->id(), Removed);
+}
@@ -0,0 +1,147 @@
+/*
+ * Copyright (C) 2017 Stuart Howarth <showarth@marxoft.co.uk>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CHANGELOG_H
+#define CHANGELOG_H
+
+#include <QObject>
+#include <QHash>
+#include <QMap>
+#include <QMutex>
+#include <QPair>
+#include <QStringList>
+
+class Transfer;
+
+struct ChangeSet
+{
+    ChangeSet() :
+        sequence(0),
+        complete(true)
+    {
+    }
+    
+    QStringList added;
+    QStringList changed;
+    QStringList removed;
+    
+    qlonglong sequence;
+    bool complete;
+};
+
+/**
+ * Records which articles, subscriptions and transfers have changed, so that remote clients can
+ * request only the changes made since their last sync.
+ *
+ * Each item is kept only once, at the sequence number of its latest change. Sequence numbers
+ * are seeded from the start time, so a sequence from a previous run is always out of range.
+ */
+class ChangeLog : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum ItemType {
+        ArticleItem = 0,
+        SubscriptionItem,
+        TransferItem,
+        ItemTypeCount
+    };
+    
+    ~ChangeLog();
+    
+    static ChangeLog* instance();
+    
+    qlonglong sequence() const;
+    
+    /**
+     * Returns the changes made after since. If since is no longer covered by the log,
+     * the returned sets are not complete and the client must reload.
+     */
+    QList<ChangeSet> changesSince(qlonglong since) const;
+    
+    /**
+     * Returns the subscriptions whose articles were all marked as read or unread after since,
+     * in the order they were marked. An empty subscription id refers to all subscriptions.
+     */
+    QList< QPair<QString, bool> > readStatesSince(qlonglong since) const;
+
+private Q_SLOTS:
+    void onSubscriptionsAdded(const QStringList &ids);
+    void onSubscriptionDeleted(const QString &id);
+    void onSubscriptionUpdated(const QString &id);
+    void onSubscriptionsUpdated(const QStringList &ids);
+    void onSubscriptionRead(const QString &id, bool isRead);
+    void onAllSubscriptionsRead();
+    
+    void onArticlesAdded(const QStringList &articleIds, const QString &subscriptionId);
+    void onArticlesDeleted(const QStringList &articleIds, const QString &subscriptionId);
+    void onArticleUpdated(const QString &id);
+    void onArticleFavourited(const QString &id);
+    void onArticlesFavourited(const QStringList &ids);
+    void onArticleRead(const QString &articleId, const QString &subscriptionId);
+    void onArticlesRead(const QStringList &articleIds, const QStringList &subscriptionIds);
+    
+    void onTransferAdded(Transfer *transfer);
+    void onTransferDataChanged(Transfer *transfer);
+    void onTransferRemoved(Transfer *transfer);
+
+private:
+    enum Action {
+        Added = 0,
+        Changed,
+        Removed,
+        MarkedRead,
+        MarkedUnread
+    };
+    
+    struct Entry
+    {
+        Entry() :
+            sequence(0),
+            added(0),
+            action(Changed)
+        {
+        }
+        
+        qlonglong sequence;
+        qlonglong added;
+        Action action;
+    };
+    
+    typedef QPair<int, QString> Key;
+    
+    ChangeLog();
+    
+    void record(ItemType type, const QString &id, Action action);
+    void record(ItemType type, const QStringList &ids, Action action);
+    void recordReadState(const QString &subscriptionId, bool isRead);
+    
+    void insert(const Key &key, Action action);
+    void trim();
+    
+    static ChangeLog *self;
+    
+    mutable QMutex m_mutex;
+    
+    qlonglong m_sequence;
+    qlonglong m_firstSequence;
+    
+    QHash<Key, Entry> m_entries;
+    QMap<qlonglong, Key> m_sequences;
+};
+
+#endif // CHANGELOG_H
@@ -0,0 +1,121 @@
+/*
+ * Copyright (C) 2017 Stuart Howarth <showarth@marxoft.co.uk>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "databaseserver.h"
+#include "dbconnection.h"
+#include "dbmaintenance.h"
+#include "definitions.h"
+#include "qhttprequest.h"
+#include "qhttpresponse.h"
+#include "serverresponse.h"
+#include <QFileInfo>
+
+DatabaseServer::DatabaseServer(QObject *parent) :
+    QObject(parent)
+{
+}
+
+bool DatabaseServer::handleRequest(QHttpRequest *request, QHttpResponse *response) {
+    const QStringList parts = request->path().split("/", QString::SkipEmptyParts);
+    
+    if ((parts.size() < 2) || (parts.size() > 3) || (parts.at(0).compare("settings", Qt::CaseInsensitive) != 0)
+        || (parts.at(1).compare("database", Qt::CaseInsensitive) != 0)) {
+        return false;
+    }
+    
+    if (request->method() != QHttpRequest::HTTP_GET) {
+        writeResponse(response, QHttpResponse::STATUS_METHOD_NOT_ALLOWED);
+        return true;
+    }
+    
+    if (parts.size() == 2) {
+        DBConnection *connection = DBConnection::connection(this, SLOT(onStatisticsFetched(DBConnection*)));
+        addResponse(connection, response);
+        connection->fetchDatabaseStatistics();
+        return true;
+    }
+    
+    if (parts.at(2).compare("maintenance", Qt::CaseInsensitive) == 0) {
+        if (DBMaintenance::instance()->run(true)) {
+            writeResponse(response, QHttpResponse::STATUS_ACCEPTED);
+        }
+        else {
+            writeResponse(response, QHttpResponse::STATUS_CONFLICT);
+        }
+        
+        return true;
+    }
+    
+    return false;
+}
+
+void DatabaseServer::addResponse(DBConnection *connection, QHttpResponse *response) {
+    m_responses.insert(connection, response);
+    connect(response, SIGNAL(done()), this, SLOT(onResponseDone()));
+}
+
+QHttpResponse* DatabaseServer::getResponse(DBConnection *connection) {
+    return m_responses.value(connection);
+}
+
+void DatabaseServer::removeResponse(QHttpResponse *response) {
+    if (DBConnection *connection = m_responses.key(response)) {
+        m_responses.remove(connection);
+        connection->deleteLater();
+        disconnect(response, 0, this, 0);
+    }
+}
+
+void DatabaseServer::onStatisticsFetched(DBConnection *connection) {
+    if (QHttpResponse *response = getResponse(connection)) {
+        if (connection->status() == DBConnection::Ready) {
+            const qint64 pageSize = connection->property("page_size").toLongLong();
+            const qint64 pageCount = connection->property("page_count").toLongLong();
+            const qint64 freelistCount = connection->property("freelist_count").toLongLong();
+            QVariantMap result;
+            result["fileSize"] = QFileInfo(DATABASE_NAME).size();
+            result["pageSize"] = pageSize;
+            result["pageCount"] = pageCount;
+            result["freelistCount"] = freelistCount;
+            result["freeBytes"] = pageSize * freelistCount;
+            result["maintenanceActive"] = DBMaintenance::instance()->isActive();
+            result["lastMaintenance"] = DBMaintenance::instance()->lastRun().toString(Qt::ISODate);
+            result["lastAnalyzed"] = DBMaintenance::instance()->lastAnalyzed().toString(Qt::ISODate);
+            QVariantList subscriptions;
+            
+            while (connection->nextRecord()) {
+                QVariantMap subscription;
+                subscription["id"] = connection->value(0);
+                subscription["title"] = connection->value(1);
+                subscription["articles"] = connection->value(2);
+                subscription["bytes"] = connection->value(3).toLongLong();
+                subscriptions << subscription;
+            }
+            
+            result["subscriptions"] = subscriptions;
+            writeResponse(response, QHttpResponse::STATUS_OK, result);
+        }
+        else {
+            writeResponse(response, QHttpResponse::STATUS_INTERNAL_SERVER_ERROR);
+        }
+    }
+}
+
+void DatabaseServer::onResponseDone() {
+    if (QHttpResponse *response = qobject_cast<QHttpResponse*>(sender())) {
+        removeResponse(response);
+    }
+}
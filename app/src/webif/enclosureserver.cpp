@@ -15,7 +15,6 @@
  */
 
 #include "enclosureserver.h"
-#include "json.h"
 #include "pluginmanager.h"
 #include "pluginsettings.h"
 #include "qhttprequest.h"
@@ -97,7 +96,7 @@ void EnclosureServer::onEnclosureRequestFinished(EnclosureRequest *request) {
     if (QHttpResponse *response = getResponse(request)) {
         if (request->status() == EnclosureRequest::Ready) {
             writeResponse(response, QHttpResponse::STATUS_OK,
-                    QtJson::Json::serialize(enclosureResultToMap(request->result())));
+                    enclosureResultToMap(request->result()));
         }
         else {
             writeResponse(response, QHttpResponse::STATUS_INTERNAL_SERVER_ERROR);
@@ -48,7 +48,7 @@ bool FileServer::handleRequest(QHttpRequest *request, QHttpResponse *response) {
     if (!QFile::exists(filePath)) {
         if (dir.startsWith(CACHE_PATH)) {
             const QByteArray url = QByteArray::fromBase64(filePath.mid(filePath.lastIndexOf("/") + 1).toUtf8());
-            getCachedFile(dir, QUrl::fromEncoded(url), response);
+            getCachedFile(DiskCache::directoryForPath(filePath), QUrl::fromEncoded(url), response);
             return true;
         }
         
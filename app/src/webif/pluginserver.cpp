@@ -15,7 +15,7 @@
  */
 
 #include "pluginserver.h"
-#include "json.h"
+#include "jsonreader.h"
 #include "pluginmanager.h"
 #include "pluginsettings.h"
 #include "qhttprequest.h"
@@ -126,7 +126,7 @@ bool PluginServer::handleRequest(QHttpRequest *request, QHttpResponse *response)
                 configs << pluginConfigToMap(plugins.at(i).config);
             }
             
-            writeResponse(response, QHttpResponse::STATUS_OK, QtJson::Json::serialize(configs));
+            writeResponse(response, QHttpResponse::STATUS_OK, configs);
         }
         else {
             writeResponse(response, QHttpResponse::STATUS_METHOD_NOT_ALLOWED);
@@ -144,7 +144,7 @@ bool PluginServer::handleRequest(QHttpRequest *request, QHttpResponse *response)
 
     if (parts.size() == 2) {
         if (request->method() == QHttpRequest::HTTP_GET) {
-            writeResponse(response, QHttpResponse::STATUS_OK, QtJson::Json::serialize(pluginConfigToMap(config)));
+            writeResponse(response, QHttpResponse::STATUS_OK, pluginConfigToMap(config));
         }
         else {
             writeResponse(response, QHttpResponse::STATUS_METHOD_NOT_ALLOWED);
@@ -157,11 +157,11 @@ bool PluginServer::handleRequest(QHttpRequest *request, QHttpResponse *response)
         if (parts.at(2).compare("articlesettings", Qt::CaseInsensitive) == 0) {
             if (request->method() == QHttpRequest::HTTP_GET) {
                 writeResponse(response, QHttpResponse::STATUS_OK,
-                        QtJson::Json::serialize(pluginConfigArticleSettings(config)));
+                        pluginConfigArticleSettings(config));
             }
             else if (request->method() == QHttpRequest::HTTP_PUT) {
                 PluginSettings ps(config->id());
-                ps.setValues(QtJson::Json::parse(QString::fromUtf8(request->body())).toMap());
+                ps.setValues(JsonReader::parse(QString::fromUtf8(request->body())).toMap());
                 writeResponse(response, QHttpResponse::STATUS_OK);
             }
             else {
@@ -171,11 +171,11 @@ bool PluginServer::handleRequest(QHttpRequest *request, QHttpResponse *response)
         else if (parts.at(2).compare("enclosuresettings", Qt::CaseInsensitive) == 0) {
             if (request->method() == QHttpRequest::HTTP_GET) {
                 writeResponse(response, QHttpResponse::STATUS_OK,
-                        QtJson::Json::serialize(pluginConfigEnclosureSettings(config)));
+                        pluginConfigEnclosureSettings(config));
             }
             else if (request->method() == QHttpRequest::HTTP_PUT) {
                 PluginSettings ps(config->id());
-                ps.setValues(QtJson::Json::parse(QString::fromUtf8(request->body())).toMap());
+                ps.setValues(JsonReader::parse(QString::fromUtf8(request->body())).toMap());
                 writeResponse(response, QHttpResponse::STATUS_OK);
             }
             else {
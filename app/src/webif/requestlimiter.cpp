@@ -0,0 +1,144 @@
+/*
+ * Copyright (C) 2017 Stuart Howarth <showarth@marxoft.co.uk>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "requestlimiter.h"
+#include "logger.h"
+#include "qhttprequest.h"
+#include "qhttpresponse.h"
+#include <QStringList>
+#include <qmath.h>
+
+// Each client can make a burst of 60 requests, then 20 requests per second
+static const double BUCKET_SIZE = 60.0;
+static const double BUCKET_RATE = 20.0;
+
+// Buckets that have refilled are removed once there are more clients than this
+static const int MAX_BUCKETS = 256;
+
+// The number of requests that can be handled at once, for each priority
+static const int MAX_ACTIVE_REQUESTS[] = { 64, 32, 8 };
+
+// Overloaded clients are asked to retry after one second
+static const int OVERLOADED_RETRY_AFTER = 1;
+
+// Releases the request's place when the response is deleted
+class RequestTicket : public QObject
+{
+
+public:
+    RequestTicket(RequestLimiter *limiter, QObject *parent) :
+        QObject(parent),
+        m_limiter(limiter)
+    {
+    }
+    
+    ~RequestTicket() {
+        m_limiter->release();
+    }
+
+private:
+    RequestLimiter *m_limiter;
+};
+
+RequestLimiter::RequestLimiter() :
+    m_active(0)
+{
+    m_timer.start();
+}
+
+RequestLimiter::Result RequestLimiter::admit(QHttpRequest *request, QHttpResponse *response, int *retryAfter) {
+    QMutexLocker locker(&m_mutex);
+    
+    if (!takeToken(request->remoteAddress(), retryAfter)) {
+        Logger::log("RequestLimiter::admit(). Rate limit exceeded by " + request->remoteAddress(),
+                    Logger::MediumVerbosity);
+        return RateLimited;
+    }
+    
+    if (m_active >= MAX_ACTIVE_REQUESTS[priority(request)]) {
+        Logger::log("RequestLimiter::admit(). Too many active requests. Rejecting " + request->path(),
+                    Logger::MediumVerbosity);
+        *retryAfter = OVERLOADED_RETRY_AFTER;
+        return Overloaded;
+    }
+    
+    ++m_active;
+    // The ticket moves with the response if it is handled in another thread
+    new RequestTicket(this, response);
+    return Accepted;
+}
+
+RequestLimiter::Priority RequestLimiter::priority(const QHttpRequest *request) {
+    const QString path = request->path();
+    
+    if ((path.startsWith("/settings/database", Qt::CaseInsensitive))
+        || (path.startsWith("/articles/deleteread", Qt::CaseInsensitive))
+        || (path.startsWith("/subscriptions/update", Qt::CaseInsensitive))) {
+        return MaintenancePriority;
+    }
+    
+    const QStringList apiPaths = QStringList() << "/articles" << "/enclosures" << "/plugins" << "/settings"
+                                               << "/subscriptions" << "/sync" << "/transfers";
+    
+    foreach (const QString &apiPath, apiPaths) {
+        if (path.startsWith(apiPath, Qt::CaseInsensitive)) {
+            return ApiPriority;
+        }
+    }
+    
+    return InterfacePriority;
+}
+
+bool RequestLimiter::takeToken(const QString &client, int *retryAfter) {
+    const qint64 now = m_timer.elapsed();
+    
+    if ((m_buckets.size() > MAX_BUCKETS) && (!m_buckets.contains(client))) {
+        QMutableHashIterator<QString, Bucket> iterator(m_buckets);
+        
+        while (iterator.hasNext()) {
+            iterator.next();
+            
+            if (iterator.value().tokens + (now - iterator.value().time) * BUCKET_RATE / 1000 >= BUCKET_SIZE) {
+                iterator.remove();
+            }
+        }
+    }
+    
+    if (!m_buckets.contains(client)) {
+        Bucket bucket;
+        bucket.tokens = BUCKET_SIZE;
+        bucket.time = now;
+        m_buckets.insert(client, bucket);
+    }
+    
+    Bucket &bucket = m_buckets[client];
+    bucket.tokens = qMin(BUCKET_SIZE, bucket.tokens + (now - bucket.time) * BUCKET_RATE / 1000);
+    bucket.time = now;
+    
+    if (bucket.tokens < 1.0) {
+        *retryAfter = qMax(1, qCeil((1.0 - bucket.tokens) / BUCKET_RATE));
+        return false;
+    }
+    
+    bucket.tokens -= 1.0;
+    return true;
+}
+
+void RequestLimiter::release() {
+    QMutexLocker locker(&m_mutex);
+    --m_active;
+}
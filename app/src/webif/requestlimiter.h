@@ -0,0 +1,83 @@
+/*
+ * Copyright (C) 2017 Stuart Howarth <showarth@marxoft.co.uk>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef REQUESTLIMITER_H
+#define REQUESTLIMITER_H
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QMutex>
+
+class QHttpRequest;
+class QHttpResponse;
+
+/**
+ * Decides whether the web server should handle a request.
+ *
+ * Each client has a token bucket, so that it cannot make requests faster than a sustained rate.
+ * The number of requests being handled is also limited, with requests for the web interface
+ * itself admitted before API requests, and API requests admitted before maintenance requests.
+ * This keeps a busy client from queueing database work ahead of the application.
+ *
+ * Requests that are not admitted should be answered with the number of seconds to wait before
+ * retrying.
+ */
+class RequestLimiter
+{
+
+public:
+    enum Priority {
+        InterfacePriority = 0,
+        ApiPriority,
+        MaintenancePriority
+    };
+    
+    enum Result {
+        Accepted = 0,
+        RateLimited,
+        Overloaded
+    };
+    
+    RequestLimiter();
+    
+    Result admit(QHttpRequest *request, QHttpResponse *response, int *retryAfter);
+    
+    static Priority priority(const QHttpRequest *request);
+
+private:
+    struct Bucket
+    {
+        double tokens;
+        qint64 time;
+    };
+    
+    bool takeToken(const QString &client, int *retryAfter);
+    
+    void release();
+    
+    QHash<QString, Bucket> m_buckets;
+    
+    QElapsedTimer m_timer;
+    
+    int m_active;
+    
+    QMutex m_mutex;
+    
+    friend class RequestTicket;
+};
+
+#endif // REQUESTLIMITER_H
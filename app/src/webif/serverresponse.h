@@ -17,8 +17,24 @@
 #ifndef SERVERRESPONSE_H
 #define SERVERRESPONSE_H
 
+#include "jsonwriter.h"
+#include "msgpackwriter.h"
 #include "qhttpresponse.h"
 
+// Set on the response by WebRequestHandler when the client accepts MessagePack rather than JSON
+inline bool acceptsMsgPack(const QHttpResponse *response) {
+    return response->property("msgpack").toBool();
+}
+
+// Returns a writer for the format accepted by the client. The caller takes ownership.
+inline DataWriter* createWriter(const QHttpResponse *response, int reserve = 0) {
+    if (acceptsMsgPack(response)) {
+        return new MsgPackWriter(reserve);
+    }
+
+    return new JsonWriter(reserve);
+}
+
 inline void writeResponse(QHttpResponse *response, int responseCode, const QByteArray &data = QByteArray(),
         const QByteArray &contentType = QByteArray()) {
     if (!contentType.isEmpty()) {
@@ -30,4 +46,22 @@ inline void writeResponse(QHttpResponse *response, int responseCode, const QByte
     response->end(data);
 }
 
+inline void writeResponse(QHttpResponse *response, int responseCode, const DataWriter &writer) {
+    response->setHeader("Vary", "Accept");
+    writeResponse(response, responseCode, writer.data(), writer.contentType());
+}
+
+inline void writeResponse(QHttpResponse *response, int responseCode, const QVariant &data) {
+    if (acceptsMsgPack(response)) {
+        MsgPackWriter writer;
+        writer.writeVariant(data);
+        writeResponse(response, responseCode, writer);
+    }
+    else {
+        JsonWriter writer;
+        writer.writeVariant(data);
+        writeResponse(response, responseCode, writer);
+    }
+}
+
 #endif // SERVERRESPONSE_H
@@ -15,7 +15,7 @@
  */
 
 #include "settingsserver.h"
-#include "json.h"
+#include "jsonreader.h"
 #include "qhttprequest.h"
 #include "qhttpresponse.h"
 #include "serverresponse.h"
@@ -43,13 +43,13 @@ bool SettingsServer::handleRequest(QHttpRequest *request, QHttpResponse *respons
             settings[property.name()] = property.read(Settings::instance());
         }
         
-        writeResponse(response, QHttpResponse::STATUS_OK, QtJson::Json::serialize(settings));
+        writeResponse(response, QHttpResponse::STATUS_OK, settings);
         return true;
     }
     
     if (request->method() == QHttpRequest::HTTP_PUT) {
         const QByteArray body = request->body();
-        const QVariantMap settings = QtJson::Json::parse(QString::fromUtf8(body)).toMap();
+        const QVariantMap settings = JsonReader::parse(QString::fromUtf8(body)).toMap();
         
         if (settings.isEmpty()) {
             writeResponse(response, QHttpResponse::STATUS_BAD_REQUEST);
@@ -16,7 +16,7 @@
 
 #include "subscriptionserver.h"
 #include "dbconnection.h"
-#include "json.h"
+#include "jsonreader.h"
 #include "qhttprequest.h"
 #include "qhttpresponse.h"
 #include "serverresponse.h"
@@ -24,14 +24,14 @@
 #include "subscriptions.h"
 #include "utils.h"
 
-static QVariantMap subscriptionToMap(const DBConnection *connection) {
+QVariantMap SubscriptionServer::subscriptionToMap(const DBConnection *connection) {
     QVariantMap subscription;
     subscription["id"] = connection->value(0);
     subscription["description"] = connection->value(1);
     subscription["downloadEnclosures"] = connection->value(2);
     subscription["iconPath"] = connection->value(3);
     subscription["lastUpdated"] = connection->value(4);
-    subscription["source"] = QtJson::Json::parse(connection->value(5).toString());
+    subscription["source"] = JsonReader::parse(connection->value(5).toString());
     subscription["sourceType"] = connection->value(6);
     subscription["title"] = connection->value(7);
     subscription["updateInterval"] = connection->value(8);
@@ -64,7 +64,7 @@ bool SubscriptionServer::handleRequest(QHttpRequest *request, QHttpResponse *res
         }
         
         if (request->method() == QHttpRequest::HTTP_POST) {
-            const QVariantList list = QtJson::Json::parse(request->body()).toList();
+            const QVariantList list = JsonReader::parse(QString::fromUtf8(request->body())).toList();
             QVariantList subscriptions;
             
             foreach (const QVariant &v, list) {
@@ -95,7 +95,7 @@ bool SubscriptionServer::handleRequest(QHttpRequest *request, QHttpResponse *res
             }
             
             if (!subscriptions.isEmpty()) {
-                writeResponse(response, QHttpResponse::STATUS_CREATED, QtJson::Json::serialize(subscriptions));
+                writeResponse(response, QHttpResponse::STATUS_CREATED, subscriptions);
             }
             else {
                 writeResponse(response, QHttpResponse::STATUS_BAD_REQUEST);
@@ -104,6 +104,24 @@ bool SubscriptionServer::handleRequest(QHttpRequest *request, QHttpResponse *res
             return true;
         }
         
+        if (request->method() == QHttpRequest::HTTP_PUT) {
+            // Batch update: {"ids": [...], "properties": {...}}
+            const QVariantMap batch = JsonReader::parse(QString::fromUtf8(request->body())).toMap();
+            const QStringList ids = batch.value("ids").toStringList();
+            const QVariantMap properties = batch.value("properties").toMap();
+            
+            if ((ids.isEmpty()) || (properties.isEmpty())) {
+                writeResponse(response, QHttpResponse::STATUS_BAD_REQUEST);
+            }
+            else {
+                DBConnection *connection = DBConnection::connection(this, SLOT(onSubscriptionsFetched(DBConnection*)));
+                addResponse(connection, response);
+                connection->updateSubscriptions(ids, properties, true);
+            }
+            
+            return true;
+        }
+        
         writeResponse(response, QHttpResponse::STATUS_METHOD_NOT_ALLOWED);
         return true;
     }
@@ -124,7 +142,7 @@ bool SubscriptionServer::handleRequest(QHttpRequest *request, QHttpResponse *res
             status["progress"] = Subscriptions::instance()->progress();
             status["status"] = Subscriptions::instance()->status();
             status["statusText"] = Subscriptions::instance()->statusText();
-            writeResponse(response, QHttpResponse::STATUS_OK, QtJson::Json::serialize(status));
+            writeResponse(response, QHttpResponse::STATUS_OK, status);
             return true;
         }
         
@@ -140,7 +158,7 @@ bool SubscriptionServer::handleRequest(QHttpRequest *request, QHttpResponse *res
             status["progress"] = Subscriptions::instance()->progress();
             status["status"] = Subscriptions::instance()->status();
             status["statusText"] = Subscriptions::instance()->statusText();
-            writeResponse(response, QHttpResponse::STATUS_OK, QtJson::Json::serialize(status));
+            writeResponse(response, QHttpResponse::STATUS_OK, status);
             return true;
         }
         
@@ -209,7 +227,7 @@ bool SubscriptionServer::handleRequest(QHttpRequest *request, QHttpResponse *res
     }
     
     if (request->method() == QHttpRequest::HTTP_PUT) {
-        const QVariantMap properties = QtJson::Json::parse(request->body()).toMap();
+        const QVariantMap properties = JsonReader::parse(QString::fromUtf8(request->body())).toMap();
         
         if (properties.isEmpty()) {
             writeResponse(response, QHttpResponse::STATUS_BAD_REQUEST);
@@ -265,7 +283,7 @@ void SubscriptionServer::onConnectionFinished(DBConnection *connection) {
 void SubscriptionServer::onSubscriptionFetched(DBConnection *connection) {
     if (QHttpResponse *response = getResponse(connection)) {
         if (connection->status() == DBConnection::Ready) {
-            writeResponse(response, QHttpResponse::STATUS_OK, QtJson::Json::serialize(subscriptionToMap(connection)));
+            writeResponse(response, QHttpResponse::STATUS_OK, subscriptionToMap(connection));
         }
         else {
             writeResponse(response, QHttpResponse::STATUS_INTERNAL_SERVER_ERROR);
@@ -282,7 +300,7 @@ void SubscriptionServer::onSubscriptionsFetched(DBConnection *connection) {
                 subscriptions << subscriptionToMap(connection);
             }
             
-            writeResponse(response, QHttpResponse::STATUS_OK, QtJson::Json::serialize(subscriptions));
+            writeResponse(response, QHttpResponse::STATUS_OK, subscriptions);
         }
         else {
             writeResponse(response, QHttpResponse::STATUS_INTERNAL_SERVER_ERROR);
@@ -19,6 +19,7 @@
 
 #include <QObject>
 #include <QHash>
+#include <QVariantMap>
 
 class DBConnection;
 class QHttpRequest;
@@ -32,6 +33,8 @@ public:
     explicit SubscriptionServer(QObject *parent = 0);
     
     bool handleRequest(QHttpRequest *request, QHttpResponse *response);
+    
+    static QVariantMap subscriptionToMap(const DBConnection *connection);
 
 private Q_SLOTS:
     void onConnectionFinished(DBConnection *connection);
@@ -0,0 +1,227 @@
+/*
+ * Copyright (C) 2017 Stuart Howarth <showarth@marxoft.co.uk>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "syncserver.h"
+#include "dbconnection.h"
+#include "qhttprequest.h"
+#include "qhttpresponse.h"
+#include "serverresponse.h"
+#include "subscriptionserver.h"
+#include "transfers.h"
+#include "transferserver.h"
+#include "utils.h"
+#include <QSet>
+
+// Articles are reported by state only. Clients fetch the full article when they need it.
+static QVariantMap articleStateToMap(const DBConnection *connection) {
+    QVariantMap article;
+    article["id"] = connection->value(0);
+    article["subscriptionId"] = connection->value(1);
+    article["favourite"] = connection->value(2).toBool();
+    article["read"] = connection->value(3).toBool();
+    return article;
+}
+
+static QVariantMap changesToMap(const ChangeSet &set, const QList<QVariantMap> &records) {
+    const QSet<QString> addedIds = set.added.toSet();
+    QSet<QString> foundIds;
+    QVariantList added;
+    QVariantList changed;
+    QStringList removed = set.removed;
+    
+    foreach (const QVariantMap &record, records) {
+        const QString id = record.value("id").toString();
+        foundIds << id;
+        
+        if (addedIds.contains(id)) {
+            added << record;
+        }
+        else {
+            changed << record;
+        }
+    }
+    
+    // Items that have gone since the change was recorded are reported as removed
+    foreach (const QString &id, set.added + set.changed) {
+        if (!foundIds.contains(id)) {
+            removed << id;
+        }
+    }
+    
+    QVariantMap changes;
+    changes["added"] = added;
+    changes["changed"] = changed;
+    changes["removed"] = removed;
+    return changes;
+}
+
+SyncServer::SyncServer(QObject *parent) :
+    QObject(parent)
+{
+}
+
+bool SyncServer::handleRequest(QHttpRequest *request, QHttpResponse *response) {
+    const QStringList parts = request->path().split("/", QString::SkipEmptyParts);
+    
+    if ((parts.size() != 1) || (parts.first().compare("sync", Qt::CaseInsensitive) != 0)) {
+        return false;
+    }
+    
+    if (request->method() != QHttpRequest::HTTP_GET) {
+        writeResponse(response, QHttpResponse::STATUS_METHOD_NOT_ALLOWED);
+        return true;
+    }
+    
+    const qlonglong since = Utils::urlQueryItemValue(request->url(), "since", "0").toLongLong();
+    const QList<ChangeSet> changes = ChangeLog::instance()->changesSince(since);
+    const ChangeSet &transfers = changes.at(ChangeLog::TransferItem);
+    PendingSync sync;
+    sync.result["sequence"] = transfers.sequence;
+    sync.result["complete"] = transfers.complete;
+    
+    if (!transfers.complete) {
+        writeResponse(response, QHttpResponse::STATUS_OK, sync.result);
+        return true;
+    }
+    
+    QList<QVariantMap> records;
+    
+    foreach (const QString &id, transfers.added + transfers.changed) {
+        if (const Transfer *transfer = Transfers::instance()->get(id)) {
+            records << TransferServer::transferToMap(transfer);
+        }
+    }
+    
+    QVariantList readStates;
+    const QList< QPair<QString, bool> > states = ChangeLog::instance()->readStatesSince(since);
+    
+    for (int i = 0; i < states.size(); i++) {
+        QVariantMap state;
+        state["subscriptionId"] = states.at(i).first;
+        state["read"] = states.at(i).second;
+        readStates << state;
+    }
+    
+    sync.result["transfers"] = changesToMap(transfers, records);
+    sync.result["readStates"] = readStates;
+    sync.articles = changes.at(ChangeLog::ArticleItem);
+    sync.subscriptions = changes.at(ChangeLog::SubscriptionItem);
+    m_syncs.insert(response, sync);
+    connect(response, SIGNAL(done()), this, SLOT(onResponseDone()));
+    fetchSubscriptions(response);
+    return true;
+}
+
+void SyncServer::fetchSubscriptions(QHttpResponse *response) {
+    const ChangeSet &subscriptions = m_syncs[response].subscriptions;
+    
+    if ((subscriptions.added.isEmpty()) && (subscriptions.changed.isEmpty())) {
+        m_syncs[response].result["subscriptions"] = changesToMap(subscriptions, QList<QVariantMap>());
+        fetchArticles(response);
+        return;
+    }
+    
+    DBConnection *connection = DBConnection::connection(this, SLOT(onSubscriptionsFetched(DBConnection*)));
+    addResponse(connection, response);
+    connection->fetchSubscriptions(subscriptions.added + subscriptions.changed);
+}
+
+void SyncServer::fetchArticles(QHttpResponse *response) {
+    const ChangeSet &articles = m_syncs[response].articles;
+    
+    if ((articles.added.isEmpty()) && (articles.changed.isEmpty())) {
+        m_syncs[response].result["articles"] = changesToMap(articles, QList<QVariantMap>());
+        finishSync(response);
+        return;
+    }
+    
+    DBConnection *connection = DBConnection::connection(this, SLOT(onArticlesFetched(DBConnection*)));
+    addResponse(connection, response);
+    connection->exec(QString("SELECT id, subscriptionId, isFavourite, isRead FROM articles WHERE id IN (%1)")
+                     .arg(DBConnection::idList(articles.added + articles.changed)));
+}
+
+void SyncServer::finishSync(QHttpResponse *response) {
+    const QVariantMap result = m_syncs.take(response).result;
+    disconnect(response, 0, this, 0);
+    writeResponse(response, QHttpResponse::STATUS_OK, result);
+}
+
+void SyncServer::addResponse(DBConnection *connection, QHttpResponse *response) {
+    m_responses.insert(connection, response);
+}
+
+QHttpResponse* SyncServer::takeResponse(DBConnection *connection) {
+    connection->deleteLater();
+    return m_responses.take(connection);
+}
+
+void SyncServer::removeResponse(QHttpResponse *response) {
+    m_syncs.remove(response);
+    
+    if (DBConnection *connection = m_responses.key(response)) {
+        m_responses.remove(connection);
+        connection->deleteLater();
+    }
+    
+    disconnect(response, 0, this, 0);
+}
+
+void SyncServer::onSubscriptionsFetched(DBConnection *connection) {
+    if (QHttpResponse *response = takeResponse(connection)) {
+        if (connection->status() == DBConnection::Ready) {
+            PendingSync &sync = m_syncs[response];
+            QList<QVariantMap> records;
+            
+            while (connection->nextRecord()) {
+                records << SubscriptionServer::subscriptionToMap(connection);
+            }
+            
+            sync.result["subscriptions"] = changesToMap(sync.subscriptions, records);
+            fetchArticles(response);
+        }
+        else {
+            removeResponse(response);
+            writeResponse(response, QHttpResponse::STATUS_INTERNAL_SERVER_ERROR);
+        }
+    }
+}
+
+void SyncServer::onArticlesFetched(DBConnection *connection) {
+    if (QHttpResponse *response = takeResponse(connection)) {
+        if (connection->status() == DBConnection::Ready) {
+            PendingSync &sync = m_syncs[response];
+            QList<QVariantMap> records;
+            
+            while (connection->nextRecord()) {
+                records << articleStateToMap(connection);
+            }
+            
+            sync.result["articles"] = changesToMap(sync.articles, records);
+            finishSync(response);
+        }
+        else {
+            removeResponse(response);
+            writeResponse(response, QHttpResponse::STATUS_INTERNAL_SERVER_ERROR);
+        }
+    }
+}
+
+void SyncServer::onResponseDone() {
+    if (QHttpResponse *response = qobject_cast<QHttpResponse*>(sender())) {
+        removeResponse(response);
+    }
+}
@@ -0,0 +1,66 @@
+/*
+ * Copyright (C) 2017 Stuart Howarth <showarth@marxoft.co.uk>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SYNCSERVER_H
+#define SYNCSERVER_H
+
+#include "changelog.h"
+#include <QHash>
+#include <QVariantMap>
+
+class DBConnection;
+class QHttpRequest;
+class QHttpResponse;
+
+/**
+ * Handles GET /sync?since=<sequence>, returning the articles, subscriptions and transfers
+ * that have been added, changed or removed since the given sequence.
+ */
+class SyncServer : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit SyncServer(QObject *parent = 0);
+    
+    bool handleRequest(QHttpRequest *request, QHttpResponse *response);
+
+private Q_SLOTS:
+    void onSubscriptionsFetched(DBConnection *connection);
+    void onArticlesFetched(DBConnection *connection);
+    void onResponseDone();
+
+private:
+    struct PendingSync
+    {
+        QVariantMap result;
+        ChangeSet articles;
+        ChangeSet subscriptions;
+    };
+    
+    void fetchSubscriptions(QHttpResponse *response);
+    void fetchArticles(QHttpResponse *response);
+    void finishSync(QHttpResponse *response);
+    
+    void addResponse(DBConnection *connection, QHttpResponse *response);
+    QHttpResponse* takeResponse(DBConnection *connection);
+    void removeResponse(QHttpResponse *response);
+    
+    QHash<DBConnection*, QHttpResponse*> m_responses;
+    QHash<QHttpResponse*, PendingSync> m_syncs;
+};
+
+#endif // SYNCSERVER_H
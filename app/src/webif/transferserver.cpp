@@ -15,14 +15,15 @@
  */
 
 #include "transferserver.h"
-#include "json.h"
+#include "jsonreader.h"
 #include "qhttprequest.h"
 #include "qhttpresponse.h"
 #include "serverresponse.h"
+#include "settings.h"
 #include "transfers.h"
 #include "utils.h"
 
-static QVariantMap transferToMap(const Transfer *transfer) {
+QVariantMap TransferServer::transferToMap(const Transfer *transfer) {
     QVariantMap map;
     QHashIterator<int, QByteArray> iterator(Transfer::roleNames());
     
@@ -34,6 +35,19 @@ static QVariantMap transferToMap(const Transfer *transfer) {
     return map;
 }
 
+static QVariantMap speedLimitsToMap() {
+    QVariantMap limits;
+    QVariantMap categories;
+    
+    foreach (const QString &category, Settings::categoryNames()) {
+        categories[category] = Settings::maximumDownloadSpeed(category);
+    }
+    
+    limits["maximumDownloadSpeed"] = Settings::maximumDownloadSpeed();
+    limits["categories"] = categories;
+    return limits;
+}
+
 TransferServer::TransferServer(QObject *parent) :
     QObject(parent)
 {
@@ -66,12 +80,12 @@ bool TransferServer::handleRequest(QHttpRequest *request, QHttpResponse *respons
                 }
             }
             
-            writeResponse(response, QHttpResponse::STATUS_OK, QtJson::Json::serialize(list));
+            writeResponse(response, QHttpResponse::STATUS_OK, list);
             return true;
         }
         
         if (request->method() == QHttpRequest::HTTP_POST) {
-            const QVariantList list = QtJson::Json::parse(request->body()).toList();
+            const QVariantList list = JsonReader::parse(QString::fromUtf8(request->body())).toList();
             QVariantList transfers;
             
             foreach (const QVariant &v, list) {
@@ -94,7 +108,7 @@ bool TransferServer::handleRequest(QHttpRequest *request, QHttpResponse *respons
             }
             
             if (!transfers.isEmpty()) {
-                writeResponse(response, QHttpResponse::STATUS_CREATED, QtJson::Json::serialize(transfers));
+                writeResponse(response, QHttpResponse::STATUS_CREATED, transfers);
             }
             else {
                 writeResponse(response, QHttpResponse::STATUS_BAD_REQUEST);
@@ -107,6 +121,64 @@ bool TransferServer::handleRequest(QHttpRequest *request, QHttpResponse *respons
         return true;
     }
     
+    if (parts.at(1) == "limits") {
+        if (request->method() == QHttpRequest::HTTP_GET) {
+            writeResponse(response, QHttpResponse::STATUS_OK, speedLimitsToMap());
+            return true;
+        }
+        
+        if (request->method() == QHttpRequest::HTTP_PUT) {
+            const QVariantMap properties = JsonReader::parse(QString::fromUtf8(request->body())).toMap();
+            
+            if (properties.isEmpty()) {
+                writeResponse(response, QHttpResponse::STATUS_BAD_REQUEST);
+                return true;
+            }
+            
+            if (properties.contains("maximumDownloadSpeed")) {
+                Settings::setMaximumDownloadSpeed(properties.value("maximumDownloadSpeed").toInt());
+            }
+            
+            QMapIterator<QString, QVariant> iterator(properties.value("categories").toMap());
+            
+            while (iterator.hasNext()) {
+                iterator.next();
+                Settings::setMaximumDownloadSpeed(iterator.key(), iterator.value().toInt());
+            }
+            
+            writeResponse(response, QHttpResponse::STATUS_OK, speedLimitsToMap());
+            return true;
+        }
+        
+        writeResponse(response, QHttpResponse::STATUS_METHOD_NOT_ALLOWED);
+        return true;
+    }
+    
+    if (parts.at(1) == "enclosure") {
+        if (request->method() == QHttpRequest::HTTP_GET) {
+            const QString url = Utils::urlQueryItemValue(request->url(), "url");
+            
+            if (url.isEmpty()) {
+                writeResponse(response, QHttpResponse::STATUS_BAD_REQUEST);
+                return true;
+            }
+            
+            const QVariantMap enclosure = Transfers::instance()->enclosure(url);
+            
+            if (enclosure.isEmpty()) {
+                writeResponse(response, QHttpResponse::STATUS_NOT_FOUND);
+            }
+            else {
+                writeResponse(response, QHttpResponse::STATUS_OK, enclosure);
+            }
+            
+            return true;
+        }
+        
+        writeResponse(response, QHttpResponse::STATUS_METHOD_NOT_ALLOWED);
+        return true;
+    }
+    
     if (parts.at(1) == "start") {
         if (request->method() == QHttpRequest::HTTP_GET) {
             const QString id = Utils::urlQueryItemValue(request->url(), "id");
@@ -114,7 +186,7 @@ bool TransferServer::handleRequest(QHttpRequest *request, QHttpResponse *respons
             if (!id.isEmpty()) {
                 if (Transfer *transfer = Transfers::instance()->get(id)) {
                     transfer->queue();
-                    writeResponse(response, QHttpResponse::STATUS_OK, QtJson::Json::serialize(transferToMap(transfer)));
+                    writeResponse(response, QHttpResponse::STATUS_OK, transferToMap(transfer));
                 }
                 else {
                     writeResponse(response, QHttpResponse::STATUS_BAD_REQUEST);
@@ -139,7 +211,7 @@ bool TransferServer::handleRequest(QHttpRequest *request, QHttpResponse *respons
             if (!id.isEmpty()) {
                 if (Transfer *transfer = Transfers::instance()->get(id)) {
                     transfer->pause();
-                    writeResponse(response, QHttpResponse::STATUS_OK, QtJson::Json::serialize(transferToMap(transfer)));
+                    writeResponse(response, QHttpResponse::STATUS_OK, transferToMap(transfer));
                 }
                 else {
                     writeResponse(response, QHttpResponse::STATUS_BAD_REQUEST);
@@ -178,7 +250,7 @@ bool TransferServer::handleRequest(QHttpRequest *request, QHttpResponse *respons
         const Transfer *transfer = Transfers::instance()->get(parts.at(1));
         
         if (transfer) {
-            writeResponse(response, QHttpResponse::STATUS_OK,  QtJson::Json::serialize(transferToMap(transfer)));
+            writeResponse(response, QHttpResponse::STATUS_OK,  transferToMap(transfer));
             return true;
         }
         
@@ -187,7 +259,7 @@ bool TransferServer::handleRequest(QHttpRequest *request, QHttpResponse *respons
     
     if (request->method() == QHttpRequest::HTTP_PUT) {
         Transfer *transfer = Transfers::instance()->get(parts.at(1));
-        const QVariantMap properties = QtJson::Json::parse(request->body()).toMap();
+        const QVariantMap properties = JsonReader::parse(QString::fromUtf8(request->body())).toMap();
         
         if ((!transfer) || (properties.isEmpty())) {
             writeResponse(response, QHttpResponse::STATUS_BAD_REQUEST);
@@ -205,7 +277,7 @@ bool TransferServer::handleRequest(QHttpRequest *request, QHttpResponse *respons
             }
         }
         
-        writeResponse(response, QHttpResponse::STATUS_OK, QtJson::Json::serialize(transferToMap(transfer)));
+        writeResponse(response, QHttpResponse::STATUS_OK, transferToMap(transfer));
         return true;
     }
     
@@ -18,7 +18,9 @@
 #define TRANSFERSERVER_H
 
 #include <QObject>
+#include <QVariantMap>
 
+class Transfer;
 class QHttpRequest;
 class QHttpResponse;
 
@@ -30,6 +32,8 @@ public:
     explicit TransferServer(QObject *parent = 0);
     
     static bool handleRequest(QHttpRequest *request, QHttpResponse *response);
+    
+    static QVariantMap transferToMap(const Transfer *transfer);
 };
 
 #endif // TRANSFERSERVER_H
@@ -0,0 +1,188 @@
+/*
+ * Copyright (C) 2017 Stuart Howarth <showarth@marxoft.co.uk>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "webrequesthandler.h"
+#include "articleserver.h"
+#include "databaseserver.h"
+#include "definitions.h"
+#include "enclosureserver.h"
+#include "fileserver.h"
+#include "metrics.h"
+#include "pluginserver.h"
+#include "qhttprequest.h"
+#include "qhttpresponse.h"
+#include "settingsserver.h"
+#include "subscriptionserver.h"
+#include "syncserver.h"
+#include "transferserver.h"
+#include <QStringList>
+#include <QThread>
+
+WebRequestHandler::WebRequestHandler(WebRequestHandler *mainHandler, QObject *parent) :
+    QObject(parent),
+    m_mainHandler(mainHandler),
+    m_articleServer(new ArticleServer(this)),
+    m_databaseServer(new DatabaseServer(this)),
+    m_enclosureServer(new EnclosureServer(this)),
+    m_subscriptionServer(new SubscriptionServer(this)),
+    m_syncServer(new SyncServer(this)),
+    m_fileServer(new FileServer(this))
+{
+}
+
+void WebRequestHandler::addRequest(QHttpRequest *request, QHttpResponse *response) {
+    if (request->successful()) {
+        forwardRequest(request, response);
+    }
+    else {
+        m_requests.insert(request, response);
+        connect(request, SIGNAL(end()), this, SLOT(onRequestEnd()));
+    }
+}
+
+bool WebRequestHandler::requiresMainThread(QHttpRequest *request) {
+    const QString path = request->path();
+    
+    if ((path.startsWith("/enclosures", Qt::CaseInsensitive)) || (path.startsWith("/plugins", Qt::CaseInsensitive)) ||
+        (path.startsWith("/settings", Qt::CaseInsensitive)) || (path.startsWith("/transfers", Qt::CaseInsensitive)) ||
+        (path.startsWith("/sync", Qt::CaseInsensitive)) || (path.startsWith(CACHE_PATH))) {
+        return true;
+    }
+    
+    const QStringList parts = path.split("/", QString::SkipEmptyParts);
+    
+    if (parts.size() != 2) {
+        return (parts.size() == 1) && (request->method() == QHttpRequest::HTTP_POST)
+               && (parts.first().compare("subscriptions", Qt::CaseInsensitive) == 0);
+    }
+    
+    // Subscription updates and single article requests may use Subscriptions or plugins
+    if (parts.first().compare("subscriptions", Qt::CaseInsensitive) == 0) {
+        return (parts.at(1).compare("update", Qt::CaseInsensitive) == 0)
+               || (parts.at(1).compare("status", Qt::CaseInsensitive) == 0)
+               || (parts.at(1).compare("cancel", Qt::CaseInsensitive) == 0);
+    }
+    
+    if ((parts.first().compare("articles", Qt::CaseInsensitive) == 0)
+        && (request->method() == QHttpRequest::HTTP_GET)) {
+        return (parts.at(1).compare("read", Qt::CaseInsensitive) != 0)
+               && (parts.at(1).compare("unread", Qt::CaseInsensitive) != 0)
+               && (parts.at(1).compare("favourite", Qt::CaseInsensitive) != 0)
+               && (parts.at(1).compare("unfavourite", Qt::CaseInsensitive) != 0)
+               && (parts.at(1).compare("deleteread", Qt::CaseInsensitive) != 0);
+    }
+    
+    return false;
+}
+
+void WebRequestHandler::forwardRequest(QHttpRequest *request, QHttpResponse *response) {
+    if ((!m_mainHandler) || (!requiresMainThread(request))) {
+        handleRequest(request, response);
+        return;
+    }
+    
+    // The connection may be closed before the main thread has finished with the request and
+    // response, so they are released from it here, in its own thread, and deleted once answered
+    QThread *thread = m_mainHandler->thread();
+    request->detach();
+    request->moveToThread(thread);
+    response->setParent(0);
+    response->moveToThread(thread);
+    connect(response, SIGNAL(done()), request, SLOT(deleteLater()));
+    connect(response, SIGNAL(done()), response, SLOT(deleteLater()));
+    QMetaObject::invokeMethod(m_mainHandler, "onRequestForwarded", Qt::QueuedConnection,
+                              Q_ARG(QObject*, request), Q_ARG(QObject*, response));
+}
+
+void WebRequestHandler::onRequestEnd() {
+    if (QHttpRequest *request = qobject_cast<QHttpRequest*>(sender())) {
+        QHttpResponse *response = m_requests.take(request);
+        
+        // Incomplete requests are deleted along with their connection
+        if ((response) && (request->successful())) {
+            forwardRequest(request, response);
+        }
+    }
+}
+
+void WebRequestHandler::onRequestForwarded(QObject *request, QObject *response) {
+    handleRequest(qobject_cast<QHttpRequest*>(request), qobject_cast<QHttpResponse*>(response));
+}
+
+void WebRequestHandler::handleRequest(QHttpRequest *request, QHttpResponse *response) {
+    // Responses are written as MessagePack when the client accepts it, otherwise as JSON
+    if (request->header("accept").contains("application/x-msgpack")) {
+        response->setProperty("msgpack", true);
+    }
+    
+    if (request->path().startsWith("/articles", Qt::CaseInsensitive)) {
+        if (m_articleServer->handleRequest(request, response)) {
+            return;
+        }
+    }
+    else if (request->path().startsWith("/enclosures", Qt::CaseInsensitive)) {
+        if (m_enclosureServer->handleRequest(request, response)) {
+            return;
+        }
+    }
+    else if (request->path().startsWith("/subscriptions", Qt::CaseInsensitive)) {
+        if (m_subscriptionServer->handleRequest(request, response)) {
+            return;
+        }
+    }
+    else if (request->path().startsWith("/sync", Qt::CaseInsensitive)) {
+        if (m_syncServer->handleRequest(request, response)) {
+            return;
+        }
+    }
+    else if (request->path().startsWith("/plugins", Qt::CaseInsensitive)) {
+        if (PluginServer::handleRequest(request, response)) {
+            return;
+        }
+    }
+    else if (request->path().startsWith("/transfers", Qt::CaseInsensitive)) {
+        if (TransferServer::handleRequest(request, response)) {
+            return;
+        }
+    }
+    else if (request->path().startsWith("/settings/database", Qt::CaseInsensitive)) {
+        if (m_databaseServer->handleRequest(request, response)) {
+            return;
+        }
+    }
+    else if (request->path().startsWith("/settings", Qt::CaseInsensitive)) {
+        if (SettingsServer::handleRequest(request, response)) {
+            return;
+        }
+    }
+    else if (request->path() == "/metrics") {
+        if (request->method() == QHttpRequest::HTTP_GET) {
+            writeResponse(response, QHttpResponse::STATUS_OK, Metrics::text(), "text/plain; version=0.0.4");
+        }
+        else {
+            writeResponse(response, QHttpResponse::STATUS_METHOD_NOT_ALLOWED);
+        }
+        
+        return;
+    }
+    else if (m_fileServer->handleRequest(request, response)) {
+        return;
+    }
+    
+    response->setHeader("Content-Length", "0");
+    response->writeHead(QHttpResponse::STATUS_NOT_FOUND);
+    response->end();
+}
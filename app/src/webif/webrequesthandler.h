@@ -0,0 +1,69 @@
+/*
+ * Copyright (C) 2017 Stuart Howarth <showarth@marxoft.co.uk>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef WEBREQUESTHANDLER_H
+#define WEBREQUESTHANDLER_H
+
+#include <QObject>
+#include <QHash>
+
+class ArticleServer;
+class DatabaseServer;
+class EnclosureServer;
+class FileServer;
+class SubscriptionServer;
+class SyncServer;
+class QHttpRequest;
+class QHttpResponse;
+
+/**
+ * Dispatches web interface requests to the API servers in the thread that the handler lives in.
+ *
+ * Requests that use objects belonging to the main thread (plugins, transfers, settings, sync, etc)
+ * are passed to the main thread handler once they have been received.
+ */
+class WebRequestHandler : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit WebRequestHandler(WebRequestHandler *mainHandler = 0, QObject *parent = 0);
+    
+    void addRequest(QHttpRequest *request, QHttpResponse *response);
+
+private Q_SLOTS:
+    void onRequestEnd();
+    void onRequestForwarded(QObject *request, QObject *response);
+
+private:
+    static bool requiresMainThread(QHttpRequest *request);
+    
+    void forwardRequest(QHttpRequest *request, QHttpResponse *response);
+    void handleRequest(QHttpRequest *request, QHttpResponse *response);
+    
+    WebRequestHandler *m_mainHandler;
+    
+    ArticleServer *m_articleServer;
+    DatabaseServer *m_databaseServer;
+    EnclosureServer *m_enclosureServer;
+    SubscriptionServer *m_subscriptionServer;
+    SyncServer *m_syncServer;
+    FileServer *m_fileServer;
+    
+    QHash<QHttpRequest*, QHttpResponse*> m_requests;
+};
+
+#endif // WEBREQUESTHANDLER_H
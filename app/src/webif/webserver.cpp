@@ -15,34 +15,45 @@
  */
 
 #include "webserver.h"
-#include "articleserver.h"
-#include "definitions.h"
-#include "enclosureserver.h"
-#include "fileserver.h"
-#include "pluginserver.h"
+#include "metrics.h"
 #include "qhttprequest.h"
 #include "qhttpresponse.h"
 #include "qhttpserver.h"
-#include "settingsserver.h"
-#include "subscriptionserver.h"
-#include "transferserver.h"
+#include "serverresponse.h"
+#include "webrequesthandler.h"
+#include <QStringList>
+#include <QThread>
 
 WebServer* WebServer::self = 0;
 
+// Requests are timed by the first part of their path, with requests for the web interface itself grouped together.
+// Only known routes are used as labels, so that clients cannot create any number of series.
+static QString requestRoute(const QHttpRequest *request) {
+    if (RequestLimiter::priority(request) == RequestLimiter::InterfacePriority) {
+        return QString("/");
+    }
+    
+    static const QStringList routes = QStringList() << "articles" << "enclosures" << "plugins" << "settings"
+                                                    << "subscriptions" << "sync" << "transfers";
+    const QString route = request->path().section('/', 1, 1).toLower();
+    return routes.contains(route) ? "/" + route : QString("other");
+}
+
 WebServer::WebServer() :
     QObject(),
     m_server(0),
-    m_articleServer(0),
-    m_enclosureServer(0),
-    m_subscriptionServer(0),
-    m_fileServer(0),
+    m_handler(0),
     m_port(8080),
+    m_threadCount(0),
     m_authenticationEnabled(false),
     m_status(Idle)
 {
 }
 
 WebServer::~WebServer() {
+    // Stop the worker threads, and so delete their request handlers, before the thread storage
+    delete m_server;
+    m_server = 0;
     self = 0;
 }
 
@@ -71,12 +82,15 @@ void WebServer::setPort(int p) {
 }
 
 bool WebServer::authenticationEnabled() const {
+    QMutexLocker locker(&m_authMutex);
     return m_authenticationEnabled;
 }
 
 void WebServer::setAuthenticationEnabled(bool enabled) {
     if (enabled != authenticationEnabled()) {
+        m_authMutex.lock();
         m_authenticationEnabled = enabled;
+        m_authMutex.unlock();
         emit authenticationEnabledChanged();
     }
 }
@@ -88,7 +102,9 @@ QString WebServer::username() const {
 void WebServer::setUsername(const QString &u) {
     if (u != username()) {
         m_username = u;
+        m_authMutex.lock();
         m_auth = QByteArray(u.toUtf8() + ":" + password().toUtf8()).toBase64();
+        m_authMutex.unlock();
         emit usernameChanged();
     }
 }
@@ -100,11 +116,31 @@ QString WebServer::password() const {
 void WebServer::setPassword(const QString &p) {
     if (p != password()) {
         m_password = p;
+        m_authMutex.lock();
         m_auth = QByteArray(username().toUtf8() + ":" + p.toUtf8()).toBase64();
+        m_authMutex.unlock();
         emit passwordChanged();
     }
 }
 
+int WebServer::threadCount() const {
+    return m_threadCount;
+}
+
+void WebServer::setThreadCount(int count) {
+    count = qMax(0, count);
+    
+    if (count != threadCount()) {
+        m_threadCount = count;
+        emit threadCountChanged();
+        
+        if (isRunning()) {
+            stop();
+            start();
+        }
+    }
+}
+
 bool WebServer::isRunning() const {
     return m_status == Active;
 }
@@ -155,95 +191,64 @@ void WebServer::stop() {
 void WebServer::init() {
     if (!m_server) {
         m_server = new QHttpServer(this);
+        // Requests are handled in the thread of their connection
         connect(m_server, SIGNAL(newRequest(QHttpRequest*,QHttpResponse*)),
-                this, SLOT(onNewRequest(QHttpRequest*,QHttpResponse*)));
+                this, SLOT(onNewRequest(QHttpRequest*,QHttpResponse*)), Qt::DirectConnection);
     }
     
-    if (!m_articleServer) {
-        m_articleServer = new ArticleServer(this);
-    }
-
-    if (!m_enclosureServer) {
-        m_enclosureServer = new EnclosureServer(this);
+    if (!m_handler) {
+        m_handler = new WebRequestHandler(0, this);
     }
     
-    if (!m_subscriptionServer) {
-        m_subscriptionServer = new SubscriptionServer(this);
-    }
+    m_server->setThreadCount(threadCount());
+}
 
-    if (!m_fileServer) {
-        m_fileServer = new FileServer(this);
-    }
+bool WebServer::isAuthorized(QHttpRequest *request) const {
+    QMutexLocker locker(&m_authMutex);
+    return (!m_authenticationEnabled) || (request->header("authorization").section(" ", -1).toUtf8() == m_auth);
 }
 
-void WebServer::onNewRequest(QHttpRequest *request, QHttpResponse *response) {
-    if (authenticationEnabled()) {
-        const QByteArray auth = request->header("authorization").section(" ", -1).toUtf8();
-        
-        if (auth != m_auth) {
-            response->setHeader("WWW-Authenticate", "Basic realm=\"cuteNews\"");
-            response->setHeader("Content-Length", "0");
-            response->writeHead(QHttpResponse::STATUS_UNAUTHORIZED);
-            response->end();
-            return;
-        }
+WebRequestHandler* WebServer::requestHandler() {
+    if (QThread::currentThread() == thread()) {
+        return m_handler;
     }
     
-    request->storeBody();
-    
-    if (request->successful()) {
-        handleRequest(request, response);
-    }
-    else {
-        m_requests.insert(request, response);
-        connect(request, SIGNAL(end()), this, SLOT(onRequestEnd()));
-    }    
-}
-
-void WebServer::onRequestEnd() {
-    if (QHttpRequest *request = qobject_cast<QHttpRequest*>(sender())) {
-        if (QHttpResponse *response = m_requests.take(request)) {
-            handleRequest(request, response);
-        }
+    // Worker thread handlers are deleted by the thread storage when their thread finishes
+    if (!m_threadHandlers.hasLocalData()) {
+        m_threadHandlers.setLocalData(new WebRequestHandler(m_handler));
     }
+    
+    return m_threadHandlers.localData();
 }
 
-void WebServer::handleRequest(QHttpRequest *request, QHttpResponse *response) {
-    if (request->path().startsWith("/articles", Qt::CaseInsensitive)) {
-        if (m_articleServer->handleRequest(request, response)) {
-            return;
-        }
-    }
-    else if (request->path().startsWith("/enclosures", Qt::CaseInsensitive)) {
-        if (m_enclosureServer->handleRequest(request, response)) {
-            return;
-        }
-    }
-    else if (request->path().startsWith("/subscriptions", Qt::CaseInsensitive)) {
-        if (m_subscriptionServer->handleRequest(request, response)) {
-            return;
-        }
-    }
-    else if (request->path().startsWith("/plugins", Qt::CaseInsensitive)) {
-        if (PluginServer::handleRequest(request, response)) {
-            return;
-        }
-    }
-    else if (request->path().startsWith("/transfers", Qt::CaseInsensitive)) {
-        if (TransferServer::handleRequest(request, response)) {
-            return;
-        }
-    }
-    else if (request->path().startsWith("/settings", Qt::CaseInsensitive)) {
-        if (SettingsServer::handleRequest(request, response)) {
-            return;
-        }
+void WebServer::onNewRequest(QHttpRequest *request, QHttpResponse *response) {
+    if (!isAuthorized(request)) {
+        response->setHeader("WWW-Authenticate", "Basic realm=\"cuteNews\"");
+        response->setHeader("Content-Length", "0");
+        response->writeHead(QHttpResponse::STATUS_UNAUTHORIZED);
+        response->end();
+        return;
     }
-    else if (m_fileServer->handleRequest(request, response)) {
+    
+    int retryAfter = 0;
+    const RequestLimiter::Result result = m_limiter.admit(request, response, &retryAfter);
+    
+    if (result != RequestLimiter::Accepted) {
+        Metrics::increment(Metrics::HttpRequestsRejected, 1.0,
+                           result == RequestLimiter::RateLimited ? "rate_limited" : "overloaded");
+        response->setHeader("Retry-After", QString::number(retryAfter));
+        writeResponse(response, result == RequestLimiter::RateLimited ? QHttpResponse::STATUS_TOO_MANY_REQUESTS
+                      : QHttpResponse::STATUS_SERVICE_UNAVAILABLE);
         return;
     }
     
-    response->setHeader("Content-Length", "0");
-    response->writeHead(QHttpResponse::STATUS_NOT_FOUND);
-    response->end();
+    // Only requests that carry a body need it to be buffered
+    if ((request->header("content-length").toLongLong() > 0) ||
+        (!request->header("transfer-encoding").isEmpty())) {
+        request->storeBody();
+    }
+    
+    connect(response, SIGNAL(done()), new MetricsTimer(Metrics::HttpRequestDuration, requestRoute(request), response),
+            SLOT(finish()));
+    requestHandler()->addRequest(request, response);
 }
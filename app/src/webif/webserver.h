@@ -17,13 +17,12 @@
 #ifndef WEBSERVER_H
 #define WEBSERVER_H
 
+#include "requestlimiter.h"
 #include <QObject>
-#include <QHash>
+#include <QMutex>
+#include <QThreadStorage>
 
-class ArticleServer;
-class EnclosureServer;
-class FileServer;
-class SubscriptionServer;
+class WebRequestHandler;
 class QHttpServer;
 class QHttpRequest;
 class QHttpResponse;
@@ -38,6 +37,7 @@ class WebServer : public QObject
                NOTIFY authenticationEnabledChanged)
     Q_PROPERTY(QString username READ username WRITE setUsername NOTIFY usernameChanged)
     Q_PROPERTY(QString password READ password WRITE setPassword NOTIFY passwordChanged)
+    Q_PROPERTY(int threadCount READ threadCount WRITE setThreadCount NOTIFY threadCountChanged)
     Q_PROPERTY(bool running READ isRunning WRITE setRunning NOTIFY statusChanged)
     Q_PROPERTY(Status status READ status NOTIFY statusChanged)
     
@@ -61,6 +61,8 @@ public:
     QString username() const;
     QString password() const;
     
+    int threadCount() const;
+    
     bool isRunning() const;
     
     Status status() const;
@@ -72,19 +74,21 @@ public Q_SLOTS:
     void setUsername(const QString &u);
     void setPassword(const QString &p);
     
+    void setThreadCount(int count);
+    
     void setRunning(bool enabled);
     bool start();
     void stop();
 
 private Q_SLOTS:
     void onNewRequest(QHttpRequest *request, QHttpResponse *response);
-    void onRequestEnd();
 
 Q_SIGNALS:
     void authenticationEnabledChanged();
     void passwordChanged();
     void portChanged();
     void statusChanged(WebServer::Status status);
+    void threadCountChanged();
     void usernameChanged();
 
 private:
@@ -93,27 +97,29 @@ private:
     void init();
     
     void setStatus(Status s);
-        
-    void handleRequest(QHttpRequest *request, QHttpResponse *response);
-        
+    
+    bool isAuthorized(QHttpRequest *request) const;
+    
+    WebRequestHandler* requestHandler();
+    
     static WebServer *self;
     
     QHttpServer *m_server;
-    ArticleServer *m_articleServer;
-    EnclosureServer *m_enclosureServer;
-    SubscriptionServer *m_subscriptionServer;
-    FileServer *m_fileServer;
+    WebRequestHandler *m_handler;
+    QThreadStorage<WebRequestHandler*> m_threadHandlers;
     
     int m_port;
+    int m_threadCount;
     
     QString m_username;
     QString m_password;
     QByteArray m_auth;
     bool m_authenticationEnabled;
+    mutable QMutex m_authMutex;
+    
+    RequestLimiter m_limiter;
     
     Status m_status;
-        
-    QHash<QHttpRequest*, QHttpResponse*> m_requests;
 };
 
 #endif // WEBSERVER_H
@@ -1,7 +1,7 @@
 TEMPLATE = app
 TARGET = cutenews-client
 
-QT += network
+QT += network sql
 
 INCLUDEPATH += \
     src/base \
@@ -17,7 +17,9 @@ HEADERS += \
     src/base/download.h \
     src/base/enclosuredownload.h \
     src/base/json.h \
+    src/base/localcache.h \
     src/base/loggerverbositymodel.h \
+    src/base/msgpackreader.h \
     src/base/opmlparser.h \
     src/base/requests.h \
     src/base/selectionmodel.h \
@@ -25,6 +27,7 @@ HEADERS += \
     src/base/subscription.h \
     src/base/subscriptionmodel.h \
     src/base/subscriptions.h \
+    src/base/syncmanager.h \
     src/base/transfer.h \
     src/base/transfermodel.h \
     src/base/transferprioritymodel.h \
@@ -45,12 +48,15 @@ SOURCES += \
     src/base/download.cpp \
     src/base/enclosuredownload.cpp \
     src/base/json.cpp \
+    src/base/localcache.cpp \
+    src/base/msgpackreader.cpp \
     src/base/opmlparser.cpp \
     src/base/selectionmodel.cpp \
     src/base/serversettings.cpp \
     src/base/subscription.cpp \
     src/base/subscriptionmodel.cpp \
     src/base/subscriptions.cpp \
+    src/base/syncmanager.cpp \
     src/base/transfer.cpp \
     src/base/transfermodel.cpp \
     src/base/urlopenermodel.cpp \
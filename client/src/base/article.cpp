@@ -310,8 +310,12 @@ void Article::setAutoUpdate(bool enabled) {
         if (enabled) {
             connect(DBNotify::instance(), SIGNAL(articleFavourited(QString, bool, QVariantMap)),
                     this, SLOT(onArticleFavourited(QString, bool, QVariantMap)));
+            connect(DBNotify::instance(), SIGNAL(articlesFavourited(QStringList, bool)),
+                    this, SLOT(onArticlesFavourited(QStringList, bool)));
             connect(DBNotify::instance(), SIGNAL(articleRead(QString, QString, bool, QVariantMap)),
                     this, SLOT(onArticleRead(QString, QString, bool, QVariantMap)));
+            connect(DBNotify::instance(), SIGNAL(articlesRead(QStringList, QStringList, bool)),
+                    this, SLOT(onArticlesRead(QStringList, QStringList, bool)));
             connect(DBNotify::instance(), SIGNAL(subscriptionRead(QString, bool, QVariantMap)),
                     this, SLOT(onSubscriptionRead(QString, bool)));
             connect(DBNotify::instance(), SIGNAL(allSubscriptionsRead()), this, SLOT(onAllSubscriptionsRead()));
@@ -391,6 +395,18 @@ void Article::onArticleRead(const QString &articleId, const QString &, bool, con
     }
 }
 
+void Article::onArticlesFavourited(const QStringList &articleIds, bool isFavourite) {
+    if (articleIds.contains(id())) {
+        setFavourite(isFavourite);
+    }
+}
+
+void Article::onArticlesRead(const QStringList &articleIds, const QStringList &, bool isRead) {
+    if (articleIds.contains(id())) {
+        setRead(isRead);
+    }
+}
+
 void Article::onSubscriptionRead(const QString &subscriptionId, bool isRead) {
     if (subscriptionId == this->subscriptionId()) {
         setRead(isRead);
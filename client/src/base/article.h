@@ -127,8 +127,10 @@ public Q_SLOTS:
 private Q_SLOTS:
     void onArticleFetched(DBConnection *connection);
     void onArticleFavourited(const QString &articleId, bool isFavourite, const QVariantMap &properties);
+    void onArticlesFavourited(const QStringList &articleIds, bool isFavourite);
     void onArticleRead(const QString &articleId, const QString &subscriptionId, bool isRead,
                        const QVariantMap &properties);
+    void onArticlesRead(const QStringList &articleIds, const QStringList &subscriptionIds, bool isRead);
     void onSubscriptionRead(const QString &subscriptionId, bool isRead);
     void onAllSubscriptionsRead();
 
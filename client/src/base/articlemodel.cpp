@@ -34,9 +34,14 @@ ArticleModel::ArticleModel(QObject *parent) :
 #if QT_VERSION <= 0x050000
     setRoleNames(Article::roleNames());
 #endif
+    connect(DBNotify::instance(), SIGNAL(articlesAdded(QStringList, QString)),
+            this, SLOT(onArticlesAdded(QStringList, QString)));
     connect(DBNotify::instance(), SIGNAL(articleDeleted(QString)), this, SLOT(onArticleDeleted(QString)));
+    connect(DBNotify::instance(), SIGNAL(articlesDeleted(QStringList)), this, SLOT(onArticlesDeleted(QStringList)));
     connect(DBNotify::instance(), SIGNAL(articleFavourited(QString, bool, QVariantMap)),
             this, SLOT(onArticleFavourited(QString, bool, QVariantMap)));
+    connect(DBNotify::instance(), SIGNAL(articlesFavourited(QStringList, bool)),
+            this, SLOT(onArticlesFavourited(QStringList, bool)));
     connect(DBNotify::instance(), SIGNAL(subscriptionDeleted(QString)), this, SLOT(onSubscriptionDeleted(QString)));
 }
 
@@ -74,6 +79,32 @@ void ArticleModel::setStatus(ArticleModel::Status s) {
     }
 }
 
+Article* ArticleModel::createArticle(const QVariantMap &properties) {
+    Article *article = new Article(properties.value("id").toString(), properties.value("author").toString(),
+                                   properties.value("body").toString(),
+                                   properties.value("categories").toStringList(),
+                                   QDateTime::fromTime_t(properties.value("date").toInt()),
+                                   properties.value("enclosures").toList(),
+                                   properties.value("favourite").toBool(),
+                                   properties.value("read").toBool(),
+                                   properties.value("subscriptionId").toString(),
+                                   properties.value("title").toString(),
+                                   properties.value("url").toString(), this);
+    article->setAutoUpdate(true);
+    connect(article, SIGNAL(dataChanged(Article*, int)), this, SLOT(onArticleChanged(Article*, int)));
+    return article;
+}
+
+int ArticleModel::indexOf(const QString &articleId) const {
+    for (int i = 0; i < m_list.size(); i++) {
+        if (m_list.at(i)->id() == articleId) {
+            return i;
+        }
+    }
+    
+    return -1;
+}
+
 QString ArticleModel::subscriptionId() const {
     return m_subscriptionId;
 }
@@ -270,6 +301,22 @@ bool ArticleModel::remove(int row) {
     return false;
 }
 
+void ArticleModel::markAllRead(bool read) {
+    QStringList ids;
+    
+    foreach (const Article *article, m_list) {
+        if (article->isRead() != read) {
+            ids << article->id();
+        }
+    }
+    
+    if (!ids.isEmpty()) {
+        DBConnection *connection = DBConnection::connection();
+        connect(connection, SIGNAL(finished(DBConnection*)), connection, SLOT(deleteLater()));
+        connection->markArticlesRead(ids, read);
+    }
+}
+
 QModelIndexList ArticleModel::match(const QModelIndex &start, int role, const QVariant &value, int hits,
                                     Qt::MatchFlags flags) const {
     return QAbstractListModel::match(start, role, value, hits, flags);
@@ -357,6 +404,25 @@ void ArticleModel::onArticleChanged(Article *article, int role) {
     emit dataChanged(idx, idx);
 }
 
+void ArticleModel::onArticlesAdded(const QStringList &articleIds, const QString &subscriptionId) {
+    if ((status() != Ready) || (!m_query.isEmpty()) || ((subscriptionId != m_subscriptionId)
+                                                          && (m_subscriptionId != ALL_ARTICLES_SUBSCRIPTION_ID))) {
+        return;
+    }
+    
+    QStringList ids;
+    
+    foreach (const QString &articleId, articleIds) {
+        if (indexOf(articleId) == -1) {
+            ids << articleId;
+        }
+    }
+    
+    if (!ids.isEmpty()) {
+        DBConnection::connection(this, SLOT(onNewArticlesFetched(DBConnection*)))->fetchArticles(ids);
+    }
+}
+
 void ArticleModel::onArticleDeleted(const QString &articleId) {
     for (int i = 0; i < m_list.size(); i++) {
         if (m_list.at(i)->id() == articleId) {
@@ -370,23 +436,24 @@ void ArticleModel::onArticleDeleted(const QString &articleId) {
     }
 }
 
+void ArticleModel::onArticlesDeleted(const QStringList &articleIds) {
+    for (int i = m_list.size() - 1; i >= 0; i--) {
+        if (articleIds.contains(m_list.at(i)->id())) {
+            beginRemoveRows(QModelIndex(), i, i);
+            m_list.takeAt(i)->deleteLater();
+            endRemoveRows();
+            m_offset--;
+        }
+    }
+    
+    emit countChanged(rowCount());
+}
+
 void ArticleModel::onArticleFavourited(const QString &articleId, bool isFavourite, const QVariantMap &properties) {
     if ((m_subscriptionId == FAVOURITES_SUBSCRIPTION_ID) && (status() == Ready)) {
         if (isFavourite) {
             beginInsertRows(QModelIndex(), 0, 0);
-            Article *article = new Article(properties.value("id").toString(), properties.value("author").toString(),
-                                           properties.value("body").toString(),
-                                           properties.value("categories").toStringList(),
-                                           QDateTime::fromTime_t(properties.value("date").toInt()),
-                                           properties.value("enclosures").toList(),
-                                           properties.value("favourite").toBool(),
-                                           properties.value("read").toBool(),
-                                           properties.value("subscriptionId").toString(),
-                                           properties.value("title").toString(),
-                                           properties.value("url").toString(), this);
-            article->setAutoUpdate(true);
-            connect(article, SIGNAL(dataChanged(Article*, int)), this, SLOT(onArticleChanged(Article*, int)));
-            m_list.prepend(article);
+            m_list.prepend(createArticle(properties));
             endInsertRows();
         }
         else {
@@ -404,26 +471,39 @@ void ArticleModel::onArticleFavourited(const QString &articleId, bool isFavourit
     }
 }
 
+void ArticleModel::onArticlesFavourited(const QStringList &articleIds, bool isFavourite) {
+    if ((m_subscriptionId == FAVOURITES_SUBSCRIPTION_ID) && (status() == Ready)) {
+        if (isFavourite) {
+            // The batch response does not include the articles, so fetch the favourites again
+            foreach (const QString &articleId, articleIds) {
+                if (indexOf(articleId) == -1) {
+                    reload();
+                    return;
+                }
+            }
+        }
+        else {
+            for (int i = m_list.size() - 1; i >= 0; i--) {
+                if (articleIds.contains(m_list.at(i)->id())) {
+                    beginRemoveRows(QModelIndex(), i, i);
+                    m_list.takeAt(i)->deleteLater();
+                    endRemoveRows();
+                    m_offset--;
+                }
+            }
+            
+            emit countChanged(rowCount());
+        }
+    }
+}
+
 void ArticleModel::onArticlesFetched(DBConnection *connection) {
     if (connection->status() == DBConnection::Ready) {
         const int oldCount = rowCount();
         
         foreach (const QVariant &v, connection->result().toList()) {
-            const QVariantMap a = v.toMap();
             beginInsertRows(QModelIndex(), rowCount(), rowCount());
-            Article *article = new Article(a.value("id").toString(), a.value("author").toString(),
-                                           a.value("body").toString(),
-                                           a.value("categories").toStringList(),
-                                           QDateTime::fromTime_t(a.value("date").toInt()),
-                                           a.value("enclosures").toList(),
-                                           a.value("favourite").toBool(),
-                                           a.value("read").toBool(),
-                                           a.value("subscriptionId").toString(),
-                                           a.value("title").toString(),
-                                           a.value("url").toString(), this);
-            article->setAutoUpdate(true);
-            connect(article, SIGNAL(dataChanged(Article*, int)), this, SLOT(onArticleChanged(Article*, int)));
-            m_list << article;
+            m_list << createArticle(v.toMap());
             endInsertRows();
         }
         
@@ -443,6 +523,25 @@ void ArticleModel::onArticlesFetched(DBConnection *connection) {
     connection->deleteLater();
 }
 
+void ArticleModel::onNewArticlesFetched(DBConnection *connection) {
+    if (connection->status() == DBConnection::Ready) {
+        foreach (const QVariant &v, connection->result().toList()) {
+            const QVariantMap properties = v.toMap();
+            
+            if (indexOf(properties.value("id").toString()) == -1) {
+                beginInsertRows(QModelIndex(), 0, 0);
+                m_list.prepend(createArticle(properties));
+                endInsertRows();
+                m_offset++;
+            }
+        }
+        
+        emit countChanged(rowCount());
+    }
+    
+    connection->deleteLater();
+}
+
 void ArticleModel::onSubscriptionDeleted(const QString &id) {
     if (m_list.isEmpty()) {
         return;
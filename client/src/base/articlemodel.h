@@ -81,6 +81,8 @@ public:
     Q_INVOKABLE Article* get(int row) const;
     Q_INVOKABLE bool remove(int row);
     
+    Q_INVOKABLE void markAllRead(bool read = true);
+    
     QModelIndexList match(const QModelIndex &start, int role, const QVariant &value, int hits = 1,
                           Qt::MatchFlags flags = Qt::MatchFlags(Qt::MatchExactly | Qt::MatchWrap)) const;
     Q_INVOKABLE int match(int start, const QByteArray &role, const QVariant &value,
@@ -94,9 +96,13 @@ public Q_SLOTS:
 
 private Q_SLOTS:
     void onArticleChanged(Article *article, int role);
+    void onArticlesAdded(const QStringList &articleIds, const QString &subscriptionId);
     void onArticleDeleted(const QString &articleId);
+    void onArticlesDeleted(const QStringList &articleIds);
     void onArticleFavourited(const QString &articleId, bool isFavourite, const QVariantMap &properties);
+    void onArticlesFavourited(const QStringList &articleIds, bool isFavourite);
     void onArticlesFetched(DBConnection *connection);
+    void onNewArticlesFetched(DBConnection *connection);
     void onSubscriptionDeleted(const QString &id);
 
 Q_SIGNALS:
@@ -110,6 +116,10 @@ private:
     void setErrorString(const QString &e);
     
     void setStatus(Status s);
+    
+    Article* createArticle(const QVariantMap &properties);
+    
+    int indexOf(const QString &articleId) const;
         
     QList<Article*> m_list;
             
@@ -18,6 +18,7 @@
 #include "dbnotify.h"
 #include "definitions.h"
 #include "json.h"
+#include "localcache.h"
 #include "logger.h"
 #include "requests.h"
 #include <QNetworkReply>
@@ -144,31 +145,41 @@ void DBConnection::updateSubscription(const QString &id, const QVariantMap &prop
     connect(this, SIGNAL(finished(DBConnection*)), reply, SLOT(deleteLater()));
 }
 
-void DBConnection::markSubscriptionRead(const QString &id, bool isRead) {
+void DBConnection::updateSubscriptions(const QStringList &ids, const QVariantMap &properties) {
     if (status() == Active) {
         return;
     }
     
     setStatus(Active);
-    const QString path = isRead ? QString("/subscriptions/read") : QString("/subscriptions/unread");
-    QVariantMap params;
-    params["id"] = id;
+    QVariantMap batch;
+    batch["ids"] = ids;
+    batch["properties"] = properties;
     QNetworkReply *reply =
-    networkAccessManager(SLOT(onSubscriptionRead(QNetworkReply*)))->get(buildRequest(path, params));
+    networkAccessManager(SLOT(onSubscriptionsUpdated(QNetworkReply*)))->put(buildRequest("/subscriptions",
+                                                                            QNetworkAccessManager::PutOperation),
+                                                                            QtJson::Json::serialize(batch));
     connect(reply, SIGNAL(downloadProgress(qint64, qint64)), this, SLOT(onReplyProgress(qint64, qint64)));
     connect(this, SIGNAL(finished(DBConnection*)), reply, SLOT(deleteLater()));
 }
 
+void DBConnection::markSubscriptionRead(const QString &id, bool isRead) {
+    if (status() == Active) {
+        return;
+    }
+    
+    const QString path = isRead ? QString("/subscriptions/read") : QString("/subscriptions/unread");
+    QVariantMap params;
+    params["id"] = id;
+    sendOperation(SLOT(onSubscriptionRead(QNetworkReply*)), QNetworkAccessManager::GetOperation, path, params);
+}
+
 void DBConnection::markAllSubscriptionsRead() {
     if (status() == Active) {
         return;
     }
     
-    setStatus(Active);    
-    QNetworkReply *reply =
-    networkAccessManager(SLOT(onAllSubscriptionsRead(QNetworkReply*)))->get(buildRequest("/subscriptions/read"));
-    connect(reply, SIGNAL(downloadProgress(qint64, qint64)), this, SLOT(onReplyProgress(qint64, qint64)));
-    connect(this, SIGNAL(finished(DBConnection*)), reply, SLOT(deleteLater()));
+    sendOperation(SLOT(onAllSubscriptionsRead(QNetworkReply*)), QNetworkAccessManager::GetOperation,
+                  "/subscriptions/read");
 }
 
 void DBConnection::fetchSubscription(const QString &id) {
@@ -176,11 +187,7 @@ void DBConnection::fetchSubscription(const QString &id) {
         return;
     }
     
-    setStatus(Active);
-    QNetworkReply *reply =
-    networkAccessManager(SLOT(onReplyFinished(QNetworkReply*)))->get(buildRequest("/subscriptions/" + id));
-    connect(reply, SIGNAL(downloadProgress(qint64, qint64)), this, SLOT(onReplyProgress(qint64, qint64)));
-    connect(this, SIGNAL(finished(DBConnection*)), reply, SLOT(deleteLater()));
+    fetch("/subscriptions/" + id);
 }
 
 void DBConnection::fetchSubscriptions(int offset, int limit) {
@@ -209,10 +216,7 @@ void DBConnection::fetchSubscriptions(const QVariantMap &params) {
         return;
     }
     
-    QNetworkReply *reply =
-    networkAccessManager(SLOT(onReplyFinished(QNetworkReply*)))->get(buildRequest("/subscriptions", params));
-    connect(reply, SIGNAL(downloadProgress(qint64, qint64)), this, SLOT(onReplyProgress(qint64, qint64)));
-    connect(this, SIGNAL(finished(DBConnection*)), reply, SLOT(deleteLater()));
+    fetch("/subscriptions", params);
 }
 
 void DBConnection::deleteArticle(const QString &id) {
@@ -220,12 +224,21 @@ void DBConnection::deleteArticle(const QString &id) {
         return;
     }
     
-    setStatus(Active);
-    QNetworkReply *reply =
-    networkAccessManager(SLOT(onArticleDeleted(QNetworkReply*)))->deleteResource(buildRequest("/articles/" + id,
-                                                                                 QNetworkAccessManager::DeleteOperation));
-    connect(reply, SIGNAL(downloadProgress(qint64, qint64)), this, SLOT(onReplyProgress(qint64, qint64)));
-    connect(this, SIGNAL(finished(DBConnection*)), reply, SLOT(deleteLater()));
+    QVariantMap properties;
+    properties["id"] = id;
+    sendOperation(SLOT(onArticleDeleted(QNetworkReply*)), QNetworkAccessManager::DeleteOperation, "/articles/" + id,
+                  QVariantMap(), QByteArray(), properties);
+}
+
+void DBConnection::deleteArticles(const QStringList &ids) {
+    if (status() == Active) {
+        return;
+    }
+    
+    QVariantMap properties;
+    properties["ids"] = ids;
+    sendOperation(SLOT(onArticlesDeleted(QNetworkReply*)), QNetworkAccessManager::PostOperation, "/articles/delete",
+                  QVariantMap(), QtJson::Json::serialize(ids), properties);
 }
 
 void DBConnection::deleteReadArticles(int expiryDate) {
@@ -248,14 +261,22 @@ void DBConnection::markArticleFavourite(const QString &id, bool isFavourite) {
         return;
     }
     
-    setStatus(Active);
     const QString path = isFavourite ? QString("/articles/favourite") : QString("/articles/unfavourite");
     QVariantMap params;
     params["id"] = id;
-    QNetworkReply *reply =
-    networkAccessManager(SLOT(onArticleFavourited(QNetworkReply*)))->get(buildRequest(path, params));
-    connect(reply, SIGNAL(downloadProgress(qint64, qint64)), this, SLOT(onReplyProgress(qint64, qint64)));
-    connect(this, SIGNAL(finished(DBConnection*)), reply, SLOT(deleteLater()));
+    sendOperation(SLOT(onArticleFavourited(QNetworkReply*)), QNetworkAccessManager::GetOperation, path, params);
+}
+
+void DBConnection::markArticlesFavourite(const QStringList &ids, bool isFavourite) {
+    if (status() == Active) {
+        return;
+    }
+    
+    const QString path = isFavourite ? QString("/articles/favourite") : QString("/articles/unfavourite");
+    QVariantMap properties;
+    properties["favourite"] = isFavourite;
+    sendOperation(SLOT(onArticlesFavourited(QNetworkReply*)), QNetworkAccessManager::PostOperation, path,
+                  QVariantMap(), QtJson::Json::serialize(ids), properties);
 }
 
 void DBConnection::markArticleRead(const QString &id, bool isRead) {
@@ -263,14 +284,22 @@ void DBConnection::markArticleRead(const QString &id, bool isRead) {
         return;
     }
     
-    setStatus(Active);
     const QString path = isRead ? QString("/articles/read") : QString("/articles/unread");
     QVariantMap params;
     params["id"] = id;
-    QNetworkReply *reply =
-    networkAccessManager(SLOT(onArticleRead(QNetworkReply*)))->get(buildRequest(path, params));
-    connect(reply, SIGNAL(downloadProgress(qint64, qint64)), this, SLOT(onReplyProgress(qint64, qint64)));
-    connect(this, SIGNAL(finished(DBConnection*)), reply, SLOT(deleteLater()));
+    sendOperation(SLOT(onArticleRead(QNetworkReply*)), QNetworkAccessManager::GetOperation, path, params);
+}
+
+void DBConnection::markArticlesRead(const QStringList &ids, bool isRead) {
+    if (status() == Active) {
+        return;
+    }
+    
+    const QString path = isRead ? QString("/articles/read") : QString("/articles/unread");
+    QVariantMap properties;
+    properties["read"] = isRead;
+    sendOperation(SLOT(onArticlesRead(QNetworkReply*)), QNetworkAccessManager::PostOperation, path, QVariantMap(),
+                  QtJson::Json::serialize(ids), properties);
 }
 
 void DBConnection::fetchArticle(const QString &id) {
@@ -278,11 +307,7 @@ void DBConnection::fetchArticle(const QString &id) {
         return;
     }
     
-    setStatus(Active);
-    QNetworkReply *reply =
-    networkAccessManager(SLOT(onReplyFinished(QNetworkReply*)))->get(buildRequest("/articles/" + id));
-    connect(reply, SIGNAL(downloadProgress(qint64, qint64)), this, SLOT(onReplyProgress(qint64, qint64)));
-    connect(this, SIGNAL(finished(DBConnection*)), reply, SLOT(deleteLater()));
+    fetch("/articles/" + id);
 }
 
 void DBConnection::fetchArticles(int offset, int limit) {
@@ -311,11 +336,7 @@ void DBConnection::fetchArticles(const QVariantMap &params) {
         return;
     }
     
-    setStatus(Active);
-    QNetworkReply *reply = networkAccessManager(SLOT(onReplyFinished(QNetworkReply*)))->get(buildRequest("/articles",
-                                                                                                         params));
-    connect(reply, SIGNAL(downloadProgress(qint64, qint64)), this, SLOT(onReplyProgress(qint64, qint64)));
-    connect(this, SIGNAL(finished(DBConnection*)), reply, SLOT(deleteLater()));
+    fetch("/articles", params);
 }
 
 void DBConnection::fetchArticlesForSubscription(const QString &subscriptionId, int offset, int limit) {
@@ -361,6 +382,115 @@ QNetworkAccessManager* DBConnection::networkAccessManager(const char *slot) {
     return m_nam;
 }
 
+void DBConnection::fetch(const QString &path, const QVariantMap &params) {
+    setStatus(Active);
+    QVariant result;
+    
+    if (LocalCache::instance()->get(path, params, result)) {
+        queueResult(SLOT(onReplyFinished(QNetworkReply*)), result);
+        return;
+    }
+    
+    QNetworkReply *reply = networkAccessManager(SLOT(onReplyFinished(QNetworkReply*)))->get(params.isEmpty()
+                           ? buildRequest(path) : buildRequest(path, params));
+    reply->setProperty("cacheable", true);
+    reply->setProperty("path", path);
+    reply->setProperty("params", params);
+    connect(reply, SIGNAL(downloadProgress(qint64, qint64)), this, SLOT(onReplyProgress(qint64, qint64)));
+    connect(this, SIGNAL(finished(DBConnection*)), reply, SLOT(deleteLater()));
+}
+
+void DBConnection::sendOperation(const char *slot, QNetworkAccessManager::Operation operation, const QString &path,
+                                 const QVariantMap &params, const QByteArray &body, const QVariantMap &properties) {
+    setStatus(Active);
+    
+    // Operations must reach the server in order, so this one waits behind any that are already queued
+    QVariant result;
+    
+    if ((LocalCache::instance()->hasPendingOperations())
+        && (LocalCache::instance()->addPendingOperation(operation, path, params, body, result))) {
+        queueResult(slot, result, properties);
+        return;
+    }
+    
+    const QNetworkRequest request = params.isEmpty() ? buildRequest(path, operation)
+                                                     : buildRequest(path, params, operation);
+    QNetworkReply *reply;
+    
+    switch (operation) {
+    case QNetworkAccessManager::PostOperation:
+        reply = networkAccessManager(slot)->post(request, body);
+        break;
+    case QNetworkAccessManager::DeleteOperation:
+        reply = networkAccessManager(slot)->deleteResource(request);
+        break;
+    default:
+        reply = networkAccessManager(slot)->get(request);
+        break;
+    }
+    
+    reply->setProperty("queueable", true);
+    reply->setProperty("operation", int(operation));
+    reply->setProperty("path", path);
+    reply->setProperty("params", params);
+    reply->setProperty("body", body);
+    QMapIterator<QString, QVariant> iterator(properties);
+    
+    while (iterator.hasNext()) {
+        iterator.next();
+        reply->setProperty(iterator.key().toUtf8(), iterator.value());
+    }
+    
+    connect(reply, SIGNAL(downloadProgress(qint64, qint64)), this, SLOT(onReplyProgress(qint64, qint64)));
+    connect(this, SIGNAL(finished(DBConnection*)), reply, SLOT(deleteLater()));
+}
+
+void DBConnection::queueResult(const char *slot, const QVariant &result, const QVariantMap &properties) {
+    // The slot is called without a reply once control returns to the event loop, as it would be for the server
+    const QByteArray signature(slot + 1);
+    m_queuedSlot = signature.left(signature.indexOf('('));
+    m_queuedProperties = properties;
+    setResult(result);
+    QMetaObject::invokeMethod(this, "onQueuedResult", Qt::QueuedConnection);
+}
+
+QVariant DBConnection::operationProperty(QNetworkReply *reply, const char *name) const {
+    return reply ? reply->property(name) : m_queuedProperties.value(name);
+}
+
+bool DBConnection::finishOffline(QNetworkReply *reply) {
+    const QString path = reply->property("path").toString();
+    const QVariantMap params = reply->property("params").toMap();
+    QVariant result;
+    
+    if (reply->property("cacheable").toBool()) {
+        if (!LocalCache::instance()->get(path, params, result, false)) {
+            return false;
+        }
+    }
+    else if (reply->property("queueable").toBool()) {
+        const QNetworkAccessManager::Operation operation =
+        QNetworkAccessManager::Operation(reply->property("operation").toInt());
+        
+        if (!LocalCache::instance()->addPendingOperation(operation, path, params,
+                                                         reply->property("body").toByteArray(), result)) {
+            return false;
+        }
+    }
+    else {
+        return false;
+    }
+    
+    setResult(result);
+
+    Logger::log("DBConnection::finishOffline(). Server unavailable. Using local cache for " + path,
+                Logger::MediumVerbosity);
+    setErrorString(QString());
+    setStatus(Ready);
+    emit finished(this);
+    return true;
+}
+
 void DBConnection::onSubscriptionsAdded(QNetworkReply *reply) {
     onReplyFinished(reply);
     
@@ -387,6 +517,14 @@ void DBConnection::onSubscriptionUpdated(QNetworkReply *reply) {
     }
 }
 
+void DBConnection::onSubscriptionsUpdated(QNetworkReply *reply) {
+    onReplyFinished(reply);
+    
+    if (status() == Ready) {
+        emit DBNotify::instance()->subscriptionsUpdated(m_result.toList());
+    }
+}
+
 void DBConnection::onSubscriptionRead(QNetworkReply *reply) {
     onReplyFinished(reply);
     
@@ -407,7 +545,7 @@ void DBConnection::onAllSubscriptionsRead(QNetworkReply *reply) {
 }
 
 void DBConnection::onArticleDeleted(QNetworkReply *reply) {
-    const QString id = reply->url().path().section("/", -1);
+    const QString id = operationProperty(reply, "id").toString();
     onReplyFinished(reply);
     
     if (status() == Ready) {
@@ -415,6 +553,15 @@ void DBConnection::onArticleDeleted(QNetworkReply *reply) {
     }
 }
 
+void DBConnection::onArticlesDeleted(QNetworkReply *reply) {
+    const QStringList ids = operationProperty(reply, "ids").toStringList();
+    onReplyFinished(reply);
+    
+    if (status() == Ready) {
+        emit DBNotify::instance()->articlesDeleted(ids);
+    }
+}
+
 void DBConnection::onArticleFavourited(QNetworkReply *reply) {
     onReplyFinished(reply);
     
@@ -436,6 +583,43 @@ void DBConnection::onArticleRead(QNetworkReply *reply) {
     }
 }
 
+void DBConnection::onArticlesFavourited(QNetworkReply *reply) {
+    const bool isFavourite = operationProperty(reply, "favourite").toBool();
+    onReplyFinished(reply);
+    
+    if (status() == Ready) {
+        QStringList ids;
+        
+        foreach (const QVariant &article, m_result.toList()) {
+            ids << article.toMap().value("id").toString();
+        }
+        
+        if (!ids.isEmpty()) {
+            emit DBNotify::instance()->articlesFavourited(ids, isFavourite);
+        }
+    }
+}
+
+void DBConnection::onArticlesRead(QNetworkReply *reply) {
+    const bool isRead = operationProperty(reply, "read").toBool();
+    onReplyFinished(reply);
+    
+    if (status() == Ready) {
+        QStringList articleIds;
+        QStringList subscriptionIds;
+        
+        foreach (const QVariant &v, m_result.toList()) {
+            const QVariantMap article = v.toMap();
+            articleIds << article.value("id").toString();
+            subscriptionIds << article.value("subscriptionId").toString();
+        }
+        
+        if (!articleIds.isEmpty()) {
+            emit DBNotify::instance()->articlesRead(articleIds, subscriptionIds, isRead);
+        }
+    }
+}
+
 void DBConnection::onReadArticlesDeleted(QNetworkReply *reply) {
     onReplyFinished(reply);
     
@@ -453,6 +637,14 @@ void DBConnection::onReplyProgress(qint64 current, qint64 total) {
 }
 
 void DBConnection::onReplyFinished(QNetworkReply *reply) {
+    // Results from the local cache and of queued operations are set before the slot is called
+    if (!reply) {
+        setErrorString(QString());
+        setStatus(Ready);
+        emit finished(this);
+        return;
+    }
+    
     switch (reply->error()) {
     case QNetworkReply::NoError:
         break;
@@ -462,14 +654,29 @@ void DBConnection::onReplyFinished(QNetworkReply *reply) {
         emit finished(this);
         return;
     default:
+        if ((isNetworkUnavailable(reply)) && (finishOffline(reply))) {
+            return;
+        }
+        
         setErrorString(reply->errorString());
         setStatus(Error);
         emit finished(this);
         return;
     }
     
-    setResult(QtJson::Json::parse(QString::fromUtf8(reply->readAll())));
+    setResult(parseReply(reply));
+    
+    if (reply->property("cacheable").toBool()) {
+        LocalCache::instance()->store(reply->property("path").toString(), reply->property("params").toMap(), m_result);
+    }
+    
     setErrorString(QString());
     setStatus(Ready);
     emit finished(this);
 }
+
+void DBConnection::onQueuedResult() {
+    if (status() == Active) {
+        QMetaObject::invokeMethod(this, m_queuedSlot.constData(), Q_ARG(QNetworkReply*, 0));
+    }
+}
@@ -19,9 +19,8 @@
 
 #include <QObject>
 #include <QVariantMap>
-#include <QNetworkRequest>
+#include <QNetworkAccessManager>
 
-class QNetworkAccessManager;
 class QNetworkReply;
 
 class DBConnection : public QObject
@@ -63,6 +62,7 @@ public Q_SLOTS:
     void addSubscriptions(const QVariantList &subscriptions);
     void deleteSubscription(const QString &id);
     void updateSubscription(const QString &id, const QVariantMap &properties);
+    void updateSubscriptions(const QStringList &ids, const QVariantMap &properties);
     void markSubscriptionRead(const QString &id, bool isRead = true);
     void markAllSubscriptionsRead();
     
@@ -72,9 +72,12 @@ public Q_SLOTS:
     void fetchSubscriptions(const QVariantMap &params);
     
     void deleteArticle(const QString &id);
+    void deleteArticles(const QStringList &ids);
     void deleteReadArticles(int expiryDate);
     void markArticleFavourite(const QString &id, bool isFavourite = true);
+    void markArticlesFavourite(const QStringList &ids, bool isFavourite = true);
     void markArticleRead(const QString &id, bool isRead = true);
+    void markArticlesRead(const QStringList &ids, bool isRead = true);
     
     void fetchArticle(const QString &id);
     void fetchArticles(int offset = 0, int limit = 0);
@@ -89,17 +92,23 @@ private Q_SLOTS:
     void onSubscriptionsAdded(QNetworkReply *reply);
     void onSubscriptionDeleted(QNetworkReply *reply);
     void onSubscriptionUpdated(QNetworkReply *reply);
+    void onSubscriptionsUpdated(QNetworkReply *reply);
     void onSubscriptionRead(QNetworkReply *reply);
     void onAllSubscriptionsRead(QNetworkReply *reply);
     
     void onArticleDeleted(QNetworkReply *reply);
+    void onArticlesDeleted(QNetworkReply *reply);
     void onArticleFavourited(QNetworkReply *reply);
+    void onArticlesFavourited(QNetworkReply *reply);
     void onArticleRead(QNetworkReply *reply);
+    void onArticlesRead(QNetworkReply *reply);
     void onReadArticlesDeleted(QNetworkReply *reply);
     
     void onReplyProgress(qint64 current, qint64 total);
     void onReplyFinished(QNetworkReply *reply);
 
+    void onQueuedResult();
+
 Q_SIGNALS:
     void finished(DBConnection *conn);
     void progressChanged(int p);
@@ -116,6 +125,16 @@ private:
         
     QNetworkAccessManager* networkAccessManager(const char *slot);
     
+    void fetch(const QString &path, const QVariantMap &params = QVariantMap());
+    void sendOperation(const char *slot, QNetworkAccessManager::Operation operation, const QString &path,
+                       const QVariantMap &params = QVariantMap(), const QByteArray &body = QByteArray(),
+                       const QVariantMap &properties = QVariantMap());
+    void queueResult(const char *slot, const QVariant &result, const QVariantMap &properties = QVariantMap());
+    
+    QVariant operationProperty(QNetworkReply *reply, const char *name) const;
+    
+    bool finishOffline(QNetworkReply *reply);
+    
     QNetworkAccessManager *m_nam;
     
     QString m_errorString;
@@ -125,6 +144,10 @@ private:
     QVariant m_result;
     
     Status m_status;
+    
+    QByteArray m_queuedSlot;
+    
+    QVariantMap m_queuedProperties;
 };
 
 #endif // DBCONNECTION_H
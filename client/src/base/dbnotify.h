@@ -33,13 +33,19 @@ Q_SIGNALS:
     void subscriptionsAdded(const QVariantList &subscriptions);
     void subscriptionDeleted(const QString &id);
     void subscriptionUpdated(const QString &id, const QVariantMap &properties);
+    void subscriptionsUpdated(const QVariantList &subscriptions);
     void subscriptionRead(const QString &id, bool isRead, const QVariantMap &properties);
     void allSubscriptionsRead();
     
+    void articlesAdded(const QStringList &articleIds, const QString &subscriptionId);
     void articleDeleted(const QString &id);
+    void articlesDeleted(const QStringList &ids);
     void articleFavourited(const QString &id, bool isFavourite, const QVariantMap &properties);
+    void articlesFavourited(const QStringList &ids, bool isFavourite);
     void articleRead(const QString &articleId, const QString &subscriptionId, bool isRead,
                      const QVariantMap &properties);
+    // subscriptionIds holds the subscription of each article in articleIds
+    void articlesRead(const QStringList &articleIds, const QStringList &subscriptionIds, bool isRead);
     void readArticlesDeleted(int count);
     
     void error(const QString &errorString);
@@ -50,6 +56,7 @@ private:
     static DBNotify *self;
     
     friend class DBConnection;
+    friend class SyncManager;
 };
 
 #endif // DBNOTIFY_H
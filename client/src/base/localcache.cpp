@@ -0,0 +1,1114 @@
+/*
+ * Copyright (C) 2017 Stuart Howarth <showarth@marxoft.co.uk>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "localcache.h"
+#include "dbconnection.h"
+#include "dbnotify.h"
+#include "definitions.h"
+#include "json.h"
+#include "logger.h"
+#include "requests.h"
+#include "settings.h"
+#include <QDir>
+#include <QNetworkReply>
+#include <QSet>
+#include <QSqlError>
+#include <QSqlQuery>
+
+static const QString CONNECTION_NAME("localcache");
+
+static const QString SUBSCRIPTIONS_COMPLETE_KEY("subscriptionsComplete");
+static const QString SYNC_SEQUENCE_KEY("syncSequence");
+
+static const int PENDING_OPERATION_RETRY_DELAY = 60000;
+
+static QVariantMap articleToMap(const QSqlQuery &query) {
+    QVariantMap article = QtJson::Json::parse(query.value(0).toString()).toMap();
+    article["favourite"] = query.value(1).toBool();
+    article["read"] = query.value(2).toBool();
+    return article;
+}
+
+static QString articleListCondition(const QString &subscriptionId) {
+    if (subscriptionId == ALL_ARTICLES_SUBSCRIPTION_ID) {
+        return QString();
+    }
+    
+    if (subscriptionId == FAVOURITES_SUBSCRIPTION_ID) {
+        return QString(" WHERE isFavourite = 1");
+    }
+    
+    return QString(" WHERE subscriptionId = ?");
+}
+
+LocalCache* LocalCache::self = 0;
+
+LocalCache::LocalCache() :
+    QObject(),
+    m_nam(0),
+    m_sending(false)
+{
+    m_retryTimer.setSingleShot(true);
+    connect(&m_retryTimer, SIGNAL(timeout()), this, SLOT(sendPendingOperations()));
+    
+    m_db = QSqlDatabase::addDatabase("QSQLITE", CONNECTION_NAME);
+    m_db.setDatabaseName(LOCAL_CACHE_NAME);
+    
+    // Items that have not been kept up to date by SyncManager cannot be trusted for reads
+    if ((open()) && (syncSequence() == 0)) {
+        invalidate();
+    }
+    
+    connect(DBNotify::instance(), SIGNAL(subscriptionsAdded(QVariantList)),
+            this, SLOT(onSubscriptionsAdded(QVariantList)));
+    connect(DBNotify::instance(), SIGNAL(subscriptionDeleted(QString)), this, SLOT(onSubscriptionDeleted(QString)));
+    connect(DBNotify::instance(), SIGNAL(subscriptionUpdated(QString, QVariantMap)),
+            this, SLOT(onSubscriptionUpdated(QString, QVariantMap)));
+    connect(DBNotify::instance(), SIGNAL(subscriptionsUpdated(QVariantList)),
+            this, SLOT(onSubscriptionsUpdated(QVariantList)));
+    connect(DBNotify::instance(), SIGNAL(subscriptionRead(QString, bool, QVariantMap)),
+            this, SLOT(onSubscriptionRead(QString, bool, QVariantMap)));
+    connect(DBNotify::instance(), SIGNAL(allSubscriptionsRead()), this, SLOT(onAllSubscriptionsRead()));
+    connect(DBNotify::instance(), SIGNAL(articlesAdded(QStringList, QString)),
+            this, SLOT(onArticlesAdded(QStringList, QString)));
+    connect(DBNotify::instance(), SIGNAL(articleDeleted(QString)), this, SLOT(onArticleDeleted(QString)));
+    connect(DBNotify::instance(), SIGNAL(articlesDeleted(QStringList)), this, SLOT(onArticlesDeleted(QStringList)));
+    connect(DBNotify::instance(), SIGNAL(articleFavourited(QString, bool, QVariantMap)),
+            this, SLOT(onArticleFavourited(QString, bool)));
+    connect(DBNotify::instance(), SIGNAL(articlesFavourited(QStringList, bool)),
+            this, SLOT(onArticlesFavourited(QStringList, bool)));
+    connect(DBNotify::instance(), SIGNAL(articleRead(QString, QString, bool, QVariantMap)),
+            this, SLOT(onArticleRead(QString, QString, bool)));
+    connect(DBNotify::instance(), SIGNAL(articlesRead(QStringList, QStringList, bool)),
+            this, SLOT(onArticlesRead(QStringList, QStringList, bool)));
+    connect(DBNotify::instance(), SIGNAL(readArticlesDeleted(int)), this, SLOT(onReadArticlesDeleted()));
+    connect(Settings::instance(), SIGNAL(serverAddressChanged(QString)), this, SLOT(onServerAddressChanged()));
+}
+
+LocalCache::~LocalCache() {
+    self = 0;
+    m_db.close();
+    m_db = QSqlDatabase();
+    QSqlDatabase::removeDatabase(CONNECTION_NAME);
+}
+
+LocalCache* LocalCache::instance() {
+    return self ? self : self = new LocalCache;
+}
+
+bool LocalCache::open() {
+    if (m_db.isOpen()) {
+        return true;
+    }
+    
+    if (!QDir().mkpath(APP_CONFIG_PATH)) {
+        Logger::log("LocalCache::open(). Unable to make path " + APP_CONFIG_PATH);
+        return false;
+    }
+    
+    if (!m_db.open()) {
+        Logger::log("LocalCache::open(). Error: " + m_db.lastError().text());
+        return false;
+    }
+    
+    QSqlQuery query(m_db);
+    const QStringList statements = QStringList()
+        << "CREATE TABLE IF NOT EXISTS subscriptions (id TEXT PRIMARY KEY NOT NULL, position INTEGER, \
+        unreadArticles INTEGER, data TEXT)"
+        << "CREATE TABLE IF NOT EXISTS articles (id TEXT PRIMARY KEY NOT NULL, subscriptionId TEXT, date INTEGER, \
+        isFavourite INTEGER, isRead INTEGER, data TEXT)"
+        << "CREATE INDEX IF NOT EXISTS articles_subscriptionId ON articles (subscriptionId)"
+        << "CREATE INDEX IF NOT EXISTS articles_date ON articles (date)"
+        // The number of articles of each list that have been loaded, from the most recent
+        << "CREATE TABLE IF NOT EXISTS lists (id TEXT PRIMARY KEY NOT NULL, loaded INTEGER, complete INTEGER)"
+        << "CREATE TABLE IF NOT EXISTS operations (id INTEGER PRIMARY KEY AUTOINCREMENT, operation INTEGER, \
+        path TEXT, params TEXT, body BLOB)"
+        << "CREATE TABLE IF NOT EXISTS settings (key TEXT PRIMARY KEY NOT NULL, value TEXT)";
+    
+    foreach (const QString &statement, statements) {
+        if (!query.exec(statement)) {
+            Logger::log("LocalCache::open(). Error: " + query.lastError().text());
+            m_db.close();
+            return false;
+        }
+    }
+    
+    Logger::log("LocalCache::open(). OK", Logger::LowVerbosity);
+    return true;
+}
+
+qlonglong LocalCache::syncSequence() const {
+    return value(SYNC_SEQUENCE_KEY).toLongLong();
+}
+
+void LocalCache::setSyncSequence(qlonglong sequence) {
+    setValue(SYNC_SEQUENCE_KEY, QString::number(sequence));
+}
+
+bool LocalCache::get(const QString &path, const QVariantMap &params, QVariant &result, bool requireComplete) {
+    if (!open()) {
+        return false;
+    }
+    
+    const QStringList parts = path.split("/", QString::SkipEmptyParts);
+    
+    if ((parts.isEmpty()) || (parts.size() > 2)) {
+        return false;
+    }
+    
+    const QStringList ids = params.value("id").toString().split(",", QString::SkipEmptyParts);
+    const int offset = params.value("offset").toInt();
+    const int limit = params.value("limit").toInt();
+    
+    if (parts.first() == "subscriptions") {
+        if ((requireComplete) && (value(SUBSCRIPTIONS_COMPLETE_KEY) != "1")) {
+            return false;
+        }
+        
+        if (parts.size() == 2) {
+            const QVariantList subscription = subscriptions(QStringList() << parts.at(1));
+            
+            if (subscription.isEmpty()) {
+                return false;
+            }
+            
+            result = subscription.first();
+            return true;
+        }
+        
+        if (!ids.isEmpty()) {
+            const QVariantList list = subscriptions(ids);
+            
+            if ((requireComplete) && (list.size() < ids.size())) {
+                return false;
+            }
+            
+            result = list;
+            return true;
+        }
+        
+        result = subscriptions(QStringList(), offset, limit);
+        return true;
+    }
+    
+    if (parts.first() == "articles") {
+        if (parts.size() == 2) {
+            const QVariantList article = articles(QStringList() << parts.at(1));
+            
+            if (article.isEmpty()) {
+                return false;
+            }
+            
+            result = article.first();
+            return true;
+        }
+        
+        if (!ids.isEmpty()) {
+            const QVariantList list = articles(ids);
+            
+            if ((requireComplete) && (list.size() < ids.size())) {
+                return false;
+            }
+            
+            result = list;
+            return true;
+        }
+        
+        const QString query = params.value("search").toString();
+        
+        if (!query.isEmpty()) {
+            // Only the server can search all of the articles
+            if (requireComplete) {
+                return false;
+            }
+            
+            result = searchArticles(query, offset, limit);
+            return true;
+        }
+        
+        QString subscriptionId = params.value("subscriptionId").toString();
+        
+        if (subscriptionId.isEmpty()) {
+            subscriptionId = ALL_ARTICLES_SUBSCRIPTION_ID;
+        }
+        
+        if ((requireComplete) && (!hasArticles(subscriptionId, offset, limit))) {
+            return false;
+        }
+        
+        result = articles(subscriptionId, offset, limit);
+        return true;
+    }
+    
+    return false;
+}
+
+void LocalCache::store(const QString &path, const QVariantMap &params, const QVariant &result) {
+    if (!open()) {
+        return;
+    }
+    
+    const QStringList parts = path.split("/", QString::SkipEmptyParts);
+    
+    if ((parts.isEmpty()) || (parts.size() > 2)) {
+        return;
+    }
+    
+    const bool hasIds = !params.value("id").toString().isEmpty();
+    const int offset = params.value("offset").toInt();
+    const int limit = params.value("limit").toInt();
+    
+    if (parts.first() == "subscriptions") {
+        if (parts.size() == 2) {
+            storeSubscriptions(QVariantList() << result);
+        }
+        else {
+            storeSubscriptions(result.toList(), (!hasIds) && (offset == 0) && (limit <= 0));
+        }
+    }
+    else if (parts.first() == "articles") {
+        if (parts.size() == 2) {
+            storeArticles(QVariantList() << result);
+        }
+        else if ((hasIds) || (params.contains("search"))) {
+            storeArticles(result.toList());
+        }
+        else {
+            const QString subscriptionId = params.value("subscriptionId").toString();
+            storeArticles(result.toList(), subscriptionId.isEmpty() ? ALL_ARTICLES_SUBSCRIPTION_ID : subscriptionId,
+                          offset, limit);
+        }
+    }
+}
+
+bool LocalCache::hasPendingOperations() const {
+    if (!m_db.isOpen()) {
+        return false;
+    }
+    
+    QSqlQuery query(m_db);
+    return (query.exec("SELECT id FROM operations LIMIT 1")) && (query.next());
+}
+
+bool LocalCache::isQueueable(QNetworkAccessManager::Operation operation, const QString &path) {
+    const QStringList parts = path.split("/", QString::SkipEmptyParts);
+    
+    if (parts.size() != 2) {
+        return false;
+    }
+    
+    const QString &action = parts.at(1);
+    
+    if (parts.first() == "articles") {
+        return (operation == QNetworkAccessManager::DeleteOperation) || (action == "delete")
+            || (action == "favourite") || (action == "unfavourite") || (action == "read") || (action == "unread");
+    }
+    
+    if (parts.first() == "subscriptions") {
+        return (operation == QNetworkAccessManager::GetOperation) && ((action == "read") || (action == "unread"));
+    }
+    
+    return false;
+}
+
+bool LocalCache::addPendingOperation(QNetworkAccessManager::Operation operation, const QString &path,
+                                     const QVariantMap &params, const QByteArray &body, QVariant &result) {
+    if ((!isQueueable(operation, path)) || (!open())) {
+        return false;
+    }
+    
+    Logger::log("LocalCache::addPendingOperation(). " + path, Logger::MediumVerbosity);
+    QSqlQuery query(m_db);
+    query.prepare("INSERT INTO operations (operation, path, params, body) VALUES (?, ?, ?, ?)");
+    query.addBindValue(int(operation));
+    query.addBindValue(path);
+    query.addBindValue(QString::fromUtf8(QtJson::Json::serialize(params)));
+    query.addBindValue(body);
+    
+    if (!query.exec()) {
+        Logger::log("LocalCache::addPendingOperation(). Error: " + query.lastError().text());
+        return false;
+    }
+    
+    // The result is the one the server would give, using what is known locally.
+    // The change itself is applied to the cache when it is announced via DBNotify.
+    const QStringList parts = path.split("/", QString::SkipEmptyParts);
+    const QString &action = parts.at(1);
+    const bool state = (action == "read") || (action == "favourite");
+    const QString id = params.value("id").toString();
+    
+    if (parts.first() == "subscriptions") {
+        if (id.isEmpty()) {
+            return true;
+        }
+        
+        const QVariantList list = subscriptions(QStringList() << id);
+        QVariantMap subscription = list.isEmpty() ? QVariantMap() : list.first().toMap();
+        subscription["id"] = id;
+        
+        if (state) {
+            subscription["unreadArticles"] = 0;
+        }
+        else {
+            query.prepare("SELECT COUNT(id) FROM articles WHERE subscriptionId = ?");
+            query.addBindValue(id);
+            subscription["unreadArticles"] = ((query.exec()) && (query.next())) ? query.value(0).toInt() : 0;
+        }
+        
+        result = subscription;
+        return true;
+    }
+    
+    if ((operation == QNetworkAccessManager::DeleteOperation) || (action == "delete")) {
+        return true;
+    }
+    
+    const QString key = action.endsWith("read") ? QString("read") : QString("favourite");
+    
+    if (!id.isEmpty()) {
+        const QVariantList list = articles(QStringList() << id);
+        QVariantMap article = list.isEmpty() ? QVariantMap() : list.first().toMap();
+        article["id"] = id;
+        article[key] = state;
+        result = article;
+        return true;
+    }
+    
+    const QStringList ids = QtJson::Json::parse(QString::fromUtf8(body)).toStringList();
+    QHash<QString, QString> subscriptionIds;
+    
+    foreach (const QVariant &v, articles(ids)) {
+        const QVariantMap article = v.toMap();
+        subscriptionIds[article.value("id").toString()] = article.value("subscriptionId").toString();
+    }
+    
+    QVariantList list;
+    
+    foreach (const QString &articleId, ids) {
+        QVariantMap article;
+        article["id"] = articleId;
+        article["subscriptionId"] = subscriptionIds.value(articleId);
+        article[key] = state;
+        list << article;
+    }
+    
+    result = list;
+    return true;
+}
+
+void LocalCache::clear() {
+    if (!open()) {
+        return;
+    }
+    
+    Logger::log("LocalCache::clear()", Logger::LowVerbosity);
+    QSqlQuery query(m_db);
+    m_db.transaction();
+    query.exec("DELETE FROM subscriptions");
+    query.exec("DELETE FROM articles");
+    query.exec("DELETE FROM lists");
+    query.exec("DELETE FROM operations");
+    query.exec("DELETE FROM settings");
+    m_db.commit();
+    m_refreshingLists.clear();
+}
+
+void LocalCache::invalidate() {
+    if (!open()) {
+        return;
+    }
+    
+    Logger::log("LocalCache::invalidate()", Logger::LowVerbosity);
+    // The items are kept, so that they are still available when the server cannot be reached
+    QSqlQuery query(m_db);
+    query.exec("DELETE FROM lists");
+    setValue(SUBSCRIPTIONS_COMPLETE_KEY, "0");
+}
+
+void LocalCache::sendPendingOperations() {
+    if ((m_sending) || (!open())) {
+        return;
+    }
+    
+    QSqlQuery query(m_db);
+    
+    if ((!query.exec("SELECT id, operation, path, params, body FROM operations ORDER BY id ASC LIMIT 1"))
+        || (!query.next())) {
+        return;
+    }
+    
+    m_sending = true;
+    const QNetworkAccessManager::Operation operation = QNetworkAccessManager::Operation(query.value(1).toInt());
+    const QString path = query.value(2).toString();
+    const QVariantMap params = QtJson::Json::parse(query.value(3).toString()).toMap();
+    const QNetworkRequest request = params.isEmpty() ? buildRequest(path, operation)
+                                                     : buildRequest(path, params, operation);
+    Logger::log("LocalCache::sendPendingOperations(). " + path, Logger::MediumVerbosity);
+    QNetworkReply *reply;
+    
+    switch (operation) {
+    case QNetworkAccessManager::PostOperation:
+        reply = networkAccessManager()->post(request, query.value(4).toByteArray());
+        break;
+    case QNetworkAccessManager::DeleteOperation:
+        reply = networkAccessManager()->deleteResource(request);
+        break;
+    default:
+        reply = networkAccessManager()->get(request);
+        break;
+    }
+    
+    reply->setProperty("operationId", query.value(0));
+    connect(reply, SIGNAL(finished()), this, SLOT(onPendingOperationFinished()));
+}
+
+QVariantList LocalCache::subscriptions(const QStringList &ids, int offset, int limit) {
+    QVariantList list;
+    QSqlQuery query(m_db);
+    QString statement("SELECT data, unreadArticles FROM subscriptions");
+    
+    if (!ids.isEmpty()) {
+        QStringList placeholders;
+        
+        for (int i = 0; i < ids.size(); i++) {
+            placeholders << "?";
+        }
+        
+        statement.append(QString(" WHERE id IN (%1)").arg(placeholders.join(", ")));
+    }
+    
+    statement.append(" ORDER BY position ASC");
+    
+    if (limit > 0) {
+        statement.append(QString(" LIMIT %1 OFFSET %2").arg(limit).arg(offset));
+    }
+    
+    query.prepare(statement);
+    
+    foreach (const QString &id, ids) {
+        query.addBindValue(id);
+    }
+    
+    if (!query.exec()) {
+        Logger::log("LocalCache::subscriptions(). Error: " + query.lastError().text());
+        return list;
+    }
+    
+    while (query.next()) {
+        QVariantMap subscription = QtJson::Json::parse(query.value(0).toString()).toMap();
+        subscription["unreadArticles"] = query.value(1).toInt();
+        list << subscription;
+    }
+    
+    return list;
+}
+
+void LocalCache::storeSubscriptions(const QVariantList &subscriptions, bool replace) {
+    QSqlQuery query(m_db);
+    int position = 0;
+    m_db.transaction();
+    
+    if (replace) {
+        query.exec("DELETE FROM subscriptions");
+    }
+    else if ((query.exec("SELECT MAX(position) FROM subscriptions")) && (query.next())) {
+        position = query.value(0).toInt() + 1;
+    }
+    
+    foreach (const QVariant &v, subscriptions) {
+        QVariantMap subscription = v.toMap();
+        const QString id = subscription.value("id").toString();
+        
+        if (id.isEmpty()) {
+            continue;
+        }
+        
+        // Existing subscriptions keep their position and any properties that are not given
+        query.prepare("SELECT data FROM subscriptions WHERE id = ?");
+        query.addBindValue(id);
+        
+        if ((query.exec()) && (query.next())) {
+            QVariantMap properties = QtJson::Json::parse(query.value(0).toString()).toMap();
+            QMapIterator<QString, QVariant> iterator(subscription);
+            
+            while (iterator.hasNext()) {
+                iterator.next();
+                properties[iterator.key()] = iterator.value();
+            }
+            
+            query.prepare("UPDATE subscriptions SET unreadArticles = ?, data = ? WHERE id = ?");
+            query.addBindValue(properties.value("unreadArticles").toInt());
+            query.addBindValue(QString::fromUtf8(QtJson::Json::serialize(properties)));
+            query.addBindValue(id);
+        }
+        else {
+            query.prepare("INSERT INTO subscriptions (id, position, unreadArticles, data) VALUES (?, ?, ?, ?)");
+            query.addBindValue(id);
+            query.addBindValue(position++);
+            query.addBindValue(subscription.value("unreadArticles").toInt());
+            query.addBindValue(QString::fromUtf8(QtJson::Json::serialize(subscription)));
+        }
+        
+        if (!query.exec()) {
+            Logger::log("LocalCache::storeSubscriptions(). Error: " + query.lastError().text());
+        }
+    }
+    
+    if (replace) {
+        setValue(SUBSCRIPTIONS_COMPLETE_KEY, "1");
+    }
+    
+    m_db.commit();
+}
+
+bool LocalCache::hasArticles(const QString &subscriptionId, int offset, int limit) {
+    if (m_refreshingLists.contains(subscriptionId)) {
+        return false;
+    }
+    
+    QSqlQuery query(m_db);
+    query.prepare("SELECT loaded, complete FROM lists WHERE id = ?");
+    query.addBindValue(subscriptionId);
+    
+    if ((!query.exec()) || (!query.next())) {
+        return false;
+    }
+    
+    if (query.value(1).toBool()) {
+        return true;
+    }
+    
+    return (limit > 0) && (query.value(0).toInt() >= offset + limit);
+}
+
+QVariantList LocalCache::articles(const QStringList &ids) {
+    QVariantList list;
+    QSqlQuery query(m_db);
+    query.prepare("SELECT data, isFavourite, isRead FROM articles WHERE id = ?");
+    
+    foreach (const QString &id, ids) {
+        query.addBindValue(id);
+        
+        if ((query.exec()) && (query.next())) {
+            list << articleToMap(query);
+        }
+    }
+    
+    return list;
+}
+
+QVariantList LocalCache::articles(const QString &subscriptionId, int offset, int limit) {
+    QVariantList list;
+    QSqlQuery query(m_db);
+    const QString condition = articleListCondition(subscriptionId);
+    QString statement("SELECT data, isFavourite, isRead FROM articles" + condition + " ORDER BY date DESC");
+    
+    if (limit > 0) {
+        statement.append(QString(" LIMIT %1 OFFSET %2").arg(limit).arg(offset));
+    }
+    
+    query.prepare(statement);
+    
+    if (condition.contains("?")) {
+        query.addBindValue(subscriptionId);
+    }
+    
+    if (!query.exec()) {
+        Logger::log("LocalCache::articles(). Error: " + query.lastError().text());
+        return list;
+    }
+    
+    while (query.next()) {
+        list << articleToMap(query);
+    }
+    
+    return list;
+}
+
+QVariantList LocalCache::searchArticles(const QString &query, int offset, int limit) {
+    QVariantList list;
+    QSqlQuery sqlQuery(m_db);
+    QString statement("SELECT data, isFavourite, isRead FROM articles WHERE data LIKE ? ORDER BY date DESC");
+    
+    if (limit > 0) {
+        statement.append(QString(" LIMIT %1 OFFSET %2").arg(limit).arg(offset));
+    }
+    
+    sqlQuery.prepare(statement);
+    sqlQuery.addBindValue("%" + query + "%");
+    
+    if (!sqlQuery.exec()) {
+        Logger::log("LocalCache::searchArticles(). Error: " + sqlQuery.lastError().text());
+        return list;
+    }
+    
+    while (sqlQuery.next()) {
+        list << articleToMap(sqlQuery);
+    }
+    
+    return list;
+}
+
+void LocalCache::storeArticles(const QVariantList &articles) {
+    QSqlQuery query(m_db);
+    query.prepare("INSERT OR REPLACE INTO articles (id, subscriptionId, date, isFavourite, isRead, data) \
+    VALUES (?, ?, ?, ?, ?, ?)");
+    m_db.transaction();
+    
+    foreach (const QVariant &v, articles) {
+        const QVariantMap article = v.toMap();
+        query.addBindValue(article.value("id").toString());
+        query.addBindValue(article.value("subscriptionId").toString());
+        query.addBindValue(article.value("date").toLongLong());
+        query.addBindValue(article.value("favourite").toBool() ? 1 : 0);
+        query.addBindValue(article.value("read").toBool() ? 1 : 0);
+        query.addBindValue(QString::fromUtf8(QtJson::Json::serialize(article)));
+        
+        if (!query.exec()) {
+            Logger::log("LocalCache::storeArticles(). Error: " + query.lastError().text());
+        }
+    }
+    
+    m_db.commit();
+}
+
+void LocalCache::storeArticles(const QVariantList &articles, const QString &subscriptionId, int offset, int limit) {
+    const bool isLast = (limit <= 0) || (articles.size() < limit);
+    QSqlQuery query(m_db);
+    
+    // When the whole list has been fetched, any other articles in the list are no longer on the server
+    if ((offset == 0) && (isLast)) {
+        QSet<QString> ids;
+        QStringList removed;
+        
+        foreach (const QVariant &article, articles) {
+            ids << article.toMap().value("id").toString();
+        }
+        
+        const QString condition = articleListCondition(subscriptionId);
+        query.prepare("SELECT id FROM articles" + condition);
+        
+        if (condition.contains("?")) {
+            query.addBindValue(subscriptionId);
+        }
+        
+        if (query.exec()) {
+            while (query.next()) {
+                const QString id = query.value(0).toString();
+                
+                if (!ids.contains(id)) {
+                    removed << id;
+                }
+            }
+        }
+        
+        if (!removed.isEmpty()) {
+            if (subscriptionId == FAVOURITES_SUBSCRIPTION_ID) {
+                markArticlesFavourite(removed, false);
+            }
+            else {
+                deleteArticles(removed);
+            }
+        }
+    }
+    
+    storeArticles(articles);
+    int loaded = 0;
+    bool complete = false;
+    query.prepare("SELECT loaded, complete FROM lists WHERE id = ?");
+    query.addBindValue(subscriptionId);
+    
+    if ((query.exec()) && (query.next())) {
+        loaded = query.value(0).toInt();
+        complete = query.value(1).toBool();
+    }
+    
+    // A range is only recorded if it follows on from the articles already loaded
+    if (offset > loaded) {
+        return;
+    }
+    
+    query.prepare("INSERT OR REPLACE INTO lists (id, loaded, complete) VALUES (?, ?, ?)");
+    query.addBindValue(subscriptionId);
+    query.addBindValue(qMax(loaded, offset + articles.size()));
+    query.addBindValue(((complete) || (isLast)) ? 1 : 0);
+    
+    if (!query.exec()) {
+        Logger::log("LocalCache::storeArticles(). Error: " + query.lastError().text());
+    }
+}
+
+void LocalCache::deleteArticles(const QStringList &ids) {
+    QSqlQuery query(m_db);
+    query.prepare("DELETE FROM articles WHERE id = ?");
+    int count = 0;
+    m_db.transaction();
+    
+    foreach (const QString &id, ids) {
+        query.addBindValue(id);
+        
+        if (query.exec()) {
+            count += query.numRowsAffected();
+        }
+    }
+    
+    // Lists with fewer articles loaded are still correct, so the loaded counts are reduced by the maximum
+    if (count > 0) {
+        query.prepare("UPDATE lists SET loaded = MAX(0, loaded - ?)");
+        query.addBindValue(count);
+        query.exec();
+    }
+    
+    m_db.commit();
+}
+
+void LocalCache::markArticlesFavourite(const QStringList &ids, bool isFavourite) {
+    QSqlQuery query(m_db);
+    query.prepare("UPDATE articles SET isFavourite = ? WHERE id = ?");
+    bool missing = false;
+    m_db.transaction();
+    
+    foreach (const QString &id, ids) {
+        query.addBindValue(isFavourite ? 1 : 0);
+        query.addBindValue(id);
+        
+        if ((!query.exec()) || (query.numRowsAffected() < 1)) {
+            missing = true;
+        }
+    }
+    
+    m_db.commit();
+    
+    if ((missing) && (isFavourite)) {
+        invalidateList(FAVOURITES_SUBSCRIPTION_ID);
+    }
+    else {
+        // Favourites can be added anywhere in the list, so only a complete list remains valid
+        query.prepare("UPDATE lists SET loaded = 0 WHERE id = ? AND complete = 0");
+        query.addBindValue(FAVOURITES_SUBSCRIPTION_ID);
+        query.exec();
+    }
+}
+
+void LocalCache::markArticlesRead(const QStringList &ids, bool isRead) {
+    QSqlQuery select(m_db);
+    QSqlQuery update(m_db);
+    QHash<QString, int> changes;
+    select.prepare("SELECT subscriptionId FROM articles WHERE id = ? AND isRead != ?");
+    update.prepare("UPDATE articles SET isRead = ? WHERE id = ?");
+    m_db.transaction();
+    
+    foreach (const QString &id, ids) {
+        select.addBindValue(id);
+        select.addBindValue(isRead ? 1 : 0);
+        
+        if ((select.exec()) && (select.next())) {
+            changes[select.value(0).toString()] += isRead ? -1 : 1;
+            update.addBindValue(isRead ? 1 : 0);
+            update.addBindValue(id);
+            update.exec();
+        }
+    }
+    
+    adjustUnreadArticles(changes);
+    m_db.commit();
+}
+
+void LocalCache::markSubscriptionRead(const QString &id, bool isRead) {
+    QSqlQuery query(m_db);
+    
+    if (id.isEmpty()) {
+        m_db.transaction();
+        query.exec("UPDATE articles SET isRead = 1");
+        query.exec("UPDATE subscriptions SET unreadArticles = 0");
+        m_db.commit();
+        return;
+    }
+    
+    query.prepare("UPDATE articles SET isRead = ? WHERE subscriptionId = ?");
+    query.addBindValue(isRead ? 1 : 0);
+    query.addBindValue(id);
+    query.exec();
+}
+
+void LocalCache::adjustUnreadArticles(const QHash<QString, int> &changes) {
+    QSqlQuery query(m_db);
+    query.prepare("UPDATE subscriptions SET unreadArticles = MAX(0, unreadArticles + ?) WHERE id = ?");
+    QHashIterator<QString, int> iterator(changes);
+    
+    while (iterator.hasNext()) {
+        iterator.next();
+        query.addBindValue(iterator.value());
+        query.addBindValue(iterator.key());
+        query.exec();
+    }
+}
+
+void LocalCache::invalidateList(const QString &subscriptionId) {
+    QSqlQuery query(m_db);
+    query.prepare("DELETE FROM lists WHERE id = ?");
+    query.addBindValue(subscriptionId);
+    query.exec();
+}
+
+QString LocalCache::value(const QString &key) const {
+    if (!m_db.isOpen()) {
+        return QString();
+    }
+    
+    QSqlQuery query(m_db);
+    query.prepare("SELECT value FROM settings WHERE key = ?");
+    query.addBindValue(key);
+    return ((query.exec()) && (query.next())) ? query.value(0).toString() : QString();
+}
+
+void LocalCache::setValue(const QString &key, const QString &value) {
+    if (!open()) {
+        return;
+    }
+    
+    QSqlQuery query(m_db);
+    query.prepare("INSERT OR REPLACE INTO settings (key, value) VALUES (?, ?)");
+    query.addBindValue(key);
+    query.addBindValue(value);
+    query.exec();
+}
+
+QNetworkAccessManager* LocalCache::networkAccessManager() {
+    if (!m_nam) {
+        m_nam = new QNetworkAccessManager(this);
+    }
+    
+    return m_nam;
+}
+
+void LocalCache::onSubscriptionsAdded(const QVariantList &subscriptions) {
+    if (open()) {
+        storeSubscriptions(subscriptions);
+    }
+}
+
+void LocalCache::onSubscriptionDeleted(const QString &id) {
+    if (!open()) {
+        return;
+    }
+    
+    QSqlQuery query(m_db);
+    query.prepare("DELETE FROM subscriptions WHERE id = ?");
+    query.addBindValue(id);
+    query.exec();
+    query.prepare("SELECT id FROM articles WHERE subscriptionId = ?");
+    query.addBindValue(id);
+    QStringList ids;
+    
+    if (query.exec()) {
+        while (query.next()) {
+            ids << query.value(0).toString();
+        }
+    }
+    
+    deleteArticles(ids);
+    invalidateList(id);
+}
+
+void LocalCache::onSubscriptionUpdated(const QString &id, const QVariantMap &properties) {
+    if (open()) {
+        QVariantMap subscription = properties;
+        subscription["id"] = id;
+        storeSubscriptions(QVariantList() << subscription);
+    }
+}
+
+void LocalCache::onSubscriptionsUpdated(const QVariantList &subscriptions) {
+    if (open()) {
+        storeSubscriptions(subscriptions);
+    }
+}
+
+void LocalCache::onSubscriptionRead(const QString &id, bool isRead, const QVariantMap &properties) {
+    if (!open()) {
+        return;
+    }
+    
+    markSubscriptionRead(id, isRead);
+    QVariantMap subscription = properties;
+    subscription["id"] = id;
+    storeSubscriptions(QVariantList() << subscription);
+}
+
+void LocalCache::onAllSubscriptionsRead() {
+    if (open()) {
+        markSubscriptionRead(QString(), true);
+    }
+}
+
+void LocalCache::onArticlesAdded(const QStringList &articleIds, const QString &subscriptionId) {
+    if (!open()) {
+        return;
+    }
+    
+    QStringList lists;
+    QSqlQuery query(m_db);
+    query.prepare("SELECT id FROM lists WHERE id IN (?, ?)");
+    query.addBindValue(subscriptionId);
+    query.addBindValue(ALL_ARTICLES_SUBSCRIPTION_ID);
+    
+    if (query.exec()) {
+        while (query.next()) {
+            lists << query.value(0).toString();
+        }
+    }
+    
+    // Only lists that are already cached need the new articles
+    if (lists.isEmpty()) {
+        return;
+    }
+    
+    Logger::log(QString("LocalCache::onArticlesAdded(). Fetching %1 articles").arg(articleIds.size()),
+                Logger::MediumVerbosity);
+    m_refreshingLists << lists;
+    DBConnection *connection = DBConnection::connection(this, SLOT(onAddedArticlesFetched(DBConnection*)));
+    connection->setProperty("count", articleIds.size());
+    connection->setProperty("lists", lists);
+    connection->fetchArticles(articleIds);
+}
+
+void LocalCache::onArticleDeleted(const QString &id) {
+    onArticlesDeleted(QStringList() << id);
+}
+
+void LocalCache::onArticlesDeleted(const QStringList &ids) {
+    if (!open()) {
+        return;
+    }
+    
+    QSqlQuery query(m_db);
+    QHash<QString, int> changes;
+    query.prepare("SELECT subscriptionId FROM articles WHERE id = ? AND isRead = 0");
+    
+    foreach (const QString &id, ids) {
+        query.addBindValue(id);
+        
+        if ((query.exec()) && (query.next())) {
+            changes[query.value(0).toString()]--;
+        }
+    }
+    
+    adjustUnreadArticles(changes);
+    deleteArticles(ids);
+}
+
+void LocalCache::onArticleFavourited(const QString &id, bool isFavourite) {
+    if (open()) {
+        markArticlesFavourite(QStringList() << id, isFavourite);
+    }
+}
+
+void LocalCache::onArticlesFavourited(const QStringList &ids, bool isFavourite) {
+    if (open()) {
+        markArticlesFavourite(ids, isFavourite);
+    }
+}
+
+void LocalCache::onArticleRead(const QString &articleId, const QString &, bool isRead) {
+    if (open()) {
+        markArticlesRead(QStringList() << articleId, isRead);
+    }
+}
+
+void LocalCache::onArticlesRead(const QStringList &articleIds, const QStringList &, bool isRead) {
+    if (open()) {
+        markArticlesRead(articleIds, isRead);
+    }
+}
+
+void LocalCache::onReadArticlesDeleted() {
+    if (!open()) {
+        return;
+    }
+    
+    // The deleted articles are not known, so none of the lists can be trusted
+    QSqlQuery query(m_db);
+    query.exec("DELETE FROM lists");
+}
+
+void LocalCache::onAddedArticlesFetched(DBConnection *connection) {
+    const QStringList lists = connection->property("lists").toStringList();
+    
+    // The articles may have been answered by the cache if the server could not be reached
+    if ((connection->status() == DBConnection::Ready)
+        && (connection->result().toList().size() >= connection->property("count").toInt())) {
+        // The new articles are the most recent, so the articles already loaded move down the list
+        QSqlQuery query(m_db);
+        query.prepare("UPDATE lists SET loaded = loaded + ? WHERE id = ? AND complete = 0");
+        
+        foreach (const QString &list, lists) {
+            query.addBindValue(connection->property("count").toInt());
+            query.addBindValue(list);
+            query.exec();
+        }
+    }
+    else {
+        foreach (const QString &list, lists) {
+            invalidateList(list);
+        }
+    }
+    
+    foreach (const QString &list, lists) {
+        m_refreshingLists.removeOne(list);
+    }
+    
+    connection->deleteLater();
+}
+
+void LocalCache::onPendingOperationFinished() {
+    QNetworkReply *reply = qobject_cast<QNetworkReply*>(sender());
+    
+    if (!reply) {
+        return;
+    }
+    
+    m_sending = false;
+    
+    if (isNetworkUnavailable(reply)) {
+        // The operation is kept, and sent again when the server can be reached
+        Logger::log("LocalCache::onPendingOperationFinished(). Server unavailable: " + reply->errorString(),
+                    Logger::MediumVerbosity);
+        
+        // A server that is busy or failing is asked again once it is expected to have recovered
+        if (isTransientError(reply)) {
+            m_retryTimer.start(retryDelay(reply, PENDING_OPERATION_RETRY_DELAY));
+        }
+    }
+    else {
+        if (reply->error() != QNetworkReply::NoError) {
+            // The server has refused the operation, so sending it again will not help
+            Logger::log("LocalCache::onPendingOperationFinished(). Error: " + reply->errorString());
+        }
+        
+        QSqlQuery query(m_db);
+        query.prepare("DELETE FROM operations WHERE id = ?");
+        query.addBindValue(reply->property("operationId"));
+        query.exec();
+        sendPendingOperations();
+    }
+    
+    reply->deleteLater();
+}
+
+void LocalCache::onServerAddressChanged() {
+    clear();
+}
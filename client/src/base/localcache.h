@@ -0,0 +1,133 @@
+/*
+ * Copyright (C) 2017 Stuart Howarth <showarth@marxoft.co.uk>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LOCALCACHE_H
+#define LOCALCACHE_H
+
+#include <QHash>
+#include <QNetworkAccessManager>
+#include <QSqlDatabase>
+#include <QStringList>
+#include <QTimer>
+#include <QVariantMap>
+
+class DBConnection;
+
+/**
+ * An on-device replica of the server's subscriptions and articles.
+ *
+ * The cache is addressed using the same paths and parameters as the web interface, so that
+ * DBConnection can answer a request from the cache instead of the server. It is populated from
+ * the results of requests to the server, and kept up to date using the changes announced via
+ * DBNotify (including those received by SyncManager).
+ *
+ * Article lists are only answered from the cache when the requested range has been fetched from
+ * the server. Any list can be answered from the cache when the server cannot be reached.
+ *
+ * Changes to articles and subscription read states that cannot be sent to the server are applied
+ * to the cache and queued, then sent in order by sendPendingOperations().
+ */
+class LocalCache : public QObject
+{
+    Q_OBJECT
+
+public:
+    ~LocalCache();
+    
+    static LocalCache* instance();
+    
+    qlonglong syncSequence() const;
+    void setSyncSequence(qlonglong sequence);
+    
+    bool get(const QString &path, const QVariantMap &params, QVariant &result, bool requireComplete = true);
+    void store(const QString &path, const QVariantMap &params, const QVariant &result);
+    
+    bool hasPendingOperations() const;
+    bool addPendingOperation(QNetworkAccessManager::Operation operation, const QString &path,
+                             const QVariantMap &params, const QByteArray &body, QVariant &result);
+
+public Q_SLOTS:
+    void clear();
+    void invalidate();
+    
+    void sendPendingOperations();
+
+private Q_SLOTS:
+    void onSubscriptionsAdded(const QVariantList &subscriptions);
+    void onSubscriptionDeleted(const QString &id);
+    void onSubscriptionUpdated(const QString &id, const QVariantMap &properties);
+    void onSubscriptionsUpdated(const QVariantList &subscriptions);
+    void onSubscriptionRead(const QString &id, bool isRead, const QVariantMap &properties);
+    void onAllSubscriptionsRead();
+    
+    void onArticlesAdded(const QStringList &articleIds, const QString &subscriptionId);
+    void onArticleDeleted(const QString &id);
+    void onArticlesDeleted(const QStringList &ids);
+    void onArticleFavourited(const QString &id, bool isFavourite);
+    void onArticlesFavourited(const QStringList &ids, bool isFavourite);
+    void onArticleRead(const QString &articleId, const QString &subscriptionId, bool isRead);
+    void onArticlesRead(const QStringList &articleIds, const QStringList &subscriptionIds, bool isRead);
+    void onReadArticlesDeleted();
+    
+    void onAddedArticlesFetched(DBConnection *connection);
+    void onPendingOperationFinished();
+    
+    void onServerAddressChanged();
+
+private:
+    LocalCache();
+    
+    bool open();
+    
+    static bool isQueueable(QNetworkAccessManager::Operation operation, const QString &path);
+    
+    QVariantList subscriptions(const QStringList &ids = QStringList(), int offset = 0, int limit = 0);
+    void storeSubscriptions(const QVariantList &subscriptions, bool replace = false);
+    
+    bool hasArticles(const QString &subscriptionId, int offset, int limit);
+    QVariantList articles(const QStringList &ids);
+    QVariantList articles(const QString &subscriptionId, int offset, int limit);
+    QVariantList searchArticles(const QString &query, int offset, int limit);
+    void storeArticles(const QVariantList &articles);
+    void storeArticles(const QVariantList &articles, const QString &subscriptionId, int offset, int limit);
+    
+    void deleteArticles(const QStringList &ids);
+    void markArticlesFavourite(const QStringList &ids, bool isFavourite);
+    void markArticlesRead(const QStringList &ids, bool isRead);
+    void markSubscriptionRead(const QString &id, bool isRead);
+    
+    void adjustUnreadArticles(const QHash<QString, int> &changes);
+    void invalidateList(const QString &subscriptionId);
+    
+    QString value(const QString &key) const;
+    void setValue(const QString &key, const QString &value);
+    
+    QNetworkAccessManager* networkAccessManager();
+    
+    static LocalCache *self;
+    
+    QSqlDatabase m_db;
+    
+    QNetworkAccessManager *m_nam;
+    
+    QStringList m_refreshingLists;
+    
+    bool m_sending;
+    
+    QTimer m_retryTimer;
+};
+
+#endif // LOCALCACHE_H
@@ -0,0 +1,183 @@
+/*
+ * Copyright (C) 2017 Stuart Howarth <showarth@marxoft.co.uk>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "msgpackreader.h"
+#include <string.h>
+
+QVariant MsgPackReader::parse(const QByteArray &data, bool *ok) {
+    int index = 0;
+    bool success = true;
+    QVariant value = parseValue(data, index, success);
+    
+    if ((!success) || (index != data.size())) {
+        value = QVariant();
+        success = false;
+    }
+    
+    if (ok) {
+        *ok = success;
+    }
+    
+    return value;
+}
+
+QVariant MsgPackReader::parseValue(const QByteArray &data, int &index, bool &success) {
+    if (index >= data.size()) {
+        success = false;
+        return QVariant();
+    }
+    
+    const uchar type = uchar(data.at(index++));
+    
+    if (type < 0x80) {
+        return qlonglong(type);
+    }
+    
+    if (type >= 0xe0) {
+        return qlonglong(qint8(type));
+    }
+    
+    if ((type & 0xf0) == 0x80) {
+        return parseMap(data, index, type & 0x0f, success);
+    }
+    
+    if ((type & 0xf0) == 0x90) {
+        return parseArray(data, index, type & 0x0f, success);
+    }
+    
+    if ((type & 0xe0) == 0xa0) {
+        return parseString(data, index, type & 0x1f, success);
+    }
+    
+    switch (type) {
+    case 0xc0:
+        return QVariant();
+    case 0xc2:
+        return false;
+    case 0xc3:
+        return true;
+    case 0xca: {
+        const quint32 bits = quint32(readBigEndian(data, index, 4, success));
+        float value;
+        memcpy(&value, &bits, sizeof(value));
+        return double(value);
+    }
+    case 0xcb: {
+        const quint64 bits = readBigEndian(data, index, 8, success);
+        double value;
+        memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+    case 0xcc:
+        return qlonglong(readBigEndian(data, index, 1, success));
+    case 0xcd:
+        return qlonglong(readBigEndian(data, index, 2, success));
+    case 0xce:
+        return qlonglong(readBigEndian(data, index, 4, success));
+    case 0xcf:
+        return qulonglong(readBigEndian(data, index, 8, success));
+    case 0xd0:
+        return qlonglong(qint8(readBigEndian(data, index, 1, success)));
+    case 0xd1:
+        return qlonglong(qint16(readBigEndian(data, index, 2, success)));
+    case 0xd2:
+        return qlonglong(qint32(readBigEndian(data, index, 4, success)));
+    case 0xd3:
+        return qlonglong(readBigEndian(data, index, 8, success));
+    case 0xd9:
+        return parseString(data, index, quint32(readBigEndian(data, index, 1, success)), success);
+    case 0xda:
+        return parseString(data, index, quint32(readBigEndian(data, index, 2, success)), success);
+    case 0xdb:
+        return parseString(data, index, quint32(readBigEndian(data, index, 4, success)), success);
+    case 0xdc:
+        return parseArray(data, index, quint32(readBigEndian(data, index, 2, success)), success);
+    case 0xdd:
+        return parseArray(data, index, quint32(readBigEndian(data, index, 4, success)), success);
+    case 0xde:
+        return parseMap(data, index, quint32(readBigEndian(data, index, 2, success)), success);
+    case 0xdf:
+        return parseMap(data, index, quint32(readBigEndian(data, index, 4, success)), success);
+    default:
+        // Binary and extension types are not written by the server
+        success = false;
+        return QVariant();
+    }
+}
+
+QVariant MsgPackReader::parseArray(const QByteArray &data, int &index, quint32 count, bool &success) {
+    QVariantList list;
+    
+    // Each item is at least one byte, so a larger count can only be the result of corrupt data
+    if ((!success) || (count > quint32(data.size() - index))) {
+        success = false;
+        return list;
+    }
+    
+    list.reserve(int(count));
+    
+    for (quint32 i = 0; (i < count) && (success); i++) {
+        list << parseValue(data, index, success);
+    }
+    
+    return list;
+}
+
+QVariant MsgPackReader::parseMap(const QByteArray &data, int &index, quint32 count, bool &success) {
+    QVariantMap map;
+    
+    if ((!success) || (count > quint32(data.size() - index))) {
+        success = false;
+        return map;
+    }
+    
+    for (quint32 i = 0; (i < count) && (success); i++) {
+        const QString key = parseValue(data, index, success).toString();
+        
+        if (success) {
+            map[key] = parseValue(data, index, success);
+        }
+    }
+    
+    return map;
+}
+
+QString MsgPackReader::parseString(const QByteArray &data, int &index, quint32 size, bool &success) {
+    if ((!success) || (size > quint32(data.size() - index))) {
+        success = false;
+        return QString();
+    }
+    
+    const QString value = QString::fromUtf8(data.constData() + index, int(size));
+    index += int(size);
+    return value;
+}
+
+quint64 MsgPackReader::readBigEndian(const QByteArray &data, int &index, int size, bool &success) {
+    if (index + size > data.size()) {
+        success = false;
+        return 0;
+    }
+    
+    quint64 value = 0;
+    
+    for (int i = 0; i < size; i++) {
+        value = (value << 8) | uchar(data.at(index++));
+    }
+    
+    return value;
+}
@@ -0,0 +1,43 @@
+/*
+ * Copyright (C) 2017 Stuart Howarth <showarth@marxoft.co.uk>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef MSGPACKREADER_H
+#define MSGPACKREADER_H
+
+#include <QVariant>
+
+/**
+ * Reads MessagePack (http://msgpack.org), the compact binary format in which the server can respond.
+ *
+ * Values are read into the same QVariant types as those produced by the JSON parser.
+ */
+class MsgPackReader
+{
+
+public:
+    static QVariant parse(const QByteArray &data, bool *ok = 0);
+
+private:
+    static QVariant parseValue(const QByteArray &data, int &index, bool &success);
+    static QVariant parseArray(const QByteArray &data, int &index, quint32 count, bool &success);
+    static QVariant parseMap(const QByteArray &data, int &index, quint32 count, bool &success);
+    static QString parseString(const QByteArray &data, int &index, quint32 size, bool &success);
+    
+    static quint64 readBigEndian(const QByteArray &data, int &index, int size, bool &success);
+};
+
+#endif // MSGPACKREADER_H
@@ -17,8 +17,13 @@
 #ifndef REQUESTS_H
 #define REQUESTS_H
 
+#include "json.h"
+#include "msgpackreader.h"
 #include "settings.h"
+#include <QDateTime>
+#include <QLocale>
 #include <QNetworkAccessManager>
+#include <QNetworkReply>
 #include <QNetworkRequest>
 #if QT_VERSION >= 0x050000
 #include <QUrlQuery>
@@ -39,6 +44,9 @@ inline static QNetworkRequest buildRequest(const QString &path, QNetworkAccessMa
         break;
     }
     
+    // Responses are requested as MessagePack, which is smaller and quicker to parse than JSON
+    request.setRawHeader("Accept", "application/x-msgpack, application/json");
+    
     if (Settings::serverAuthenticationEnabled()) {
         request.setRawHeader("Authorization", "Basic " + QString("%1:%2").arg(Settings::serverUsername())
                                                                 .arg(Settings::serverPassword()).toUtf8().toBase64());
@@ -79,6 +87,8 @@ inline static QNetworkRequest buildRequest(const QString &path, const QVariantMa
         break;
     }
     
+    request.setRawHeader("Accept", "application/x-msgpack, application/json");
+    
     if (Settings::serverAuthenticationEnabled()) {
         request.setRawHeader("Authorization", "Basic " + QString("%1:%2").arg(Settings::serverUsername())
                                                                 .arg(Settings::serverPassword()).toUtf8().toBase64());
@@ -87,4 +97,60 @@ inline static QNetworkRequest buildRequest(const QString &path, const QVariantMa
     return request;
 }
 
+// Parses the response in the format chosen by the server
+inline static QVariant parseReply(QNetworkReply *reply) {
+    const QByteArray data = reply->readAll();
+    
+    if (reply->header(QNetworkRequest::ContentTypeHeader).toString().startsWith("application/x-msgpack")) {
+        return MsgPackReader::parse(data);
+    }
+    
+    return QtJson::Json::parse(QString::fromUtf8(data));
+}
+
+// Server responses that mean the request may succeed if it is sent again later
+inline static bool isTransientError(QNetworkReply *reply) {
+    const int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    return (status == 429) || (status >= 500);
+}
+
+// Errors that mean the server could not be reached or is temporarily unavailable, rather than that
+// the request failed
+inline static bool isNetworkUnavailable(QNetworkReply *reply) {
+    const QNetworkReply::NetworkError error = reply->error();
+    
+    if ((error == QNetworkReply::NoError) || (error == QNetworkReply::OperationCanceledError)) {
+        return false;
+    }
+    
+    return (error < QNetworkReply::ContentAccessDenied) || (isTransientError(reply));
+}
+
+// Returns the delay in msecs requested by the Retry-After header of the reply, or defaultDelay
+inline static int retryDelay(QNetworkReply *reply, int defaultDelay) {
+    static const int MAX_DELAY = 3600000;
+    const QByteArray value = reply->rawHeader("Retry-After").trimmed();
+    
+    if (value.isEmpty()) {
+        return defaultDelay;
+    }
+    
+    bool ok;
+    qint64 delay = value.toLongLong(&ok) * 1000;
+    
+    if (!ok) {
+        // e.g. "Fri, 31 Dec 1999 23:59:59 GMT"
+        QDateTime date = QLocale::c().toDateTime(QString::fromLatin1(value.left(25)), "ddd, dd MMM yyyy hh:mm:ss");
+        
+        if (!date.isValid()) {
+            return defaultDelay;
+        }
+        
+        date.setTimeSpec(Qt::UTC);
+        delay = QDateTime::currentDateTimeUtc().msecsTo(date);
+    }
+    
+    return int(qBound(qint64(0), delay, qint64(MAX_DELAY)));
+}
+
 #endif
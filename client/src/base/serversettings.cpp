@@ -130,7 +130,7 @@ void ServerSettings::onSettingsLoaded(QNetworkReply *reply) {
         return;
     }
     
-    const QVariantMap settings = QtJson::Json::parse(QString::fromUtf8(reply->readAll())).toMap();
+    const QVariantMap settings = parseReply(reply).toMap();
     reply->deleteLater();
     
     if (settings.isEmpty()) {
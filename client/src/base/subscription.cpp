@@ -313,11 +313,15 @@ void Subscription::setAutoUpdate(bool enabled) {
         if (enabled) {
             connect(DBNotify::instance(), SIGNAL(articleRead(QString, QString, bool, QVariantMap)),
                     this, SLOT(onArticleRead(QString, QString, bool)));
+            connect(DBNotify::instance(), SIGNAL(articlesRead(QStringList, QStringList, bool)),
+                    this, SLOT(onArticlesRead(QStringList, QStringList, bool)));
             connect(DBNotify::instance(), SIGNAL(subscriptionRead(QString, bool, QVariantMap)),
                     this, SLOT(onSubscriptionRead(QString, bool, QVariantMap)));
             connect(DBNotify::instance(), SIGNAL(allSubscriptionsRead()), this, SLOT(onAllSubscriptionsRead()));
             connect(DBNotify::instance(), SIGNAL(subscriptionUpdated(QString, QVariantMap)),
                     this, SLOT(onSubscriptionUpdated(QString, QVariantMap)));
+            connect(DBNotify::instance(), SIGNAL(subscriptionsUpdated(QVariantList)),
+                    this, SLOT(onSubscriptionsUpdated(QVariantList)));
         }
         else {
             disconnect(DBNotify::instance(), 0, this, 0);
@@ -370,6 +374,14 @@ void Subscription::onArticleRead(const QString &, const QString &subscriptionId,
     }
 }
 
+void Subscription::onArticlesRead(const QStringList &, const QStringList &subscriptionIds, bool isRead) {
+    const int count = subscriptionIds.count(id());
+    
+    if (count > 0) {
+        setUnreadArticles(isRead ? unreadArticles() - count : unreadArticles() + count);
+    }
+}
+
 void Subscription::onSubscriptionFetched(DBConnection *connection) {
     if (connection->status() == DBConnection::Ready) {
         const QVariantMap result = connection->result().toMap();
@@ -399,3 +411,14 @@ void Subscription::onSubscriptionUpdated(const QString &subscriptionId, const QV
         load(properties);
     }
 }
+
+void Subscription::onSubscriptionsUpdated(const QVariantList &subscriptions) {
+    foreach (const QVariant &subscription, subscriptions) {
+        const QVariantMap properties = subscription.toMap();
+        
+        if (properties.value("id") == id()) {
+            load(properties);
+            return;
+        }
+    }
+}
@@ -134,10 +134,12 @@ public Q_SLOTS:
 
 private Q_SLOTS:
     void onArticleRead(const QString &articleId, const QString &subscriptionId, bool isRead);
+    void onArticlesRead(const QStringList &articleIds, const QStringList &subscriptionIds, bool isRead);
     void onSubscriptionFetched(DBConnection *connection);
     void onSubscriptionRead(const QString &subscriptionId, bool isRead, const QVariantMap &properties);
     void onAllSubscriptionsRead();
     void onSubscriptionUpdated(const QString &subscriptionId, const QVariantMap &properties);
+    void onSubscriptionsUpdated(const QVariantList &subscriptions);
 
 Q_SIGNALS:
     void idChanged();
@@ -21,6 +21,7 @@
 #include "json.h"
 #include "subscription.h"
 #include <QFont>
+#include <QSet>
 
 SubscriptionModel::SubscriptionModel(QObject *parent) :
     QAbstractListModel(parent),
@@ -251,8 +252,20 @@ void SubscriptionModel::onSubscriptionChanged(Subscription *subscription, int) {
 }
 
 void SubscriptionModel::onSubscriptionsAdded(const QVariantList &subscriptions) {
+    QSet<QString> ids;
+    
+    foreach (const Subscription *subscription, m_list) {
+        ids << subscription->id();
+    }
+    
     foreach (const QVariant &v, subscriptions) {
         const QVariantMap s = v.toMap();
+        
+        // Subscriptions added by this client are also reported by a sync
+        if (ids.contains(s.value("id").toString())) {
+            continue;
+        }
+        
         beginInsertRows(QModelIndex(), rowCount(), rowCount());
         Subscription *subscription = new Subscription(s.value("id").toString(),
                                                       s.value("description").toString(),
@@ -18,7 +18,6 @@
 #include "dbconnection.h"
 #include "dbnotify.h"
 #include "definitions.h"
-#include "json.h"
 #include "logger.h"
 #include "opmlparser.h"
 #include "requests.h"
@@ -213,7 +212,7 @@ void Subscriptions::checkStatus(QNetworkReply *reply) {
         return;
     }
     
-    const QVariantMap result = QtJson::Json::parse(QString::fromUtf8(reply->readAll())).toMap();
+    const QVariantMap result = parseReply(reply).toMap();
     
     if (!result.isEmpty()) {
         setActiveSubscription(result.value("activeSubscription").toString());
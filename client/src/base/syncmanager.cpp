@@ -0,0 +1,272 @@
+/*
+ * Copyright (C) 2017 Stuart Howarth <showarth@marxoft.co.uk>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "syncmanager.h"
+#include "dbnotify.h"
+#include "localcache.h"
+#include "logger.h"
+#include "requests.h"
+#include "settings.h"
+#include "transfermodel.h"
+#include <QNetworkReply>
+
+SyncManager* SyncManager::self = 0;
+
+SyncManager::SyncManager() :
+    QObject(),
+    m_nam(0),
+    m_sequence(LocalCache::instance()->syncSequence()),
+    m_syncing(false)
+{
+    m_timer.setInterval(DefaultSyncInterval);
+    m_timer.setSingleShot(true);
+    
+    connect(&m_timer, SIGNAL(timeout()), this, SLOT(sync()));
+    connect(Settings::instance(), SIGNAL(serverAddressChanged(QString)), this, SLOT(onServerAddressChanged(QString)));
+    connect(Subscriptions::instance(), SIGNAL(statusChanged(Subscriptions::Status)),
+            this, SLOT(onSubscriptionsStatusChanged(Subscriptions::Status)));
+    
+    if (!Settings::serverAddress().isEmpty()) {
+        sync();
+    }
+}
+
+SyncManager::~SyncManager() {
+    self = 0;
+}
+
+SyncManager* SyncManager::instance() {
+    return self ? self : self = new SyncManager;
+}
+
+int SyncManager::interval() const {
+    return m_timer.interval();
+}
+
+void SyncManager::setInterval(int i) {
+    if (i != interval()) {
+        m_timer.setInterval(i);
+        emit intervalChanged(i);
+    }
+}
+
+qlonglong SyncManager::sequence() const {
+    return m_sequence;
+}
+
+void SyncManager::sync() {
+    if ((m_syncing) || (Settings::serverAddress().isEmpty())) {
+        return;
+    }
+    
+    Logger::log("SyncManager::sync(). Sequence: " + QString::number(m_sequence), Logger::MediumVerbosity);
+    m_syncing = true;
+    m_timer.stop();
+    QVariantMap params;
+    params["since"] = m_sequence;
+    QNetworkReply *reply = networkAccessManager()->get(buildRequest("/sync", params));
+    connect(reply, SIGNAL(finished()), this, SLOT(onSyncFinished()));
+}
+
+void SyncManager::applyReadStates(const QVariantList &states, const QVariantMap &subscriptions) {
+    foreach (const QVariant &v, states) {
+        const QVariantMap state = v.toMap();
+        const QString id = state.value("subscriptionId").toString();
+        
+        if (id.isEmpty()) {
+            emit DBNotify::instance()->allSubscriptionsRead();
+        }
+        else if (subscriptions.contains(id)) {
+            emit DBNotify::instance()->subscriptionRead(id, state.value("read").toBool(),
+                                                        subscriptions.value(id).toMap());
+        }
+    }
+}
+
+void SyncManager::applyArticleChanges(const QVariantMap &changes) {
+    const QStringList removed = changes.value("removed").toStringList();
+    
+    if (!removed.isEmpty()) {
+        emit DBNotify::instance()->articlesDeleted(removed);
+    }
+    
+    QHash<QString, QStringList> added;
+    
+    foreach (const QVariant &v, changes.value("added").toList()) {
+        const QVariantMap article = v.toMap();
+        added[article.value("subscriptionId").toString()] << article.value("id").toString();
+    }
+    
+    QHashIterator<QString, QStringList> iterator(added);
+    
+    while (iterator.hasNext()) {
+        iterator.next();
+        emit DBNotify::instance()->articlesAdded(iterator.value(), iterator.key());
+    }
+    
+    // The changed articles are grouped by state, so that each state is announced only once
+    QStringList readIds;
+    QStringList readSubscriptionIds;
+    QStringList unreadIds;
+    QStringList unreadSubscriptionIds;
+    QStringList favouriteIds;
+    QStringList unfavouriteIds;
+    
+    foreach (const QVariant &v, changes.value("changed").toList()) {
+        const QVariantMap article = v.toMap();
+        const QString id = article.value("id").toString();
+        
+        if (article.value("read").toBool()) {
+            readIds << id;
+            readSubscriptionIds << article.value("subscriptionId").toString();
+        }
+        else {
+            unreadIds << id;
+            unreadSubscriptionIds << article.value("subscriptionId").toString();
+        }
+        
+        if (article.value("favourite").toBool()) {
+            favouriteIds << id;
+        }
+        else {
+            unfavouriteIds << id;
+        }
+    }
+    
+    if (!readIds.isEmpty()) {
+        emit DBNotify::instance()->articlesRead(readIds, readSubscriptionIds, true);
+    }
+    
+    if (!unreadIds.isEmpty()) {
+        emit DBNotify::instance()->articlesRead(unreadIds, unreadSubscriptionIds, false);
+    }
+    
+    if (!favouriteIds.isEmpty()) {
+        emit DBNotify::instance()->articlesFavourited(favouriteIds, true);
+    }
+    
+    if (!unfavouriteIds.isEmpty()) {
+        emit DBNotify::instance()->articlesFavourited(unfavouriteIds, false);
+    }
+}
+
+void SyncManager::applySubscriptionChanges(const QVariantMap &changes) {
+    foreach (const QString &id, changes.value("removed").toStringList()) {
+        emit DBNotify::instance()->subscriptionDeleted(id);
+    }
+    
+    const QVariantList added = changes.value("added").toList();
+    
+    if (!added.isEmpty()) {
+        emit DBNotify::instance()->subscriptionsAdded(added);
+    }
+    
+    // Subscriptions are applied after the articles, so that their unread counts are those of the server
+    const QVariantList changed = changes.value("changed").toList();
+    
+    if (!changed.isEmpty()) {
+        emit DBNotify::instance()->subscriptionsUpdated(changed);
+    }
+}
+
+QNetworkAccessManager* SyncManager::networkAccessManager() {
+    if (!m_nam) {
+        m_nam = new QNetworkAccessManager(this);
+    }
+    
+    return m_nam;
+}
+
+void SyncManager::onServerAddressChanged(const QString &address) {
+    m_sequence = 0;
+    m_timer.stop();
+    
+    if (!address.isEmpty()) {
+        sync();
+    }
+}
+
+void SyncManager::onSubscriptionsStatusChanged(Subscriptions::Status status) {
+    if (status == Subscriptions::Finished) {
+        sync();
+    }
+}
+
+void SyncManager::onSyncFinished() {
+    QNetworkReply *reply = qobject_cast<QNetworkReply*>(sender());
+    
+    if (!reply) {
+        return;
+    }
+    
+    m_syncing = false;
+    
+    if (reply->error() == QNetworkReply::NoError) {
+        const QVariantMap result = parseReply(reply).toMap();
+        const qlonglong sequence = result.value("sequence").toLongLong();
+        
+        if (!result.value("complete").toBool()) {
+            // Without an earlier sync, the models have been loaded from the server, so no reload is required
+            if (m_sequence > 0) {
+                Logger::log("SyncManager::onSyncFinished(). Changes not available. Reload required",
+                            Logger::LowVerbosity);
+                
+                if (TransferModel::instance()->status() != TransferModel::Idle) {
+                    TransferModel::instance()->load();
+                }
+                
+                LocalCache::instance()->invalidate();
+                emit reloadRequired();
+            }
+        }
+        else {
+            QVariantMap subscriptions;
+            
+            foreach (const QVariant &v, result.value("subscriptions").toMap().value("changed").toList()) {
+                const QVariantMap subscription = v.toMap();
+                subscriptions[subscription.value("id").toString()] = subscription;
+            }
+            
+            applyReadStates(result.value("readStates").toList(), subscriptions);
+            applyArticleChanges(result.value("articles").toMap());
+            applySubscriptionChanges(result.value("subscriptions").toMap());
+            
+            if (TransferModel::instance()->status() != TransferModel::Idle) {
+                const QVariantMap transfers = result.value("transfers").toMap();
+                TransferModel::instance()->applyChanges(transfers.value("added").toList(),
+                                                        transfers.value("changed").toList(),
+                                                        transfers.value("removed").toStringList());
+            }
+        }
+        
+        if (sequence > 0) {
+            m_sequence = sequence;
+            LocalCache::instance()->setSyncSequence(sequence);
+        }
+        
+        // The server can be reached, so any changes made while it could not are sent
+        LocalCache::instance()->sendPendingOperations();
+    }
+    else {
+        Logger::log("SyncManager::onSyncFinished(). Error: " + reply->errorString());
+    }
+    
+    if (!Settings::serverAddress().isEmpty()) {
+        m_timer.start();
+    }
+    
+    reply->deleteLater();
+}
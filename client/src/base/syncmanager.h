@@ -0,0 +1,92 @@
+/*
+ * Copyright (C) 2017 Stuart Howarth <showarth@marxoft.co.uk>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SYNCMANAGER_H
+#define SYNCMANAGER_H
+
+#include "subscriptions.h"
+#include <QTimer>
+#include <QVariantMap>
+
+class QNetworkAccessManager;
+
+/**
+ * Keeps the local models up to date by periodically requesting the changes made on the server
+ * since the last sync, rather than reloading them.
+ *
+ * Changes to articles and subscriptions are announced via DBNotify, and changes to transfers
+ * are applied to the TransferModel. If the server can no longer provide the changes (e.g. it
+ * has been restarted), reloadRequired() is emitted.
+ *
+ * The sequence of the last sync is kept in the LocalCache, so that the cache can be brought up
+ * to date on startup.
+ */
+class SyncManager : public QObject
+{
+    Q_OBJECT
+    
+    Q_PROPERTY(int interval READ interval WRITE setInterval NOTIFY intervalChanged)
+    
+    Q_ENUMS(SyncInterval)
+
+public:
+    enum SyncInterval {
+        DefaultSyncInterval = 30000
+    };
+    
+    ~SyncManager();
+    
+    static SyncManager* instance();
+    
+    int interval() const;
+    
+    qlonglong sequence() const;
+
+public Q_SLOTS:
+    void setInterval(int i);
+    
+    void sync();
+
+private Q_SLOTS:
+    void onServerAddressChanged(const QString &address);
+    void onSubscriptionsStatusChanged(Subscriptions::Status status);
+    void onSyncFinished();
+
+Q_SIGNALS:
+    void intervalChanged(int interval);
+    void reloadRequired();
+
+private:
+    SyncManager();
+    
+    void applyReadStates(const QVariantList &states, const QVariantMap &subscriptions);
+    void applyArticleChanges(const QVariantMap &changes);
+    void applySubscriptionChanges(const QVariantMap &changes);
+    
+    QNetworkAccessManager* networkAccessManager();
+    
+    static SyncManager *self;
+    
+    QNetworkAccessManager *m_nam;
+    
+    QTimer m_timer;
+    
+    qlonglong m_sequence;
+    
+    bool m_syncing;
+};
+
+#endif // SYNCMANAGER_H
@@ -339,6 +339,8 @@ QString Transfer::statusString() const {
         return tr("Uploading");
     case ExecutingCustomCommand:
         return tr("Executing custom command");
+    case WaitingForCustomCommand:
+        return tr("Waiting to execute custom command");
     default:
         return QString();
     }
@@ -433,7 +435,7 @@ void Transfer::onChanged() {
     }
     
     if (reply->error() == QNetworkReply::NoError) {
-        load(QtJson::Json::parse(QString::fromUtf8(reply->readAll())).toMap());
+        load(parseReply(reply).toMap());
     }
     
     reply->deleteLater();
@@ -95,6 +95,7 @@ public:
         Downloading,
         Uploading,
         ExecutingCustomCommand,
+        WaitingForCustomCommand,
         Unknown
     };
     
@@ -223,6 +224,8 @@ private:
     TransferType m_transferType;
     
     QString m_url;
+    
+    friend class TransferModel;
 };
 
 #endif // TRANSFER_H
@@ -20,6 +20,7 @@
 #include "json.h"
 #include "logger.h"
 #include "requests.h"
+#include "syncmanager.h"
 #include <QNetworkAccessManager>
 #include <QNetworkReply>
 
@@ -248,6 +249,27 @@ void TransferModel::addEnclosureDownload(const QString &url, const QString &comm
     connect(reply, SIGNAL(finished()), this, SLOT(onTransfersLoaded()));
 }
 
+void TransferModel::applyChanges(const QVariantList &added, const QVariantList &changed,
+                                 const QStringList &removed) {
+    // Added transfers may already be known if they were added by this client
+    foreach (const QVariant &v, added + changed) {
+        const QVariantMap properties = v.toMap();
+        
+        if (Transfer *transfer = get(properties.value("id").toString())) {
+            transfer->load(properties);
+        }
+        else {
+            append(createTransfer(properties));
+        }
+    }
+    
+    foreach (const QString &id, removed) {
+        if (Transfer *transfer = get(id)) {
+            remove(m_items.indexOf(transfer));
+        }
+    }
+}
+
 void TransferModel::start() {
     if (status() == Active) {
         return;
@@ -334,6 +356,15 @@ void TransferModel::clear() {
     }
 }
 
+Transfer* TransferModel::createTransfer(const QVariantMap &properties) {
+    switch (properties.value("transferType", Transfer::Download).toInt()) {
+    case Transfer::EnclosureDownload:
+        return new EnclosureDownload(properties, this);
+    default:
+        return new Download(properties, this);
+    }
+}
+
 QNetworkAccessManager* TransferModel::networkAccessManager() {
     if (!m_nam) {
         m_nam = new QNetworkAccessManager(this);
@@ -403,7 +434,7 @@ void TransferModel::onTransfersChanged() {
     if (reply->error() == QNetworkReply::NoError) {
         setErrorString(QString());
         setStatus(Ready);
-        load();
+        SyncManager::instance()->sync();
     }
     else {
         setErrorString(reply->errorString());
@@ -423,24 +454,15 @@ void TransferModel::onTransfersLoaded() {
     }
     
     if (reply->error() == QNetworkReply::NoError) {
-        const QVariantList list = QtJson::Json::parse(QString::fromUtf8(reply->readAll())).toList();
+        const QVariantList list = parseReply(reply).toList();
         
         foreach (const QVariant &v, list) {
-            const QVariantMap result = v.toMap();
-            const Transfer::TransferType type = Transfer::TransferType(result.value("transferType", Transfer::Download)
-                                                                       .toInt());
-            Transfer *transfer;
+            const QVariantMap properties = v.toMap();
             
-            switch (type) {
-            case Transfer::EnclosureDownload:
-                transfer = new EnclosureDownload(result, this);
-                break;
-            default:
-                transfer = new Download(result, this);
-                break;
+            // The transfer may already have been added by a sync
+            if (!get(properties.value("id").toString())) {
+                append(createTransfer(properties));
             }
-            
-            append(transfer);
         }
         
         setErrorString(QString());
@@ -18,6 +18,8 @@
 #define TRANSFERMODEL_H
 
 #include <QAbstractListModel>
+#include <QStringList>
+#include <QVariantList>
 
 class Transfer;
 class QNetworkAccessManager;
@@ -79,6 +81,8 @@ public:
     Q_INVOKABLE void addEnclosureDownload(const QString &url, const QString &command, bool overrideGlobalCommand,
             const QString &category, int priority, bool usePlugin);    
     
+    void applyChanges(const QVariantList &added, const QVariantList &changed, const QStringList &removed);
+    
 public Q_SLOTS:
     void load();
     void start();
@@ -109,6 +113,8 @@ private:
     
     void setStatus(Status s);
         
+    Transfer* createTransfer(const QVariantMap &properties);
+        
     QNetworkAccessManager* networkAccessManager();
     
     static TransferModel *self;
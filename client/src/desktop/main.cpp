@@ -17,11 +17,13 @@
 #include "dbconnection.h"
 #include "dbnotify.h"
 #include "definitions.h"
+#include "localcache.h"
 #include "logger.h"
 #include "mainwindow.h"
 #include "pluginmanager.h"
 #include "settings.h"
 #include "subscriptions.h"
+#include "syncmanager.h"
 #include "transfermodel.h"
 #include "urlopenermodel.h"
 #include <QApplication>
@@ -57,9 +59,11 @@ Q_DECL_EXPORT int main(int argc, char *argv[]) {
 #endif
 
     QScopedPointer<DBNotify> notify(DBNotify::instance());
+    QScopedPointer<LocalCache> cache(LocalCache::instance());
     QScopedPointer<PluginManager> plugins(PluginManager::instance());
     QScopedPointer<Settings> settings(Settings::instance());
     QScopedPointer<Subscriptions> subscriptions(Subscriptions::instance());
+    QScopedPointer<SyncManager> syncManager(SyncManager::instance());
     QScopedPointer<TransferModel> transfers(TransferModel::instance());
     QScopedPointer<UrlOpenerModel> opener(UrlOpenerModel::instance());
     
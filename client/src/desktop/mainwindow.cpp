@@ -34,6 +34,7 @@
 #include "subscription.h"
 #include "subscriptiondialog.h"
 #include "subscriptionmodel.h"
+#include "syncmanager.h"
 #include "transfermodel.h"
 #include "transferspage.h"
 #include "urlopenermodel.h"
@@ -317,6 +318,7 @@ MainWindow::MainWindow(QWidget *parent) :
     connect(Subscriptions::instance(), SIGNAL(statusChanged(Subscriptions::Status)),
             this, SLOT(onSubscriptionsStatusChanged(Subscriptions::Status)));
     connect(Subscriptions::instance(), SIGNAL(statusTextChanged(QString)), this, SLOT(showMessage(QString)));
+    connect(SyncManager::instance(), SIGNAL(reloadRequired()), this, SLOT(reloadData()));
     connect(DBNotify::instance(), SIGNAL(error(QString)), this, SLOT(showError(QString)));
     connect(DBNotify::instance(), SIGNAL(readArticlesDeleted(int)), this, SLOT(onReadArticlesDeleted(int)));
     connect(Settings::instance(), SIGNAL(enableJavaScriptInBrowserChanged(bool)),
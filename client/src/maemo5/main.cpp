@@ -18,11 +18,13 @@
 #include "dbconnection.h"
 #include "dbnotify.h"
 #include "definitions.h"
+#include "localcache.h"
 #include "logger.h"
 #include "pluginmanager.h"
 #include "serversettings.h"
 #include "settings.h"
 #include "subscriptions.h"
+#include "syncmanager.h"
 #include "transfermodel.h"
 #include "urlopenermodel.h"
 #include <QApplication>
@@ -52,10 +54,12 @@ Q_DECL_EXPORT int main(int argc, char *argv[]) {
     
     QScopedPointer<CuteNews> cutenews(CuteNews::instance());
     QScopedPointer<DBNotify> notify(DBNotify::instance());
+    QScopedPointer<LocalCache> cache(LocalCache::instance());
     QScopedPointer<PluginManager> plugins(PluginManager::instance());
     QScopedPointer<ServerSettings> serversettings(ServerSettings::instance());
     QScopedPointer<Settings> settings(Settings::instance());
     QScopedPointer<Subscriptions> subscriptions(Subscriptions::instance());
+    QScopedPointer<SyncManager> syncManager(SyncManager::instance());
     QScopedPointer<TransferModel> transfers(TransferModel::instance());
     QScopedPointer<UrlOpenerModel> opener(UrlOpenerModel::instance());
 
@@ -15,7 +15,6 @@
  */
 
 #include "articlerequest.h"
-#include "json.h"
 #include "logger.h"
 #include "requests.h"
 #include <QNetworkAccessManager>
@@ -134,7 +133,7 @@ void ArticleRequest::checkArticle(QNetworkReply *reply) {
             return;
     }
 
-    const QVariantMap result = QtJson::Json::parse(QString::fromUtf8(reply->readAll())).toMap();
+    const QVariantMap result = parseReply(reply).toMap();
 
     if (result.isEmpty()) {
         setErrorString(tr("Article result is empty"));
@@ -15,7 +15,6 @@
  */
 
 #include "enclosurerequest.h"
-#include "json.h"
 #include "logger.h"
 #include "requests.h"
 #include <QNetworkAccessManager>
@@ -114,7 +113,7 @@ void EnclosureRequest::checkEnclosure(QNetworkReply *reply) {
             return;
     }
 
-    const QVariantMap result = QtJson::Json::parse(QString::fromUtf8(reply->readAll())).toMap();
+    const QVariantMap result = parseReply(reply).toMap();
 
     if (result.isEmpty()) {
         setErrorString(tr("Enclosure result is empty"));
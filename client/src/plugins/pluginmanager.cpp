@@ -17,7 +17,6 @@
 
 #include "pluginmanager.h"
 #include "definitions.h"
-#include "json.h"
 #include "logger.h"
 #include "requests.h"
 #include <QNetworkAccessManager>
@@ -159,7 +158,7 @@ QNetworkAccessManager* PluginManager::networkAccessManager() {
 
 void PluginManager::onPluginsLoaded(QNetworkReply *reply) {
     if (reply->error() == QNetworkReply::NoError) {
-        const QVariantList plugins = QtJson::Json::parse(QString::fromUtf8(reply->readAll())).toList();
+        const QVariantList plugins = parseReply(reply).toList();
     
         foreach (const QVariant &p, plugins) {
             m_plugins << new FeedPluginConfig(p.toMap(), this);
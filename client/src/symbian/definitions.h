@@ -23,6 +23,9 @@
 static const QString APP_CONFIG_PATH(QDesktopServices::storageLocation(QDesktopServices::HomeLocation)
                                      + "/.config/cutenews-client/");
 
+// Local cache
+static const QString LOCAL_CACHE_NAME(APP_CONFIG_PATH + "cache.db");
+
 // Network
 static const int MAX_CONCURRENT_TRANSFERS = 4;
 static const int MAX_REDIRECTS = 8;
@@ -21,6 +21,7 @@
 #include "dbconnection.h"
 #include "dbnotify.h"
 #include "definitions.h"
+#include "localcache.h"
 #include "logger.h"
 #include "loggerverbositymodel.h"
 #include "pluginconfigmodel.h"
@@ -32,6 +33,7 @@
 #include "subscriptionmodel.h"
 #include "subscriptions.h"
 #include "subscriptionsourcetypemodel.h"
+#include "syncmanager.h"
 #include "transfermodel.h"
 #include "transferprioritymodel.h"
 #include "updateintervaltypemodel.h"
@@ -85,10 +87,12 @@ Q_DECL_EXPORT int main(int argc, char *argv[]) {
     QSslConfiguration::setDefaultConfiguration(config);
 
     QScopedPointer<DBNotify> notify(DBNotify::instance());
+    QScopedPointer<LocalCache> cache(LocalCache::instance());
     QScopedPointer<PluginManager> plugins(PluginManager::instance());
     QScopedPointer<ServerSettings> serversettings(ServerSettings::instance());
     QScopedPointer<Settings> settings(Settings::instance());
     QScopedPointer<Subscriptions> subscriptions(Subscriptions::instance());
+    QScopedPointer<SyncManager> syncManager(SyncManager::instance());
     QScopedPointer<TransferModel> transfers(TransferModel::instance());
     QScopedPointer<UrlOpenerModel> opener(UrlOpenerModel::instance());
     